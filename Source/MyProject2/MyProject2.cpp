@@ -3,4 +3,7 @@
 #include "MyProject2.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_LOG_CATEGORY(LogStrategyCamera);
+DEFINE_LOG_CATEGORY(LogStrategyUnits);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, MyProject2, "MyProject2" );
@@ -3,4 +3,10 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
 
+MYPROJECT2_API DECLARE_LOG_CATEGORY_EXTERN(LogStrategyCamera, Log, All);
+MYPROJECT2_API DECLARE_LOG_CATEGORY_EXTERN(LogStrategyUnits, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("StrategyCamera"), STATGROUP_StrategyCamera, STATCAT_Advanced);
+DECLARE_STATS_GROUP(TEXT("StrategyUnits"), STATGROUP_StrategyUnits, STATCAT_Advanced);
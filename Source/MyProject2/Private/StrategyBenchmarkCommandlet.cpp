@@ -0,0 +1,3032 @@
+// StrategyBenchmarkCommandlet.cpp
+#include "StrategyBenchmarkCommandlet.h"
+#include "MyProject2.h"
+#include "StrategyGameMode.h"
+#include "StrategyPlayerController.h"
+#include "StrategyCameraPawn.h"
+#include "StrategyCursorQueryComponent.h"
+#include "StrategyCameraSpring.h"
+#include "StrategyCameraProfiler.h"
+#include "StrategyCurveTable.h"
+#include "StrategyUnitRegistrySubsystem.h"
+#include "StrategyUnitSimulationSubsystem.h"
+#include "StrategyFlowFieldSubsystem.h"
+#include "StrategyTerrainHeightSubsystem.h"
+#include "StrategyFogOfWarSubsystem.h"
+#include "StrategyMinimapSubsystem.h"
+#include "StrategyLockstep.h"
+#include "StrategyLockstepSubsystem.h"
+#include "StrategyPlacementSubsystem.h"
+#include "StrategyFormation.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "NavigationPath.h"
+#include "NavMesh/NavMeshBoundsVolume.h"
+#include "Algo/Unique.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Components/BoxComponent.h"
+#include "Components/BrushComponent.h"
+#include "Curves/CurveFloat.h"
+#include "EnhancedInputSubsystems.h"
+#include "InputAction.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "GameFramework/PawnMovementComponent.h"
+#include "GameFramework/SpringArmComponent.h"
+#include "GameFramework/WorldSettings.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/MemoryBase.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "SceneView.h"
+#include <atomic>
+
+namespace StrategyBenchmark
+{
+	// Forwards every call to the real allocator and counts allocations on all threads.
+	// Installed once, when the commandlet starts, and never removed: any thread may have read GMalloc and call through it
+	// at any time, so Inner must stay valid for the rest of the process. Measurements read deltas of the count.
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		void Install()
+		{
+			if (!Inner)
+			{
+				Inner = GMalloc;
+				GMalloc = this;
+			}
+		}
+
+		uint64 GetNumAllocations() const { return NumAllocations.load(std::memory_order_relaxed); }
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			NumAllocations.fetch_add(1, std::memory_order_relaxed);
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			NumAllocations.fetch_add(1, std::memory_order_relaxed);
+			return Inner->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			NumAllocations.fetch_add(1, std::memory_order_relaxed);
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			NumAllocations.fetch_add(1, std::memory_order_relaxed);
+			return Inner->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void UpdateStats() override { Inner->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("StrategyBenchmarkCountingMalloc"); }
+
+	private:
+		FMalloc* Inner = nullptr;
+		std::atomic<uint64> NumAllocations{ 0 };
+	};
+
+	FCountingMalloc& GetCountingMalloc()
+	{
+		// Never destroyed: allocations made through it may outlive the benchmark.
+		static FCountingMalloc* CountingMalloc = new FCountingMalloc();
+		return *CountingMalloc;
+	}
+
+	struct FFrameSample
+	{
+		double GameThreadMs = 0.0;
+		uint64 Allocations = 0;
+		uint64 TracesIssued = 0;
+		uint64 CursorQueries = 0;
+		uint64 CameraTicks = 0;
+		uint64 PawnMoves = 0;
+		float ArmLength = 0.f;
+	};
+
+	double Percentile(TArray<double> Values, double Fraction)
+	{
+		if (Values.IsEmpty())
+		{
+			return 0.0;
+		}
+		Values.Sort();
+		const int32 Index = FMath::Clamp(FMath::CeilToInt32(Fraction * Values.Num()) - 1, 0, Values.Num() - 1);
+		return Values[Index];
+	}
+
+	// Ray through a pixel of a virtual 1920x1080 screen: a pinhole camera with a 90 degree horizontal field of view at
+	// the current camera view, so a still cursor keeps the same camera-space ray like a real deprojection.
+	bool GetSimulatedCursorRay(const AStrategyPlayerController& Controller, const FVector2D& ScreenPosition, FVector& OutOrigin, FVector& OutDirection)
+	{
+		const APlayerCameraManager* CameraManager = Controller.PlayerCameraManager;
+		if (!CameraManager)
+		{
+			return false;
+		}
+
+		const FVector2D Normalized = ScreenPosition / FVector2D(1920.0, 1080.0) - FVector2D(0.5, 0.5);
+		const FVector LocalDirection(1.0, Normalized.X * 2.0, -Normalized.Y * 2.0 * 1080.0 / 1920.0);
+		OutOrigin = CameraManager->GetCameraLocation();
+		OutDirection = CameraManager->GetCameraRotation().RotateVector(LocalDirection).GetSafeNormal();
+		return true;
+	}
+
+	void SetSimulatedCursor(AStrategyPlayerController& Controller, const FVector2D& ScreenPosition)
+	{
+		FVector Origin;
+		FVector Direction;
+		if (GetSimulatedCursorRay(Controller, ScreenPosition, Origin, Direction))
+		{
+			Controller.GetCursorQuery()->SetSimulatedCursor(ScreenPosition, Origin, Direction);
+		}
+	}
+
+	// Ground point under a pixel of the virtual screen, as rendered this frame.
+	bool TraceSimulatedCursor(const AStrategyPlayerController& Controller, const FVector2D& ScreenPosition, FVector& OutGroundPoint)
+	{
+		FVector Origin;
+		FVector Direction;
+		FHitResult Hit;
+		if (!GetSimulatedCursorRay(Controller, ScreenPosition, Origin, Direction)
+			|| !Controller.GetWorld()->LineTraceSingleByChannel(Hit, Origin, Origin + Direction * 1.0e6, ECC_Visibility))
+		{
+			return false;
+		}
+		OutGroundPoint = Hit.Location;
+		return true;
+	}
+}
+
+UStrategyBenchmarkCommandlet::UStrategyBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UStrategyBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString Suite = TEXT("Camera");
+	FParse::Value(*Params, TEXT("Suite="), Suite);
+
+	// Before any benchmark world spawns async traces or parallel work.
+	if (!FParse::Param(*Params, TEXT("NoAllocCount")))
+	{
+		StrategyBenchmark::GetCountingMalloc().Install();
+	}
+
+	FString Csv;
+	int32 Result = 1;
+	if (Suite == TEXT("Camera"))
+	{
+		Result = RunCameraSuite(Params, Csv);
+	}
+	else if (Suite == TEXT("ZoomTiers"))
+	{
+		Result = RunZoomTierSuite(Params, Csv);
+	}
+	else if (Suite == TEXT("PitchTable"))
+	{
+		Result = RunPitchTableSuite(Params, Csv);
+	}
+	else if (Suite == TEXT("CameraSpring"))
+	{
+		Result = RunCameraSpringSuite(Params, Csv);
+	}
+	else if (Suite == TEXT("InputReplay"))
+	{
+		Result = RunInputReplaySuite(Params, Csv);
+	}
+	else if (Suite == TEXT("TerrainHeight"))
+	{
+		Result = RunTerrainHeightSuite(Params, Csv);
+	}
+	else if (Suite == TEXT("Selection"))
+	{
+		Result = RunSelectionSuite(Params, Csv);
+	}
+	else if (Suite == TEXT("Units"))
+	{
+		Result = RunUnitSimulationSuite(Params, Csv);
+	}
+	else if (Suite == TEXT("FlowField"))
+	{
+		Result = RunFlowFieldSuite(Params, Csv);
+	}
+	else if (Suite == TEXT("FogOfWar"))
+	{
+		Result = RunFogOfWarSuite(Params, Csv);
+	}
+	else if (Suite == TEXT("Minimap"))
+	{
+		Result = RunMinimapSuite(Params, Csv);
+	}
+	else if (Suite == TEXT("Bookmarks"))
+	{
+		Result = RunBookmarkSuite(Params, Csv);
+	}
+	else if (Suite == TEXT("Lockstep"))
+	{
+		Result = RunLockstepSuite(Params, Csv);
+	}
+	else if (Suite == TEXT("Placement"))
+	{
+		Result = RunPlacementSuite(Params, Csv);
+	}
+	else if (Suite == TEXT("Startup"))
+	{
+		Result = RunStartupSuite(Params, Csv);
+	}
+	else if (Suite == TEXT("Formation"))
+	{
+		Result = RunFormationSuite(Params, Csv);
+	}
+	else
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Unknown suite '%s'."), *Suite);
+		return 1;
+	}
+
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("StrategyBenchmark-%s-%s.csv"), *Suite, *FDateTime::Now().ToString());
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	if (!Csv.IsEmpty())
+	{
+		if (FFileHelper::SaveStringToFile(Csv, *OutputPath))
+		{
+			UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] Wrote %s"), *OutputPath);
+		}
+		else
+		{
+			UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Failed to write %s"), *OutputPath);
+			Result = 1;
+		}
+	}
+
+	return Result;
+}
+
+int32 UStrategyBenchmarkCommandlet::RunCameraSuite(const FString& Params, FString& OutCsv) const
+{
+	int32 NumFrames = 600;
+	float DeltaTime = 1.f / 60.f;
+	FString ScenarioFilter;
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("DeltaTime="), DeltaTime);
+	FParse::Value(*Params, TEXT("Scenario="), ScenarioFilter);
+
+	UGameInstance* GameInstance = nullptr;
+	UWorld* World = CreateBenchmarkWorld(GameInstance);
+	AStrategyPlayerController* Controller = World ? CreatePlayer(*World, *GameInstance, Params) : nullptr;
+	if (!Controller)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Could not create the benchmark world or player."));
+		DestroyBenchmarkWorld(World, GameInstance);
+		return 1;
+	}
+
+	const FVector2D ScreenCenter(960.0, 540.0);
+
+	// Every scenario starts from a camera at rest, with the cursor in the middle of the screen: ticks until a frame
+	// passes without a camera update (at most ten seconds).
+	auto SettleCamera = [World, Controller, DeltaTime, ScreenCenter]()
+	{
+		StrategyBenchmark::SetSimulatedCursor(*Controller, ScreenCenter);
+		for (int32 Frame = 0; Frame < 600; ++Frame)
+		{
+			const uint64 CameraTicksBefore = Controller->GetNumCameraUpdateTicks();
+			World->Tick(LEVELTICK_All, DeltaTime);
+			++GFrameCounter;
+			if (Frame > 0 && Controller->GetNumCameraUpdateTicks() == CameraTicksBefore)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+	TArray<TPair<FString, FInputStep>> Scenarios;
+
+	// Five-notch wheel bursts in, then out, every second, with the cursor off-center.
+	Scenarios.Emplace(TEXT("WheelBurst"), [ScreenCenter](AStrategyPlayerController& PC, int32 Frame)
+	{
+		StrategyBenchmark::SetSimulatedCursor(PC, ScreenCenter + FVector2D(300.0, -150.0));
+		const int32 Phase = Frame % 60;
+		if (Phase < 5)
+		{
+			PC.HandleZoomInput(FInputActionValue(1.f));
+		}
+		else if (Phase >= 30 && Phase < 35)
+		{
+			PC.HandleZoomInput(FInputActionValue(-1.f));
+		}
+	});
+
+	// Continuous diagonal pan with a still cursor: the camera moves every frame.
+	Scenarios.Emplace(TEXT("Pan"), [ScreenCenter](AStrategyPlayerController& PC, int32 Frame)
+	{
+		StrategyBenchmark::SetSimulatedCursor(PC, ScreenCenter);
+		PC.HandleMoveInput(FInputActionValue(FVector2D(0.7, 1.0)));
+	});
+
+	// Rotate drag with the mouse moving every frame.
+	Scenarios.Emplace(TEXT("RotateDrag"), [ScreenCenter, NumFrames](AStrategyPlayerController& PC, int32 Frame)
+	{
+		StrategyBenchmark::SetSimulatedCursor(PC, ScreenCenter + FVector2D(4.0 * (Frame % 100), 0.0));
+		if (Frame == 0)
+		{
+			PC.HandleRotateCameraTrigger(FInputActionValue(true));
+		}
+		PC.HandleRotateCameraValue(FInputActionValue(FVector2D(4.0, 0.0)));
+		if (Frame == NumFrames - 1)
+		{
+			PC.HandleRotateCameraTrigger(FInputActionValue(false));
+		}
+	});
+
+	// Everything at once: pan, rotate drag and periodic wheel bursts while the cursor circles.
+	Scenarios.Emplace(TEXT("Mixed"), [ScreenCenter, NumFrames](AStrategyPlayerController& PC, int32 Frame)
+	{
+		const double Angle = Frame * 0.05;
+		StrategyBenchmark::SetSimulatedCursor(PC, ScreenCenter + FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * 250.0);
+		PC.HandleMoveInput(FInputActionValue(FVector2D(FMath::Sin(Angle), 1.0)));
+		if (Frame == 0)
+		{
+			PC.HandleRotateCameraTrigger(FInputActionValue(true));
+		}
+		PC.HandleRotateCameraValue(FInputActionValue(FVector2D(2.0, 0.0)));
+		if (Frame % 45 < 3)
+		{
+			PC.HandleZoomInput(FInputActionValue((Frame / 45) % 2 == 0 ? 1.f : -1.f));
+		}
+		if (Frame == NumFrames - 1)
+		{
+			PC.HandleRotateCameraTrigger(FInputActionValue(false));
+		}
+	});
+
+	// Two key mappings held at once (e.g. WASD and arrows), with the cursor in the right edge band for the first half
+	// and a drag for the second: every source is active, yet the pawn must move at most once per frame.
+	Scenarios.Emplace(TEXT("CombinedPan"), [ScreenCenter, NumFrames](AStrategyPlayerController& PC, int32 Frame)
+	{
+		const int32 HalfFrames = NumFrames / 2;
+		if (Frame < HalfFrames)
+		{
+			StrategyBenchmark::SetSimulatedCursor(PC, FVector2D(1915.0, ScreenCenter.Y + 300.0 * FMath::Sin(Frame * 0.05)));
+		}
+		else
+		{
+			StrategyBenchmark::SetSimulatedCursor(PC, ScreenCenter + FVector2D(3.0 * (Frame - HalfFrames) - 300.0, 0.0));
+			if (Frame == HalfFrames)
+			{
+				PC.HandlePanDragStarted(FInputActionValue(true));
+			}
+		}
+		PC.HandleMoveInput(FInputActionValue(FVector2D(0.0, 1.0)));
+		PC.HandleMoveInput(FInputActionValue(FVector2D(1.0, 0.0)));
+		if (Frame == NumFrames - 1)
+		{
+			PC.HandlePanDragCompleted(FInputActionValue(false));
+		}
+	});
+
+	// Checks run after a scenario's frame has ticked, outside the timed part.
+	TMap<FString, FInputStep> FrameChecks;
+
+	// Wheel bursts in with the cursor held on an off-center pixel, jumping to the other pixel in the frame each gesture
+	// begins (so the last async cursor trace is for the old one). The ground point under the pixel is traced when each
+	// gesture begins, then again after every frame until the zoom out: it must stay within 1 cm of where it started.
+	const FVector2D ZoomCursors[2] = { ScreenCenter + FVector2D(-420.0, 260.0), ScreenCenter + FVector2D(380.0, -210.0) };
+	const int32 ZoomCycleFrames = 180;
+	FVector ZoomAnchorPoint = FVector::ZeroVector;
+	bool bZoomAnchorValid = false;
+	double MaxZoomDrift = 0.0;
+	int32 NumZoomDriftFrames = 0;
+	int32 NumZoomMissedTraces = 0;
+	Scenarios.Emplace(TEXT("ZoomToCursor"), [ZoomCursors, ZoomCycleFrames, &ZoomAnchorPoint, &bZoomAnchorValid, &NumZoomMissedTraces](AStrategyPlayerController& PC, int32 Frame)
+	{
+		const FVector2D ZoomCursor = ZoomCursors[(Frame / ZoomCycleFrames) % 2];
+		StrategyBenchmark::SetSimulatedCursor(PC, ZoomCursor);
+		const int32 Phase = Frame % ZoomCycleFrames;
+		if (Phase == 0)
+		{
+			bZoomAnchorValid = StrategyBenchmark::TraceSimulatedCursor(PC, ZoomCursor, ZoomAnchorPoint);
+			NumZoomMissedTraces += bZoomAnchorValid ? 0 : 1;
+		}
+		if (Phase < 5)
+		{
+			PC.HandleZoomInput(FInputActionValue(1.f));
+		}
+		else if (Phase >= ZoomCycleFrames / 2 && Phase < ZoomCycleFrames / 2 + 5)
+		{
+			// Zooming out isn't anchored.
+			bZoomAnchorValid = false;
+			PC.HandleZoomInput(FInputActionValue(-1.f));
+		}
+	});
+	FrameChecks.Add(TEXT("ZoomToCursor"), [ZoomCursors, ZoomCycleFrames, &ZoomAnchorPoint, &bZoomAnchorValid, &MaxZoomDrift, &NumZoomDriftFrames, &NumZoomMissedTraces](AStrategyPlayerController& PC, int32 Frame)
+	{
+		const FVector2D ZoomCursor = ZoomCursors[(Frame / ZoomCycleFrames) % 2];
+		FVector GroundPoint;
+		if (!bZoomAnchorValid)
+		{
+			return;
+		}
+		if (!StrategyBenchmark::TraceSimulatedCursor(PC, ZoomCursor, GroundPoint))
+		{
+			++NumZoomMissedTraces;
+			return;
+		}
+		const double Drift = FVector::Dist(GroundPoint, ZoomAnchorPoint);
+		MaxZoomDrift = FMath::Max(MaxZoomDrift, Drift);
+		if (Drift >= 1.0)
+		{
+			++NumZoomDriftFrames;
+		}
+	});
+
+	// An idle session: no input at all once the camera has settled. The camera update must stay asleep and the pawn's
+	// movement component must never tick.
+	uint64 IdleCameraTicksBefore = 0;
+	int32 NumIdleMovementTickFrames = 0;
+	Scenarios.Emplace(TEXT("Idle"), [&IdleCameraTicksBefore](AStrategyPlayerController& PC, int32 Frame)
+	{
+		if (Frame == 0)
+		{
+			IdleCameraTicksBefore = PC.GetNumCameraUpdateTicks();
+		}
+	});
+	FrameChecks.Add(TEXT("Idle"), [&NumIdleMovementTickFrames](AStrategyPlayerController& PC, int32 Frame)
+	{
+		const UPawnMovementComponent* MovementComponent = PC.PossessedCameraPawn ? PC.PossessedCameraPawn->GetMovementComponent() : nullptr;
+		if (MovementComponent && MovementComponent->IsComponentTickEnabled())
+		{
+			++NumIdleMovementTickFrames;
+		}
+	});
+
+	OutCsv = TEXT("Scenario,Frame,GameThreadMs,Allocations,TracesIssued,CursorQueries,CameraTicks,PawnMoves,ArmLength\n");
+	int32 NumFailures = 0;
+	for (const TPair<FString, FInputStep>& Scenario : Scenarios)
+	{
+		if (ScenarioFilter.IsEmpty() || ScenarioFilter == Scenario.Key)
+		{
+			if (!SettleCamera())
+			{
+				UE_LOG(LogStrategyCamera, Warning, TEXT("[BENCHMARK] %s: the camera was still moving after ten seconds without input."), *Scenario.Key);
+			}
+			FStrategyCameraProfiler::Get().Reset();
+			const FInputStep* FrameCheck = FrameChecks.Find(Scenario.Key);
+			const uint64 MaxPawnMoves = RunCameraScenario(Scenario.Key, *World, *Controller, NumFrames, DeltaTime, Scenario.Value, OutCsv, FrameCheck ? *FrameCheck : FInputStep());
+			if (MaxPawnMoves > 1)
+			{
+				UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] %s moved the pawn %llu times in one frame."), *Scenario.Key, MaxPawnMoves);
+				++NumFailures;
+			}
+			FStrategyCameraProfiler::Get().Summarize().Log(*GLog);
+		}
+	}
+
+	if (ScenarioFilter.IsEmpty() || ScenarioFilter == TEXT("Idle"))
+	{
+		const uint64 IdleCameraTicks = Controller->GetNumCameraUpdateTicks() - IdleCameraTicksBefore;
+		UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] Idle: %llu camera update ticks, movement component ticking in %d frames."), IdleCameraTicks, NumIdleMovementTickFrames);
+		if (IdleCameraTicks > 0 || NumIdleMovementTickFrames > 0)
+		{
+			UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Idle: the camera updated %llu times and the movement component ticked in %d frames without input."),
+				IdleCameraTicks, NumIdleMovementTickFrames);
+			++NumFailures;
+		}
+	}
+
+	if (ScenarioFilter.IsEmpty() || ScenarioFilter == TEXT("ZoomToCursor"))
+	{
+		UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] ZoomToCursor: cursor ground point drift max %.3f cm, %d frames at 1 cm or more."), MaxZoomDrift, NumZoomDriftFrames);
+		if (NumZoomDriftFrames > 0 || NumZoomMissedTraces > 0)
+		{
+			UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] ZoomToCursor: the point under the cursor drifted 1 cm or more in %d frames (max %.3f cm); %d traces missed the ground."),
+				NumZoomDriftFrames, MaxZoomDrift, NumZoomMissedTraces);
+			++NumFailures;
+		}
+	}
+
+	DestroyBenchmarkWorld(World, GameInstance);
+	return NumFailures == 0 ? 0 : 1;
+}
+
+int32 UStrategyBenchmarkCommandlet::RunZoomTierSuite(const FString& Params, FString& OutCsv) const
+{
+	const AStrategyPlayerController* DefaultController = GetDefault<AStrategyPlayerController>();
+	FString ControllerClassPath;
+	if (FParse::Value(*Params, TEXT("ControllerClass="), ControllerClassPath))
+	{
+		if (UClass* ControllerClass = LoadClass<AStrategyPlayerController>(nullptr, *ControllerClassPath))
+		{
+			DefaultController = ControllerClass->GetDefaultObject<AStrategyPlayerController>();
+		}
+	}
+
+	const TArray<FStrategyZoomTier>& Tiers = DefaultController->ZoomTiers;
+	const float Hysteresis = DefaultController->ZoomTierHysteresis;
+	const float MinArmLength = DefaultController->MinZoomLength;
+	const float MaxArmLength = DefaultController->MaxZoomLength;
+	if (Tiers.IsEmpty())
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] ZoomTiers: the controller has no zoom tiers."));
+		return 1;
+	}
+
+	// Band ignoring hysteresis, and whether ArmLength is close enough to a boundary for either neighbour to be valid.
+	auto GetBand = [&Tiers](float ArmLength)
+	{
+		int32 Band = 0;
+		while (Band + 1 < Tiers.Num() && ArmLength >= Tiers[Band + 1].MinArmLength)
+		{
+			++Band;
+		}
+		return Band;
+	};
+	auto IsNearBoundary = [&Tiers, Hysteresis](float ArmLength)
+	{
+		for (int32 Index = 1; Index < Tiers.Num(); ++Index)
+		{
+			if (FMath::Abs(ArmLength - Tiers[Index].MinArmLength) <= Hysteresis)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
+	int32 NumFailures = 0;
+	OutCsv = TEXT("Scenario,Step,ArmLength,Tier,Switched\n");
+
+	// Feeds ArmLengths through a fresh selector and checks every step. MaxSwitches < 0 means unbounded.
+	auto RunScenario = [&](const TCHAR* Name, const TArray<float>& ArmLengths, int32 MaxSwitches)
+	{
+		FStrategyZoomTierSelector Selector;
+		int32 NumSwitches = 0;
+		int32 LastSwitchStep = INDEX_NONE;
+		int32 MinStepsBetweenSwitches = MAX_int32;
+		for (int32 Step = 0; Step < ArmLengths.Num(); ++Step)
+		{
+			const float ArmLength = ArmLengths[Step];
+			const int32 PreviousTier = Selector.GetCurrentTier();
+			const bool bSwitched = Selector.Update(Tiers, ArmLength, Hysteresis);
+			const int32 Tier = Selector.GetCurrentTier();
+			OutCsv += FString::Printf(TEXT("%s,%d,%.2f,%d,%d\n"), Name, Step, ArmLength, Tier, bSwitched ? 1 : 0);
+
+			if (!IsNearBoundary(ArmLength) && Tier != GetBand(ArmLength))
+			{
+				UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] ZoomTiers %s step %d: arm length %.1f is in tier %d, expected %d."), Name, Step, ArmLength, Tier, GetBand(ArmLength));
+				++NumFailures;
+			}
+
+			if (bSwitched && Step > 0)
+			{
+				// A switch must be caused by leaving the hysteresis band of the previous tier.
+				if (IsNearBoundary(ArmLength) && FMath::Abs(Tier - PreviousTier) == 1 && GetBand(ArmLength) != Tier)
+				{
+					UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] ZoomTiers %s step %d: switched %d -> %d inside the hysteresis band at %.1f."), Name, Step, PreviousTier, Tier, ArmLength);
+					++NumFailures;
+				}
+				if (LastSwitchStep != INDEX_NONE)
+				{
+					MinStepsBetweenSwitches = FMath::Min(MinStepsBetweenSwitches, Step - LastSwitchStep);
+				}
+				LastSwitchStep = Step;
+				++NumSwitches;
+			}
+		}
+
+		if (MaxSwitches >= 0 && NumSwitches > MaxSwitches)
+		{
+			UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] ZoomTiers %s: %d tier switches, expected at most %d (flicker)."), Name, NumSwitches, MaxSwitches);
+			++NumFailures;
+		}
+
+		UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] ZoomTiers %-10s steps %d | switches %d | min steps between switches %d"),
+			Name, ArmLengths.Num(), NumSwitches, MinStepsBetweenSwitches == MAX_int32 ? 0 : MinStepsBetweenSwitches);
+	};
+
+	// Slow sweep out and back in: exactly one switch per boundary each way.
+	TArray<float> Sweep;
+	for (float ArmLength = MinArmLength; ArmLength <= MaxArmLength; ArmLength += 5.f)
+	{
+		Sweep.Add(ArmLength);
+	}
+	for (float ArmLength = MaxArmLength; ArmLength >= MinArmLength; ArmLength -= 5.f)
+	{
+		Sweep.Add(ArmLength);
+	}
+	RunScenario(TEXT("Sweep"), Sweep, 2 * (Tiers.Num() - 1));
+
+	// Oscillation just inside the hysteresis band around each boundary, approached from both sides: no switches at all.
+	for (int32 Index = 1; Index < Tiers.Num(); ++Index)
+	{
+		const float Boundary = Tiers[Index].MinArmLength;
+		for (const float Side : { -1.f, 1.f })
+		{
+			TArray<float> Jitter;
+			Jitter.Add(Boundary + Side * 2.f * Hysteresis);
+			for (int32 Step = 0; Step < 600; ++Step)
+			{
+				Jitter.Add(Boundary + 0.95f * Hysteresis * FMath::Sin(Step * 0.7f));
+			}
+			RunScenario(*FString::Printf(TEXT("Jitter%d%s"), Index, Side < 0.f ? TEXT("In") : TEXT("Out")), Jitter, 0);
+		}
+	}
+
+	// Random walk with interpolation-sized steps: correctness everywhere, no bound on switches.
+	TArray<float> Walk;
+	FRandomStream Random(0x71E5);
+	float WalkArmLength = 0.5f * (MinArmLength + MaxArmLength);
+	for (int32 Step = 0; Step < 20000; ++Step)
+	{
+		WalkArmLength = FMath::Clamp(WalkArmLength + Random.FRandRange(-40.f, 40.f), MinArmLength, MaxArmLength);
+		Walk.Add(WalkArmLength);
+	}
+	RunScenario(TEXT("RandomWalk"), Walk, -1);
+
+	UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] ZoomTiers: %d tiers, hysteresis %.0f, %d failures."), Tiers.Num(), Hysteresis, NumFailures);
+	return NumFailures > 0 ? 1 : 0;
+}
+
+int32 UStrategyBenchmarkCommandlet::RunPitchTableSuite(const FString& Params, FString& OutCsv) const
+{
+	const AStrategyPlayerController* DefaultController = GetDefault<AStrategyPlayerController>();
+	FString ControllerClassPath;
+	if (FParse::Value(*Params, TEXT("ControllerClass="), ControllerClassPath))
+	{
+		if (UClass* ControllerClass = LoadClass<AStrategyPlayerController>(nullptr, *ControllerClassPath))
+		{
+			DefaultController = ControllerClass->GetDefaultObject<AStrategyPlayerController>();
+		}
+	}
+
+	int32 Resolution = DefaultController->PitchCurveTableResolution;
+	double MaxAllowedError = 0.05;
+	int32 NumCalls = 1000000;
+	FParse::Value(*Params, TEXT("Resolution="), Resolution);
+	FParse::Value(*Params, TEXT("MaxError="), MaxAllowedError);
+	FParse::Value(*Params, TEXT("Calls="), NumCalls);
+	NumCalls = FMath::Max(NumCalls, 1);
+
+	const float MinArmLength = DefaultController->MinZoomLength;
+	const float MaxArmLength = DefaultController->MaxZoomLength;
+	const UCurveFloat* PitchCurve = DefaultController->CameraPitchByZoomCurve.LoadSynchronous();
+	if (!PitchCurve)
+	{
+		// Cubic keys, so the table has curvature to approximate.
+		UCurveFloat* FallbackCurve = NewObject<UCurveFloat>(GetTransientPackage());
+		const float Keys[][2] = { { MinArmLength, 70.f }, { FMath::Lerp(MinArmLength, MaxArmLength, 0.3f), 58.f }, { MaxArmLength, 40.f } };
+		for (const float* Key : Keys)
+		{
+			FallbackCurve->FloatCurve.SetKeyInterpMode(FallbackCurve->FloatCurve.AddKey(Key[0], Key[1]), RCIM_Cubic);
+		}
+		FallbackCurve->FloatCurve.AutoSetTangents();
+		PitchCurve = FallbackCurve;
+		UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] PitchTable: the controller has no pitch curve, using a cubic stand-in."));
+	}
+
+	FStrategyCurveTable PitchTable;
+	PitchTable.Bake(PitchCurve, MinArmLength, MaxArmLength, Resolution);
+	if (!PitchTable.IsBaked())
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] PitchTable: could not bake the curve over [%.0f, %.0f]."), MinArmLength, MaxArmLength);
+		return 1;
+	}
+
+	// Error over the whole zoom range, ends included.
+	const int32 NumErrorSamples = 100000;
+	double MaxError = 0.0;
+	float MaxErrorArmLength = MinArmLength;
+	for (int32 Sample = 0; Sample <= NumErrorSamples; ++Sample)
+	{
+		const float ArmLength = FMath::Lerp(MinArmLength, MaxArmLength, float(Sample) / NumErrorSamples);
+		const double Error = FMath::Abs(PitchTable.Evaluate(ArmLength) - PitchCurve->GetFloatValue(ArmLength));
+		if (Error > MaxError)
+		{
+			MaxError = Error;
+			MaxErrorArmLength = ArmLength;
+		}
+	}
+
+	// Same pseudo-random arm lengths for both paths, generated up front so only the lookups are timed.
+	TArray<float> ArmLengths;
+	ArmLengths.SetNumUninitialized(4096);
+	FRandomStream Random(0x5A7E);
+	for (float& ArmLength : ArmLengths)
+	{
+		ArmLength = Random.FRandRange(MinArmLength, MaxArmLength);
+	}
+
+	volatile float Sink = 0.f;
+	const uint64 CurveStart = FPlatformTime::Cycles64();
+	for (int32 Call = 0; Call < NumCalls; ++Call)
+	{
+		Sink = Sink + PitchCurve->GetFloatValue(ArmLengths[Call % ArmLengths.Num()]);
+	}
+	const uint64 CurveCycles = FPlatformTime::Cycles64() - CurveStart;
+
+	const uint64 TableStart = FPlatformTime::Cycles64();
+	for (int32 Call = 0; Call < NumCalls; ++Call)
+	{
+		Sink = Sink + PitchTable.Evaluate(ArmLengths[Call % ArmLengths.Num()]);
+	}
+	const uint64 TableCycles = FPlatformTime::Cycles64() - TableStart;
+
+	const double CurveNs = FPlatformTime::ToMilliseconds64(CurveCycles) * 1e6 / NumCalls;
+	const double TableNs = FPlatformTime::ToMilliseconds64(TableCycles) * 1e6 / NumCalls;
+	OutCsv = TEXT("Samples,MaxErrorDeg,MaxErrorArmLength,CurveNs,TableNs\n");
+	OutCsv += FString::Printf(TEXT("%d,%.6f,%.1f,%.3f,%.3f\n"), PitchTable.GetNumSamples(), MaxError, MaxErrorArmLength, CurveNs, TableNs);
+	UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] PitchTable: %d samples over [%.0f, %.0f] | max error %.5f deg at %.1f (bound %.3f) | curve %.2f ns/call | table %.2f ns/call (%.1fx)"),
+		PitchTable.GetNumSamples(), MinArmLength, MaxArmLength, MaxError, MaxErrorArmLength, MaxAllowedError, CurveNs, TableNs, TableNs > 0.0 ? CurveNs / TableNs : 0.0);
+
+	if (MaxError > MaxAllowedError)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] PitchTable: max error %.5f deg exceeds %.3f deg; raise PitchCurveTableResolution."), MaxError, MaxAllowedError);
+		return 1;
+	}
+	return 0;
+}
+
+int32 UStrategyBenchmarkCommandlet::RunCameraSpringSuite(const FString& Params, FString& OutCsv) const
+{
+	FString RatesParam = TEXT("30,60,144,240");
+	double Duration = 4.0;
+	double Tolerance = 0.5;
+	FParse::Value(*Params, TEXT("Rates="), RatesParam);
+	FParse::Value(*Params, TEXT("Duration="), Duration);
+	FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+
+	const AStrategyPlayerController* DefaultController = GetDefault<AStrategyPlayerController>();
+	FString ControllerClassPath;
+	if (FParse::Value(*Params, TEXT("ControllerClass="), ControllerClassPath))
+	{
+		if (UClass* ControllerClass = LoadClass<AStrategyPlayerController>(nullptr, *ControllerClassPath))
+		{
+			DefaultController = ControllerClass->GetDefaultObject<AStrategyPlayerController>();
+		}
+	}
+	const FStrategyCameraSpringSettings Settings = DefaultController->MakeCameraSpringSettings();
+
+	// Pitch follows the arm length, so the coupled channels are covered too. Falls back to a simple curve.
+	const UCurveFloat* PitchCurve = DefaultController->CameraPitchByZoomCurve.LoadSynchronous();
+	if (!PitchCurve)
+	{
+		UCurveFloat* FallbackCurve = NewObject<UCurveFloat>(GetTransientPackage());
+		FallbackCurve->FloatCurve.AddKey(DefaultController->MinZoomLength, 70.f);
+		FallbackCurve->FloatCurve.AddKey(DefaultController->MaxZoomLength, 40.f);
+		PitchCurve = FallbackCurve;
+	}
+	FStrategyCurveTable PitchTable;
+	PitchTable.Bake(PitchCurve, DefaultController->MinZoomLength, DefaultController->MaxZoomLength, DefaultController->PitchCurveTableResolution);
+
+	// Target changes at multiples of 0.5 s, which is a whole number of frames at every tested rate, so each run sees
+	// them at the same time. Yaw crosses +-180 to cover the wrap-around.
+	struct FTargetEvent
+	{
+		double Time;
+		double ArmLength;
+		double Yaw;
+		FVector Pan;
+	};
+	const FTargetEvent Events[] =
+	{
+		{ 0.0, 4000.0, 135.0, FVector(6000.0, -2000.0, 0.0) },
+		{ 1.0, 800.0, -170.0, FVector(6000.0, 4000.0, 0.0) },
+		{ 2.0, 2500.0, 170.0, FVector(6000.0, 4000.0, 0.0) },
+		{ 2.5, 2500.0, 90.0, FVector::ZeroVector },
+	};
+
+	FStrategyCameraSpringState StartState;
+	StartState.ArmLength = 1500.0;
+	StartState.Pitch = -PitchTable.Evaluate(1500.f);
+
+	// Runs the timeline with the given frame times and records the rendered state at the end of every frame.
+	auto Replay = [&](TConstArrayView<double> FrameTimes, TArray<double>& OutTimes, TArray<FStrategyCameraSpringState>& OutStates)
+	{
+		FStrategyCameraIntegrator Integrator;
+		Integrator.Reset(StartState);
+		FStrategyCameraSpringTargets Targets;
+		Targets.PitchByArmLength = &PitchTable;
+
+		double Time = 0.0;
+		int32 NextEvent = 0;
+		for (const double FrameTime : FrameTimes)
+		{
+			while (NextEvent < int32(UE_ARRAY_COUNT(Events)) && Events[NextEvent].Time <= Time + 1e-9)
+			{
+				Targets.ArmLength = Events[NextEvent].ArmLength;
+				Targets.Yaw = Events[NextEvent].Yaw;
+				Targets.Pan = Events[NextEvent].Pan;
+				++NextEvent;
+			}
+
+			Integrator.Advance(float(FrameTime), Targets, Settings);
+			Time += FrameTime;
+			OutTimes.Add(Time);
+			OutStates.Add(Integrator.GetRenderState());
+		}
+	};
+
+	auto MakeFrameTimes = [Duration](double Rate)
+	{
+		TArray<double> FrameTimes;
+		FrameTimes.Init(1.0 / Rate, FMath::RoundToInt32(Duration * Rate));
+		return FrameTimes;
+	};
+
+	constexpr double ReferenceRate = 1000.0;
+	TArray<double> ReferenceTimes;
+	TArray<FStrategyCameraSpringState> ReferenceStates;
+	Replay(MakeFrameTimes(ReferenceRate), ReferenceTimes, ReferenceStates);
+
+	auto SampleReference = [&ReferenceStates, ReferenceRate](double Time)
+	{
+		const double Position = FMath::Clamp(Time * ReferenceRate - 1.0, 0.0, double(ReferenceStates.Num() - 1));
+		const int32 Index = FMath::Min(int32(Position), ReferenceStates.Num() - 2);
+		const double Alpha = Position - Index;
+		const FStrategyCameraSpringState& A = ReferenceStates[Index];
+		const FStrategyCameraSpringState& B = ReferenceStates[Index + 1];
+
+		FStrategyCameraSpringState State;
+		State.ArmLength = FMath::Lerp(A.ArmLength, B.ArmLength, Alpha);
+		State.Pitch = FMath::Lerp(A.Pitch, B.Pitch, Alpha);
+		State.Yaw = FMath::Lerp(A.Yaw, B.Yaw, Alpha);
+		State.Pan = FMath::Lerp(A.Pan, B.Pan, Alpha);
+		return State;
+	};
+
+	TArray<TPair<FString, TArray<double>>> Runs;
+	TArray<FString> RateStrings;
+	RatesParam.ParseIntoArray(RateStrings, TEXT(","));
+	for (const FString& RateString : RateStrings)
+	{
+		const double Rate = FCString::Atod(*RateString);
+		if (Rate > 0.0)
+		{
+			Runs.Emplace(FString::Printf(TEXT("%gfps"), Rate), MakeFrameTimes(Rate));
+		}
+	}
+
+	// A 250 ms frame at 60 FPS: within MaxSubstepsPerFrame at the default rate, so no time is dropped.
+	TArray<double> HitchFrameTimes = MakeFrameTimes(60.0);
+	HitchFrameTimes.RemoveAt(90, 15);
+	HitchFrameTimes.Insert(0.25, 90);
+	Runs.Emplace(TEXT("60fps+Hitch"), MoveTemp(HitchFrameTimes));
+
+	int32 NumFailures = 0;
+	OutCsv = TEXT("Run,Frame,Time,ArmLength,Pitch,Yaw,PanX,PanY,ArmError,PitchError,YawError,PanError\n");
+	for (const TPair<FString, TArray<double>>& Run : Runs)
+	{
+		TArray<double> Times;
+		TArray<FStrategyCameraSpringState> States;
+		Replay(Run.Value, Times, States);
+
+		double MaxArmError = 0.0;
+		double MaxPitchError = 0.0;
+		double MaxYawError = 0.0;
+		double MaxPanError = 0.0;
+		for (int32 Frame = 0; Frame < States.Num(); ++Frame)
+		{
+			const FStrategyCameraSpringState& State = States[Frame];
+			const FStrategyCameraSpringState Reference = SampleReference(Times[Frame]);
+			const double ArmError = FMath::Abs(State.ArmLength - Reference.ArmLength);
+			const double PitchError = FMath::Abs(State.Pitch - Reference.Pitch);
+			const double YawError = FMath::Abs(FMath::FindDeltaAngleDegrees(Reference.Yaw, State.Yaw));
+			const double PanError = FVector::Dist(State.Pan, Reference.Pan);
+			MaxArmError = FMath::Max(MaxArmError, ArmError);
+			MaxPitchError = FMath::Max(MaxPitchError, PitchError);
+			MaxYawError = FMath::Max(MaxYawError, YawError);
+			MaxPanError = FMath::Max(MaxPanError, PanError);
+
+			OutCsv += FString::Printf(TEXT("%s,%d,%.5f,%.3f,%.4f,%.4f,%.3f,%.3f,%.5f,%.5f,%.5f,%.5f\n"), *Run.Key, Frame, Times[Frame],
+				State.ArmLength, State.Pitch, State.Yaw, State.Pan.X, State.Pan.Y, ArmError, PitchError, YawError, PanError);
+		}
+
+		const bool bPassed = FMath::Max(FMath::Max(MaxArmError, MaxPitchError), FMath::Max(MaxYawError, MaxPanError)) <= Tolerance;
+		NumFailures += bPassed ? 0 : 1;
+		UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] CameraSpring %-12s | %4d frames | max error arm %.4f cm, pitch %.4f deg, yaw %.4f deg, pan %.4f cm | %s"),
+			*Run.Key, States.Num(), MaxArmError, MaxPitchError, MaxYawError, MaxPanError, bPassed ? TEXT("OK") : TEXT("FAILED"));
+	}
+
+	return NumFailures == 0 ? 0 : 1;
+}
+
+int32 UStrategyBenchmarkCommandlet::RunInputReplaySuite(const FString& Params, FString& OutCsv) const
+{
+	using namespace StrategyBenchmark;
+
+	int32 NumFrames = 600;
+	float DeltaTime = 1.f / 60.f;
+	double Tolerance = 0.01;
+	int32 NumRecordCalls = 1000000;
+	FString File;
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("DeltaTime="), DeltaTime);
+	FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+	FParse::Value(*Params, TEXT("Records="), NumRecordCalls);
+	FParse::Value(*Params, TEXT("File="), File);
+
+	// Recorder cost on its own: one record per call into a ring allocated up front.
+	FCountingMalloc& CountingMalloc = GetCountingMalloc();
+	FStrategyInputRecorder Recorder;
+	Recorder.Start(65536, 300);
+	const uint64 RecordAllocationsBefore = CountingMalloc.GetNumAllocations();
+	const uint64 RecordStart = FPlatformTime::Cycles64();
+	for (int32 Call = 0; Call < NumRecordCalls; ++Call)
+	{
+		if (Call % 4 == 0)
+		{
+			Recorder.BeginFrame(Call, DeltaTime, true, FVector2D(Call % 1920, Call % 1080));
+		}
+		Recorder.Record(EStrategyInputRecordType::Move, 0.5f, 1.f);
+	}
+	const uint64 RecordCycles = FPlatformTime::Cycles64() - RecordStart;
+	const uint64 RecordAllocations = CountingMalloc.GetNumAllocations() - RecordAllocationsBefore;
+	const double RecordNs = NumRecordCalls > 0 ? FPlatformTime::ToMilliseconds64(RecordCycles) * 1e6 / NumRecordCalls : 0.0;
+
+	UGameInstance* GameInstance = nullptr;
+	UWorld* World = CreateBenchmarkWorld(GameInstance);
+	AStrategyPlayerController* Controller = World ? CreatePlayer(*World, *GameInstance, Params) : nullptr;
+	if (!Controller)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Could not create the benchmark world or player."));
+		DestroyBenchmarkWorld(World, GameInstance);
+		return 1;
+	}
+	Controller->bFollowTerrain = false;
+
+	for (int32 Frame = 0; Frame < 60; ++Frame)
+	{
+		World->Tick(LEVELTICK_All, DeltaTime);
+		++GFrameCounter;
+	}
+
+	struct FCameraSample
+	{
+		FVector PawnLocation = FVector::ZeroVector;
+		double Yaw = 0.0;
+		float ArmLength = 0.f;
+	};
+	auto Capture = [Controller]()
+	{
+		FCameraSample Sample;
+		Sample.PawnLocation = Controller->PossessedCameraPawn->GetActorLocation();
+		Sample.Yaw = Controller->PossessedCameraPawn->GetActorRotation().Yaw;
+		Sample.ArmLength = Controller->PossessedCameraPawn->GetCameraBoom()->TargetArmLength;
+		return Sample;
+	};
+	auto GetError = [](const FCameraSample& Sample, const FCameraSample& Reference)
+	{
+		return FMath::Max3(FVector::Dist(Sample.PawnLocation, Reference.PawnLocation), double(FMath::Abs(Sample.ArmLength - Reference.ArmLength)),
+			FMath::Abs(FMath::FindDeltaAngleDegrees(Sample.Yaw, Reference.Yaw)));
+	};
+
+	TArray<FCameraSample> Reference;
+	double RecordSessionMs = 0.0;
+	if (File.IsEmpty())
+	{
+		File = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("StrategyInputReplay.stinput");
+
+		// No wheel input on the first frames: the cursor hit a zoom anchors on is a frame old, and only from the second
+		// frame on does it come from this session.
+		const FIntPoint ViewportSize(1920, 1080);
+		Controller->StartInputRecording();
+		const uint64 SessionStart = FPlatformTime::Cycles64();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			const double Angle = Frame * 0.05;
+			Controller->GetCursorQuery()->SetSimulatedScreenPosition(FVector2D(960.0, 540.0) + FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * 250.0, ViewportSize);
+			Controller->HandleMoveInput(FInputActionValue(FVector2D(FMath::Sin(Angle), 1.0)));
+			if (Frame % 200 == 20)
+			{
+				Controller->HandleRotateCameraTrigger(FInputActionValue(true));
+			}
+			Controller->HandleRotateCameraValue(FInputActionValue(FVector2D(2.0, 0.0)));
+			if (Frame % 200 == 80)
+			{
+				Controller->HandleRotateCameraTrigger(FInputActionValue(false));
+				Controller->HandlePanDragStarted(FInputActionValue(true));
+			}
+			if (Frame % 200 == 140)
+			{
+				Controller->HandlePanDragCompleted(FInputActionValue(false));
+			}
+			if (Frame % 45 >= 10 && Frame % 45 < 13)
+			{
+				Controller->HandleZoomInput(FInputActionValue((Frame / 45) % 2 == 0 ? 1.f : -1.f));
+			}
+
+			World->Tick(LEVELTICK_All, DeltaTime);
+			++GFrameCounter;
+			Reference.Add(Capture());
+		}
+		RecordSessionMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - SessionStart);
+		Controller->StopInputRecording();
+
+		if (!Controller->SaveInputRecording(File))
+		{
+			UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] InputReplay: could not save the recording to %s."), *File);
+			DestroyBenchmarkWorld(World, GameInstance);
+			return 1;
+		}
+	}
+
+	OutCsv = TEXT("Pass,Frame,PawnX,PawnY,PawnZ,Yaw,ArmLength,Error\n");
+	int32 NumFailures = RecordAllocations == 0 ? 0 : 1;
+	double MaxError = 0.0;
+	double ReplayMs[2] = {};
+	double OpenMs = 0.0;
+	int32 NumReplayFrames = 0;
+	for (int32 Pass = 0; Pass < 2; ++Pass)
+	{
+		const uint64 OpenStart = FPlatformTime::Cycles64();
+		if (!Controller->StartInputReplay(File, false))
+		{
+			UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] InputReplay: could not replay %s."), *File);
+			DestroyBenchmarkWorld(World, GameInstance);
+			return 1;
+		}
+		OpenMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - OpenStart);
+		NumReplayFrames = Controller->InputPlayer.GetNumFrames();
+
+		// Headless and as fast as the game thread goes, each frame ticked with its recorded time.
+		TArray<FCameraSample> Replayed;
+		Replayed.Reserve(NumReplayFrames);
+		const uint64 ReplayStart = FPlatformTime::Cycles64();
+		for (int32 Frame = 0; Frame < NumReplayFrames; ++Frame)
+		{
+			World->Tick(LEVELTICK_All, Controller->InputPlayer.PeekDeltaTime());
+			++GFrameCounter;
+			Replayed.Add(Capture());
+		}
+		ReplayMs[Pass] = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - ReplayStart);
+		Controller->StopInputReplay();
+
+		// With -File there is no recorded session to compare against; the second replay must match the first.
+		if (Reference.IsEmpty())
+		{
+			Reference = Replayed;
+			continue;
+		}
+
+		for (int32 Frame = 0; Frame < Replayed.Num(); ++Frame)
+		{
+			const double Error = Reference.IsValidIndex(Frame) ? GetError(Replayed[Frame], Reference[Frame]) : UE_BIG_NUMBER;
+			MaxError = FMath::Max(MaxError, Error);
+			const FCameraSample& Sample = Replayed[Frame];
+			OutCsv += FString::Printf(TEXT("%d,%d,%.3f,%.3f,%.3f,%.4f,%.3f,%.5f\n"), Pass, Frame, Sample.PawnLocation.X, Sample.PawnLocation.Y, Sample.PawnLocation.Z, Sample.Yaw, Sample.ArmLength, Error);
+		}
+	}
+
+	if (MaxError > Tolerance)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] InputReplay diverged by %.4f (tolerance %.4f)."), MaxError, Tolerance);
+		++NumFailures;
+	}
+	if (RecordAllocations != 0)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] InputReplay: recording allocated %llu times."), RecordAllocations);
+	}
+
+	UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] InputReplay record %.1f ns/record, %llu allocs | session %d frames in %.1f ms | map %.3f ms | replay %d frames in %.1f / %.1f ms | max divergence %.5f"),
+		RecordNs, RecordAllocations, NumFrames, RecordSessionMs, OpenMs, NumReplayFrames, ReplayMs[0], ReplayMs[1], MaxError);
+
+	DestroyBenchmarkWorld(World, GameInstance);
+	return NumFailures == 0 ? 0 : 1;
+}
+
+int32 UStrategyBenchmarkCommandlet::RunTerrainHeightSuite(const FString& Params, FString& OutCsv) const
+{
+	using namespace StrategyBenchmark;
+
+	int32 NumLookups = 100000;
+	double Radius = 16000.0;
+	int32 NumHills = 40;
+	FParse::Value(*Params, TEXT("Lookups="), NumLookups);
+	FParse::Value(*Params, TEXT("Radius="), Radius);
+	FParse::Value(*Params, TEXT("Hills="), NumHills);
+
+	UGameInstance* GameInstance = nullptr;
+	UWorld* World = CreateBenchmarkWorld(GameInstance);
+	UStrategyTerrainHeightSubsystem* TerrainHeights = World ? World->GetSubsystem<UStrategyTerrainHeightSubsystem>() : nullptr;
+	if (!TerrainHeights || NumLookups <= 0)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Could not create the benchmark world or terrain height subsystem."));
+		DestroyBenchmarkWorld(World, GameInstance);
+		return 1;
+	}
+
+	// Boxes of varying height on the ground plane, so the heightfield has slopes and steps.
+	FRandomStream Random(0x7E77);
+	for (int32 Index = 0; Index < NumHills; ++Index)
+	{
+		AActor* Hill = World->SpawnActor<AActor>();
+		UBoxComponent* HillBox = NewObject<UBoxComponent>(Hill);
+		HillBox->SetBoxExtent(FVector(Random.FRandRange(300.0, 2000.0), Random.FRandRange(300.0, 2000.0), Random.FRandRange(50.0, 800.0)));
+		HillBox->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		Hill->SetRootComponent(HillBox);
+		HillBox->RegisterComponent();
+		HillBox->SetWorldLocationAndRotation(FVector(Random.FRandRange(-Radius, Radius), Random.FRandRange(-Radius, Radius), 0.0), FRotator(0.0, Random.FRandRange(0.0, 90.0), 0.0));
+	}
+
+	// Let the async traces sample every tile in the area.
+	auto TickUntilSampled = [World, TerrainHeights]()
+	{
+		int32 NumFrames = 0;
+		for (; NumFrames < 2000 && TerrainHeights->GetNumPendingTiles() > 0; ++NumFrames)
+		{
+			World->Tick(LEVELTICK_All, 1.f / 60.f);
+			++GFrameCounter;
+		}
+		return NumFrames;
+	};
+
+	const uint64 FillStart = FPlatformTime::Cycles64();
+	TerrainHeights->RequestArea(FVector2D::ZeroVector, Radius);
+	const int32 FillFrames = TickUntilSampled();
+	const double FillMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - FillStart);
+
+	TArray<FVector2D> Locations;
+	Locations.Reserve(NumLookups);
+	for (int32 Index = 0; Index < NumLookups; ++Index)
+	{
+		// Inside the inscribed square, so every lookup lands in a sampled tile.
+		Locations.Emplace(Random.FRandRange(-Radius, Radius) * 0.7, Random.FRandRange(-Radius, Radius) * 0.7);
+	}
+
+	TArray<float> CachedHeights;
+	CachedHeights.SetNumZeroed(NumLookups);
+	int32 NumCacheMisses = 0;
+	const uint64 CacheStart = FPlatformTime::Cycles64();
+	for (int32 Index = 0; Index < NumLookups; ++Index)
+	{
+		NumCacheMisses += TerrainHeights->GetHeight(Locations[Index], CachedHeights[Index]) ? 0 : 1;
+	}
+	const double CacheMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - CacheStart);
+
+	const FStrategyTerrainHeightSettings& Settings = TerrainHeights->GetSettings();
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(StrategyBenchmarkTerrain), false);
+	TArray<float> TracedHeights;
+	TracedHeights.SetNumZeroed(NumLookups);
+	const uint64 TraceStart = FPlatformTime::Cycles64();
+	for (int32 Index = 0; Index < NumLookups; ++Index)
+	{
+		FHitResult Hit;
+		const bool bHit = World->LineTraceSingleByChannel(Hit, FVector(Locations[Index], Settings.TraceTopZ), FVector(Locations[Index], Settings.TraceBottomZ), Settings.TraceChannel, QueryParams);
+		TracedHeights[Index] = bHit ? float(Hit.ImpactPoint.Z) : Settings.NoGroundHeight;
+	}
+	const double TraceMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - TraceStart);
+
+	// Bilinear heights are exact on flat ground and smear steps over one sample spacing.
+	TArray<double> Errors;
+	Errors.Reserve(NumLookups);
+	for (int32 Index = 0; Index < NumLookups; ++Index)
+	{
+		Errors.Add(FMath::Abs(double(CachedHeights[Index]) - TracedHeights[Index]));
+	}
+
+	// Re-sampling after a change to part of the area.
+	TerrainHeights->Invalidate(FBox2D(FVector2D(-Radius * 0.25), FVector2D(Radius * 0.25)));
+	const int32 InvalidateFrames = TickUntilSampled();
+
+	const double CacheNs = CacheMs * 1e6 / NumLookups;
+	const double TraceNs = TraceMs * 1e6 / NumLookups;
+	OutCsv = TEXT("Lookups,Tiles,FillFrames,FillMs,CacheNsPerLookup,TraceNsPerLookup,CacheMisses,ErrorP50,ErrorP95,ErrorMax,InvalidateFrames\n");
+	OutCsv += FString::Printf(TEXT("%d,%d,%d,%.2f,%.2f,%.2f,%d,%.3f,%.3f,%.3f,%d\n"), NumLookups, TerrainHeights->GetNumReadyTiles(), FillFrames, FillMs,
+		CacheNs, TraceNs, NumCacheMisses, Percentile(Errors, 0.5), Percentile(Errors, 0.95), Percentile(Errors, 1.0), InvalidateFrames);
+	UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] TerrainHeight %d tiles sampled in %d frames (%.1f ms) | lookup %.1f ns vs trace %.1f ns (%.1fx) | %d misses | error p50 %.2f, p95 %.2f, max %.2f cm | re-sampled in %d frames"),
+		TerrainHeights->GetNumReadyTiles(), FillFrames, FillMs, CacheNs, TraceNs, CacheNs > 0.0 ? TraceNs / CacheNs : 0.0, NumCacheMisses,
+		Percentile(Errors, 0.5), Percentile(Errors, 0.95), Percentile(Errors, 1.0), InvalidateFrames);
+
+	DestroyBenchmarkWorld(World, GameInstance);
+	return NumCacheMisses == 0 ? 0 : 1;
+}
+
+int32 UStrategyBenchmarkCommandlet::RunSelectionSuite(const FString& Params, FString& OutCsv) const
+{
+	using namespace StrategyBenchmark;
+
+	FString UnitCountsParam = TEXT("1000,10000,50000");
+	int32 NumQueries = 200;
+	double EdgeEpsilon = 0.5;
+	FParse::Value(*Params, TEXT("Units="), UnitCountsParam);
+	FParse::Value(*Params, TEXT("Queries="), NumQueries);
+	FParse::Value(*Params, TEXT("EdgeEpsilon="), EdgeEpsilon);
+
+	TArray<FString> UnitCountStrings;
+	UnitCountsParam.ParseIntoArray(UnitCountStrings, TEXT(","));
+
+	UGameInstance* GameInstance = nullptr;
+	UWorld* World = CreateBenchmarkWorld(GameInstance);
+	AStrategyPlayerController* Controller = World ? CreatePlayer(*World, *GameInstance, Params) : nullptr;
+	UStrategyUnitRegistrySubsystem* Registry = World ? World->GetSubsystem<UStrategyUnitRegistrySubsystem>() : nullptr;
+	if (!Controller || !Registry)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Could not create the benchmark world, player or unit registry."));
+		DestroyBenchmarkWorld(World, GameInstance);
+		return 1;
+	}
+
+	for (int32 Frame = 0; Frame < 60; ++Frame)
+	{
+		World->Tick(LEVELTICK_All, 1.f / 60.f);
+		++GFrameCounter;
+	}
+
+	const FIntPoint ViewportSize(1920, 1080);
+	const FIntRect ViewRect(FIntPoint::ZeroValue, ViewportSize);
+	const FMinimalViewInfo View = Controller->PlayerCameraManager->GetCameraCacheView();
+	const FVector PawnLocation = Controller->GetPawn()->GetActorLocation();
+
+	int32 Result = 0;
+	OutCsv = TEXT("Units,Query,NaiveMs,BatchedMs,Candidates,Selected,EdgeDifferences,Mismatches\n");
+	for (const FString& UnitCountString : UnitCountStrings)
+	{
+		const int32 NumUnits = FCString::Atoi(*UnitCountString);
+		if (NumUnits <= 0)
+		{
+			continue;
+		}
+
+		// Units scattered over a 400 m square around the pawn, a little above the ground.
+		FRandomStream Random(0x5E1E + NumUnits);
+		TArray<FVector> Locations;
+		TArray<FStrategyUnitHandle> Handles;
+		Locations.Reserve(NumUnits);
+		Handles.Reserve(NumUnits);
+		for (int32 Index = 0; Index < NumUnits; ++Index)
+		{
+			Locations.Add(PawnLocation + FVector(Random.FRandRange(-20000.0, 20000.0), Random.FRandRange(-20000.0, 20000.0), Random.FRandRange(0.0, 100.0)));
+		}
+
+		Registry->UnregisterAllUnits();
+		const uint64 RegisterStart = FPlatformTime::Cycles64();
+		for (const FVector& Location : Locations)
+		{
+			Handles.Add(Registry->RegisterUnit(nullptr, Location));
+		}
+		const double RegisterMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - RegisterStart);
+		TMap<FStrategyUnitHandle, int32> IndexByHandle;
+		IndexByHandle.Reserve(NumUnits);
+		for (int32 Index = 0; Index < NumUnits; ++Index)
+		{
+			IndexByHandle.Add(Handles[Index], Index);
+		}
+
+		// One incremental update per unit, as if every unit moved a step this frame.
+		for (FVector& Location : Locations)
+		{
+			Location += FVector(Random.FRandRange(-50.0, 50.0), Random.FRandRange(-50.0, 50.0), 0.0);
+		}
+		const uint64 UpdateStart = FPlatformTime::Cycles64();
+		for (int32 Index = 0; Index < NumUnits; ++Index)
+		{
+			Registry->UpdateUnitLocation(Handles[Index], Locations[Index]);
+		}
+		const double UpdateMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - UpdateStart);
+
+		TArray<double> NaiveTimes;
+		TArray<double> BatchedTimes;
+		TArray<FStrategyUnitHandle> Selected;
+		TArray<int32> NaiveSelected;
+		TSet<FStrategyUnitHandle> BatchedOnly;
+		Selected.Reserve(NumUnits);
+		NaiveSelected.Reserve(NumUnits);
+		int64 TotalCandidates = 0;
+		int64 TotalSelected = 0;
+		int32 NumEdgeDifferences = 0;
+		int32 NumMismatches = 0;
+		for (int32 QueryIndex = 0; QueryIndex < NumQueries; ++QueryIndex)
+		{
+			const FVector2D ScreenStart(Random.FRandRange(0.0, 1920.0), Random.FRandRange(0.0, 1080.0));
+			const FVector2D ScreenEnd(Random.FRandRange(0.0, 1920.0), Random.FRandRange(0.0, 1080.0));
+			const FBox2D PixelRect(FVector2D::Min(ScreenStart, ScreenEnd), FVector2D::Max(ScreenStart, ScreenEnd));
+			const FStrategyScreenQuery Query = FStrategyScreenQuery::Make(View, ViewportSize, ScreenStart, ScreenEnd);
+
+			// Naive: every unit through ProjectWorldToScreen.
+			const FMatrix ViewProjection = FTranslationMatrix(-Query.ViewOrigin) * Query.TranslatedViewProjection;
+			NaiveSelected.Reset();
+			const uint64 NaiveStart = FPlatformTime::Cycles64();
+			for (int32 Index = 0; Index < NumUnits; ++Index)
+			{
+				FVector2D ScreenPosition;
+				if (FSceneView::ProjectWorldToScreen(Locations[Index], ViewRect, ViewProjection, ScreenPosition) && PixelRect.IsInsideOrOn(ScreenPosition))
+				{
+					NaiveSelected.Add(Index);
+				}
+			}
+			const double NaiveMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - NaiveStart);
+
+			Selected.Reset();
+			const uint64 BatchedStart = FPlatformTime::Cycles64();
+			const int32 NumBatched = Registry->SelectInScreenRect(Query, Selected);
+			const double BatchedMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - BatchedStart);
+
+			// Both paths must select the same units. Only a unit within EdgeEpsilon pixels of the rectangle's edge may
+			// differ, since the batched path projects in float; anything else, or a unit selected twice, is a mismatch.
+			const FBox2D OuterRect(PixelRect.Min - FVector2D(EdgeEpsilon), PixelRect.Max + FVector2D(EdgeEpsilon));
+			const FBox2D InnerRect(PixelRect.Min + FVector2D(EdgeEpsilon), PixelRect.Max - FVector2D(EdgeEpsilon));
+			auto IsNearEdge = [&](int32 Index)
+			{
+				FVector2D ScreenPosition;
+				return FSceneView::ProjectWorldToScreen(Locations[Index], ViewRect, ViewProjection, ScreenPosition)
+					&& OuterRect.IsInsideOrOn(ScreenPosition) && !InnerRect.IsInside(ScreenPosition);
+			};
+			int32 QueryEdgeDifferences = 0;
+			int32 QueryMismatches = 0;
+			BatchedOnly.Reset();
+			BatchedOnly.Append(Selected);
+			QueryMismatches += Selected.Num() - BatchedOnly.Num();
+			for (const int32 Index : NaiveSelected)
+			{
+				if (BatchedOnly.Remove(Handles[Index]) == 0)
+				{
+					++(IsNearEdge(Index) ? QueryEdgeDifferences : QueryMismatches);
+				}
+			}
+			for (const FStrategyUnitHandle& Handle : BatchedOnly)
+			{
+				const int32* Index = IndexByHandle.Find(Handle);
+				++(Index && IsNearEdge(*Index) ? QueryEdgeDifferences : QueryMismatches);
+			}
+			NumEdgeDifferences += QueryEdgeDifferences;
+			NumMismatches += QueryMismatches;
+
+			NaiveTimes.Add(NaiveMs);
+			BatchedTimes.Add(BatchedMs);
+			TotalCandidates += Registry->GetLastNumCandidates();
+			TotalSelected += NumBatched;
+
+			OutCsv += FString::Printf(TEXT("%d,%d,%.4f,%.4f,%d,%d,%d,%d\n"), NumUnits, QueryIndex, NaiveMs, BatchedMs, Registry->GetLastNumCandidates(), NumBatched,
+				QueryEdgeDifferences, QueryMismatches);
+		}
+
+		const double NaiveP50 = Percentile(NaiveTimes, 0.5);
+		const double BatchedP50 = Percentile(BatchedTimes, 0.5);
+		UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] Selection %6d units | register %.1f ns/unit, update %.1f ns/unit | naive p50 %.3f ms, p95 %.3f ms | batched p50 %.3f ms, p95 %.3f ms (%.1fx) | candidates %.0f, selected %.0f per query | edge differences %d, mismatches %d"),
+			NumUnits, RegisterMs * 1e6 / NumUnits, UpdateMs * 1e6 / NumUnits,
+			NaiveP50, Percentile(NaiveTimes, 0.95), BatchedP50, Percentile(BatchedTimes, 0.95), BatchedP50 > 0.0 ? NaiveP50 / BatchedP50 : 0.0,
+			NumQueries > 0 ? double(TotalCandidates) / NumQueries : 0.0, NumQueries > 0 ? double(TotalSelected) / NumQueries : 0.0, NumEdgeDifferences, NumMismatches);
+		if (NumMismatches > 0)
+		{
+			UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Selection %d units: batched and naive selections differ in %d units away from the rectangle edge."), NumUnits, NumMismatches);
+			Result = 1;
+		}
+	}
+
+	Registry->UnregisterAllUnits();
+	DestroyBenchmarkWorld(World, GameInstance);
+	return Result;
+}
+
+int32 UStrategyBenchmarkCommandlet::RunUnitSimulationSuite(const FString& Params, FString& OutCsv) const
+{
+	using namespace StrategyBenchmark;
+
+	FString EntityCountsParam = TEXT("10000,100000");
+	int32 NumFrames = 300;
+	float DeltaTime = 1.f / 60.f;
+	FParse::Value(*Params, TEXT("Entities="), EntityCountsParam);
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("DeltaTime="), DeltaTime);
+
+	TArray<FString> EntityCountStrings;
+	EntityCountsParam.ParseIntoArray(EntityCountStrings, TEXT(","));
+
+	UGameInstance* GameInstance = nullptr;
+	UWorld* World = CreateBenchmarkWorld(GameInstance);
+	UStrategyUnitSimulationSubsystem* Simulation = World ? World->GetSubsystem<UStrategyUnitSimulationSubsystem>() : nullptr;
+	IConsoleVariable* ParallelMovement = IConsoleManager::Get().FindConsoleVariable(TEXT("Strategy.Units.ParallelMovement"));
+	if (!Simulation || !ParallelMovement)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Could not create the benchmark world or unit simulation."));
+		DestroyBenchmarkWorld(World, GameInstance);
+		return 1;
+	}
+	const bool bParallelMovementWas = ParallelMovement->GetBool();
+
+	OutCsv = TEXT("Entities,Mode,Frame,MovementMs,SyncMs\n");
+	for (const FString& EntityCountString : EntityCountStrings)
+	{
+		const int32 NumEntities = FCString::Atoi(*EntityCountString);
+		if (NumEntities <= 0)
+		{
+			continue;
+		}
+
+		// Units on a square grid 2 m apart; the order sends them far enough that none arrives during the run.
+		const int32 GridSide = FMath::CeilToInt32(FMath::Sqrt(double(NumEntities)));
+		TArray<FVector> Locations;
+		Locations.Reserve(NumEntities);
+		for (int32 Index = 0; Index < NumEntities; ++Index)
+		{
+			Locations.Add(FVector((Index % GridSide) * 200.0, (Index / GridSide) * 200.0, 0.0));
+		}
+		const FVector Destination(GridSide * 200.0 + 1.0e6, 0.0, 0.0);
+
+		for (const bool bParallel : { true, false })
+		{
+			ParallelMovement->Set(bParallel, ECVF_SetByCode);
+			const TCHAR* Mode = bParallel ? TEXT("Parallel") : TEXT("GameThread");
+
+			Simulation->DestroyAllUnits();
+			TArray<FStrategyUnitHandle> Units;
+			Units.Reserve(NumEntities);
+			Simulation->SpawnUnits(Locations, &Units);
+			Simulation->MoveUnits(Units, Destination, 200.f);
+
+			TArray<double> MovementTimes;
+			TArray<double> SyncTimes;
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				Simulation->RunSimulation(DeltaTime);
+				MovementTimes.Add(Simulation->GetLastMovementMs());
+				SyncTimes.Add(Simulation->GetLastSyncMs());
+				OutCsv += FString::Printf(TEXT("%d,%s,%d,%.4f,%.4f\n"), NumEntities, Mode, Frame, Simulation->GetLastMovementMs(), Simulation->GetLastSyncMs());
+			}
+
+			UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] Units %7d %-10s | movement p50 %.3f ms, p95 %.3f ms | sync p50 %.3f ms, p95 %.3f ms"),
+				NumEntities, Mode, Percentile(MovementTimes, 0.5), Percentile(MovementTimes, 0.95), Percentile(SyncTimes, 0.5), Percentile(SyncTimes, 0.95));
+		}
+	}
+
+	ParallelMovement->Set(bParallelMovementWas, ECVF_SetByCode);
+	Simulation->DestroyAllUnits();
+	DestroyBenchmarkWorld(World, GameInstance);
+	return 0;
+}
+
+int32 UStrategyBenchmarkCommandlet::RunFlowFieldSuite(const FString& Params, FString& OutCsv) const
+{
+	FString GroupSizesParam = TEXT("50,500,5000");
+	int32 NumObstacles = 40;
+	FParse::Value(*Params, TEXT("Groups="), GroupSizesParam);
+	FParse::Value(*Params, TEXT("Obstacles="), NumObstacles);
+
+	TArray<FString> GroupSizeStrings;
+	GroupSizesParam.ParseIntoArray(GroupSizeStrings, TEXT(","));
+
+	UGameInstance* GameInstance = nullptr;
+	UWorld* World = CreateBenchmarkWorld(GameInstance);
+	UStrategyFlowFieldSubsystem* FlowFields = World ? World->GetSubsystem<UStrategyFlowFieldSubsystem>() : nullptr;
+	if (!FlowFields)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Could not create the benchmark world or flow-field subsystem."));
+		DestroyBenchmarkWorld(World, GameInstance);
+		return 1;
+	}
+
+	// Obstacles over the middle of the grid, leaving the start and destination areas open. Each one blocks the flow
+	// field and is a solid box in the world, so the navmesh routes around the same obstacles.
+	const FStrategyFlowFieldGrid& Grid = FlowFields->GetGrid();
+	const FVector2D GridSize(Grid.Width * Grid.CellSize, Grid.Height * Grid.CellSize);
+	FRandomStream Random(0xF10F);
+	for (int32 Index = 0; Index < NumObstacles; ++Index)
+	{
+		const FVector2D Center = Grid.Origin + FVector2D(Random.FRandRange(0.25, 0.75) * GridSize.X, Random.FRandRange(0.05, 0.95) * GridSize.Y);
+		const FVector2D Extent(Random.FRandRange(200.0, 1500.0), Random.FRandRange(200.0, 3000.0));
+		FlowFields->AddBlocker(FBox2D(Center - Extent, Center + Extent));
+
+		AActor* Obstacle = World->SpawnActor<AActor>();
+		UBoxComponent* ObstacleBox = NewObject<UBoxComponent>(Obstacle, TEXT("Obstacle"));
+		ObstacleBox->SetBoxExtent(FVector(Extent, 300.0));
+		ObstacleBox->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		ObstacleBox->SetCanEverAffectNavigation(true);
+		Obstacle->SetRootComponent(ObstacleBox);
+		ObstacleBox->RegisterComponent();
+		ObstacleBox->SetWorldLocation(FVector(Center, 300.0));
+	}
+
+	// Navmesh over the grid, built synchronously, for the per-unit path query baseline. A volume spawned at runtime has
+	// no brush, so its bounds come from a box body setup instead.
+	UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	if (!NavigationSystem)
+	{
+		FNavigationSystem::AddNavigationSystemToWorld(*World, FNavigationSystemRunMode::GameMode);
+		NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	}
+	const FVector NavBoundsCenter(Grid.Origin + GridSize * 0.5, 0.0);
+	const FVector NavBoundsExtent(GridSize * 0.5, 1000.0);
+	const FTransform NavBoundsTransform(NavBoundsCenter);
+	ANavMeshBoundsVolume* NavBounds = World->SpawnActorDeferred<ANavMeshBoundsVolume>(ANavMeshBoundsVolume::StaticClass(), NavBoundsTransform);
+	if (NavBounds)
+	{
+		UBodySetup* BoundsBody = NewObject<UBodySetup>(NavBounds->GetBrushComponent());
+		BoundsBody->AggGeom.BoxElems.Add(FKBoxElem(NavBoundsExtent.X * 2.0, NavBoundsExtent.Y * 2.0, NavBoundsExtent.Z * 2.0));
+		NavBounds->GetBrushComponent()->BrushBodySetup = BoundsBody;
+		NavBounds->FinishSpawning(NavBoundsTransform);
+		NavBounds->GetBrushComponent()->UpdateBounds();
+	}
+
+	const uint64 NavBuildStart = FPlatformTime::Cycles64();
+	if (NavigationSystem && NavBounds)
+	{
+		NavigationSystem->OnNavigationBoundsUpdated(NavBounds);
+		NavigationSystem->Build();
+	}
+	const double NavBuildMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - NavBuildStart);
+	if (!NavigationSystem || !NavigationSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate))
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] FlowField: building the navmesh produced no navigation data; the per-unit path query baseline can't run."));
+		DestroyBenchmarkWorld(World, GameInstance);
+		return 1;
+	}
+	UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] FlowField: navmesh over %.0f x %.0f m built in %.0f ms."), GridSize.X / 100.0, GridSize.Y / 100.0, NavBuildMs);
+
+	int32 Result = 0;
+	OutCsv = TEXT("Group,FlowBuildMs,FlowCachedRequestMs,FlowSampleMs,FlowRebuildMs,NavQueryMs,NavPathsFound\n");
+	for (const FString& GroupSizeString : GroupSizeStrings)
+	{
+		const int32 GroupSize = FCString::Atoi(*GroupSizeString);
+		if (GroupSize <= 0)
+		{
+			continue;
+		}
+
+		// The group starts in a square near the left edge; the destination is near the right edge.
+		const int32 GroupSide = FMath::CeilToInt32(FMath::Sqrt(double(GroupSize)));
+		const FVector GroupCenter(Grid.Origin.X + GridSize.X * 0.1, Grid.Origin.Y + GridSize.Y * 0.5, 0.0);
+		const FVector Destination(Grid.Origin.X + GridSize.X * 0.9, Grid.Origin.Y + GridSize.Y * (0.3 + 0.4 * Random.GetFraction()), 0.0);
+		TArray<FVector> Starts;
+		Starts.Reserve(GroupSize);
+		for (int32 Index = 0; Index < GroupSize; ++Index)
+		{
+			Starts.Add(GroupCenter + FVector(((Index % GroupSide) - GroupSide * 0.5) * 100.0, ((Index / GroupSide) - GroupSide * 0.5) * 100.0, 0.0));
+		}
+
+		// 1. One field for the whole group, built on a background task (timed until it is ready).
+		const uint64 BuildStart = FPlatformTime::Cycles64();
+		FBox2D StartBounds(ForceInit);
+		for (const FVector& Start : Starts)
+		{
+			StartBounds += FVector2D(Start);
+		}
+		const int32 FlowFieldId = FlowFields->RequestFlowField(Destination, StartBounds);
+		FlowFields->WaitForPendingBuilds();
+		const double FlowBuildMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - BuildStart);
+
+		// 2. The same destination again is a cache hit.
+		const uint64 CachedStart = FPlatformTime::Cycles64();
+		FlowFields->RequestFlowField(Destination, StartBounds);
+		const double FlowCachedRequestMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - CachedStart);
+
+		// 3. What each unit pays per frame: one field lookup.
+		const FStrategyFlowFieldRef Field = FlowFields->FindFlowField(FlowFieldId);
+		FVector DirectionSum = FVector::ZeroVector;
+		const uint64 SampleStart = FPlatformTime::Cycles64();
+		for (const FVector& Start : Starts)
+		{
+			DirectionSum += Field ? Field->GetDirection(Start) : FVector::ZeroVector;
+		}
+		const double FlowSampleMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - SampleStart);
+
+		// 4. An obstacle change in the group's path rebuilds the fields whose region it overlaps, in the background.
+		const uint64 RebuildStart = FPlatformTime::Cycles64();
+		const FVector2D Blocker(Destination.X - GridSize.X * 0.2, Destination.Y);
+		const FBox2D BlockerBox(Blocker - FVector2D(300.0), Blocker + FVector2D(300.0));
+		FlowFields->AddBlocker(BlockerBox);
+		FlowFields->WaitForPendingBuilds();
+		const double FlowRebuildMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - RebuildStart);
+
+		// Overlapping blockers: removing one keeps the cells the other still covers blocked.
+		const FIntPoint BlockerCell = Grid.GetCell(FVector(Blocker, 0.0));
+		const int32 BlockersBefore = FlowFields->GetNumBlockers(BlockerCell);
+		const FBox2D OverlapBox(Blocker - FVector2D(150.0), Blocker + FVector2D(450.0));
+		FlowFields->AddBlocker(OverlapBox);
+		FlowFields->RemoveBlocker(BlockerBox);
+		const bool bOverlapKept = FlowFields->GetNumBlockers(BlockerCell) == BlockersBefore;
+		FlowFields->RemoveBlocker(OverlapBox);
+		FlowFields->AddBlocker(BlockerBox);
+		FlowFields->WaitForPendingBuilds();
+		if (!bOverlapKept || FlowFields->GetNumBlockers(BlockerCell) != BlockersBefore)
+		{
+			UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] FlowField group %d: removing one of two overlapping blockers changed the other's cells."), GroupSize);
+			Result = 1;
+		}
+
+		// 5. Baseline: one synchronous navigation path query per unit.
+		int32 NumNavPaths = 0;
+		const uint64 NavStart = FPlatformTime::Cycles64();
+		for (const FVector& Start : Starts)
+		{
+			const UNavigationPath* Path = NavigationSystem->FindPathToLocationSynchronously(World, Start, Destination);
+			NumNavPaths += Path && Path->IsValid() ? 1 : 0;
+		}
+		const double NavQueryMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - NavStart);
+
+		OutCsv += FString::Printf(TEXT("%d,%.4f,%.4f,%.4f,%.4f,%.4f,%d\n"), GroupSize, FlowBuildMs, FlowCachedRequestMs, FlowSampleMs, FlowRebuildMs, NavQueryMs, NumNavPaths);
+		UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] FlowField group %5d | build %.2f ms (task %.2f ms), cached request %.4f ms, sample %.4f ms/frame, rebuild %.2f ms | nav queries %.2f ms (%d paths)"),
+			GroupSize, FlowBuildMs, Field ? Field->BuildMs : 0.0, FlowCachedRequestMs, FlowSampleMs, FlowRebuildMs, NavQueryMs, NumNavPaths);
+		if (NumNavPaths == 0)
+		{
+			UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] FlowField group %d: no navigation path found; the navmesh doesn't cover the grid."), GroupSize);
+			Result = 1;
+		}
+	}
+
+	DestroyBenchmarkWorld(World, GameInstance);
+	return Result;
+}
+
+int32 UStrategyBenchmarkCommandlet::RunFogOfWarSuite(const FString& Params, FString& OutCsv) const
+{
+	using namespace StrategyBenchmark;
+
+	FString SourceCountsParam = TEXT("1000,10000");
+	int32 NumFrames = 120;
+	float DeltaTime = 1.f / 60.f;
+	int32 NumQueries = 1000000;
+	FParse::Value(*Params, TEXT("Sources="), SourceCountsParam);
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("DeltaTime="), DeltaTime);
+	FParse::Value(*Params, TEXT("Queries="), NumQueries);
+
+	TArray<FString> SourceCountStrings;
+	SourceCountsParam.ParseIntoArray(SourceCountStrings, TEXT(","));
+
+	UGameInstance* GameInstance = nullptr;
+	UWorld* World = CreateBenchmarkWorld(GameInstance);
+	UStrategyFogOfWarSubsystem* FogOfWar = World ? World->GetSubsystem<UStrategyFogOfWarSubsystem>() : nullptr;
+	IConsoleVariable* ParallelUpdate = IConsoleManager::Get().FindConsoleVariable(TEXT("Strategy.FogOfWar.ParallelUpdate"));
+	if (!FogOfWar || !ParallelUpdate)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Could not create the benchmark world or fog-of-war subsystem."));
+		DestroyBenchmarkWorld(World, GameInstance);
+		return 1;
+	}
+	const bool bParallelUpdateWas = ParallelUpdate->GetBool();
+
+	// The world is never ticked, so the grid only changes through the explicit flushes below.
+	FStrategyFogOfWarGrid Grid;
+	Grid.Width = 512;
+	Grid.Height = 512;
+	const FVector2D GridMin = Grid.Origin;
+	const FVector2D GridMax = Grid.Origin + FVector2D(Grid.Width, Grid.Height) * Grid.CellSize;
+
+	int32 Result = 0;
+	OutCsv = TEXT("Sources,Mode,Frame,SourceUpdateMs,TileUpdateMs,Tiles\n");
+	for (const FString& SourceCountString : SourceCountStrings)
+	{
+		const int32 NumSources = FCString::Atoi(*SourceCountString);
+		if (NumSources <= 0)
+		{
+			continue;
+		}
+
+		for (const bool bParallel : { true, false })
+		{
+			ParallelUpdate->Set(bParallel, ECVF_SetByCode);
+			const TCHAR* Mode = bParallel ? TEXT("Parallel") : TEXT("GameThread");
+
+			// Same sources and paths for both modes.
+			FRandomStream Random(0xF06 + NumSources);
+			TArray<FVector> Locations;
+			TArray<FVector> Velocities;
+			TArray<float> Radii;
+			for (int32 Index = 0; Index < NumSources; ++Index)
+			{
+				Locations.Add(FVector(Random.FRandRange(GridMin.X, GridMax.X), Random.FRandRange(GridMin.Y, GridMax.Y), 0.0));
+				Velocities.Add(FVector(FVector2D(Random.GetUnitVector()).GetSafeNormal() * Random.FRandRange(300.0, 600.0), 0.0));
+				Radii.Add(Random.FRandRange(800.f, 1500.f));
+			}
+
+			FogOfWar->RemoveAllVisionSources();
+			FogOfWar->Configure(Grid);
+
+			// 1. Every circle stamped once.
+			const uint64 InitialStart = FPlatformTime::Cycles64();
+			TArray<FStrategyVisionHandle> Handles;
+			Handles.Reserve(NumSources);
+			for (int32 Index = 0; Index < NumSources; ++Index)
+			{
+				Handles.Add(FogOfWar->AddVisionSource(Locations[Index], Radii[Index]));
+			}
+			FogOfWar->FlushVisionUpdates();
+			const double InitialMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - InitialStart);
+
+			// 2. Every source moves every frame; only cell crossings re-stamp.
+			TArray<double> SourceUpdateTimes;
+			TArray<double> TileUpdateTimes;
+			TArray<double> TileCounts;
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				for (int32 Index = 0; Index < NumSources; ++Index)
+				{
+					FVector& Location = Locations[Index];
+					FVector& Velocity = Velocities[Index];
+					Location += Velocity * DeltaTime;
+					if (Location.X < GridMin.X || Location.X > GridMax.X)
+					{
+						Velocity.X = -Velocity.X;
+					}
+					if (Location.Y < GridMin.Y || Location.Y > GridMax.Y)
+					{
+						Velocity.Y = -Velocity.Y;
+					}
+				}
+
+				const uint64 UpdateStart = FPlatformTime::Cycles64();
+				for (int32 Index = 0; Index < NumSources; ++Index)
+				{
+					FogOfWar->UpdateVisionSource(Handles[Index], Locations[Index]);
+				}
+				const uint64 FlushStart = FPlatformTime::Cycles64();
+				FogOfWar->FlushVisionUpdates();
+				const uint64 FlushEnd = FPlatformTime::Cycles64();
+
+				SourceUpdateTimes.Add(FPlatformTime::ToMilliseconds64(FlushStart - UpdateStart));
+				TileUpdateTimes.Add(FPlatformTime::ToMilliseconds64(FlushEnd - FlushStart));
+				TileCounts.Add(FogOfWar->GetLastNumUpdatedTiles());
+				OutCsv += FString::Printf(TEXT("%d,%s,%d,%.4f,%.4f,%d\n"), NumSources, Mode, Frame, SourceUpdateTimes.Last(), TileUpdateTimes.Last(), FogOfWar->GetLastNumUpdatedTiles());
+			}
+
+			// 3. The incremental grid must match one stamped from scratch.
+			const TArray<uint64> IncrementalBits = FogOfWar->GetVisibleBits();
+			const uint64 RebuildStart = FPlatformTime::Cycles64();
+			FogOfWar->RebuildVisibility();
+			const double RebuildMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - RebuildStart);
+			if (IncrementalBits != FogOfWar->GetVisibleBits())
+			{
+				UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] FogOfWar %d %s: the incremental grid differs from a full rebuild."), NumSources, Mode);
+				Result = 1;
+			}
+
+			// 4. Sampled cells against every source's circle.
+			int32 NumMismatches = 0;
+			for (int32 Sample = 0; Sample < 500; ++Sample)
+			{
+				const FIntPoint Cell(Random.RandHelper(Grid.Width), Random.RandHelper(Grid.Height));
+				bool bExpected = false;
+				for (int32 Index = 0; Index < NumSources && !bExpected; ++Index)
+				{
+					const FIntPoint SourceCell = Grid.GetCell(Locations[Index]);
+					const int32 RadiusCells = FMath::CeilToInt32(Radii[Index] / Grid.CellSize);
+					bExpected = FMath::Square(Cell.X - SourceCell.X) + FMath::Square(Cell.Y - SourceCell.Y) <= RadiusCells * RadiusCells;
+				}
+				NumMismatches += FogOfWar->IsCellVisible(Cell) != bExpected ? 1 : 0;
+			}
+			if (NumMismatches > 0)
+			{
+				UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] FogOfWar %d %s: %d of 500 sampled cells disagree with the brute-force check."), NumSources, Mode, NumMismatches);
+				Result = 1;
+			}
+
+			// 5. Point queries, as gameplay code would issue them.
+			int32 NumVisible = 0;
+			const uint64 QueryStart = FPlatformTime::Cycles64();
+			for (int32 Query = 0; Query < NumQueries; ++Query)
+			{
+				NumVisible += FogOfWar->IsVisible(FVector(Random.FRandRange(GridMin.X, GridMax.X), Random.FRandRange(GridMin.Y, GridMax.Y), 0.0)) ? 1 : 0;
+			}
+			const double QueryNs = NumQueries > 0 ? FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - QueryStart) * 1.0e6 / NumQueries : 0.0;
+
+			UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] FogOfWar %6d %-10s | initial %.2f ms | per frame: sources p50 %.3f ms, tiles p50 %.3f ms p95 %.3f ms (%.0f of %d tiles) | full rebuild %.2f ms | query %.1f ns (%.1f%% visible)"),
+				NumSources, Mode, InitialMs, Percentile(SourceUpdateTimes, 0.5), Percentile(TileUpdateTimes, 0.5), Percentile(TileUpdateTimes, 0.95),
+				Percentile(TileCounts, 0.5), (Grid.Width / UStrategyFogOfWarSubsystem::TileSize) * (Grid.Height / UStrategyFogOfWarSubsystem::TileSize),
+				RebuildMs, QueryNs, NumQueries > 0 ? 100.0 * NumVisible / NumQueries : 0.0);
+		}
+	}
+
+	ParallelUpdate->Set(bParallelUpdateWas, ECVF_SetByCode);
+	FogOfWar->RemoveAllVisionSources();
+	DestroyBenchmarkWorld(World, GameInstance);
+	return Result;
+}
+
+int32 UStrategyBenchmarkCommandlet::RunMinimapSuite(const FString& Params, FString& OutCsv) const
+{
+	using namespace StrategyBenchmark;
+
+	int32 NumUnits = 5000;
+	int32 NumFrames = 300;
+	float DeltaTime = 1.f / 60.f;
+	double BudgetMs = 0.3;
+	FParse::Value(*Params, TEXT("Units="), NumUnits);
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("DeltaTime="), DeltaTime);
+	FParse::Value(*Params, TEXT("Budget="), BudgetMs);
+
+	UGameInstance* GameInstance = nullptr;
+	UWorld* World = CreateBenchmarkWorld(GameInstance);
+	AStrategyPlayerController* Controller = World ? CreatePlayer(*World, *GameInstance, Params) : nullptr;
+	UStrategyMinimapSubsystem* Minimap = World ? World->GetSubsystem<UStrategyMinimapSubsystem>() : nullptr;
+	UStrategyUnitSimulationSubsystem* Simulation = World ? World->GetSubsystem<UStrategyUnitSimulationSubsystem>() : nullptr;
+	if (!Controller || !Minimap || !Simulation || !Minimap->GetMinimapTexture())
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Could not create the benchmark world, player, minimap or unit simulation."));
+		DestroyBenchmarkWorld(World, GameInstance);
+		return 1;
+	}
+
+	// Some raised ground for the base layer, which is rasterized again after they are added.
+	const FStrategyMinimapSettings& Settings = Minimap->GetSettings();
+	const FVector2D MapSize = Settings.WorldMax - Settings.WorldMin;
+	FRandomStream Random(0x313A);
+	for (int32 Index = 0; Index < 30; ++Index)
+	{
+		AActor* Hill = World->SpawnActor<AActor>();
+		UBoxComponent* HillBox = NewObject<UBoxComponent>(Hill);
+		HillBox->SetBoxExtent(FVector(Random.FRandRange(500.0, 3000.0), Random.FRandRange(500.0, 3000.0), Random.FRandRange(100.0, 1500.0)));
+		HillBox->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		Hill->SetRootComponent(HillBox);
+		HillBox->RegisterComponent();
+		HillBox->SetWorldLocation(FVector(Settings.WorldMin + MapSize * FVector2D(Random.FRandRange(0.1, 0.9), Random.FRandRange(0.1, 0.9)), 0.0));
+	}
+	Minimap->InvalidateBase();
+
+	// Units in the left half of the map, ordered to the right half.
+	TArray<FVector> Locations;
+	Locations.Reserve(NumUnits);
+	for (int32 Index = 0; Index < NumUnits; ++Index)
+	{
+		Locations.Add(FVector(Settings.WorldMin + MapSize * FVector2D(Random.FRandRange(0.05, 0.45), Random.FRandRange(0.05, 0.95)), 0.0));
+	}
+	TArray<FStrategyUnitHandle> Units;
+	Simulation->SpawnUnits(Locations, &Units);
+	Simulation->MoveUnits(Units, FVector(Settings.WorldMin + MapSize * FVector2D(0.8, 0.5), 0.0), 200.f);
+
+	// The first frames rasterize the base and draw every block; measure from the steady state on.
+	for (int32 Frame = 0; Frame < 5; ++Frame)
+	{
+		World->Tick(LEVELTICK_All, DeltaTime);
+		++GFrameCounter;
+	}
+
+	TArray<double> UpdateTimes;
+	TArray<double> DirtyBlockCounts;
+	OutCsv = TEXT("Frame,UpdateMs,DirtyBlocks\n");
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		World->Tick(LEVELTICK_All, DeltaTime);
+		++GFrameCounter;
+		UpdateTimes.Add(Minimap->GetLastUpdateMs());
+		DirtyBlockCounts.Add(Minimap->GetLastNumDirtyBlocks());
+		OutCsv += FString::Printf(TEXT("%d,%.4f,%d\n"), Frame, Minimap->GetLastUpdateMs(), Minimap->GetLastNumDirtyBlocks());
+	}
+
+	int32 Result = 0;
+
+	// 1. The incremental image must match a full redraw of the same state. The minimap may have ticked before the
+	// units and the fog in the last frame, so one more incremental update catches it up first.
+	Minimap->UpdateMinimap();
+	const TArray<FColor> IncrementalPixels = Minimap->GetPixels();
+	Minimap->RedrawAll();
+	Minimap->UpdateMinimap();
+	const double RedrawMs = Minimap->GetLastUpdateMs();
+	if (IncrementalPixels != Minimap->GetPixels())
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Minimap: the incremental image differs from a full redraw."));
+		Result = 1;
+	}
+
+	// 2. Every unit on the map is drawn (or under the footprint outline).
+	UStrategyUnitRegistrySubsystem* Registry = World->GetSubsystem<UStrategyUnitRegistrySubsystem>();
+	int32 NumMissingUnits = 0;
+	for (const FStrategyUnitHandle& Unit : Units)
+	{
+		const FVector2D UV = Minimap->WorldToMinimap(Registry->GetUnitLocation(Unit));
+		const FIntPoint Pixel(FMath::FloorToInt32(UV.X * Minimap->GetResolution()), FMath::FloorToInt32(UV.Y * Minimap->GetResolution()));
+		if (Pixel.X >= 0 && Pixel.Y >= 0 && Pixel.X < Minimap->GetResolution() && Pixel.Y < Minimap->GetResolution())
+		{
+			const FColor Color = Minimap->GetPixels()[Pixel.Y * Minimap->GetResolution() + Pixel.X];
+			NumMissingUnits += Color != Settings.UnitColor && Color != Settings.FootprintColor ? 1 : 0;
+		}
+	}
+	if (NumMissingUnits > 0)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Minimap: %d units are not drawn."), NumMissingUnits);
+		Result = 1;
+	}
+
+	// 3. A click jumps the camera there.
+	const FVector2D ClickUV(0.25, 0.75);
+	const FVector ClickTarget = Minimap->MinimapToWorld(ClickUV);
+	Controller->JumpCameraToMinimap(ClickUV);
+	for (int32 Frame = 0; Frame < 60; ++Frame)
+	{
+		World->Tick(LEVELTICK_All, DeltaTime);
+		++GFrameCounter;
+	}
+	const double JumpError = FVector::Dist2D(Controller->GetPawn()->GetActorLocation(), ClickTarget);
+	if (JumpError > 100.0)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Minimap: a click put the camera %.0f cm from the clicked point."), JumpError);
+		Result = 1;
+	}
+
+	const double P95 = Percentile(UpdateTimes, 0.95);
+	UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] Minimap %d units | update p50 %.3f ms, p95 %.3f ms, max %.3f ms (budget %.2f ms: %s) | dirty blocks p50 %.0f of %d | full redraw %.3f ms | jump error %.1f cm"),
+		NumUnits, Percentile(UpdateTimes, 0.5), P95, Percentile(UpdateTimes, 1.0), BudgetMs, P95 <= BudgetMs ? TEXT("met") : TEXT("MISSED"),
+		Percentile(DirtyBlockCounts, 0.5), FMath::Square(Minimap->GetResolution() / Settings.BlockSize), RedrawMs, JumpError);
+
+	Simulation->DestroyAllUnits();
+	DestroyBenchmarkWorld(World, GameInstance);
+	return Result;
+}
+
+int32 UStrategyBenchmarkCommandlet::RunBookmarkSuite(const FString& Params, FString& OutCsv) const
+{
+	using namespace StrategyBenchmark;
+
+	double Distance = 40000.0;
+	int32 MaxFrames = 900;
+	float DeltaTime = 1.f / 60.f;
+	FParse::Value(*Params, TEXT("Distance="), Distance);
+	FParse::Value(*Params, TEXT("MaxFrames="), MaxFrames);
+	FParse::Value(*Params, TEXT("DeltaTime="), DeltaTime);
+
+	UGameInstance* GameInstance = nullptr;
+	UWorld* World = CreateBenchmarkWorld(GameInstance);
+	AStrategyPlayerController* Controller = World ? CreatePlayer(*World, *GameInstance, Params) : nullptr;
+	AStrategyCameraPawn* Pawn = Controller ? Cast<AStrategyCameraPawn>(Controller->GetPawn()) : nullptr;
+	if (!Pawn)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Could not create the benchmark world or player."));
+		DestroyBenchmarkWorld(World, GameInstance);
+		return 1;
+	}
+
+	FStrategyCameraBookmark Bookmarks[2];
+	Bookmarks[0].Location = FVector(0.0, 0.0, 0.0);
+	Bookmarks[0].Yaw = 0.f;
+	Bookmarks[0].ZoomLength = FMath::Clamp(1500.f, Controller->MinZoomLength, Controller->MaxZoomLength);
+	Bookmarks[1].Location = FVector(Distance, Distance * 0.5, 0.0);
+	Bookmarks[1].Yaw = 135.f;
+	Bookmarks[1].ZoomLength = FMath::Clamp(3500.f, Controller->MinZoomLength, Controller->MaxZoomLength);
+	Bookmarks[0].bIsSet = Bookmarks[1].bIsSet = true;
+
+	int32 Result = 0;
+	TArray<double> StableMs[2];
+	TArray<double> StableFrames[2];
+	OutCsv = TEXT("Jump,Mode,PrefetchMs,StableMs,StableFrames,PrefetchTimedOut,LocationError,YawError,ArmLengthError\n");
+	for (int32 Jump = 0; Jump < 8; ++Jump)
+	{
+		// Animated jumps first, then cuts, alternating destinations.
+		const bool bCut = Jump >= 4;
+		const FStrategyCameraBookmark& Bookmark = Bookmarks[(Jump + 1) % 2];
+		Controller->JumpToCameraBookmarkData(Bookmark, bCut);
+		int32 Frame = 0;
+		for (; Frame < MaxFrames && Controller->IsCameraJumpPending(); ++Frame)
+		{
+			World->Tick(LEVELTICK_All, DeltaTime);
+			++GFrameCounter;
+		}
+
+		const FStrategyCameraJumpMetrics& Metrics = Controller->GetLastCameraJumpMetrics();
+		const double LocationError = FVector::Dist2D(Pawn->GetActorLocation(), Bookmark.Location);
+		const double YawError = FMath::Abs(FMath::FindDeltaAngleDegrees(Pawn->GetActorRotation().Yaw, Bookmark.Yaw));
+		const double ArmLengthError = FMath::Abs(Pawn->GetCameraBoom()->TargetArmLength - Bookmark.ZoomLength);
+		OutCsv += FString::Printf(TEXT("%d,%s,%.3f,%.3f,%d,%d,%.2f,%.3f,%.2f\n"), Jump, bCut ? TEXT("Cut") : TEXT("Animate"), Metrics.PrefetchMs,
+			Metrics.StableMs, Metrics.StableFrames, Metrics.bPrefetchTimedOut ? 1 : 0, LocationError, YawError, ArmLengthError);
+
+		if (Controller->IsCameraJumpPending())
+		{
+			UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Bookmarks: jump %d was not stable after %d frames."), Jump, MaxFrames);
+			Result = 1;
+			continue;
+		}
+		if (LocationError > 100.0 || YawError > 1.0 || ArmLengthError > 10.0)
+		{
+			UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Bookmarks: jump %d ended %.0f cm, %.2f deg and %.0f cm of arm length off the bookmark."), Jump, LocationError, YawError, ArmLengthError);
+			Result = 1;
+		}
+		StableMs[bCut ? 1 : 0].Add(Metrics.StableMs);
+		StableFrames[bCut ? 1 : 0].Add(Metrics.StableFrames);
+	}
+
+	// A bookmark set where the camera rests returns it there.
+	Controller->SetCameraBookmark(0);
+	const FStrategyCameraBookmark* Saved = Controller->GetCameraBookmark(0);
+	if (!Saved || FVector::Dist2D(Saved->Location, Pawn->GetActorLocation()) > 1.0 || !FMath::IsNearlyEqual(Saved->ZoomLength, Pawn->GetCameraBoom()->TargetArmLength, 10.f))
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Bookmarks: SetCameraBookmark did not store the camera's resting view."));
+		Result = 1;
+	}
+
+	for (int32 Mode = 0; Mode < 2; ++Mode)
+	{
+		UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] Bookmarks %s over %.0f m | stable p50 %.1f ms (%.0f frames), max %.1f ms (%.0f frames)"),
+			Mode == 1 ? TEXT("cut") : TEXT("animated"), Distance / 100.0, Percentile(StableMs[Mode], 0.5), Percentile(StableFrames[Mode], 0.5),
+			Percentile(StableMs[Mode], 1.0), Percentile(StableFrames[Mode], 1.0));
+	}
+
+	DestroyBenchmarkWorld(World, GameInstance);
+	return Result;
+}
+
+int32 UStrategyBenchmarkCommandlet::RunLockstepSuite(const FString& Params, FString& OutCsv) const
+{
+	using namespace StrategyBenchmark;
+
+	int32 NumClients = 4;
+	FString UnitCountsParam = TEXT("1000,100000");
+	int32 NumTurns = 600;
+	float TurnMs = 100.f;
+	double Latency = 0.05;
+	float OrderRate = 0.3f;
+	int32 NumSessionUnits = 200;
+	FParse::Value(*Params, TEXT("Clients="), NumClients);
+	FParse::Value(*Params, TEXT("Units="), UnitCountsParam);
+	FParse::Value(*Params, TEXT("Turns="), NumTurns);
+	FParse::Value(*Params, TEXT("TurnMs="), TurnMs);
+	FParse::Value(*Params, TEXT("Latency="), Latency);
+	FParse::Value(*Params, TEXT("OrderRate="), OrderRate);
+	FParse::Value(*Params, TEXT("SessionUnits="), NumSessionUnits);
+	NumClients = FMath::Clamp(NumClients, 1, FStrategyLockstepPeer::MaxPlayers);
+	NumSessionUnits = FMath::Max(NumSessionUnits, 1);
+
+	TArray<FString> UnitCounts;
+	UnitCountsParam.ParseIntoArray(UnitCounts, TEXT(","));
+
+	constexpr double FrameSeconds = 1.0 / 60.0;
+	int32 Result = 0;
+	OutCsv = TEXT("Units,Turns,AvgPacketBytes,MaxPacketBytes,CommandsPerTurn,LatencyP50Ms,LatencyP95Ms,UpdateMsPerTurn,StalledUpdates,DesyncDetectTurns\n");
+	for (const FString& UnitCountString : UnitCounts)
+	{
+		const int32 NumUnits = FCString::Atoi(*UnitCountString);
+
+		// Every client starts from the same unit list.
+		FRandomStream Random(0x10C5);
+		TArray<FVector> Locations;
+		Locations.Reserve(NumUnits);
+		for (int32 Index = 0; Index < NumUnits; ++Index)
+		{
+			Locations.Add(FVector(Random.FRandRange(-25000.0, 25000.0), Random.FRandRange(-25000.0, 25000.0), 0.0));
+		}
+
+		FStrategyLockstepSettings Settings;
+		Settings.NumPlayers = NumClients;
+		Settings.TurnSeconds = TurnMs / 1000.f;
+		FStrategyLockstepLoopback Transport(NumClients, Latency);
+		TArray<FStrategyLockstepPeer> Peers;
+		Peers.SetNum(NumClients);
+		TArray<FRandomStream> ClientRandoms;
+		TArray<int32> ClientTurns;
+		for (int32 Client = 0; Client < NumClients; ++Client)
+		{
+			Settings.LocalPlayer = uint8(Client);
+			Peers[Client].Start(Settings, Locations, 0.0);
+			ClientRandoms.Emplace(0x5EED + Client);
+			ClientTurns.Add(INDEX_NONE);
+		}
+
+		auto MinNextTurn = [&Peers]()
+		{
+			uint32 Turn = MAX_uint32;
+			for (const FStrategyLockstepPeer& Peer : Peers)
+			{
+				Turn = FMath::Min(Turn, Peer.GetNextTurn());
+			}
+			return Turn;
+		};
+
+		// Runs every client for one frame of the virtual clock; Now is the same for all of them.
+		double Now = 0.0;
+		uint64 UpdateCycles = 0;
+		auto RunFrame = [&](bool bIssueOrders)
+		{
+			Now += FrameSeconds;
+			for (int32 Client = 0; Client < NumClients; ++Client)
+			{
+				const int32 Turn = FMath::FloorToInt32(Now / Settings.TurnSeconds);
+				FRandomStream& ClientRandom = ClientRandoms[Client];
+				if (bIssueOrders && NumUnits > 0 && Turn != ClientTurns[Client] && ClientRandom.FRand() < OrderRate)
+				{
+					FStrategyLockstepCommand Select;
+					Select.Type = EStrategyLockstepCommandType::Select;
+					const int32 SelectionSize = ClientRandom.RandRange(1, FMath::Min(200, NumUnits));
+					for (int32 Index = 0; Index < SelectionSize; ++Index)
+					{
+						Select.Units.Add(ClientRandom.RandRange(0, NumUnits - 1));
+					}
+					Select.Units.Sort();
+					Select.Units.SetNum(Algo::Unique(Select.Units));
+					Peers[Client].QueueCommand(MoveTemp(Select), Now);
+
+					FStrategyLockstepCommand Move;
+					Move.Type = EStrategyLockstepCommandType::Move;
+					Move.Target = StrategyFixed::FromLocation(FVector(ClientRandom.FRandRange(-25000.0, 25000.0), ClientRandom.FRandRange(-25000.0, 25000.0), 0.0));
+					Move.Spacing = StrategyFixed::FromCm(150.0);
+					Peers[Client].QueueCommand(MoveTemp(Move), Now);
+				}
+				ClientTurns[Client] = Turn;
+
+				const uint64 StartCycles = FPlatformTime::Cycles64();
+				Peers[Client].Update(Now, Transport);
+				UpdateCycles += FPlatformTime::Cycles64() - StartCycles;
+			}
+		};
+
+		const int32 MaxFrames = FMath::CeilToInt32((NumTurns + 10) * Settings.TurnSeconds / FrameSeconds) * 4;
+		for (int32 Frame = 0; Frame < MaxFrames && MinNextTurn() < uint32(NumTurns); ++Frame)
+		{
+			RunFrame(true);
+		}
+
+		// 1. Every client has the same state after the last common turn.
+		const uint32 CheckTurn = MinNextTurn() - 1;
+		uint32 ReferenceChecksum = 0;
+		bool bChecksumsMatch = MinNextTurn() > 0 && Peers[0].GetTurnChecksum(CheckTurn, ReferenceChecksum);
+		for (int32 Client = 1; Client < NumClients && bChecksumsMatch; ++Client)
+		{
+			uint32 Checksum = 0;
+			bChecksumsMatch = Peers[Client].GetTurnChecksum(CheckTurn, Checksum) && Checksum == ReferenceChecksum;
+		}
+		bool bAnyDesynced = false;
+		for (const FStrategyLockstepPeer& Peer : Peers)
+		{
+			bAnyDesynced |= Peer.IsDesynced();
+		}
+		if (!bChecksumsMatch || bAnyDesynced || MinNextTurn() < uint32(NumTurns))
+		{
+			UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Lockstep %d units: clients reached turn %u of %d, checksums at turn %u %s%s."), NumUnits,
+				MinNextTurn(), NumTurns, CheckTurn, bChecksumsMatch ? TEXT("match") : TEXT("DIFFER"), bAnyDesynced ? TEXT(", desync reported") : TEXT(""));
+			Result = 1;
+		}
+
+		// Metrics of the orders phase, before the desync check below adds turns.
+		uint64 BytesSent = 0;
+		uint64 PacketsSent = 0;
+		uint64 CommandsSent = 0;
+		uint64 StalledUpdates = 0;
+		int32 MaxPacketBytes = 0;
+		TArray<double> LatenciesMs;
+		for (const FStrategyLockstepPeer& Peer : Peers)
+		{
+			const FStrategyLockstepMetrics& Metrics = Peer.GetMetrics();
+			BytesSent += Metrics.BytesSent;
+			PacketsSent += Metrics.PacketsSent;
+			CommandsSent += Metrics.CommandsSent;
+			StalledUpdates += Metrics.StalledUpdates;
+			MaxPacketBytes = FMath::Max(MaxPacketBytes, Metrics.MaxPacketBytes);
+			for (const double Seconds : Metrics.CommandLatencies)
+			{
+				LatenciesMs.Add(Seconds * 1000.0);
+			}
+		}
+		const double AvgPacketBytes = PacketsSent > 0 ? double(BytesSent) / PacketsSent : 0.0;
+		const double CommandsPerTurn = PacketsSent > 0 ? double(CommandsSent) / PacketsSent * NumClients : 0.0;
+		const double UpdateMsPerTurn = FPlatformTime::ToMilliseconds64(UpdateCycles) / FMath::Max<uint32>(MinNextTurn() * NumClients, 1);
+
+		// 2. A unit moved on one client alone is reported as a desync by the others within a few turns.
+		int32 DesyncDetectTurns = INDEX_NONE;
+		if (NumClients > 1 && NumUnits > 0)
+		{
+			const uint32 NudgeTurn = Peers[1].GetNextTurn();
+			Peers[1].GetMutableSim().DebugNudgeUnit(0);
+			for (int32 Frame = 0; Frame < MaxFrames && DesyncDetectTurns == INDEX_NONE; ++Frame)
+			{
+				RunFrame(false);
+				if (Peers[0].IsDesynced())
+				{
+					DesyncDetectTurns = int32(Peers[0].GetNextTurn() - NudgeTurn);
+				}
+			}
+			if (DesyncDetectTurns == INDEX_NONE)
+			{
+				UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Lockstep %d units: a nudged unit was never reported as a desync."), NumUnits);
+				Result = 1;
+			}
+		}
+
+		OutCsv += FString::Printf(TEXT("%d,%d,%.1f,%d,%.2f,%.1f,%.1f,%.4f,%llu,%d\n"), NumUnits, NumTurns, AvgPacketBytes, MaxPacketBytes,
+			CommandsPerTurn, Percentile(LatenciesMs, 0.5), Percentile(LatenciesMs, 0.95), UpdateMsPerTurn, StalledUpdates, DesyncDetectTurns);
+		UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] Lockstep %d clients, %d units, %d turns | packet avg %.1f B, max %d B (%.2f commands/turn) | command latency p50 %.1f ms, p95 %.1f ms | update %.4f ms/turn/client | %llu stalled updates | desync seen after %d turns"),
+			NumClients, NumUnits, NumTurns, AvgPacketBytes, MaxPacketBytes, CommandsPerTurn, Percentile(LatenciesMs, 0.5), Percentile(LatenciesMs, 0.95),
+			UpdateMsPerTurn, StalledUpdates, DesyncDetectTurns);
+	}
+
+	// 3. Two UStrategyLockstepSubsystem sessions, one per world, over one loopback and on the real clock the subsystem
+	// uses. The first world's controller orders its selection; the order must execute in both worlds, and ending a
+	// session must leave units it didn't spawn.
+	UGameInstance* SessionGameInstances[2] = {};
+	UWorld* SessionWorlds[2] = {};
+	UStrategyLockstepSubsystem* Sessions[2] = {};
+	for (int32 Player = 0; Player < 2; ++Player)
+	{
+		SessionWorlds[Player] = CreateBenchmarkWorld(SessionGameInstances[Player]);
+		Sessions[Player] = SessionWorlds[Player] ? SessionWorlds[Player]->GetSubsystem<UStrategyLockstepSubsystem>() : nullptr;
+	}
+	AStrategyPlayerController* Controller = SessionWorlds[0] ? CreatePlayer(*SessionWorlds[0], *SessionGameInstances[0], Params) : nullptr;
+	UStrategyUnitSimulationSubsystem* Simulation = SessionWorlds[0] ? SessionWorlds[0]->GetSubsystem<UStrategyUnitSimulationSubsystem>() : nullptr;
+	UStrategyUnitRegistrySubsystem* OtherRegistry = SessionWorlds[1] ? SessionWorlds[1]->GetSubsystem<UStrategyUnitRegistrySubsystem>() : nullptr;
+	if (!Controller || !Simulation || !OtherRegistry || !Sessions[0] || !Sessions[1])
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Lockstep sessions: could not create the worlds, player or lockstep subsystems."));
+		Result = 1;
+	}
+	else
+	{
+		// One unit outside the session, spawned before it.
+		const TArray<FVector> OutsideLocations = { FVector(-5000.0, -5000.0, 0.0) };
+		Simulation->SpawnUnits(OutsideLocations);
+
+		TArray<FVector> Locations;
+		const int32 Side = FMath::CeilToInt32(FMath::Sqrt(double(NumSessionUnits)));
+		for (int32 Index = 0; Index < NumSessionUnits; ++Index)
+		{
+			Locations.Add(FVector((Index % Side) * 200.0, (Index / Side) * 200.0, 0.0));
+		}
+		FStrategyLockstepSettings Settings;
+		Settings.NumPlayers = 2;
+		Settings.TurnSeconds = TurnMs / 1000.f;
+		const TSharedRef<FStrategyLockstepLoopback> Loopback = MakeShared<FStrategyLockstepLoopback>(2, Latency);
+		for (int32 Player = 0; Player < 2; ++Player)
+		{
+			Settings.LocalPlayer = uint8(Player);
+			Sessions[Player]->StartSession(Settings, Loopback, Locations);
+		}
+
+		Controller->SelectedUnits.Reset();
+		for (int32 Unit = 0; Unit < NumSessionUnits; ++Unit)
+		{
+			Controller->SelectedUnits.Add(Sessions[0]->GetUnitHandle(Unit));
+		}
+		const FVector Destination(20000.0, 0.0, 0.0);
+		const FStrategyUnitHandle WatchedUnit = Sessions[1]->GetUnitHandle(0);
+		const FVector WatchedStart = OtherRegistry->GetUnitLocation(WatchedUnit);
+		const int32 NumOrdered = Controller->IssueMoveOrder(Destination);
+
+		// Until the order has executed on both peers and the other world's Mass units present it.
+		const double StartSeconds = FPlatformTime::Seconds();
+		constexpr double TimeoutSeconds = 10.0;
+		bool bExecuted = false;
+		while (!bExecuted && FPlatformTime::Seconds() - StartSeconds < TimeoutSeconds)
+		{
+			for (UWorld* SessionWorld : SessionWorlds)
+			{
+				SessionWorld->Tick(LEVELTICK_All, float(FrameSeconds));
+			}
+			++GFrameCounter;
+			FPlatformProcess::Sleep(float(FrameSeconds));
+
+			bExecuted = Sessions[0]->GetPeer().GetSim().GetSelection(0).Num() == NumSessionUnits
+				&& Sessions[1]->GetPeer().GetSim().GetSelection(0).Num() == NumSessionUnits
+				&& FVector::Dist2D(OtherRegistry->GetUnitLocation(WatchedUnit), WatchedStart) > 1.0;
+		}
+		const double OrderMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+
+		const uint32 CheckTurn = FMath::Min(Sessions[0]->GetPeer().GetNextTurn(), Sessions[1]->GetPeer().GetNextTurn()) - 1;
+		uint32 Checksums[2] = {};
+		const bool bChecksumsMatch = Sessions[0]->GetPeer().GetTurnChecksum(CheckTurn, Checksums[0]) && Sessions[1]->GetPeer().GetTurnChecksum(CheckTurn, Checksums[1])
+			&& Checksums[0] == Checksums[1];
+		UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] Lockstep sessions | %d of %d units ordered through the controller | executed and presented on both peers after %.0f ms | checksums at turn %u %s"),
+			NumOrdered, NumSessionUnits, OrderMs, CheckTurn, bChecksumsMatch ? TEXT("match") : TEXT("DIFFER"));
+		if (NumOrdered != NumSessionUnits || !bExecuted || !bChecksumsMatch)
+		{
+			UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Lockstep sessions: the controller's order did not execute identically in both worlds within %.0f s."), TimeoutSeconds);
+			Result = 1;
+		}
+
+		Sessions[0]->EndSession();
+		if (Simulation->GetNumUnits() != 1)
+		{
+			UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Lockstep sessions: ending a session left %d units, expected only the 1 spawned outside it."), Simulation->GetNumUnits());
+			Result = 1;
+		}
+		Sessions[1]->EndSession();
+	}
+	for (int32 Player = 0; Player < 2; ++Player)
+	{
+		DestroyBenchmarkWorld(SessionWorlds[Player], SessionGameInstances[Player]);
+	}
+
+	return Result;
+}
+
+int32 UStrategyBenchmarkCommandlet::RunPlacementSuite(const FString& Params, FString& OutCsv) const
+{
+	int32 GridSize = 1024;
+	int32 NumFootprints = 10000;
+	int32 NumQueries = 1000000;
+	int32 NumVerify = 20000;
+	FParse::Value(*Params, TEXT("Grid="), GridSize);
+	FParse::Value(*Params, TEXT("Footprints="), NumFootprints);
+	FParse::Value(*Params, TEXT("Queries="), NumQueries);
+	FParse::Value(*Params, TEXT("Verify="), NumVerify);
+	const bool bCompareOverlap = !FParse::Param(*Params, TEXT("NoOverlap"));
+
+	UGameInstance* GameInstance = nullptr;
+	UWorld* World = CreateBenchmarkWorld(GameInstance);
+	UStrategyPlacementSubsystem* Placement = World ? World->GetSubsystem<UStrategyPlacementSubsystem>() : nullptr;
+	if (!Placement)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Could not create the benchmark world or placement grid."));
+		DestroyBenchmarkWorld(World, GameInstance);
+		return 1;
+	}
+
+	FStrategyPlacementGrid Grid;
+	Grid.Width = GridSize;
+	Grid.Height = GridSize;
+	Grid.Origin = -FVector2D(GridSize * Grid.CellSize * 0.5);
+	Placement->Configure(Grid);
+	GridSize = Placement->GetGrid().Width;
+
+	// Buildings placed through the controller, in every quarter turn: the cells UStrategyBuildingFootprintComponent
+	// stamps from the spawned actor's transform must be the preview's footprint at the preview's cell.
+	int32 Result = 0;
+	AStrategyPlayerController* Controller = CreatePlayer(*World, *GameInstance, Params);
+	for (int32 Turns = 0; Controller && Turns < 4; ++Turns)
+	{
+		Controller->BeginPlacement(AStaticMeshActor::StaticClass(), FIntPoint(3, 6));
+		for (int32 Turn = 0; Turn < Turns; ++Turn)
+		{
+			Controller->RotatePlacement();
+		}
+		Controller->SetPlacementLocation(FVector(Turns * 1000.0 + 37.0, 61.0, 0.0));
+		const FStrategyPlacementFootprint Preview = Controller->PlacementFootprint;
+		const FIntPoint PreviewCell = Controller->PlacementCell;
+		AActor* Building = Controller->ConfirmPlacement();
+		Controller->CancelPlacement();
+
+		int32 NumWrongCells = 0;
+		for (int32 Y = -2; Y < Preview.Height + 2; ++Y)
+		{
+			for (int32 X = -2; X < Preview.Width + 2; ++X)
+			{
+				const bool bInPreview = X >= 0 && Y >= 0 && X < Preview.Width && Y < Preview.Height && Preview.IsCellSet(X, Y);
+				NumWrongCells += Placement->IsCellOccupied(PreviewCell + FIntPoint(X, Y)) != bInPreview ? 1 : 0;
+			}
+		}
+		if (Building)
+		{
+			Building->Destroy();
+		}
+		if (!Building || NumWrongCells > 0 || Placement->GetNumFootprints() != 0)
+		{
+			UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Placement: a building placed in %d quarter turns %s (%d cells differ from the preview, %d footprints left after destroying it)."),
+				Turns, Building ? TEXT("was spawned") : TEXT("was NOT spawned"), NumWrongCells, Placement->GetNumFootprints());
+			Result = 1;
+		}
+	}
+	if (!Controller)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Placement: could not create a player to place buildings with."));
+		Result = 1;
+	}
+
+	// A per-cell mirror of the grid to check CanPlace against.
+	TArray<uint16> MirrorCounts;
+	TArray<bool> MirrorBuildable;
+	MirrorCounts.Init(0, GridSize * GridSize);
+	MirrorBuildable.Init(true, GridSize * GridSize);
+	auto MirrorStamp = [&](const FStrategyPlacementFootprint& Footprint, const FIntPoint& MinCell, int32 Delta)
+	{
+		for (int32 Y = 0; Y < Footprint.Height; ++Y)
+		{
+			for (int32 X = 0; X < Footprint.Width; ++X)
+			{
+				if (Footprint.IsCellSet(X, Y))
+				{
+					MirrorCounts[(MinCell.Y + Y) * GridSize + MinCell.X + X] += Delta;
+				}
+			}
+		}
+	};
+	auto MirrorCanPlace = [&](const FStrategyPlacementFootprint& Footprint, const FIntPoint& MinCell)
+	{
+		if (MinCell.X < 0 || MinCell.Y < 0 || MinCell.X + Footprint.Width > GridSize || MinCell.Y + Footprint.Height > GridSize)
+		{
+			return false;
+		}
+		for (int32 Y = 0; Y < Footprint.Height; ++Y)
+		{
+			for (int32 X = 0; X < Footprint.Width; ++X)
+			{
+				const int32 Cell = (MinCell.Y + Y) * GridSize + MinCell.X + X;
+				if (Footprint.IsCellSet(X, Y) && (MirrorCounts[Cell] > 0 || !MirrorBuildable[Cell]))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	};
+
+	// Footprint shapes: rectangles of 2-8 cells a side in every quarter turn, plus an L to exercise rotation.
+	TArray<FStrategyPlacementFootprint> Shapes;
+	FRandomStream Random(0x91AC);
+	for (int32 Index = 0; Index < 16; ++Index)
+	{
+		Shapes.Add(FStrategyPlacementFootprint::MakeRectangle(Random.RandRange(2, 8), Random.RandRange(2, 8)).Rotated(Index));
+	}
+	FStrategyPlacementFootprint LShape = FStrategyPlacementFootprint::MakeRectangle(6, 6);
+	for (int32 Y = 2; Y < 6; ++Y)
+	{
+		LShape.Rows[Y] = 0x3;
+	}
+	for (int32 Turns = 0; Turns < 4; ++Turns)
+	{
+		Shapes.Add(LShape.Rotated(Turns));
+	}
+
+	// Unbuildable lakes.
+	for (int32 Index = 0; Index < 40; ++Index)
+	{
+		const FIntPoint Min(Random.RandRange(0, GridSize - 1), Random.RandRange(0, GridSize - 1));
+		const FIntPoint Max = Min + FIntPoint(Random.RandRange(4, 60), Random.RandRange(4, 60));
+		Placement->SetBuildable(Min, Max, false);
+		for (int32 Y = Min.Y; Y <= FMath::Min(Max.Y, GridSize - 1); ++Y)
+		{
+			for (int32 X = Min.X; X <= FMath::Min(Max.X, GridSize - 1); ++X)
+			{
+				MirrorBuildable[Y * GridSize + X] = false;
+			}
+		}
+	}
+
+	auto RandomCell = [&Random, GridSize]() { return FIntPoint(Random.RandRange(-4, GridSize - 1), Random.RandRange(-4, GridSize - 1)); };
+
+	// Place where it fits, as a player would after a valid preview.
+	TArray<FStrategyPlacementHandle> Handles;
+	TArray<int32> HandleShapes;
+	TArray<FIntPoint> HandleCells;
+	uint64 AddCycles = 0;
+	for (int32 Attempt = 0; Attempt < NumFootprints * 20 && Handles.Num() < NumFootprints; ++Attempt)
+	{
+		const int32 Shape = Random.RandRange(0, Shapes.Num() - 1);
+		const FIntPoint Cell = RandomCell();
+		if (!Placement->CanPlace(Shapes[Shape], Cell))
+		{
+			continue;
+		}
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		Handles.Add(Placement->AddFootprint(Shapes[Shape], Cell));
+		AddCycles += FPlatformTime::Cycles64() - StartCycles;
+		HandleShapes.Add(Shape);
+		HandleCells.Add(Cell);
+		MirrorStamp(Shapes[Shape], Cell, 1);
+	}
+
+	auto Verify = [&](const TCHAR* Stage)
+	{
+		int32 NumMismatches = 0;
+		for (int32 Query = 0; Query < NumVerify; ++Query)
+		{
+			const int32 Shape = Random.RandRange(0, Shapes.Num() - 1);
+			const FIntPoint Cell = RandomCell();
+			NumMismatches += Placement->CanPlace(Shapes[Shape], Cell) != MirrorCanPlace(Shapes[Shape], Cell) ? 1 : 0;
+		}
+		if (NumMismatches > 0)
+		{
+			UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Placement: CanPlace disagrees with the per-cell check in %d of %d queries %s."), NumMismatches, NumVerify, Stage);
+			Result = 1;
+		}
+	};
+	Verify(TEXT("after placing"));
+
+	// Random query positions are generated up front, so only CanPlace is timed.
+	TArray<TPair<int32, FIntPoint>> Queries;
+	Queries.Reserve(NumQueries);
+	for (int32 Query = 0; Query < NumQueries; ++Query)
+	{
+		Queries.Emplace(Random.RandRange(0, Shapes.Num() - 1), RandomCell());
+	}
+	int32 NumValid = 0;
+	const uint64 QueryStart = FPlatformTime::Cycles64();
+	for (const TPair<int32, FIntPoint>& Query : Queries)
+	{
+		NumValid += Placement->CanPlace(Shapes[Query.Key], Query.Value) ? 1 : 0;
+	}
+	const double QueryNs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - QueryStart) * 1e6 / FMath::Max(NumQueries, 1);
+
+	// Footprints stacked over the fifth about to be removed, without CanPlace, so cells are covered two or three times.
+	const int32 NumRemoved = Handles.Num() / 5;
+	TArray<FStrategyPlacementHandle> OverlapHandles;
+	TArray<TPair<int32, FIntPoint>> OverlapPlacements;
+	for (int32 Index = 0; Index < NumRemoved; ++Index)
+	{
+		const FStrategyPlacementFootprint& Shape = Shapes[HandleShapes[Index]];
+		for (const FIntPoint Offset : { FIntPoint(0, 0), FIntPoint(1, 1) })
+		{
+			const FIntPoint Cell = HandleCells[Index] + Offset;
+			if (Cell.X + Shape.Width <= GridSize && Cell.Y + Shape.Height <= GridSize)
+			{
+				OverlapHandles.Add(Placement->AddFootprint(Shape, Cell));
+				OverlapPlacements.Emplace(HandleShapes[Index], Cell);
+				MirrorStamp(Shape, Cell, 1);
+			}
+		}
+	}
+	Verify(TEXT("after stacking overlapping footprints"));
+
+	// Despawn a fifth of the buildings; removal must not clear cells other footprints still cover.
+	const uint64 RemoveStart = FPlatformTime::Cycles64();
+	for (int32 Index = 0; Index < NumRemoved; ++Index)
+	{
+		Placement->RemoveFootprint(Handles[Index]);
+	}
+	const double RemoveUs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - RemoveStart) * 1000.0 / FMath::Max(NumRemoved, 1);
+	for (int32 Index = 0; Index < NumRemoved; ++Index)
+	{
+		MirrorStamp(Shapes[HandleShapes[Index]], HandleCells[Index], -1);
+	}
+	Verify(TEXT("after removals"));
+
+	for (int32 Index = 0; Index < OverlapHandles.Num(); ++Index)
+	{
+		Placement->RemoveFootprint(OverlapHandles[Index]);
+		MirrorStamp(Shapes[OverlapPlacements[Index].Key], OverlapPlacements[Index].Value, -1);
+	}
+	Verify(TEXT("after removing the overlapping footprints"));
+
+	// The same queries through the physics scene, one blocking box per remaining building.
+	double OverlapNs = 0.0;
+	int32 NumOverlapFree = 0;
+	const int32 NumOverlapQueries = FMath::Min(NumQueries, 100000);
+	if (bCompareOverlap)
+	{
+		const FStrategyPlacementGrid& PlacedGrid = Placement->GetGrid();
+		for (int32 Index = NumRemoved; Index < Handles.Num(); ++Index)
+		{
+			const FStrategyPlacementFootprint& Shape = Shapes[HandleShapes[Index]];
+			AActor* Building = World->SpawnActor<AActor>();
+			UBoxComponent* BuildingBox = NewObject<UBoxComponent>(Building);
+			BuildingBox->SetBoxExtent(FVector(Shape.Width * PlacedGrid.CellSize * 0.5, Shape.Height * PlacedGrid.CellSize * 0.5, 200.0));
+			BuildingBox->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+			Building->SetRootComponent(BuildingBox);
+			BuildingBox->RegisterComponent();
+			BuildingBox->SetWorldLocation(Placement->GetFootprintCenter(HandleCells[Index], Shape) + FVector(0.0, 0.0, 200.0));
+		}
+
+		const uint64 OverlapStart = FPlatformTime::Cycles64();
+		for (int32 Query = 0; Query < NumOverlapQueries; ++Query)
+		{
+			const FStrategyPlacementFootprint& Shape = Shapes[Queries[Query].Key];
+			const FVector Center = Placement->GetFootprintCenter(Queries[Query].Value, Shape) + FVector(0.0, 0.0, 100.0);
+			const FCollisionShape Box = FCollisionShape::MakeBox(FVector(Shape.Width * PlacedGrid.CellSize * 0.5 - 1.0, Shape.Height * PlacedGrid.CellSize * 0.5 - 1.0, 50.0));
+			NumOverlapFree += World->OverlapBlockingTestByChannel(Center, FQuat::Identity, ECC_WorldStatic, Box) ? 0 : 1;
+		}
+		OverlapNs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - OverlapStart) * 1e6 / FMath::Max(NumOverlapQueries, 1);
+	}
+
+	OutCsv = TEXT("Grid,Footprints,CanPlaceNs,AddUs,RemoveUs,OverlapNs,ValidFraction\n");
+	OutCsv += FString::Printf(TEXT("%d,%d,%.2f,%.3f,%.3f,%.2f,%.4f\n"), GridSize, Handles.Num(), QueryNs,
+		FPlatformTime::ToMilliseconds64(AddCycles) * 1000.0 / FMath::Max(Handles.Num(), 1), RemoveUs, OverlapNs, double(NumValid) / FMath::Max(NumQueries, 1));
+	UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] Placement %dx%d, %d footprints | CanPlace %.1f ns (%.1f%% valid) | add %.2f us, remove %.2f us | physics overlap %s"),
+		GridSize, GridSize, Handles.Num(), QueryNs, 100.0 * NumValid / FMath::Max(NumQueries, 1), FPlatformTime::ToMilliseconds64(AddCycles) * 1000.0 / FMath::Max(Handles.Num(), 1),
+		RemoveUs, bCompareOverlap ? *FString::Printf(TEXT("%.1f ns (%.1f%% free)"), OverlapNs, 100.0 * NumOverlapFree / FMath::Max(NumOverlapQueries, 1)) : TEXT("skipped"));
+
+	if (Handles.Num() < NumFootprints)
+	{
+		UE_LOG(LogStrategyCamera, Warning, TEXT("[BENCHMARK] Placement: only %d of %d footprints fit."), Handles.Num(), NumFootprints);
+	}
+
+	DestroyBenchmarkWorld(World, GameInstance);
+	return Result;
+}
+
+int32 UStrategyBenchmarkCommandlet::RunStartupSuite(const FString& Params, FString& OutCsv) const
+{
+	FString GameModeClassPath = TEXT("/Game/BP_StrategyGameMode.BP_StrategyGameMode_C");
+	int32 MaxFrames = 600;
+	float DeltaTime = 1.f / 60.f;
+	FParse::Value(*Params, TEXT("GameMode="), GameModeClassPath);
+	FParse::Value(*Params, TEXT("MaxFrames="), MaxFrames);
+	FParse::Value(*Params, TEXT("DeltaTime="), DeltaTime);
+
+	// Loaded before the clock starts, like a game mode the map refers to. Its controller class comes with it, but not
+	// the controller's soft-referenced assets.
+	UClass* GameModeClass = LoadClass<AGameModeBase>(nullptr, *GameModeClassPath);
+	if (!GameModeClass)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Could not load game mode class '%s'."), *GameModeClassPath);
+		return 1;
+	}
+
+	// Whatever is already in memory at InitGame isn't measured: a hard reference from the game mode or controller
+	// Blueprint loads it with the class, before the clock starts.
+	const AGameModeBase* DefaultGameMode = GameModeClass->GetDefaultObject<AGameModeBase>();
+	const AStrategyPlayerController* DefaultController = DefaultGameMode && DefaultGameMode->PlayerControllerClass ? Cast<AStrategyPlayerController>(DefaultGameMode->PlayerControllerClass->GetDefaultObject()) : nullptr;
+	if (DefaultController)
+	{
+		TArray<FSoftObjectPath> StartupAssets;
+		DefaultController->GetStartupAssets(StartupAssets);
+		int32 NumResident = 0;
+		for (const FSoftObjectPath& Asset : StartupAssets)
+		{
+			if (Asset.ResolveObject())
+			{
+				UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Startup: '%s' is already loaded before InitGame; '%s' or its controller still hard-references it."), *Asset.ToString(), *GameModeClassPath);
+				++NumResident;
+			}
+		}
+		if (NumResident > 0)
+		{
+			return 1;
+		}
+	}
+
+	UGameInstance* GameInstance = nullptr;
+	UWorld* World = CreateBenchmarkWorld(GameInstance, GameModeClass);
+	AStrategyPlayerController* Controller = World ? CreatePlayer(*World, *GameInstance, FString(), false) : nullptr;
+	if (!Controller || !Controller->PossessedCameraPawn)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Could not create the benchmark world, player or camera pawn."));
+		DestroyBenchmarkWorld(World, GameInstance);
+		return 1;
+	}
+
+	UEnhancedInputLocalPlayerSubsystem* Input = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(Controller->GetLocalPlayer());
+	const FStrategyStartupMetrics& Metrics = Controller->GetStartupMetrics();
+	int32 Frame = 0;
+	int32 InputReadyFrame = INDEX_NONE;
+	for (; Frame < MaxFrames && Metrics.FirstInputMs < 0.0; ++Frame)
+	{
+		// Nothing else pumps the loader in a commandlet.
+		ProcessAsyncLoading(true, false, 0.005);
+
+		if (Metrics.IsInputReady())
+		{
+			const UInputAction* MoveAction = Controller->MoveAction.Get();
+			if (!MoveAction || !Input)
+			{
+				UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Startup: the controller of '%s' has no MoveAction to inject."), *GameModeClassPath);
+				break;
+			}
+			InputReadyFrame = InputReadyFrame == INDEX_NONE ? Frame : InputReadyFrame;
+			Input->InjectInputForAction(MoveAction, FInputActionValue(FVector2D(1.0, 0.0)), {}, {});
+		}
+
+		World->Tick(LEVELTICK_All, DeltaTime);
+		++GFrameCounter;
+	}
+
+	const int32 Result = Metrics.FirstInputMs >= 0.0 ? 0 : 1;
+	OutCsv = TEXT("Phase,Ms\n");
+	OutCsv += FString::Printf(TEXT("PawnPossessed,%.3f\nAssetsLoaded,%.3f\nInputReady,%.3f\nViewStreamed,%.3f\nFirstInput,%.3f\n"),
+		Metrics.PawnPossessedMs, Metrics.AssetsLoadedMs, Metrics.InputReadyMs, Metrics.WorldStreamedMs, Metrics.FirstInputMs);
+
+	TArray<FSoftObjectPath> Assets;
+	Controller->GetStartupAssets(Assets);
+	UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] Startup (%d assets) | pawn possessed %.1f ms | assets loaded %.1f ms | input ready %.1f ms (frame %d) | view streamed %.1f ms | first input %.1f ms after map load (%d frames)"),
+		Assets.Num(), Metrics.PawnPossessedMs, Metrics.AssetsLoadedMs, Metrics.InputReadyMs, InputReadyFrame, Metrics.WorldStreamedMs, Metrics.FirstInputMs, Frame);
+	if (Result != 0)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Startup: no input processed within %d frames."), MaxFrames);
+	}
+
+	DestroyBenchmarkWorld(World, GameInstance);
+	return Result;
+}
+
+int32 UStrategyBenchmarkCommandlet::RunFormationSuite(const FString& Params, FString& OutCsv) const
+{
+	using namespace StrategyBenchmark;
+
+	FString UnitCountsParam = TEXT("50,500,5000");
+	int32 NumRuns = 20;
+	int32 LeafSize = 64;
+	int32 OptimalMax = 1000;
+	double MaxRatio = 1.25;
+	const float Spacing = 150.f;
+	FParse::Value(*Params, TEXT("Units="), UnitCountsParam);
+	FParse::Value(*Params, TEXT("Runs="), NumRuns);
+	FParse::Value(*Params, TEXT("LeafSize="), LeafSize);
+	FParse::Value(*Params, TEXT("OptimalMax="), OptimalMax);
+	FParse::Value(*Params, TEXT("MaxRatio="), MaxRatio);
+	NumRuns = FMath::Max(NumRuns, 1);
+
+	TArray<FString> UnitCountStrings;
+	UnitCountsParam.ParseIntoArray(UnitCountStrings, TEXT(","));
+
+	// Paths (unit to slot) that cross another one in the X/Y plane.
+	auto CountCrossings = [](TConstArrayView<FVector> Units, TConstArrayView<FVector> Slots, TConstArrayView<int32> SlotForUnit)
+	{
+		auto Orientation = [](const FVector2D& A, const FVector2D& B, const FVector2D& C) { return FVector2D::CrossProduct(B - A, C - A); };
+		int32 NumCrossings = 0;
+		for (int32 First = 0; First < Units.Num(); ++First)
+		{
+			const FVector2D A(Units[First]);
+			const FVector2D B(Slots[SlotForUnit[First]]);
+			for (int32 Second = First + 1; Second < Units.Num(); ++Second)
+			{
+				const FVector2D C(Units[Second]);
+				const FVector2D D(Slots[SlotForUnit[Second]]);
+				if (Orientation(A, B, C) * Orientation(A, B, D) < 0.0 && Orientation(C, D, A) * Orientation(C, D, B) < 0.0)
+				{
+					++NumCrossings;
+				}
+			}
+		}
+		return NumCrossings;
+	};
+
+	auto IsPermutation = [](TConstArrayView<int32> SlotForUnit)
+	{
+		TBitArray<> Used(false, SlotForUnit.Num());
+		for (const int32 Slot : SlotForUnit)
+		{
+			if (!SlotForUnit.IsValidIndex(Slot) || Used[Slot])
+			{
+				return false;
+			}
+			Used[Slot] = true;
+		}
+		return true;
+	};
+
+	const TCHAR* ShapeNames[] = { TEXT("Line"), TEXT("Box"), TEXT("Wedge") };
+	const EStrategyFormationShape Shapes[] = { EStrategyFormationShape::Line, EStrategyFormationShape::Box, EStrategyFormationShape::Wedge };
+
+	FStrategyFormationSolver Solver;
+	Solver.LeafSize = LeafSize;
+	FRandomStream Random(0xF0A7);
+	TArray<FVector> Units;
+	TArray<FVector> Slots;
+	TArray<int32> Assignment;
+	TArray<int32> Optimal;
+	TArray<int32> Naive;
+
+	int32 Result = 0;
+	OutCsv = TEXT("Units,Shape,Move,ParallelMs,SerialMs,Buckets,OptimalMs,SolverPath,OptimalPath,NaivePath,Ratio,SolverCrossings,NaiveCrossings\n");
+	for (const FString& UnitCountString : UnitCountStrings)
+	{
+		const int32 NumUnits = FCString::Atoi(*UnitCountString);
+		if (NumUnits <= 0)
+		{
+			continue;
+		}
+
+		// About as dense as the formation itself.
+		const double GroupRadius = FMath::Sqrt(double(NumUnits)) * Spacing * 0.7;
+		Naive.Reset(NumUnits);
+		for (int32 Unit = 0; Unit < NumUnits; ++Unit)
+		{
+			Naive.Add(Unit);
+		}
+
+		for (int32 Move = 0; Move < 2; ++Move)
+		{
+			for (int32 ShapeIndex = 0; ShapeIndex < int32(UE_ARRAY_COUNT(Shapes)); ++ShapeIndex)
+			{
+				Units.Reset(NumUnits);
+				for (int32 Unit = 0; Unit < NumUnits; ++Unit)
+				{
+					const double Radius = GroupRadius * FMath::Sqrt(Random.FRand());
+					const double Angle = Random.FRandRange(0.f, 2.f * UE_PI);
+					Units.Add(FVector(Radius * FMath::Cos(Angle), Radius * FMath::Sin(Angle), 0.0));
+				}
+				const double Heading = Random.FRandRange(0.f, 2.f * UE_PI);
+				const double Distance = Move == 0 ? 20000.0 : GroupRadius * 0.3;
+				const FVector Destination(Distance * FMath::Cos(Heading), Distance * FMath::Sin(Heading), 0.0);
+				const float Yaw = Random.FRandRange(-180.f, 180.f);
+				StrategyFormation::MakeSlots(Shapes[ShapeIndex], NumUnits, Destination, Yaw, Spacing, Slots);
+
+				TArray<double> ParallelMs;
+				TArray<double> SerialMs;
+				for (int32 Run = 0; Run < NumRuns; ++Run)
+				{
+					Solver.bParallel = false;
+					Solver.Solve(Units, Slots, Assignment);
+					SerialMs.Add(Solver.GetLastSolveMs());
+					Solver.bParallel = true;
+					Solver.Solve(Units, Slots, Assignment);
+					ParallelMs.Add(Solver.GetLastSolveMs());
+				}
+
+				const double SolverPath = StrategyFormation::GetTotalPathLength(Units, Slots, Assignment);
+				const double NaivePath = StrategyFormation::GetTotalPathLength(Units, Slots, Naive);
+				double OptimalPath = 0.0;
+				double OptimalMs = -1.0;
+				if (NumUnits <= OptimalMax)
+				{
+					const uint64 OptimalStart = FPlatformTime::Cycles64();
+					StrategyFormation::SolveOptimal(Units, Slots, Optimal);
+					OptimalMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - OptimalStart);
+					OptimalPath = StrategyFormation::GetTotalPathLength(Units, Slots, Optimal);
+				}
+				else
+				{
+					// No assignment is shorter than every unit (or every slot) taking its nearest counterpart.
+					double UnitBound = 0.0;
+					for (const FVector& Unit : Units)
+					{
+						double Nearest = DBL_MAX;
+						for (const FVector& Slot : Slots)
+						{
+							Nearest = FMath::Min(Nearest, FVector::DistSquared(Unit, Slot));
+						}
+						UnitBound += FMath::Sqrt(Nearest);
+					}
+					double SlotBound = 0.0;
+					for (const FVector& Slot : Slots)
+					{
+						double Nearest = DBL_MAX;
+						for (const FVector& Unit : Units)
+						{
+							Nearest = FMath::Min(Nearest, FVector::DistSquared(Unit, Slot));
+						}
+						SlotBound += FMath::Sqrt(Nearest);
+					}
+					OptimalPath = FMath::Max(UnitBound, SlotBound);
+				}
+
+				const double Ratio = OptimalPath > 0.0 ? SolverPath / OptimalPath : 1.0;
+				const int32 SolverCrossings = CountCrossings(Units, Slots, Assignment);
+				const int32 NaiveCrossings = CountCrossings(Units, Slots, Naive);
+				const TCHAR* MoveName = Move == 0 ? TEXT("Far") : TEXT("Near");
+
+				OutCsv += FString::Printf(TEXT("%d,%s,%s,%.4f,%.4f,%d,%.3f,%.1f,%.1f,%.1f,%.5f,%d,%d\n"), NumUnits, ShapeNames[ShapeIndex], MoveName,
+					Percentile(ParallelMs, 0.5), Percentile(SerialMs, 0.5), Solver.GetLastNumBuckets(), OptimalMs, SolverPath, OptimalPath, NaivePath, Ratio, SolverCrossings, NaiveCrossings);
+				UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] Formation %5d %-5s %-4s | solve %.3f ms parallel, %.3f ms serial, %d buckets | path %.4fx %s (+%.1f cm/unit), selection order %.4fx | crossings %d vs %d | exact %s"),
+					NumUnits, ShapeNames[ShapeIndex], MoveName, Percentile(ParallelMs, 0.5), Percentile(SerialMs, 0.5), Solver.GetLastNumBuckets(),
+					Ratio, OptimalMs >= 0.0 ? TEXT("of exact") : TEXT("of lower bound"), (SolverPath - OptimalPath) / NumUnits, OptimalPath > 0.0 ? NaivePath / OptimalPath : 1.0,
+					SolverCrossings, NaiveCrossings, OptimalMs >= 0.0 ? *FString::Printf(TEXT("%.1f ms"), OptimalMs) : TEXT("skipped"));
+
+				if (!IsPermutation(Assignment) || (OptimalMs >= 0.0 && !IsPermutation(Optimal)))
+				{
+					UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Formation %d %s %s: an assignment doesn't give every unit its own slot."), NumUnits, ShapeNames[ShapeIndex], MoveName);
+					Result = 1;
+				}
+				if (OptimalMs >= 0.0 && Ratio > MaxRatio)
+				{
+					UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Formation %d %s %s: path length %.4fx the exact assignment's, above %.2fx."), NumUnits, ShapeNames[ShapeIndex], MoveName, Ratio, MaxRatio);
+					Result = 1;
+				}
+			}
+		}
+	}
+
+	return Result;
+}
+
+UWorld* UStrategyBenchmarkCommandlet::CreateBenchmarkWorld(UGameInstance*& OutGameInstance, TSubclassOf<AGameModeBase> GameModeClass) const
+{
+	OutGameInstance = NewObject<UGameInstance>(GEngine);
+	OutGameInstance->AddToRoot();
+	OutGameInstance->InitializeStandalone(TEXT("StrategyBenchmarkWorld"));
+
+	UWorld* World = OutGameInstance->GetWorld();
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	World->GetWorldSettings()->DefaultGameMode = GameModeClass ? GameModeClass.Get() : AStrategyGameMode::StaticClass();
+
+	const FURL URL;
+	World->SetGameMode(URL);
+	World->InitializeActorsForPlay(URL);
+	World->BeginPlay();
+
+	// A large flat ground box, so cursor traces and the zoom anchor have something to hit.
+	AActor* Ground = World->SpawnActor<AActor>();
+	UBoxComponent* GroundBox = NewObject<UBoxComponent>(Ground, TEXT("Ground"));
+	GroundBox->SetBoxExtent(FVector(1.0e6, 1.0e6, 10.0));
+	GroundBox->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	Ground->SetRootComponent(GroundBox);
+	GroundBox->RegisterComponent();
+	GroundBox->SetWorldLocation(FVector(0.0, 0.0, -10.0));
+
+	return World;
+}
+
+AStrategyPlayerController* UStrategyBenchmarkCommandlet::CreatePlayer(UWorld& World, UGameInstance& GameInstance, const FString& Params, bool bFinishStartup) const
+{
+	// Optionally benchmark the configured Blueprint controller (curve, tuning) instead of the native defaults.
+	FString ControllerClassPath;
+	if (FParse::Value(*Params, TEXT("ControllerClass="), ControllerClassPath))
+	{
+		if (UClass* ControllerClass = LoadClass<AStrategyPlayerController>(nullptr, *ControllerClassPath))
+		{
+			World.GetAuthGameMode()->PlayerControllerClass = ControllerClass;
+		}
+		else
+		{
+			UE_LOG(LogStrategyCamera, Warning, TEXT("[BENCHMARK] Could not load controller class '%s', using the native one."), *ControllerClassPath);
+		}
+	}
+
+	FString Error;
+	ULocalPlayer* LocalPlayer = GameInstance.CreateLocalPlayer(0, Error, true);
+	AStrategyPlayerController* Controller = LocalPlayer ? Cast<AStrategyPlayerController>(LocalPlayer->PlayerController) : nullptr;
+	if (!Controller)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[BENCHMARK] Failed to create a local player: %s"), *Error);
+		return nullptr;
+	}
+
+	// AStrategyGameMode has spawned and possessed one at the player start, or the origin without one.
+	if (!Controller->PossessedCameraPawn)
+	{
+		AStrategyCameraPawn* Pawn = World.SpawnActor<AStrategyCameraPawn>(FVector::ZeroVector, FRotator::ZeroRotator);
+		Controller->Possess(Pawn);
+	}
+
+	if (bFinishStartup && !Controller->GetStartupMetrics().IsInputReady())
+	{
+		if (Controller->StartupAssets.IsValid())
+		{
+			Controller->StartupAssets->WaitUntilComplete();
+		}
+		Controller->UpdateStartup();
+	}
+	return Controller;
+}
+
+uint64 UStrategyBenchmarkCommandlet::RunCameraScenario(const FString& Name, UWorld& World, AStrategyPlayerController& Controller, int32 NumFrames, float DeltaTime, const FInputStep& InputStep, FString& InOutCsv, const FInputStep& FrameCheck) const
+{
+	using namespace StrategyBenchmark;
+
+	UStrategyCursorQueryComponent* CursorQuery = Controller.GetCursorQuery();
+	FCountingMalloc& CountingMalloc = GetCountingMalloc();
+
+	TArray<FFrameSample> Samples;
+	Samples.Reserve(NumFrames);
+
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		const uint64 TracesBefore = CursorQuery->GetNumTracesIssued();
+		const uint64 QueriesBefore = CursorQuery->GetNumQueriesServed();
+		const uint64 CameraTicksBefore = Controller.GetNumCameraUpdateTicks();
+		const uint64 PawnMovesBefore = Controller.GetNumPawnMoves();
+
+		const uint64 AllocationsBefore = CountingMalloc.GetNumAllocations();
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		InputStep(Controller, Frame);
+		World.Tick(LEVELTICK_All, DeltaTime);
+
+		const uint64 EndCycles = FPlatformTime::Cycles64();
+		const uint64 AllocationsAfter = CountingMalloc.GetNumAllocations();
+		++GFrameCounter;
+
+		if (FrameCheck)
+		{
+			FrameCheck(Controller, Frame);
+		}
+
+		FFrameSample& Sample = Samples.AddDefaulted_GetRef();
+		Sample.GameThreadMs = FPlatformTime::ToMilliseconds64(EndCycles - StartCycles);
+		Sample.Allocations = AllocationsAfter - AllocationsBefore;
+		Sample.TracesIssued = CursorQuery->GetNumTracesIssued() - TracesBefore;
+		Sample.CursorQueries = CursorQuery->GetNumQueriesServed() - QueriesBefore;
+		Sample.CameraTicks = Controller.GetNumCameraUpdateTicks() - CameraTicksBefore;
+		Sample.PawnMoves = Controller.GetNumPawnMoves() - PawnMovesBefore;
+		Sample.ArmLength = Controller.PossessedCameraPawn ? Controller.PossessedCameraPawn->GetCameraBoom()->TargetArmLength : 0.f;
+
+		InOutCsv += FString::Printf(TEXT("%s,%d,%.4f,%llu,%llu,%llu,%llu,%llu,%.2f\n"), *Name, Frame, Sample.GameThreadMs, Sample.Allocations,
+			Sample.TracesIssued, Sample.CursorQueries, Sample.CameraTicks, Sample.PawnMoves, Sample.ArmLength);
+	}
+
+	TArray<double> FrameTimes;
+	uint64 TotalAllocations = 0;
+	uint64 TotalTraces = 0;
+	uint64 TotalQueries = 0;
+	uint64 MaxPawnMoves = 0;
+	for (const FFrameSample& Sample : Samples)
+	{
+		MaxPawnMoves = FMath::Max(MaxPawnMoves, Sample.PawnMoves);
+		FrameTimes.Add(Sample.GameThreadMs);
+		TotalAllocations += Sample.Allocations;
+		TotalTraces += Sample.TracesIssued;
+		TotalQueries += Sample.CursorQueries;
+	}
+
+	UE_LOG(LogStrategyCamera, Display, TEXT("[BENCHMARK] %-11s frames %d | game thread p50 %.3f ms, p95 %.3f ms, max %.3f ms | allocs/frame %.1f | traces %llu, cursor queries %llu | pawn moves/frame max %llu"),
+		*Name, NumFrames, Percentile(FrameTimes, 0.5), Percentile(FrameTimes, 0.95), Percentile(FrameTimes, 1.0),
+		NumFrames > 0 ? double(TotalAllocations) / NumFrames : 0.0, TotalTraces, TotalQueries, MaxPawnMoves);
+	return MaxPawnMoves;
+}
+
+void UStrategyBenchmarkCommandlet::DestroyBenchmarkWorld(UWorld* World, UGameInstance* GameInstance) const
+{
+	if (GameInstance)
+	{
+		GameInstance->Shutdown();
+		GameInstance->RemoveFromRoot();
+	}
+
+	if (World)
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+}
@@ -0,0 +1,56 @@
+// StrategyBuildingFootprintComponent.cpp
+#include "StrategyBuildingFootprintComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "MyProject2.h"
+#include "StrategyFlowFieldSubsystem.h"
+
+UStrategyBuildingFootprintComponent::UStrategyBuildingFootprintComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UStrategyBuildingFootprintComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	AActor* Owner = GetOwner();
+	UStrategyPlacementSubsystem* Placement = GetWorld()->GetSubsystem<UStrategyPlacementSubsystem>();
+	if (!Placement)
+	{
+		UE_LOG(LogStrategyUnits, Warning, TEXT("[FOOTPRINT] %s has no placement grid; it will not block building."), *GetNameSafe(Owner));
+		return;
+	}
+
+	const FStrategyPlacementFootprint Footprint = FStrategyPlacementFootprint::MakeRectangle(FootprintSize.X, FootprintSize.Y).Rotated(GetQuarterTurns(Owner->GetActorRotation().Yaw));
+	const FIntPoint MinCell = Placement->GetFootprintMinCell(Owner->GetActorLocation(), Footprint);
+	PlacementHandle = Placement->AddFootprint(Footprint, MinCell);
+
+	if (UStrategyFlowFieldSubsystem* FlowFields = GetWorld()->GetSubsystem<UStrategyFlowFieldSubsystem>())
+	{
+		const FStrategyPlacementGrid& Grid = Placement->GetGrid();
+		const FVector2D Min = Grid.Origin + FVector2D(MinCell) * Grid.CellSize;
+		FlowFieldBlocker = FBox2D(Min, Min + FVector2D(Footprint.Width, Footprint.Height) * Grid.CellSize);
+		FlowFields->AddBlocker(FlowFieldBlocker);
+	}
+}
+
+void UStrategyBuildingFootprintComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UStrategyPlacementSubsystem* Placement = GetWorld()->GetSubsystem<UStrategyPlacementSubsystem>())
+	{
+		Placement->RemoveFootprint(PlacementHandle);
+	}
+	PlacementHandle = FStrategyPlacementHandle();
+
+	if (FlowFieldBlocker.bIsValid)
+	{
+		if (UStrategyFlowFieldSubsystem* FlowFields = GetWorld()->GetSubsystem<UStrategyFlowFieldSubsystem>())
+		{
+			FlowFields->RemoveBlocker(FlowFieldBlocker);
+		}
+		FlowFieldBlocker = FBox2D(ForceInit);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
@@ -0,0 +1,18 @@
+// StrategyCameraDebug.cpp
+#include "StrategyCameraDebug.h"
+#include "HAL/IConsoleManager.h"
+
+#if STRATEGY_CAMERA_DEBUG
+
+int32 StrategyCameraDebug::GLevel = StrategyCameraDebug::Off;
+
+static FAutoConsoleVariableRef CVarStrategyCameraDebug(
+	TEXT("Strategy.Camera.Debug"),
+	StrategyCameraDebug::GLevel,
+	TEXT("Camera/controller diagnostics.\n")
+	TEXT(" 0: off (default)\n")
+	TEXT(" 1: log input events and camera state\n")
+	TEXT(" 2: log and draw debug shapes"),
+	ECVF_Cheat);
+
+#endif
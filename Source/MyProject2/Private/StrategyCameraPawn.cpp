@@ -3,12 +3,27 @@
 #include "GameFramework/SpringArmComponent.h"
 #include "Camera/CameraComponent.h"
 #include "GameFramework/FloatingPawnMovement.h"
+#include "WorldPartition/WorldPartitionSubsystem.h"
+#include "WorldPartition/WorldPartitionRuntimeCell.h"
+#include "TimerManager.h"
+#include "MyProject2.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Streaming Requested Ahead"), STAT_StrategyStreamingRequestedAhead, STATGROUP_StrategyCamera);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Streaming Loaded Late"), STAT_StrategyStreamingLoadedLate, STATGROUP_StrategyCamera);
+
+namespace
+{
+	const FName ViewStreamingSourceName(TEXT("StrategyCameraView"));
+	const FName PredictedStreamingSourceName(TEXT("StrategyCameraPredicted"));
+	const FName PrefetchStreamingSourceName(TEXT("StrategyCameraPrefetch"));
+}
 
 AStrategyCameraPawn::AStrategyCameraPawn()
 {
-	PrimaryActorTick.bCanEverTick = true; // The controller will tick, not the pawn.
+	PrimaryActorTick.bCanEverTick = false; // The controller will tick, not the pawn.
 
-	bUseControllerRotationYaw = true;
+	// The controller's camera springs drive the yaw (and the location) through the movement component.
+	bUseControllerRotationYaw = false;
 	
 	// Create a root component that we can attach things to.
 	PawnRootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("PawnRoot"));
@@ -19,6 +34,8 @@ AStrategyCameraPawn::AStrategyCameraPawn()
 	MovementComponent->MaxSpeed = 3000.f; // You can adjust this default speed
 	MovementComponent->Acceleration = 1500.f;
 	MovementComponent->Deceleration = 3000.f;
+	// Never ticks: the controller moves the pawn once per frame with the smoothed camera state.
+	MovementComponent->PrimaryComponentTick.bStartWithTickEnabled = false;
 	// --- THIS LINE IS REMOVED ---
 	// MovementComponent->bPositionCorrected = true; // This is a protected member
 
@@ -26,8 +43,8 @@ AStrategyCameraPawn::AStrategyCameraPawn()
 	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
 	CameraBoom->SetupAttachment(GetRootComponent());
 	CameraBoom->TargetArmLength = 1500.0f;
-	CameraBoom->bEnableCameraLag = true;
-	CameraBoom->CameraLagSpeed = 5.0f;
+	// No boom lag: smoothing is done by the controller at a fixed rate, lag on top would make it frame-rate dependent again.
+	CameraBoom->bEnableCameraLag = false;
 	CameraBoom->bUsePawnControlRotation = false; // We control rotation via Controller + Boom Pitch
 	CameraBoom->bInheritPitch = false;
 	CameraBoom->bInheritYaw = true;
@@ -41,15 +58,181 @@ AStrategyCameraPawn::AStrategyCameraPawn()
 	ViewCamera->bUsePawnControlRotation = false;
 }
 
-void AStrategyCameraPawn::Tick(float DeltaSeconds)
+UPawnMovementComponent* AStrategyCameraPawn::GetMovementComponent() const
+{
+	return MovementComponent;
+}
+
+void AStrategyCameraPawn::BeginPlay()
 {
-	Super::Tick(DeltaSeconds);
+	Super::BeginPlay();
 
-	if (GFrameCounter % 120 == 0)
+	if (UWorldPartitionSubsystem* WorldPartitionSubsystem = GetWorld()->GetSubsystem<UWorldPartitionSubsystem>())
+	{
+		WorldPartitionSubsystem->RegisterStreamingSourceProvider(this);
+
+		if (StreamingMetricsInterval > 0.f)
+		{
+			GetWorldTimerManager().SetTimer(StreamingMetricsTimerHandle, this, &AStrategyCameraPawn::SampleStreamingMetrics, StreamingMetricsInterval, true);
+		}
+	}
+}
+
+void AStrategyCameraPawn::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorldPartitionSubsystem* WorldPartitionSubsystem = GetWorld()->GetSubsystem<UWorldPartitionSubsystem>())
+	{
+		WorldPartitionSubsystem->UnregisterStreamingSourceProvider(this);
+	}
+	GetWorldTimerManager().ClearTimer(StreamingMetricsTimerHandle);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AStrategyCameraPawn::SetStreamingTarget(float TargetArmLength, float TargetBoomPitch)
+{
+	StreamingTargetArmLength = TargetArmLength;
+	StreamingTargetBoomPitch = TargetBoomPitch;
+	bHasStreamingTarget = true;
+}
+
+bool AStrategyCameraPawn::GetStreamingSources(TArray<FWorldPartitionStreamingSource>& OutStreamingSources) const
+{
+	const FVector PawnLocation = GetActorLocation();
+	const float ArmLength = CameraBoom->TargetArmLength;
+	const float BoomPitch = CameraBoom->GetRelativeRotation().Pitch;
+
+	// What is in view right now.
+	OutStreamingSources.Add(MakeStreamingSource(ViewStreamingSourceName, ComputeGroundFootprint(PawnLocation, ArmLength, BoomPitch), EStreamingSourcePriority::High));
+
+	// Where the view is heading: extrapolated pan velocity and the pending zoom target.
+	const FVector PredictedLocation = PawnLocation + MovementComponent->Velocity * StreamingLookAheadTime;
+	const float PredictedArmLength = bHasStreamingTarget ? StreamingTargetArmLength : ArmLength;
+	const float PredictedBoomPitch = bHasStreamingTarget ? StreamingTargetBoomPitch : BoomPitch;
+	OutStreamingSources.Add(MakeStreamingSource(PredictedStreamingSourceName, ComputeGroundFootprint(PredictedLocation, PredictedArmLength, PredictedBoomPitch), EStreamingSourcePriority::Normal));
+
+	// Where the camera is about to jump; as urgent as the current view, since it will be the view shortly.
+	if (bHasStreamingPrefetch)
+	{
+		OutStreamingSources.Add(MakeStreamingSource(PrefetchStreamingSourceName, StreamingPrefetchFootprint, EStreamingSourcePriority::High));
+	}
+
+	return true;
+}
+
+void AStrategyCameraPawn::SetStreamingPrefetch(const FVector& PawnLocation, float ArmLength, float BoomPitch, float Yaw)
+{
+	StreamingPrefetchFootprint = ComputeGroundFootprint(PawnLocation, ArmLength, BoomPitch, Yaw);
+	bHasStreamingPrefetch = true;
+}
+
+bool AStrategyCameraPawn::IsPrefetchStreamed() const
+{
+	return !bHasStreamingPrefetch || IsSourceStreamed(MakeStreamingSource(PrefetchStreamingSourceName, StreamingPrefetchFootprint, EStreamingSourcePriority::High));
+}
+
+bool AStrategyCameraPawn::IsViewStreamed() const
+{
+	const FStrategyGroundFootprint Footprint = ComputeGroundFootprint(GetActorLocation(), CameraBoom->TargetArmLength, CameraBoom->GetRelativeRotation().Pitch);
+	return IsSourceStreamed(MakeStreamingSource(ViewStreamingSourceName, Footprint, EStreamingSourcePriority::High));
+}
+
+bool AStrategyCameraPawn::IsSourceStreamed(const FWorldPartitionStreamingSource& StreamingSource) const
+{
+	UWorldPartitionSubsystem* WorldPartitionSubsystem = GetWorld()->GetSubsystem<UWorldPartitionSubsystem>();
+	if (!WorldPartitionSubsystem)
+	{
+		return true;
+	}
+
+	FWorldPartitionStreamingQuerySource QuerySource(StreamingSource.Location);
+	QuerySource.Radius = StreamingSource.Shapes[0].Radius;
+	QuerySource.bUseGridLoadingRange = false;
+	return WorldPartitionSubsystem->IsStreamingCompleted(EWorldPartitionRuntimeCellState::Activated, { QuerySource }, false);
+}
+
+FWorldPartitionStreamingSource AStrategyCameraPawn::MakeStreamingSource(FName Name, const FStrategyGroundFootprint& Footprint, EStreamingSourcePriority Priority) const
+{
+	FWorldPartitionStreamingSource StreamingSource;
+	StreamingSource.Name = Name;
+	StreamingSource.Location = Footprint.Center;
+	StreamingSource.Rotation = GetActorRotation();
+	StreamingSource.TargetState = EStreamingSourceTargetState::Activated;
+	StreamingSource.Priority = Priority;
+
+	// Loading radius follows what the camera can actually see instead of the grid's fixed loading range.
+	FStreamingSourceShape& Shape = StreamingSource.Shapes.AddDefaulted_GetRef();
+	Shape.bUseGridLoadingRange = false;
+	Shape.Radius = float(Footprint.Radius * StreamingRadiusScale);
+	return StreamingSource;
+}
+
+FStrategyGroundFootprint AStrategyCameraPawn::ComputeGroundFootprint(const FVector& PawnLocation, float ArmLength, float BoomPitch) const
+{
+	return ComputeGroundFootprint(PawnLocation, ArmLength, BoomPitch, GetActorRotation().Yaw);
+}
+
+FStrategyGroundFootprint AStrategyCameraPawn::ComputeGroundFootprint(const FVector& PawnLocation, float ArmLength, float BoomPitch, float Yaw) const
+{
+	FStrategyGroundFootprint Footprint;
+
+	const FRotator ViewRotation(BoomPitch, Yaw, 0.f);
+	const FVector CameraLocation = PawnLocation - ViewRotation.Vector() * ArmLength;
+	const FRotationMatrix ViewAxes(ViewRotation);
+	const FVector Forward = ViewAxes.GetUnitAxis(EAxis::X);
+	const FVector Right = ViewAxes.GetUnitAxis(EAxis::Y);
+	const FVector Up = ViewAxes.GetUnitAxis(EAxis::Z);
+
+	// FieldOfView is horizontal.
+	const double TanHalfHorizontal = FMath::Tan(FMath::DegreesToRadians(ViewCamera->FieldOfView * 0.5));
+	const double TanHalfVertical = TanHalfHorizontal / FMath::Max(ViewCamera->AspectRatio, UE_KINDA_SMALL_NUMBER);
+
+	static const FVector2D ScreenCorners[4] = { FVector2D(-1.0, -1.0), FVector2D(1.0, -1.0), FVector2D(1.0, 1.0), FVector2D(-1.0, 1.0) };
+	for (int32 Index = 0; Index < 4; ++Index)
+	{
+		const FVector RayDirection = (Forward + Right * (ScreenCorners[Index].X * TanHalfHorizontal) + Up * (ScreenCorners[Index].Y * TanHalfVertical)).GetSafeNormal();
+
+		// Rays at or above the horizon never hit the ground; clamp them to the max distance.
+		double Distance = MaxStreamingDistance;
+		if (RayDirection.Z < -UE_KINDA_SMALL_NUMBER)
+		{
+			Distance = FMath::Min((PawnLocation.Z - CameraLocation.Z) / RayDirection.Z, double(MaxStreamingDistance));
+		}
+
+		FVector Corner = CameraLocation + RayDirection * Distance;
+		Corner.Z = PawnLocation.Z;
+		Footprint.Corners[Index] = Corner;
+		Footprint.Center += Corner * 0.25;
+	}
+
+	for (const FVector& Corner : Footprint.Corners)
+	{
+		Footprint.Radius = FMath::Max(Footprint.Radius, FVector::Dist2D(Footprint.Center, Corner));
+	}
+
+	return Footprint;
+}
+
+void AStrategyCameraPawn::SampleStreamingMetrics()
+{
+	UWorldPartitionSubsystem* WorldPartitionSubsystem = GetWorld()->GetSubsystem<UWorldPartitionSubsystem>();
+	if (!WorldPartitionSubsystem)
+	{
+		return;
+	}
+
+	TArray<FWorldPartitionStreamingSource> StreamingSources;
+	GetStreamingSources(StreamingSources);
+
+	++StreamingMetrics.NumSamples;
+	if (!IsSourceStreamed(StreamingSources[0]))
+	{
+		++StreamingMetrics.NumLoadedLate;
+		INC_DWORD_STAT(STAT_StrategyStreamingLoadedLate);
+	}
+	else if (!IsSourceStreamed(StreamingSources[1]))
 	{
-		UE_LOG(LogTemp, Verbose, TEXT("[PAWN] '%s' Tick: World Location: %s | World Rotation: %s"),
-			*GetNameSafe(this),
-			*GetActorLocation().ToString(),
-			*GetActorRotation().ToString());
+		++StreamingMetrics.NumRequestedAhead;
+		INC_DWORD_STAT(STAT_StrategyStreamingRequestedAhead);
 	}
 }
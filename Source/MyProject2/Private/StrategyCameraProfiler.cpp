@@ -0,0 +1,222 @@
+// StrategyCameraProfiler.cpp
+#include "StrategyCameraProfiler.h"
+#include "HAL/IConsoleManager.h"
+
+namespace StrategyCameraProfiler
+{
+#if STRATEGY_CAMERA_PROFILE
+	static int32 GEnabled = 1;
+
+	static FAutoConsoleVariableRef CVarStrategyCameraProfile(
+		TEXT("Strategy.Camera.Profile"),
+		GEnabled,
+		TEXT("Records per-frame camera/controller timings for Strategy.Camera.ProfileDump.\n")
+		TEXT(" 0: off\n")
+		TEXT(" 1: on (default)"));
+
+	static FAutoConsoleCommandWithArgsAndOutputDevice CmdStrategyCameraProfileDump(
+		TEXT("Strategy.Camera.ProfileDump"),
+		TEXT("Logs p50/p95/p99/max of the camera/controller timings (ms) and counters (per frame) over the rolling window.\n")
+		TEXT("Strategy.Camera.ProfileDump [Frames] [reset]: Frames limits the window to the most recent frames; reset clears it afterwards."),
+		FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+		{
+			int32 NumFrames = 0;
+			bool bReset = false;
+			for (const FString& Arg : Args)
+			{
+				if (Arg.Equals(TEXT("reset"), ESearchCase::IgnoreCase))
+				{
+					bReset = true;
+				}
+				else if (Arg.IsNumeric())
+				{
+					NumFrames = FCString::Atoi(*Arg);
+				}
+			}
+
+			FStrategyCameraProfiler::Get().Summarize(NumFrames).Log(Ar);
+			if (bReset)
+			{
+				FStrategyCameraProfiler::Get().Reset();
+			}
+		}));
+#endif
+
+	// Values must be sorted.
+	double SortedPercentile(const TArray<double>& Values, double Fraction)
+	{
+		if (Values.IsEmpty())
+		{
+			return 0.0;
+		}
+		const int32 Index = FMath::Clamp(FMath::CeilToInt32(Fraction * Values.Num()) - 1, 0, Values.Num() - 1);
+		return Values[Index];
+	}
+
+	FStrategyCameraProfileStat MakeStat(const TCHAR* Name, TArray<double>& Values)
+	{
+		Values.Sort();
+
+		FStrategyCameraProfileStat Stat;
+		Stat.Name = Name;
+		Stat.NumFrames = Values.Num();
+		Stat.P50 = SortedPercentile(Values, 0.50);
+		Stat.P95 = SortedPercentile(Values, 0.95);
+		Stat.P99 = SortedPercentile(Values, 0.99);
+		Stat.Max = Values.IsEmpty() ? 0.0 : Values.Last();
+		for (double Value : Values)
+		{
+			Stat.Total += Value;
+		}
+		return Stat;
+	}
+}
+
+FStrategyCameraProfiler& FStrategyCameraProfiler::Get()
+{
+	static FStrategyCameraProfiler Profiler;
+	return Profiler;
+}
+
+bool FStrategyCameraProfiler::IsEnabled()
+{
+#if STRATEGY_CAMERA_PROFILE
+	return StrategyCameraProfiler::GEnabled != 0;
+#else
+	return false;
+#endif
+}
+
+FStrategyCameraProfiler::FFrame& FStrategyCameraProfiler::GetCurrentFrame()
+{
+	check(IsInGameThread());
+
+	if (CurrentFrameNumber != GFrameCounter)
+	{
+		if (Frames.IsEmpty())
+		{
+			Frames.SetNum(WindowSize);
+		}
+
+		// The first record ever has nothing to commit.
+		if (CurrentFrameNumber != 0)
+		{
+			Frames[NextFrame] = Current;
+			NextFrame = (NextFrame + 1) % WindowSize;
+			NumCommittedFrames = FMath::Min(NumCommittedFrames + 1, WindowSize);
+		}
+		Current = FFrame();
+		CurrentFrameNumber = GFrameCounter;
+	}
+
+	return Current;
+}
+
+void FStrategyCameraProfiler::AddTime(EStrategyCameraMetric Metric, uint64 Cycles)
+{
+	// Never 0 once recorded, so a metric that ran counts as active for the frame.
+	GetCurrentFrame().Cycles[int32(Metric)] += FMath::Max<uint64>(Cycles, 1);
+}
+
+void FStrategyCameraProfiler::AddCount(EStrategyCameraCounter Counter, uint32 Count)
+{
+	GetCurrentFrame().Counts[int32(Counter)] += Count;
+}
+
+void FStrategyCameraProfiler::Reset()
+{
+	Current = FFrame();
+	CurrentFrameNumber = 0;
+	NextFrame = 0;
+	NumCommittedFrames = 0;
+}
+
+FStrategyCameraProfileSummary FStrategyCameraProfiler::Summarize(int32 NumFrames) const
+{
+	FStrategyCameraProfileSummary Summary;
+	Summary.NumFrames = NumFrames > 0 ? FMath::Min(NumFrames, NumCommittedFrames) : NumCommittedFrames;
+
+	// Most recent frames first, walking back from the write position.
+	auto ForEachFrame = [this, &Summary](TFunctionRef<void(const FFrame&)> Visit)
+	{
+		for (int32 Index = 1; Index <= Summary.NumFrames; ++Index)
+		{
+			Visit(Frames[(NextFrame - Index + WindowSize) % WindowSize]);
+		}
+	};
+
+	TArray<double> Values;
+	Values.Reserve(Summary.NumFrames);
+
+	// Timings over the frames where the metric ran, so rare input handlers are not drowned in zeros.
+	for (int32 Metric = 0; Metric < NumMetrics; ++Metric)
+	{
+		Values.Reset();
+		ForEachFrame([&Values, Metric](const FFrame& Frame)
+		{
+			if (Frame.Cycles[Metric] != 0)
+			{
+				Values.Add(FPlatformTime::ToMilliseconds64(Frame.Cycles[Metric]));
+			}
+		});
+		Summary.Metrics.Add(StrategyCameraProfiler::MakeStat(GetMetricName(EStrategyCameraMetric(Metric)), Values));
+	}
+
+	// Counters over every frame of the window.
+	for (int32 Counter = 0; Counter < NumCounters; ++Counter)
+	{
+		Values.Reset();
+		ForEachFrame([&Values, Counter](const FFrame& Frame)
+		{
+			Values.Add(double(Frame.Counts[Counter]));
+		});
+		Summary.Counters.Add(StrategyCameraProfiler::MakeStat(GetCounterName(EStrategyCameraCounter(Counter)), Values));
+	}
+
+	return Summary;
+}
+
+void FStrategyCameraProfileSummary::Log(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("[PROFILE] Camera/controller over the last %d frames"), NumFrames);
+	Ar.Logf(TEXT("[PROFILE] %-16s %7s %9s %9s %9s %9s"), TEXT("Scope (ms)"), TEXT("Frames"), TEXT("p50"), TEXT("p95"), TEXT("p99"), TEXT("max"));
+	for (const FStrategyCameraProfileStat& Stat : Metrics)
+	{
+		Ar.Logf(TEXT("[PROFILE] %-16s %7d %9.4f %9.4f %9.4f %9.4f"), Stat.Name, Stat.NumFrames, Stat.P50, Stat.P95, Stat.P99, Stat.Max);
+	}
+	Ar.Logf(TEXT("[PROFILE] %-16s %7s %9s %9s %9s %9s"), TEXT("Per frame"), TEXT("Total"), TEXT("p50"), TEXT("p95"), TEXT("p99"), TEXT("max"));
+	for (const FStrategyCameraProfileStat& Stat : Counters)
+	{
+		Ar.Logf(TEXT("[PROFILE] %-16s %7.0f %9.0f %9.0f %9.0f %9.0f"), Stat.Name, Stat.Total, Stat.P50, Stat.P95, Stat.P99, Stat.Max);
+	}
+}
+
+const TCHAR* FStrategyCameraProfiler::GetMetricName(EStrategyCameraMetric Metric)
+{
+	switch (Metric)
+	{
+	case EStrategyCameraMetric::ControllerTick:	return TEXT("ControllerTick");
+	case EStrategyCameraMetric::CameraTick:		return TEXT("CameraTick");
+	case EStrategyCameraMetric::CameraMovement:	return TEXT("CameraMovement");
+	case EStrategyCameraMetric::CameraSprings:	return TEXT("CameraSprings");
+	case EStrategyCameraMetric::MoveInput:		return TEXT("MoveInput");
+	case EStrategyCameraMetric::PanDragInput:	return TEXT("PanDragInput");
+	case EStrategyCameraMetric::ZoomInput:		return TEXT("ZoomInput");
+	case EStrategyCameraMetric::RotateInput:	return TEXT("RotateInput");
+	case EStrategyCameraMetric::SelectInput:	return TEXT("SelectInput");
+	case EStrategyCameraMetric::MoveOrderInput:	return TEXT("MoveOrderInput");
+	case EStrategyCameraMetric::CursorQuery:	return TEXT("CursorQuery");
+	default:									return TEXT("Unknown");
+	}
+}
+
+const TCHAR* FStrategyCameraProfiler::GetCounterName(EStrategyCameraCounter Counter)
+{
+	switch (Counter)
+	{
+	case EStrategyCameraCounter::CursorTraces:			return TEXT("CursorTraces");
+	case EStrategyCameraCounter::CameraSubsteps:		return TEXT("CameraSubsteps");
+	case EStrategyCameraCounter::InterpolatingFrames:	return TEXT("Interpolating");
+	default:											return TEXT("Unknown");
+	}
+}
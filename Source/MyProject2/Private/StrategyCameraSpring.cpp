@@ -0,0 +1,92 @@
+// StrategyCameraSpring.cpp
+#include "StrategyCameraSpring.h"
+#include "StrategyCurveTable.h"
+
+void FStrategyCameraIntegrator::Reset(const FStrategyCameraSpringState& State)
+{
+	Previous = State;
+	Current = State;
+	Velocity = FStrategyCameraSpringState();
+	Accumulator = 0.0;
+}
+
+void FStrategyCameraIntegrator::StepSpring(double& Value, double& ValueVelocity, double Target, double AngularFrequency, double DeltaTime)
+{
+	// x(t) = Target + (x0 + (v0 + w * x0) * t) * e^(-w t), with x0 measured from Target.
+	const double Offset = Value - Target;
+	const double Decay = FMath::Exp(-AngularFrequency * DeltaTime);
+	const double Impulse = (ValueVelocity + AngularFrequency * Offset) * DeltaTime;
+	Value = Target + (Offset + Impulse) * Decay;
+	ValueVelocity = (ValueVelocity - AngularFrequency * Impulse) * Decay;
+}
+
+double FStrategyCameraIntegrator::GetPitchTarget(const FStrategyCameraSpringTargets& Targets, double ArmLength) const
+{
+	return Targets.PitchByArmLength && Targets.PitchByArmLength->IsBaked() ? -double(Targets.PitchByArmLength->Evaluate(float(ArmLength))) : Targets.Pitch;
+}
+
+int32 FStrategyCameraIntegrator::Advance(float DeltaTime, const FStrategyCameraSpringTargets& Targets, const FStrategyCameraSpringSettings& Settings)
+{
+	SubstepTime = 1.0 / FMath::Max(double(Settings.SubstepRate), 1.0);
+	Accumulator += FMath::Max(double(DeltaTime), 0.0);
+
+	// Shortest way round to the target yaw, expressed next to the continuous current yaw.
+	const double YawTarget = Current.Yaw + FMath::FindDeltaAngleDegrees(Current.Yaw, Targets.Yaw);
+
+	// Frame times that add up to a whole number of substeps must not leave one behind to float rounding.
+	constexpr double TimeEpsilon = 1e-6;
+
+	int32 NumSubsteps = 0;
+	while (Accumulator >= SubstepTime - TimeEpsilon)
+	{
+		if (NumSubsteps == Settings.MaxSubstepsPerFrame)
+		{
+			// Hitch: drop the backlog but keep the sub-step phase, so rendering stays continuous.
+			Accumulator = FMath::Fmod(Accumulator, SubstepTime);
+			break;
+		}
+
+		Previous = Current;
+		StepSpring(Current.ArmLength, Velocity.ArmLength, Targets.ArmLength, Settings.ArmLengthFrequency, SubstepTime);
+		StepSpring(Current.Pitch, Velocity.Pitch, GetPitchTarget(Targets, Current.ArmLength), Settings.PitchFrequency, SubstepTime);
+		StepSpring(Current.Yaw, Velocity.Yaw, YawTarget, Settings.YawFrequency, SubstepTime);
+		StepSpring(Current.Pan.X, Velocity.Pan.X, Targets.Pan.X, Settings.PanFrequency, SubstepTime);
+		StepSpring(Current.Pan.Y, Velocity.Pan.Y, Targets.Pan.Y, Settings.PanFrequency, SubstepTime);
+		StepSpring(Current.Pan.Z, Velocity.Pan.Z, Targets.Pan.Z, Settings.PanFrequency, SubstepTime);
+
+		Accumulator = FMath::Max(Accumulator - SubstepTime, 0.0);
+		++NumSubsteps;
+	}
+
+	return NumSubsteps;
+}
+
+FStrategyCameraSpringState FStrategyCameraIntegrator::GetRenderState() const
+{
+	const double Alpha = FMath::Clamp(Accumulator / SubstepTime, 0.0, 1.0);
+
+	FStrategyCameraSpringState State;
+	State.ArmLength = FMath::Lerp(Previous.ArmLength, Current.ArmLength, Alpha);
+	State.Pitch = FMath::Lerp(Previous.Pitch, Current.Pitch, Alpha);
+	State.Yaw = FMath::Lerp(Previous.Yaw, Current.Yaw, Alpha);
+	State.Pan = FMath::Lerp(Previous.Pan, Current.Pan, Alpha);
+	return State;
+}
+
+void FStrategyCameraIntegrator::OffsetPan(const FVector& Offset)
+{
+	Previous.Pan += Offset;
+	Current.Pan += Offset;
+}
+
+bool FStrategyCameraIntegrator::IsSettled(const FStrategyCameraSpringTargets& Targets, double ArmLengthTolerance, double AngleTolerance, double PanTolerance) const
+{
+	return FMath::IsNearlyEqual(Current.ArmLength, Targets.ArmLength, ArmLengthTolerance)
+		&& FMath::IsNearlyEqual(Current.Pitch, GetPitchTarget(Targets, Targets.ArmLength), AngleTolerance)
+		&& FMath::Abs(FMath::FindDeltaAngleDegrees(Current.Yaw, Targets.Yaw)) <= AngleTolerance
+		&& FVector::DistSquared(Current.Pan, Targets.Pan) <= FMath::Square(PanTolerance)
+		&& FMath::Abs(Velocity.ArmLength) <= ArmLengthTolerance
+		&& FMath::Abs(Velocity.Pitch) <= AngleTolerance
+		&& FMath::Abs(Velocity.Yaw) <= AngleTolerance
+		&& Velocity.Pan.SizeSquared() <= FMath::Square(PanTolerance);
+}
@@ -0,0 +1,241 @@
+// StrategyCursorQueryComponent.cpp
+#include "StrategyCursorQueryComponent.h"
+#include "MyProject2.h"
+#include "StrategyCameraProfiler.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "SceneView.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Cursor Traces Issued"), STAT_StrategyCursorTracesIssued, STATGROUP_StrategyCamera);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Cursor Queries Served From Cache"), STAT_StrategyCursorQueriesServed, STATGROUP_StrategyCamera);
+DECLARE_CYCLE_STAT(TEXT("Cursor Query Tick"), STAT_StrategyCursorQueryTick, STATGROUP_StrategyCamera);
+
+UStrategyCursorQueryComponent::UStrategyCursorQueryComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	// Run after movement and camera updates so the trace matches what the player is looking at.
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+
+	TraceDelegate.BindUObject(this, &UStrategyCursorQueryComponent::OnTraceCompleted);
+}
+
+void UStrategyCursorQueryComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	STRATEGY_CAMERA_SCOPE(CursorQuery, STAT_StrategyCursorQueryTick);
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	UWorld* World = GetWorld();
+	if (!PlayerController || !World || !PlayerController->PlayerCameraManager)
+	{
+		return;
+	}
+
+	TimeSinceLastTrace += DeltaTime;
+
+	FVector2D MousePosition;
+	if (!GetMousePosition(MousePosition))
+	{
+		return;
+	}
+
+	const FVector CameraLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+	const FRotator CameraRotation = PlayerController->PlayerCameraManager->GetCameraRotation();
+	const bool bExpired = MaxResultAge > 0.f && TimeSinceLastTrace >= MaxResultAge;
+	if (!bForceTrace && !bExpired && !HasViewChanged(MousePosition, CameraLocation, CameraRotation))
+	{
+		return;
+	}
+
+	FVector WorldOrigin = SimulatedRayOrigin;
+	FVector WorldDirection = SimulatedRayDirection;
+	if (!bUseSimulatedCursor && !PlayerController->DeprojectScreenPositionToWorld(MousePosition.X, MousePosition.Y, WorldOrigin, WorldDirection))
+	{
+		return;
+	}
+
+	static const FName CursorTraceTag(TEXT("StrategyCursorQuery"));
+	FCollisionQueryParams QueryParams(CursorTraceTag, false, PlayerController->GetPawn());
+	const FVector TraceEnd = WorldOrigin + WorldDirection * PlayerController->HitResultTraceDistance;
+
+	// Only the latest trace matters; results of older ones are dropped when they complete.
+	PendingTrace = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, WorldOrigin, TraceEnd, TraceChannel, QueryParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate);
+	PendingMousePosition = MousePosition;
+	PendingCameraLocation = CameraLocation;
+	PendingCameraRotation = CameraRotation;
+
+	LastTracedMousePosition = MousePosition;
+	LastTracedCameraLocation = CameraLocation;
+	LastTracedCameraRotation = CameraRotation;
+	TimeSinceLastTrace = 0.f;
+	bForceTrace = false;
+
+	++NumTracesIssued;
+	INC_DWORD_STAT(STAT_StrategyCursorTracesIssued);
+	STRATEGY_CAMERA_PROFILE_COUNT(CursorTraces, 1);
+}
+
+bool UStrategyCursorQueryComponent::GetCursorHit(FHitResult& OutHit) const
+{
+	++NumQueriesServed;
+	INC_DWORD_STAT(STAT_StrategyCursorQueriesServed);
+
+	if (!CachedResult.bBlockingHit)
+	{
+		return false;
+	}
+
+	OutHit = CachedResult.Hit;
+	return true;
+}
+
+bool UStrategyCursorQueryComponent::GetCurrentCursorHit(FHitResult& OutHit)
+{
+	APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	UWorld* World = GetWorld();
+	FVector2D MousePosition;
+	if (!PlayerController || !World || !PlayerController->PlayerCameraManager || !GetMousePosition(MousePosition))
+	{
+		return GetCursorHit(OutHit);
+	}
+
+	const FVector CameraLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+	const FRotator CameraRotation = PlayerController->PlayerCameraManager->GetCameraRotation();
+	const bool bCacheCurrent = CachedResult.MousePosition.Equals(MousePosition, 0.5)
+		&& CachedResult.CameraLocation.Equals(CameraLocation, CameraMoveTolerance)
+		&& CachedResult.CameraRotation.Equals(CameraRotation, CameraMoveTolerance);
+	if (bCacheCurrent)
+	{
+		return GetCursorHit(OutHit);
+	}
+
+	FVector WorldOrigin;
+	FVector WorldDirection;
+	if (!GetCursorRay(WorldOrigin, WorldDirection))
+	{
+		return false;
+	}
+
+	static const FName CursorTraceTag(TEXT("StrategyCursorQuery"));
+	FCollisionQueryParams QueryParams(CursorTraceTag, false, PlayerController->GetPawn());
+	FHitResult Hit;
+	const bool bBlockingHit = World->LineTraceSingleByChannel(Hit, WorldOrigin, WorldOrigin + WorldDirection * PlayerController->HitResultTraceDistance, TraceChannel, QueryParams);
+	++NumSyncTraces;
+
+	// Becomes the cached result; an async trace still in flight is older, so its result is dropped.
+	CachedResult.Hit = bBlockingHit ? Hit : FHitResult();
+	CachedResult.bBlockingHit = bBlockingHit;
+	CachedResult.MousePosition = MousePosition;
+	CachedResult.CameraLocation = CameraLocation;
+	CachedResult.CameraRotation = CameraRotation;
+	CachedResult.FrameNumber = GFrameCounter;
+	PendingTrace = FTraceHandle();
+	LastTracedMousePosition = MousePosition;
+	LastTracedCameraLocation = CameraLocation;
+	LastTracedCameraRotation = CameraRotation;
+	TimeSinceLastTrace = 0.f;
+
+	OutHit = CachedResult.Hit;
+	return bBlockingHit;
+}
+
+bool UStrategyCursorQueryComponent::GetMousePosition(FVector2D& OutMousePosition) const
+{
+	if (bUseSimulatedCursor)
+	{
+		OutMousePosition = SimulatedScreenPosition;
+		return true;
+	}
+
+	const APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	return PlayerController && PlayerController->GetMousePosition(OutMousePosition.X, OutMousePosition.Y);
+}
+
+bool UStrategyCursorQueryComponent::GetCursorRay(FVector& OutOrigin, FVector& OutDirection) const
+{
+	if (bUseSimulatedCursor)
+	{
+		OutOrigin = SimulatedRayOrigin;
+		OutDirection = SimulatedRayDirection;
+		return true;
+	}
+
+	const APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	FVector2D MousePosition;
+	return PlayerController && GetMousePosition(MousePosition) && PlayerController->DeprojectScreenPositionToWorld(MousePosition.X, MousePosition.Y, OutOrigin, OutDirection);
+}
+
+bool UStrategyCursorQueryComponent::GetViewportSize(FIntPoint& OutViewportSize) const
+{
+	if (bUseSimulatedCursor)
+	{
+		OutViewportSize = SimulatedViewportSize;
+		return true;
+	}
+
+	const APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	if (!PlayerController)
+	{
+		return false;
+	}
+
+	PlayerController->GetViewportSize(OutViewportSize.X, OutViewportSize.Y);
+	return OutViewportSize.X > 0 && OutViewportSize.Y > 0;
+}
+
+void UStrategyCursorQueryComponent::SetSimulatedCursor(const FVector2D& ScreenPosition, const FVector& WorldOrigin, const FVector& WorldDirection)
+{
+	bUseSimulatedCursor = true;
+	SimulatedScreenPosition = ScreenPosition;
+	SimulatedRayOrigin = WorldOrigin;
+	SimulatedRayDirection = WorldDirection.GetSafeNormal();
+}
+
+void UStrategyCursorQueryComponent::SetSimulatedScreenPosition(const FVector2D& ScreenPosition, const FIntPoint& ViewportSize)
+{
+	FVector WorldOrigin = SimulatedRayOrigin;
+	FVector WorldDirection = SimulatedRayDirection;
+
+	const APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	if (PlayerController && PlayerController->PlayerCameraManager && ViewportSize.X > 0 && ViewportSize.Y > 0)
+	{
+		// Same projection the viewport would use, but for the given size instead of the live viewport's.
+		FMinimalViewInfo ViewInfo = PlayerController->PlayerCameraManager->GetCameraCacheView();
+		ViewInfo.AspectRatio = float(ViewportSize.X) / float(ViewportSize.Y);
+		ViewInfo.bConstrainAspectRatio = true;
+
+		FMatrix ViewMatrix;
+		FMatrix ProjectionMatrix;
+		FMatrix ViewProjectionMatrix;
+		UGameplayStatics::GetViewProjectionMatrix(ViewInfo, ViewMatrix, ProjectionMatrix, ViewProjectionMatrix);
+		FSceneView::DeprojectScreenToWorld(ScreenPosition, FIntRect(FIntPoint::ZeroValue, ViewportSize), ViewProjectionMatrix.InverseFast(), WorldOrigin, WorldDirection);
+	}
+
+	SimulatedViewportSize = ViewportSize;
+	SetSimulatedCursor(ScreenPosition, WorldOrigin, WorldDirection);
+}
+
+void UStrategyCursorQueryComponent::OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Data)
+{
+	if (Handle != PendingTrace)
+	{
+		return;
+	}
+
+	CachedResult.MousePosition = PendingMousePosition;
+	CachedResult.CameraLocation = PendingCameraLocation;
+	CachedResult.CameraRotation = PendingCameraRotation;
+	CachedResult.FrameNumber = Data.FrameNumber;
+	CachedResult.bBlockingHit = Data.OutHits.Num() > 0 && Data.OutHits[0].bBlockingHit;
+	CachedResult.Hit = CachedResult.bBlockingHit ? Data.OutHits[0] : FHitResult();
+	PendingTrace = FTraceHandle();
+}
+
+bool UStrategyCursorQueryComponent::HasViewChanged(const FVector2D& MousePosition, const FVector& CameraLocation, const FRotator& CameraRotation) const
+{
+	return !MousePosition.Equals(LastTracedMousePosition, 0.5)
+		|| !CameraLocation.Equals(LastTracedCameraLocation, CameraMoveTolerance)
+		|| !CameraRotation.Equals(LastTracedCameraRotation, CameraMoveTolerance);
+}
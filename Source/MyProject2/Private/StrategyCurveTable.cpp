@@ -0,0 +1,33 @@
+// StrategyCurveTable.cpp
+#include "StrategyCurveTable.h"
+#include "Curves/CurveFloat.h"
+
+void FStrategyCurveTable::Bake(const UCurveFloat* Curve, float InMinTime, float InMaxTime, int32 InNumSamples)
+{
+	Reset();
+
+	if (!Curve || InMaxTime <= InMinTime)
+	{
+		return;
+	}
+
+	NumSamples = FMath::Clamp(InNumSamples, 2, MaxSamples);
+	MinTime = InMinTime;
+	MaxTime = InMaxTime;
+
+	const float SampleSpacing = (MaxTime - MinTime) / float(NumSamples - 1);
+	InvSampleSpacing = 1.f / SampleSpacing;
+
+	for (int32 Index = 0; Index < NumSamples; ++Index)
+	{
+		Samples[Index] = Curve->GetFloatValue(MinTime + SampleSpacing * float(Index));
+	}
+}
+
+void FStrategyCurveTable::Reset()
+{
+	MinTime = 0.f;
+	MaxTime = 0.f;
+	InvSampleSpacing = 0.f;
+	NumSamples = 0;
+}
@@ -0,0 +1,361 @@
+// StrategyFlowFieldSubsystem.cpp
+#include "StrategyFlowFieldSubsystem.h"
+#include "MyProject2.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Field Builds"), STAT_StrategyFlowFieldBuilds, STATGROUP_StrategyUnits);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Field Cache Hits"), STAT_StrategyFlowFieldCacheHits, STATGROUP_StrategyUnits);
+
+namespace
+{
+	// East, then counter-clockwise.
+	const FIntPoint DirectionOffsets[8] =
+	{
+		FIntPoint(1, 0), FIntPoint(1, 1), FIntPoint(0, 1), FIntPoint(-1, 1),
+		FIntPoint(-1, 0), FIntPoint(-1, -1), FIntPoint(0, -1), FIntPoint(1, -1),
+	};
+
+	const FVector DirectionVectors[8] =
+	{
+		FVector(1.0, 0.0, 0.0), FVector(UE_INV_SQRT_2, UE_INV_SQRT_2, 0.0), FVector(0.0, 1.0, 0.0), FVector(-UE_INV_SQRT_2, UE_INV_SQRT_2, 0.0),
+		FVector(-1.0, 0.0, 0.0), FVector(-UE_INV_SQRT_2, -UE_INV_SQRT_2, 0.0), FVector(0.0, -1.0, 0.0), FVector(UE_INV_SQRT_2, -UE_INV_SQRT_2, 0.0),
+	};
+
+	struct FOpenCell
+	{
+		uint32 Cost;
+		int32 Index;
+
+		bool operator<(const FOpenCell& Other) const { return Cost < Other.Cost; }
+	};
+
+	// A diagonal step must not squeeze between two blocked cells (or clip the corner of one).
+	bool CanStep(const FStrategyFlowFieldGrid& Grid, const TArray<uint8>& Costs, const FIntPoint& From, int32 Direction)
+	{
+		const FIntPoint& Offset = DirectionOffsets[Direction];
+		const FIntPoint To = From + Offset;
+		if (!Grid.IsValidCell(To) || Costs[Grid.GetCellIndex(To)] == StrategyFlowField::BlockedCost)
+		{
+			return false;
+		}
+		if (Offset.X != 0 && Offset.Y != 0)
+		{
+			return Costs[Grid.GetCellIndex(FIntPoint(From.X + Offset.X, From.Y))] != StrategyFlowField::BlockedCost
+				&& Costs[Grid.GetCellIndex(FIntPoint(From.X, From.Y + Offset.Y))] != StrategyFlowField::BlockedCost;
+		}
+		return true;
+	}
+}
+
+// --- FLOW FIELD ---
+const FIntPoint& FStrategyFlowField::GetDirectionOffset(uint8 Direction)
+{
+	return DirectionOffsets[Direction];
+}
+
+const FVector& FStrategyFlowField::GetDirectionVector(uint8 Direction)
+{
+	return DirectionVectors[Direction];
+}
+
+TSharedRef<const FStrategyFlowField, ESPMode::ThreadSafe> FStrategyFlowField::Build(const FStrategyFlowFieldGrid& Grid, const TArray<uint8>& Costs, const FVector& Destination, uint32 ObstacleVersion)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	TSharedRef<FStrategyFlowField, ESPMode::ThreadSafe> Field = MakeShared<FStrategyFlowField, ESPMode::ThreadSafe>();
+	Field->Grid = Grid;
+	Field->DestinationCell = Grid.GetCell(Destination);
+	Field->Destination = Destination;
+	Field->ObstacleVersion = ObstacleVersion;
+	Field->Integration.Init(MAX_uint32, Grid.GetNumCells());
+	Field->Directions.Init(StrategyFlowField::NoDirection, Grid.GetNumCells());
+
+	if (!Grid.IsValidCell(Field->DestinationCell))
+	{
+		return Field;
+	}
+
+	// 1. Integration field: Dijkstra outwards from the destination.
+	TArray<FOpenCell> Open;
+	Open.Reserve(Grid.Width * 4);
+	const int32 DestinationIndex = Grid.GetCellIndex(Field->DestinationCell);
+	Field->Integration[DestinationIndex] = 0;
+	Open.HeapPush(FOpenCell{ 0, DestinationIndex });
+
+	while (!Open.IsEmpty())
+	{
+		FOpenCell Current;
+		Open.HeapPop(Current, EAllowShrinking::No);
+		if (Current.Cost > Field->Integration[Current.Index])
+		{
+			continue;
+		}
+
+		const FIntPoint CurrentCell(Current.Index % Grid.Width, Current.Index / Grid.Width);
+		for (int32 Direction = 0; Direction < 8; ++Direction)
+		{
+			if (!CanStep(Grid, Costs, CurrentCell, Direction))
+			{
+				continue;
+			}
+
+			const int32 NeighbourIndex = Grid.GetCellIndex(CurrentCell + DirectionOffsets[Direction]);
+			const uint32 StepCost = ((Direction & 1) ? 14u : 10u) * Costs[NeighbourIndex];
+			const uint32 NewCost = Current.Cost + StepCost;
+			if (NewCost < Field->Integration[NeighbourIndex])
+			{
+				Field->Integration[NeighbourIndex] = NewCost;
+				Open.HeapPush(FOpenCell{ NewCost, NeighbourIndex });
+			}
+		}
+	}
+
+	// 2. Direction field: every reachable cell points at its cheapest reachable neighbour.
+	for (int32 CellY = 0; CellY < Grid.Height; ++CellY)
+	{
+		for (int32 CellX = 0; CellX < Grid.Width; ++CellX)
+		{
+			const FIntPoint Cell(CellX, CellY);
+			const int32 Index = Grid.GetCellIndex(Cell);
+			uint32 BestCost = Field->Integration[Index];
+			if (BestCost == MAX_uint32 || Index == DestinationIndex)
+			{
+				continue;
+			}
+
+			for (int32 Direction = 0; Direction < 8; ++Direction)
+			{
+				if (!CanStep(Grid, Costs, Cell, Direction))
+				{
+					continue;
+				}
+
+				const uint32 NeighbourCost = Field->Integration[Grid.GetCellIndex(Cell + DirectionOffsets[Direction])];
+				if (NeighbourCost < BestCost)
+				{
+					BestCost = NeighbourCost;
+					Field->Directions[Index] = uint8(Direction);
+				}
+			}
+		}
+	}
+
+	Field->BuildMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+	return Field;
+}
+
+// --- SUBSYSTEM ---
+void UStrategyFlowFieldSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Configure(FStrategyFlowFieldGrid());
+}
+
+void UStrategyFlowFieldSubsystem::Deinitialize()
+{
+	WaitForPendingBuilds();
+	Entries.Reset();
+	CellById.Reset();
+
+	Super::Deinitialize();
+}
+
+void UStrategyFlowFieldSubsystem::Configure(const FStrategyFlowFieldGrid& InGrid)
+{
+	WaitForPendingBuilds();
+	Entries.Reset();
+	CellById.Reset();
+
+	Grid = InGrid;
+	BlockerCounts.Init(0, Grid.GetNumCells());
+	TSharedRef<TArray<uint8>, ESPMode::ThreadSafe> NewCosts = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>();
+	NewCosts->Init(StrategyFlowField::OpenCost, Grid.GetNumCells());
+	Costs = NewCosts;
+	++ObstacleVersion;
+}
+
+void UStrategyFlowFieldSubsystem::AddBlocker(const FBox2D& Box)
+{
+	UpdateBlockers(Box, 1);
+}
+
+void UStrategyFlowFieldSubsystem::RemoveBlocker(const FBox2D& Box)
+{
+	UpdateBlockers(Box, -1);
+}
+
+void UStrategyFlowFieldSubsystem::UpdateBlockers(const FBox2D& Box, int32 Delta)
+{
+	// A box ending exactly on a cell boundary doesn't cover the next cell.
+	const FVector2D MaxInside = Box.Max - FVector2D(UE_KINDA_SMALL_NUMBER);
+	const FIntPoint MinCell = Grid.GetCell(FVector(Box.Min, 0.0)).ComponentMax(FIntPoint::ZeroValue);
+	const FIntPoint MaxCell = Grid.GetCell(FVector(MaxInside, 0.0)).ComponentMin(FIntPoint(Grid.Width - 1, Grid.Height - 1));
+	if (MinCell.X > MaxCell.X || MinCell.Y > MaxCell.Y)
+	{
+		return;
+	}
+
+	// Only cells that turn blocked or open change the costs.
+	TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> NewCosts;
+	for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+	{
+		for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+		{
+			const int32 Index = Grid.GetCellIndex(FIntPoint(CellX, CellY));
+			uint16& Count = BlockerCounts[Index];
+			const bool bWasBlocked = Count > 0;
+			Count = uint16(FMath::Clamp(int32(Count) + Delta, 0, int32(MAX_uint16)));
+			if ((Count > 0) != bWasBlocked)
+			{
+				if (!NewCosts)
+				{
+					NewCosts = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(*Costs);
+				}
+				(*NewCosts)[Index] = Count > 0 ? StrategyFlowField::BlockedCost : StrategyFlowField::OpenCost;
+			}
+		}
+	}
+	if (!NewCosts)
+	{
+		return;
+	}
+	Costs = NewCosts;
+	++ObstacleVersion;
+
+	const FBox2D ChangedBox(Grid.Origin + FVector2D(MinCell) * Grid.CellSize, Grid.Origin + FVector2D(MaxCell + FIntPoint(1, 1)) * Grid.CellSize);
+	for (TPair<FIntPoint, FEntry>& Pair : Entries)
+	{
+		if (Pair.Value.Region.Intersect(ChangedBox))
+		{
+			LaunchBuild(Pair.Value);
+		}
+	}
+}
+
+int32 UStrategyFlowFieldSubsystem::RequestFlowField(const FVector& Destination, const FBox2D& UnitBounds)
+{
+	const FIntPoint DestinationCell = Grid.GetCell(Destination);
+	if (!Grid.IsValidCell(DestinationCell))
+	{
+		return INDEX_NONE;
+	}
+
+	// Where the units will walk: from their bounds to the destination, plus room to go around obstacles.
+	FBox2D Region = UnitBounds;
+	Region += FVector2D(Destination);
+	Region = Region.ExpandBy(FMath::Max(Region.GetSize().GetMax() * 0.5, Grid.CellSize * 16.0));
+
+	if (FEntry* Entry = Entries.Find(DestinationCell))
+	{
+		Entry->LastRequestTime = FPlatformTime::Seconds();
+		Entry->Region += Region;
+		INC_DWORD_STAT(STAT_StrategyFlowFieldCacheHits);
+		// Obstacles changed outside its region since it was built; this order may walk through them.
+		if (Entry->LaunchedVersion != ObstacleVersion)
+		{
+			LaunchBuild(*Entry);
+		}
+		return Entry->Id;
+	}
+
+	if (Entries.Num() >= MaxCachedFields)
+	{
+		EvictLeastRecentlyRequested();
+	}
+
+	FEntry& Entry = Entries.Add(DestinationCell);
+	Entry.Id = NextFlowFieldId++;
+	Entry.Destination = Destination;
+	Entry.LastRequestTime = FPlatformTime::Seconds();
+	Entry.Region = Region;
+	CellById.Add(Entry.Id, DestinationCell);
+	LaunchBuild(Entry);
+	return Entry.Id;
+}
+
+FStrategyFlowFieldRef UStrategyFlowFieldSubsystem::FindFlowField(int32 FlowFieldId) const
+{
+	const FIntPoint* Cell = CellById.Find(FlowFieldId);
+	const FEntry* Entry = Cell ? Entries.Find(*Cell) : nullptr;
+	return Entry ? Entry->Field : FStrategyFlowFieldRef();
+}
+
+void UStrategyFlowFieldSubsystem::AddFlowFieldUsers(int32 FlowFieldId, int32 Delta)
+{
+	const FIntPoint* Cell = CellById.Find(FlowFieldId);
+	if (FEntry* Entry = Cell ? Entries.Find(*Cell) : nullptr)
+	{
+		Entry->NumUsers = FMath::Max(Entry->NumUsers + Delta, 0);
+	}
+}
+
+void UStrategyFlowFieldSubsystem::GatherReadyFlowFields(TMap<int32, FStrategyFlowFieldRef>& OutFields)
+{
+	OutFields.Reset();
+	for (TPair<FIntPoint, FEntry>& Pair : Entries)
+	{
+		PollBuild(Pair.Value);
+		if (Pair.Value.Field)
+		{
+			OutFields.Add(Pair.Value.Id, Pair.Value.Field);
+		}
+	}
+}
+
+void UStrategyFlowFieldSubsystem::WaitForPendingBuilds()
+{
+	for (TPair<FIntPoint, FEntry>& Pair : Entries)
+	{
+		if (Pair.Value.PendingBuild.IsValid())
+		{
+			Pair.Value.PendingBuild.Wait();
+		}
+		PollBuild(Pair.Value);
+	}
+}
+
+void UStrategyFlowFieldSubsystem::LaunchBuild(FEntry& Entry)
+{
+	// A build already in flight for this entry is superseded; its result is dropped when the handle is replaced.
+	Entry.LaunchedVersion = ObstacleVersion;
+	Entry.PendingBuild = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+		[BuildGrid = Grid, BuildCosts = Costs, Destination = Entry.Destination, Version = ObstacleVersion]() -> FStrategyFlowFieldRef
+		{
+			return FStrategyFlowField::Build(BuildGrid, *BuildCosts, Destination, Version);
+		});
+
+	INC_DWORD_STAT(STAT_StrategyFlowFieldBuilds);
+}
+
+void UStrategyFlowFieldSubsystem::PollBuild(FEntry& Entry)
+{
+	if (Entry.PendingBuild.IsValid() && Entry.PendingBuild.IsCompleted())
+	{
+		Entry.Field = Entry.PendingBuild.GetResult();
+		Entry.PendingBuild = UE::Tasks::TTask<FStrategyFlowFieldRef>();
+
+		UE_LOG(LogStrategyUnits, Verbose, TEXT("[FLOW FIELD] Field %d towards %s built in %.2f ms."), Entry.Id, *Entry.Destination.ToString(), Entry.Field->BuildMs);
+	}
+}
+
+void UStrategyFlowFieldSubsystem::EvictLeastRecentlyRequested()
+{
+	const FIntPoint* OldestCell = nullptr;
+	double OldestTime = TNumericLimits<double>::Max();
+	for (const TPair<FIntPoint, FEntry>& Pair : Entries)
+	{
+		// Units still following a field would lose their steering and walk straight into obstacles.
+		if (Pair.Value.NumUsers == 0 && Pair.Value.LastRequestTime < OldestTime)
+		{
+			OldestTime = Pair.Value.LastRequestTime;
+			OldestCell = &Pair.Key;
+		}
+	}
+
+	if (OldestCell)
+	{
+		const FIntPoint Cell = *OldestCell;
+		CellById.Remove(Entries[Cell].Id);
+		Entries.Remove(Cell);
+	}
+}
@@ -0,0 +1,473 @@
+// StrategyFogOfWarSubsystem.cpp
+#include "StrategyFogOfWarSubsystem.h"
+#include "MyProject2.h"
+#include "Async/ParallelFor.h"
+#include "Engine/Texture2D.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Fog Of War Update"), STAT_StrategyFogOfWarUpdate, STATGROUP_StrategyUnits);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fog Of War Stamps"), STAT_StrategyFogOfWarStamps, STATGROUP_StrategyUnits);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fog Of War Tiles Updated"), STAT_StrategyFogOfWarTiles, STATGROUP_StrategyUnits);
+
+namespace StrategyFogOfWar
+{
+	static bool GParallelUpdate = true;
+	static FAutoConsoleVariableRef CVarParallelUpdate(
+		TEXT("Strategy.FogOfWar.ParallelUpdate"),
+		GParallelUpdate,
+		TEXT("Apply fog-of-war stamps over tiles in parallel (default) or on the game thread."));
+
+	// Vision counts are uint16; radii are capped so a single circle stays a bounded amount of work.
+	constexpr int32 MaxRadiusCells = 255;
+}
+
+void UStrategyFogOfWarSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Configure(Grid);
+}
+
+void UStrategyFogOfWarSubsystem::Deinitialize()
+{
+	RemoveAllVisionSources();
+	VisionCounts.Empty();
+	VisibleBits.Empty();
+	ExploredBits.Empty();
+	Texels.Empty();
+	VisibilityTexture = nullptr;
+
+	Super::Deinitialize();
+}
+
+void UStrategyFogOfWarSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	FlushVisionUpdates();
+}
+
+TStatId UStrategyFogOfWarSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyFogOfWarSubsystem, STATGROUP_Tickables);
+}
+
+void UStrategyFogOfWarSubsystem::Configure(const FStrategyFogOfWarGrid& InGrid)
+{
+	// Sources store cells and radii in cells of the old grid.
+	ensureMsgf(SourceIds.IsEmpty(), TEXT("Configure the fog-of-war grid before adding vision sources."));
+	RemoveAllVisionSources();
+
+	Grid = InGrid;
+	Grid.CellSize = FMath::Max(Grid.CellSize, 1.0);
+	Grid.Width = Align(FMath::Max(Grid.Width, 1), TileSize);
+	Grid.Height = Align(FMath::Max(Grid.Height, 1), TileSize);
+	TilesX = Grid.Width / TileSize;
+	TilesY = Grid.Height / TileSize;
+
+	VisionCounts.SetNumZeroed(Grid.GetNumCells());
+	VisibleBits.SetNumZeroed(GetWordsPerRow() * Grid.Height);
+	ExploredBits.SetNumZeroed(GetWordsPerRow() * Grid.Height);
+	StampsByTile.SetNum(TilesX * TilesY);
+	PendingRemovals.Reset();
+
+	// Everything was cleared, so every tile counts as changed.
+	TileRevisions.SetNum(TilesX * TilesY);
+	for (uint32& Revision : TileRevisions)
+	{
+		++Revision;
+	}
+
+	if (VisibilityTexture)
+	{
+		// Recreated at the new size on next use.
+		VisibilityTexture = nullptr;
+		Texels.Empty();
+	}
+}
+
+// --- SOURCES ---
+int32 UStrategyFogOfWarSubsystem::FindDenseIndex(FStrategyVisionHandle Handle) const
+{
+	if (!DenseIndexById.IsValidIndex(Handle.Id) || SerialById[Handle.Id] != Handle.Serial)
+	{
+		return INDEX_NONE;
+	}
+	return DenseIndexById[Handle.Id];
+}
+
+int32 UStrategyFogOfWarSubsystem::GetRadiusInCells(float Radius) const
+{
+	return FMath::Clamp(FMath::CeilToInt32(Radius / Grid.CellSize), 0, StrategyFogOfWar::MaxRadiusCells);
+}
+
+const TArray<int32>& UStrategyFogOfWarSubsystem::GetCircleSpans(int32 Radius)
+{
+	if (!CircleSpans.IsValidIndex(Radius))
+	{
+		CircleSpans.SetNum(Radius + 1);
+	}
+
+	TArray<int32>& Spans = CircleSpans[Radius];
+	if (Spans.IsEmpty())
+	{
+		// Cells whose centers are within Radius cells of the source cell's center.
+		Spans.SetNumUninitialized(Radius + 1);
+		for (int32 DY = 0; DY <= Radius; ++DY)
+		{
+			Spans[DY] = FMath::FloorToInt32(FMath::Sqrt(double(Radius * Radius - DY * DY)));
+		}
+	}
+	return Spans;
+}
+
+FStrategyVisionHandle UStrategyFogOfWarSubsystem::AddVisionSource(const FVector& Location, float Radius)
+{
+	int32 Id;
+	if (FreeIds.Num() > 0)
+	{
+		Id = FreeIds.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		Id = DenseIndexById.Add(INDEX_NONE);
+		SerialById.Add(0);
+		DirtyById.Add(false);
+	}
+
+	const int32 RadiusCells = GetRadiusInCells(Radius);
+	GetCircleSpans(RadiusCells);
+
+	DenseIndexById[Id] = SourceIds.Num();
+	SourceIds.Add(Id);
+	SourceCells.Add(Grid.GetCell(Location));
+	SourceRadii.Add(RadiusCells);
+	SourceStampedCells.Add(FIntPoint(INDEX_NONE, INDEX_NONE));
+
+	DirtyById[Id] = true;
+	DirtySourceIds.Add(Id);
+
+	return FStrategyVisionHandle{ Id, SerialById[Id] };
+}
+
+void UStrategyFogOfWarSubsystem::UpdateVisionSource(FStrategyVisionHandle Handle, const FVector& Location)
+{
+	const int32 Index = FindDenseIndex(Handle);
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	const FIntPoint Cell = Grid.GetCell(Location);
+	if (Cell == SourceCells[Index])
+	{
+		return;
+	}
+
+	SourceCells[Index] = Cell;
+	if (!DirtyById[Handle.Id])
+	{
+		DirtyById[Handle.Id] = true;
+		DirtySourceIds.Add(Handle.Id);
+	}
+}
+
+void UStrategyFogOfWarSubsystem::RemoveVisionSource(FStrategyVisionHandle Handle)
+{
+	const int32 Index = FindDenseIndex(Handle);
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (SourceStampedCells[Index].X != INDEX_NONE)
+	{
+		PendingRemovals.Add({ SourceStampedCells[Index], SourceRadii[Index], -1 });
+	}
+
+	// Swap the last source into the hole.
+	const int32 LastIndex = SourceIds.Num() - 1;
+	if (Index != LastIndex)
+	{
+		SourceIds[Index] = SourceIds[LastIndex];
+		SourceCells[Index] = SourceCells[LastIndex];
+		SourceRadii[Index] = SourceRadii[LastIndex];
+		SourceStampedCells[Index] = SourceStampedCells[LastIndex];
+		DenseIndexById[SourceIds[Index]] = Index;
+	}
+	SourceIds.Pop(EAllowShrinking::No);
+	SourceCells.Pop(EAllowShrinking::No);
+	SourceRadii.Pop(EAllowShrinking::No);
+	SourceStampedCells.Pop(EAllowShrinking::No);
+
+	// A dirty entry left for this id is skipped by the update.
+	DenseIndexById[Handle.Id] = INDEX_NONE;
+	DirtyById[Handle.Id] = false;
+	++SerialById[Handle.Id];
+	FreeIds.Add(Handle.Id);
+}
+
+void UStrategyFogOfWarSubsystem::RemoveAllVisionSources()
+{
+	for (int32 Index = 0; Index < SourceIds.Num(); ++Index)
+	{
+		if (SourceStampedCells[Index].X != INDEX_NONE)
+		{
+			PendingRemovals.Add({ SourceStampedCells[Index], SourceRadii[Index], -1 });
+		}
+		const int32 Id = SourceIds[Index];
+		DenseIndexById[Id] = INDEX_NONE;
+		DirtyById[Id] = false;
+		++SerialById[Id];
+		FreeIds.Add(Id);
+	}
+
+	SourceIds.Reset();
+	SourceCells.Reset();
+	SourceRadii.Reset();
+	SourceStampedCells.Reset();
+	DirtySourceIds.Reset();
+}
+
+// --- UPDATE ---
+void UStrategyFogOfWarSubsystem::FlushVisionUpdates()
+{
+	if (DirtySourceIds.IsEmpty() && PendingRemovals.IsEmpty())
+	{
+		LastNumUpdatedTiles = 0;
+		return;
+	}
+
+	// Each crossing becomes two stamps: the circle leaves the old cell and lands on the new one.
+	Stamps.Reset();
+	Stamps.Append(PendingRemovals);
+	PendingRemovals.Reset();
+	for (const int32 Id : DirtySourceIds)
+	{
+		if (!DirtyById[Id])
+		{
+			continue;
+		}
+		DirtyById[Id] = false;
+
+		const int32 Index = DenseIndexById[Id];
+		if (SourceStampedCells[Index].X != INDEX_NONE)
+		{
+			Stamps.Add({ SourceStampedCells[Index], SourceRadii[Index], -1 });
+		}
+		Stamps.Add({ SourceCells[Index], SourceRadii[Index], 1 });
+		SourceStampedCells[Index] = SourceCells[Index];
+	}
+	DirtySourceIds.Reset();
+
+	ApplyStamps(false);
+}
+
+void UStrategyFogOfWarSubsystem::RebuildVisibility()
+{
+	FMemory::Memzero(VisionCounts.GetData(), VisionCounts.Num() * sizeof(uint16));
+
+	Stamps.Reset();
+	for (int32 Index = 0; Index < SourceIds.Num(); ++Index)
+	{
+		Stamps.Add({ SourceCells[Index], SourceRadii[Index], 1 });
+		SourceStampedCells[Index] = SourceCells[Index];
+		DirtyById[SourceIds[Index]] = false;
+	}
+	DirtySourceIds.Reset();
+	PendingRemovals.Reset();
+
+	ApplyStamps(true);
+}
+
+void UStrategyFogOfWarSubsystem::ApplyStamps(bool bAllTiles)
+{
+	SCOPE_CYCLE_COUNTER(STAT_StrategyFogOfWarUpdate);
+	INC_DWORD_STAT_BY(STAT_StrategyFogOfWarStamps, Stamps.Num());
+
+	// Bin the stamps by the tiles their bounds overlap. Stamps entirely off the grid land nowhere.
+	UpdatedTiles.Reset();
+	for (TArray<int32>& TileStamps : StampsByTile)
+	{
+		TileStamps.Reset();
+	}
+	for (int32 StampIndex = 0; StampIndex < Stamps.Num(); ++StampIndex)
+	{
+		const FStamp& Stamp = Stamps[StampIndex];
+		if (Stamp.Center.X + Stamp.Radius < 0 || Stamp.Center.Y + Stamp.Radius < 0)
+		{
+			continue;
+		}
+		const int32 MinTileX = FMath::Max(Stamp.Center.X - Stamp.Radius, 0) / TileSize;
+		const int32 MinTileY = FMath::Max(Stamp.Center.Y - Stamp.Radius, 0) / TileSize;
+		const int32 MaxTileX = FMath::Min(Stamp.Center.X + Stamp.Radius, Grid.Width - 1) / TileSize;
+		const int32 MaxTileY = FMath::Min(Stamp.Center.Y + Stamp.Radius, Grid.Height - 1) / TileSize;
+
+		for (int32 TileY = MinTileY; TileY <= MaxTileY; ++TileY)
+		{
+			for (int32 TileX = MinTileX; TileX <= MaxTileX; ++TileX)
+			{
+				TArray<int32>& TileStamps = StampsByTile[TileY * TilesX + TileX];
+				if (TileStamps.IsEmpty() && !bAllTiles)
+				{
+					UpdatedTiles.Add(TileY * TilesX + TileX);
+				}
+				TileStamps.Add(StampIndex);
+			}
+		}
+	}
+	if (bAllTiles)
+	{
+		for (int32 Tile = 0; Tile < StampsByTile.Num(); ++Tile)
+		{
+			UpdatedTiles.Add(Tile);
+		}
+	}
+
+	const bool bWriteTexels = !Texels.IsEmpty();
+	const int32 WordsPerRow = GetWordsPerRow();
+	auto UpdateTile = [this, bWriteTexels, WordsPerRow](int32 UpdatedIndex)
+	{
+		const int32 Tile = UpdatedTiles[UpdatedIndex];
+		const int32 TileMinX = (Tile % TilesX) * TileSize;
+		const int32 TileMinY = (Tile / TilesX) * TileSize;
+
+		// Only this tile's cells are written, so tiles never race on counts, bit words or texels.
+		for (const int32 StampIndex : StampsByTile[Tile])
+		{
+			const FStamp& Stamp = Stamps[StampIndex];
+			const TArray<int32>& Spans = CircleSpans[Stamp.Radius];
+			const int32 MinY = FMath::Max(Stamp.Center.Y - Stamp.Radius, TileMinY);
+			const int32 MaxY = FMath::Min(Stamp.Center.Y + Stamp.Radius, TileMinY + TileSize - 1);
+			for (int32 Y = MinY; Y <= MaxY; ++Y)
+			{
+				const int32 HalfWidth = Spans[FMath::Abs(Y - Stamp.Center.Y)];
+				const int32 MinX = FMath::Max(Stamp.Center.X - HalfWidth, TileMinX);
+				const int32 MaxX = FMath::Min(Stamp.Center.X + HalfWidth, TileMinX + TileSize - 1);
+				uint16* Counts = &VisionCounts[Y * Grid.Width];
+				for (int32 X = MinX; X <= MaxX; ++X)
+				{
+					Counts[X] = uint16(Counts[X] + Stamp.Delta);
+				}
+			}
+		}
+
+		// Re-derive the tile's bit words (one per row) and texels from the counts.
+		const int32 WordX = TileMinX / TileSize;
+		for (int32 Y = TileMinY; Y < TileMinY + TileSize; ++Y)
+		{
+			const uint16* Counts = &VisionCounts[Y * Grid.Width + TileMinX];
+			uint64 Word = 0;
+			for (int32 X = 0; X < TileSize; ++X)
+			{
+				Word |= uint64(Counts[X] != 0) << X;
+			}
+
+			const int32 WordIndex = Y * WordsPerRow + WordX;
+			VisibleBits[WordIndex] = Word;
+			ExploredBits[WordIndex] |= Word;
+
+			if (bWriteTexels)
+			{
+				const uint64 Explored = ExploredBits[WordIndex];
+				uint8* Row = &Texels[Y * Grid.Width + TileMinX];
+				for (int32 X = 0; X < TileSize; ++X)
+				{
+					Row[X] = (Word >> X) & 1 ? 255 : ((Explored >> X) & 1 ? ExploredTexelValue : 0);
+				}
+			}
+		}
+	};
+
+	ParallelFor(UpdatedTiles.Num(), UpdateTile, !StrategyFogOfWar::GParallelUpdate);
+
+	INC_DWORD_STAT_BY(STAT_StrategyFogOfWarTiles, UpdatedTiles.Num());
+	LastNumUpdatedTiles = UpdatedTiles.Num();
+	for (const int32 Tile : UpdatedTiles)
+	{
+		++TileRevisions[Tile];
+	}
+
+	if (VisibilityTexture && bWriteTexels)
+	{
+		UpdateTexture(UpdatedTiles);
+	}
+}
+
+// --- QUERIES ---
+int32 UStrategyFogOfWarSubsystem::GetNumVisibleCells() const
+{
+	int32 NumVisible = 0;
+	for (const uint64 Word : VisibleBits)
+	{
+		NumVisible += int32(FMath::CountBits(Word));
+	}
+	return NumVisible;
+}
+
+// --- TEXTURE ---
+UTexture2D* UStrategyFogOfWarSubsystem::GetVisibilityTexture()
+{
+	if (!VisibilityTexture)
+	{
+		VisibilityTexture = UTexture2D::CreateTransient(Grid.Width, Grid.Height, PF_G8, TEXT("StrategyFogOfWar"));
+		if (!VisibilityTexture)
+		{
+			return nullptr;
+		}
+		VisibilityTexture->Filter = TF_Bilinear;
+		VisibilityTexture->AddressX = TA_Clamp;
+		VisibilityTexture->AddressY = TA_Clamp;
+		VisibilityTexture->SRGB = false;
+		VisibilityTexture->UpdateResource();
+
+		// Texels are only kept from here on; seed them from the current bits and upload everything once.
+		Texels.SetNumUninitialized(Grid.GetNumCells());
+		const int32 WordsPerRow = GetWordsPerRow();
+		for (int32 Y = 0; Y < Grid.Height; ++Y)
+		{
+			for (int32 X = 0; X < Grid.Width; ++X)
+			{
+				const int32 WordIndex = Y * WordsPerRow + X / TileSize;
+				const int32 Bit = X % TileSize;
+				Texels[Y * Grid.Width + X] = (VisibleBits[WordIndex] >> Bit) & 1 ? 255 : ((ExploredBits[WordIndex] >> Bit) & 1 ? ExploredTexelValue : 0);
+			}
+		}
+
+		TArray<int32> AllTiles;
+		AllTiles.SetNumUninitialized(TilesX * TilesY);
+		for (int32 Tile = 0; Tile < AllTiles.Num(); ++Tile)
+		{
+			AllTiles[Tile] = Tile;
+		}
+		UpdateTexture(AllTiles);
+	}
+	return VisibilityTexture;
+}
+
+void UStrategyFogOfWarSubsystem::UpdateTexture(TConstArrayView<int32> Tiles)
+{
+	if (Tiles.IsEmpty())
+	{
+		return;
+	}
+
+	FUpdateTextureRegion2D* Regions = new FUpdateTextureRegion2D[Tiles.Num()];
+	for (int32 Index = 0; Index < Tiles.Num(); ++Index)
+	{
+		const int32 X = (Tiles[Index] % TilesX) * TileSize;
+		const int32 Y = (Tiles[Index] / TilesX) * TileSize;
+		Regions[Index] = FUpdateTextureRegion2D(X, Y, X, Y, TileSize, TileSize);
+	}
+
+	// The render thread uploads later, after the next update may have changed the texels, so it gets its own copy.
+	uint8* Data = static_cast<uint8*>(FMemory::Malloc(Texels.Num()));
+	FMemory::Memcpy(Data, Texels.GetData(), Texels.Num());
+
+	VisibilityTexture->UpdateTextureRegions(0, Tiles.Num(), Regions, Grid.Width, 1, Data,
+		[](uint8* SrcData, const FUpdateTextureRegion2D* SrcRegions)
+		{
+			FMemory::Free(SrcData);
+			delete[] SrcRegions;
+		});
+}
@@ -0,0 +1,332 @@
+// StrategyFormation.cpp
+#include "StrategyFormation.h"
+#include "MyProject2.h"
+#include "Algo/Sort.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Formation Solve"), STAT_StrategyFormationSolve, STATGROUP_StrategyUnits);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Formation Slots Assigned"), STAT_StrategyFormationSlots, STATGROUP_StrategyUnits);
+
+// --- Layouts ---
+void StrategyFormation::MakeSlots(EStrategyFormationShape Shape, int32 NumSlots, const FVector& Center, float Yaw, float Spacing, TArray<FVector>& OutSlots)
+{
+	OutSlots.Reset(NumSlots);
+	if (NumSlots <= 0)
+	{
+		return;
+	}
+
+	// Slots per rank, front rank first.
+	TArray<int32, TInlineAllocator<128>> RankWidths;
+	if (Shape == EStrategyFormationShape::Wedge)
+	{
+		for (int32 Remaining = NumSlots, Width = 1; Remaining > 0; Remaining -= Width, Width += 2)
+		{
+			RankWidths.Add(FMath::Min(Remaining, Width));
+		}
+	}
+	else
+	{
+		const double Aspect = Shape == EStrategyFormationShape::Line ? 4.0 : 1.0;
+		const int32 Columns = FMath::Clamp(FMath::CeilToInt32(FMath::Sqrt(NumSlots * Aspect)), 1, NumSlots);
+		for (int32 Remaining = NumSlots; Remaining > 0; Remaining -= Columns)
+		{
+			RankWidths.Add(FMath::Min(Remaining, Columns));
+		}
+	}
+
+	const FVector Forward = FRotator(0.0, Yaw, 0.0).Vector();
+	const FVector Right(-Forward.Y, Forward.X, 0.0);
+	const double FrontRank = (RankWidths.Num() - 1) * 0.5;
+	for (int32 Rank = 0; Rank < RankWidths.Num(); ++Rank)
+	{
+		const FVector RankCenter = Center + Forward * ((FrontRank - Rank) * Spacing);
+		const int32 Width = RankWidths[Rank];
+		for (int32 Column = 0; Column < Width; ++Column)
+		{
+			OutSlots.Add(RankCenter + Right * ((Column - (Width - 1) * 0.5) * Spacing));
+		}
+	}
+}
+
+double StrategyFormation::GetTotalPathLength(TConstArrayView<FVector> Units, TConstArrayView<FVector> Slots, TConstArrayView<int32> SlotForUnit)
+{
+	double Total = 0.0;
+	for (int32 Unit = 0; Unit < Units.Num(); ++Unit)
+	{
+		Total += FVector::Dist(Units[Unit], Slots[SlotForUnit[Unit]]);
+	}
+	return Total;
+}
+
+void StrategyFormation::SolveOptimal(TConstArrayView<FVector> Units, TConstArrayView<FVector> Slots, TArray<int32>& OutSlotForUnit)
+{
+	check(Units.Num() == Slots.Num());
+	const int32 Num = Units.Num();
+
+	// Shortest augmenting paths with row/column potentials; index 0 is a virtual column, units and slots are 1-based.
+	TArray<double> UnitPotentials;
+	TArray<double> SlotPotentials;
+	TArray<double> MinSlack;
+	TArray<int32> UnitOfSlot;
+	TArray<int32> PreviousSlot;
+	TArray<bool> Visited;
+	UnitPotentials.Init(0.0, Num + 1);
+	SlotPotentials.Init(0.0, Num + 1);
+	UnitOfSlot.Init(0, Num + 1);
+	PreviousSlot.Init(0, Num + 1);
+
+	for (int32 Unit = 1; Unit <= Num; ++Unit)
+	{
+		UnitOfSlot[0] = Unit;
+		int32 Slot = 0;
+		MinSlack.Init(DBL_MAX, Num + 1);
+		Visited.Init(false, Num + 1);
+		do
+		{
+			Visited[Slot] = true;
+			const int32 CurrentUnit = UnitOfSlot[Slot];
+			double Delta = DBL_MAX;
+			int32 NextSlot = 0;
+			for (int32 Candidate = 1; Candidate <= Num; ++Candidate)
+			{
+				if (Visited[Candidate])
+				{
+					continue;
+				}
+				const double Slack = FVector::Dist(Units[CurrentUnit - 1], Slots[Candidate - 1]) - UnitPotentials[CurrentUnit] - SlotPotentials[Candidate];
+				if (Slack < MinSlack[Candidate])
+				{
+					MinSlack[Candidate] = Slack;
+					PreviousSlot[Candidate] = Slot;
+				}
+				if (MinSlack[Candidate] < Delta)
+				{
+					Delta = MinSlack[Candidate];
+					NextSlot = Candidate;
+				}
+			}
+			for (int32 Candidate = 0; Candidate <= Num; ++Candidate)
+			{
+				if (Visited[Candidate])
+				{
+					UnitPotentials[UnitOfSlot[Candidate]] += Delta;
+					SlotPotentials[Candidate] -= Delta;
+				}
+				else
+				{
+					MinSlack[Candidate] -= Delta;
+				}
+			}
+			Slot = NextSlot;
+		}
+		while (UnitOfSlot[Slot] != 0);
+
+		// Flip the augmenting path.
+		do
+		{
+			const int32 Previous = PreviousSlot[Slot];
+			UnitOfSlot[Slot] = UnitOfSlot[Previous];
+			Slot = Previous;
+		}
+		while (Slot != 0);
+	}
+
+	OutSlotForUnit.SetNumUninitialized(Num);
+	for (int32 Slot = 1; Slot <= Num; ++Slot)
+	{
+		OutSlotForUnit[UnitOfSlot[Slot] - 1] = Slot - 1;
+	}
+}
+
+// --- Solver ---
+void FStrategyFormationSolver::Solve(TConstArrayView<FVector> Units, TConstArrayView<FVector> Slots, TArray<int32>& OutSlotForUnit)
+{
+	SCOPE_CYCLE_COUNTER(STAT_StrategyFormationSolve);
+	check(Units.Num() == Slots.Num());
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const int32 Num = Units.Num();
+
+	OutSlotForUnit.SetNumUninitialized(Num);
+	Buckets.Reset();
+	UnitOrder.Reset(Num);
+	SlotOrder.Reset(Num);
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		UnitOrder.Add(Index);
+		SlotOrder.Add(Index);
+	}
+
+	auto ToCentroidSpace = [](TConstArrayView<FVector> Points, TArray<FVector2D>& OutPoints)
+	{
+		FVector2D Centroid = FVector2D::ZeroVector;
+		for (const FVector& Point : Points)
+		{
+			Centroid += FVector2D(Point);
+		}
+		Centroid /= FMath::Max(Points.Num(), 1);
+
+		OutPoints.Reset(Points.Num());
+		for (const FVector& Point : Points)
+		{
+			OutPoints.Add(FVector2D(Point) - Centroid);
+		}
+	};
+	ToCentroidSpace(Units, UnitPoints);
+	ToCentroidSpace(Slots, SlotPoints);
+
+	TArray<FBucket, TInlineAllocator<64>> Pending;
+	if (Num > 0)
+	{
+		Pending.Add({ 0, Num });
+	}
+	while (Pending.Num() > 0)
+	{
+		const FBucket Bucket = Pending.Pop(EAllowShrinking::No);
+		if (Bucket.Num <= FMath::Max(LeafSize, 1))
+		{
+			Buckets.Add(Bucket);
+			continue;
+		}
+
+		// Split across the slots' longer extent, so buckets stay compact however the formation is stretched.
+		FBox2D SlotBounds(ForceInit);
+		for (int32 Index = Bucket.Begin; Index < Bucket.Begin + Bucket.Num; ++Index)
+		{
+			SlotBounds += SlotPoints[SlotOrder[Index]];
+		}
+		const FVector2D Extent = SlotBounds.GetSize();
+		const int32 Axis = Extent.X >= Extent.Y ? 0 : 1;
+
+		auto SortBucket = [&Bucket, Axis](TArray<int32>& Order, const TArray<FVector2D>& Points)
+		{
+			Algo::Sort(MakeArrayView(Order.GetData() + Bucket.Begin, Bucket.Num), [&Points, Axis](int32 A, int32 B)
+			{
+				// Ties go by the other axis, then the index, so the same input always splits the same way.
+				const FVector2D& PointA = Points[A];
+				const FVector2D& PointB = Points[B];
+				if (PointA[Axis] != PointB[Axis])
+				{
+					return PointA[Axis] < PointB[Axis];
+				}
+				if (PointA[1 - Axis] != PointB[1 - Axis])
+				{
+					return PointA[1 - Axis] < PointB[1 - Axis];
+				}
+				return A < B;
+			});
+		};
+		SortBucket(UnitOrder, UnitPoints);
+		SortBucket(SlotOrder, SlotPoints);
+
+		const int32 Half = Bucket.Num / 2;
+		Pending.Add({ Bucket.Begin, Half });
+		Pending.Add({ Bucket.Begin + Half, Bucket.Num - Half });
+	}
+
+	// Buckets write disjoint entries of OutSlotForUnit.
+	ParallelFor(Buckets.Num(), [this, Units, Slots, &OutSlotForUnit](int32 Index)
+	{
+		SolveBucket(Buckets[Index], Units, Slots, OutSlotForUnit);
+	}, !bParallel);
+
+	INC_DWORD_STAT_BY(STAT_StrategyFormationSlots, Num);
+	LastSolveMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+}
+
+void FStrategyFormationSolver::SolveBucket(const FBucket& Bucket, TConstArrayView<FVector> Units, TConstArrayView<FVector> Slots, TArray<int32>& OutSlotForUnit) const
+{
+	const int32 Num = Bucket.Num;
+	const int32* BucketUnits = UnitOrder.GetData() + Bucket.Begin;
+	const int32* BucketSlots = SlotOrder.GetData() + Bucket.Begin;
+	if (Num == 1)
+	{
+		OutSlotForUnit[BucketUnits[0]] = BucketSlots[0];
+		return;
+	}
+
+	// Path lengths less the smallest one, so the prices stay small next to the costs.
+	TArray<float, TInlineAllocator<64 * 64>> Costs;
+	Costs.SetNumUninitialized(Num * Num);
+	float MinCost = MAX_flt;
+	float MaxCost = 0.f;
+	for (int32 Unit = 0; Unit < Num; ++Unit)
+	{
+		for (int32 Slot = 0; Slot < Num; ++Slot)
+		{
+			const float Distance = float(FVector::Dist(Units[BucketUnits[Unit]], Slots[BucketSlots[Slot]]));
+			Costs[Unit * Num + Slot] = Distance;
+			MinCost = FMath::Min(MinCost, Distance);
+			MaxCost = FMath::Max(MaxCost, Distance);
+		}
+	}
+	for (float& Cost : Costs)
+	{
+		Cost -= MinCost;
+	}
+
+	// Auction: each unassigned unit bids for its cheapest slot (path length plus price), raising the price by how much
+	// that slot beats its second choice plus Epsilon, and outbids the slot's owner. Coarse rounds settle the prices
+	// cheaply; the last round ends within Num * FinalEpsilon (1 cm) of the bucket's optimum.
+	TArray<float, TInlineAllocator<64>> Prices;
+	TArray<int32, TInlineAllocator<64>> SlotOwners;
+	TArray<int32, TInlineAllocator<64>> UnitSlots;
+	TArray<int32, TInlineAllocator<64>> Unassigned;
+	Prices.Init(0.f, Num);
+
+	const float FinalEpsilon = 1.f / Num;
+	float Epsilon = FMath::Max((MaxCost - MinCost) * 0.25f, FinalEpsilon);
+	for (;;)
+	{
+		SlotOwners.Init(INDEX_NONE, Num);
+		UnitSlots.Init(INDEX_NONE, Num);
+		Unassigned.Reset();
+		for (int32 Unit = Num - 1; Unit >= 0; --Unit)
+		{
+			Unassigned.Add(Unit);
+		}
+
+		while (Unassigned.Num() > 0)
+		{
+			const int32 Unit = Unassigned.Pop(EAllowShrinking::No);
+			const float* UnitCosts = &Costs[Unit * Num];
+			float Best = MAX_flt;
+			float SecondBest = MAX_flt;
+			int32 BestSlot = 0;
+			for (int32 Slot = 0; Slot < Num; ++Slot)
+			{
+				const float Cost = UnitCosts[Slot] + Prices[Slot];
+				if (Cost < Best)
+				{
+					SecondBest = Best;
+					Best = Cost;
+					BestSlot = Slot;
+				}
+				else if (Cost < SecondBest)
+				{
+					SecondBest = Cost;
+				}
+			}
+
+			Prices[BestSlot] += SecondBest - Best + Epsilon;
+			if (SlotOwners[BestSlot] != INDEX_NONE)
+			{
+				UnitSlots[SlotOwners[BestSlot]] = INDEX_NONE;
+				Unassigned.Add(SlotOwners[BestSlot]);
+			}
+			SlotOwners[BestSlot] = Unit;
+			UnitSlots[Unit] = BestSlot;
+		}
+
+		if (Epsilon <= FinalEpsilon)
+		{
+			break;
+		}
+		Epsilon = FMath::Max(Epsilon * 0.2f, FinalEpsilon);
+	}
+
+	for (int32 Unit = 0; Unit < Num; ++Unit)
+	{
+		OutSlotForUnit[BucketUnits[Unit]] = BucketSlots[UnitSlots[Unit]];
+	}
+}
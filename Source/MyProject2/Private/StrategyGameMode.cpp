@@ -3,13 +3,71 @@
 
 #include "StrategyCameraPawn.h"
 #include "StrategyPlayerController.h" // Include your player controller
+#include "MyProject2.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "EngineUtils.h"
 
 AStrategyGameMode::AStrategyGameMode()
 {
 	// Set default player controller class
 	PlayerControllerClass = AStrategyPlayerController::StaticClass();
-	DefaultPawnClass = AStrategyCameraPawn::StaticClass();
+	CameraPawnClass = AStrategyCameraPawn::StaticClass();
 	
-	// RTS games typically don't have a default pawn class for the player controller to possess
+	// RTS games typically don't have a default pawn class for the player controller to possess; the camera pawn is
+	// spawned in HandleStartingNewPlayer instead.
 	DefaultPawnClass = nullptr;
-}
\ No newline at end of file
+}
+
+void AStrategyGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	StartupStartSeconds = FPlatformTime::Seconds();
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	// The controller doesn't exist yet; its class defaults name the same assets it will ask for.
+	const AStrategyPlayerController* DefaultController = PlayerControllerClass ? Cast<AStrategyPlayerController>(PlayerControllerClass->GetDefaultObject()) : nullptr;
+	if (!DefaultController)
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> Assets;
+	DefaultController->GetStartupAssets(Assets);
+	if (Assets.Num() > 0)
+	{
+		StartupAssets = UAssetManager::GetStreamableManager().RequestAsyncLoad(Assets, FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+		UE_LOG(LogStrategyCamera, Log, TEXT("[CONTROLLER] Startup: preloading %d controller assets for '%s'."), Assets.Num(), *MapName);
+	}
+}
+
+void AStrategyGameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
+{
+	// Not the base version: it restarts the player with DefaultPawnClass, which is deliberately unset.
+	if (!NewPlayer || NewPlayer->GetPawn() || !CameraPawnClass)
+	{
+		return;
+	}
+
+	for (TActorIterator<AStrategyCameraPawn> It(GetWorld()); It; ++It)
+	{
+		if (It->AutoPossessPlayer != EAutoReceiveInput::Disabled)
+		{
+			return;
+		}
+	}
+
+	const AActor* PlayerStart = FindPlayerStart(NewPlayer);
+	const FVector Location = PlayerStart ? PlayerStart->GetActorLocation() : FVector::ZeroVector;
+	const FRotator Rotation(0.0, PlayerStart ? PlayerStart->GetActorRotation().Yaw : 0.0, 0.0);
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AStrategyCameraPawn* CameraPawn = GetWorld()->SpawnActor<AStrategyCameraPawn>(CameraPawnClass, Location, Rotation, SpawnParameters);
+	if (!CameraPawn)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[CONTROLLER] Startup: failed to spawn camera pawn '%s'."), *GetNameSafe(CameraPawnClass));
+		return;
+	}
+
+	NewPlayer->Possess(CameraPawn);
+}
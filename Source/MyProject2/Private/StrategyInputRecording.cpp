@@ -0,0 +1,220 @@
+// StrategyInputRecording.cpp
+#include "StrategyInputRecording.h"
+#include "MyProject2.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+
+namespace StrategyInputRecording
+{
+	constexpr uint32 Magic = 0x52495453; // "STIR"
+	constexpr uint32 Version = 1;
+
+	struct FFileHeader
+	{
+		uint32 Magic = 0;
+		uint32 Version = 0;
+		uint32 SnapshotSize = 0;
+		uint32 RecordSize = 0;
+		uint64 NumRecords = 0;
+		// Offset of the first record, 16-byte aligned.
+		uint64 RecordsOffset = 0;
+	};
+
+	uint64 GetRecordsOffset()
+	{
+		return Align(sizeof(FFileHeader) + sizeof(FStrategyInputSnapshot), 16);
+	}
+}
+
+// --- Recorder ---
+void FStrategyInputRecorder::Start(int32 InMaxRecords, int32 InSnapshotIntervalFrames)
+{
+	Records.SetNumZeroed(FMath::Max(InMaxRecords, 1024));
+	Snapshots.Reset();
+	Snapshots.SetNum(MaxSnapshots);
+	NextSequence = 0;
+	NextSnapshot = 0;
+	SnapshotIntervalFrames = FMath::Max(InSnapshotIntervalFrames, 1);
+	// The first frame always gets a snapshot, so a recording that never wrapped replays from its start.
+	FramesSinceSnapshot = SnapshotIntervalFrames;
+	bHasOpenFrame = false;
+	bRecording = true;
+}
+
+void FStrategyInputRecorder::Stop()
+{
+	bRecording = false;
+	bHasOpenFrame = false;
+}
+
+void FStrategyInputRecorder::AddSnapshot(const FStrategyInputSnapshot& State)
+{
+	FSnapshotEntry& Entry = Snapshots[NextSnapshot];
+	Entry.Sequence = NextSequence;
+	Entry.State = State;
+	Entry.bValid = true;
+	NextSnapshot = (NextSnapshot + 1) % Snapshots.Num();
+	FramesSinceSnapshot = 0;
+}
+
+void FStrategyInputRecorder::BeginFrame(uint64 FrameNumber, float DeltaTime, bool bHasCursor, const FVector2D& CursorPosition)
+{
+	OpenFrameNumber = FrameNumber;
+	bHasOpenFrame = true;
+	++FramesSinceSnapshot;
+	Record(EStrategyInputRecordType::Frame, DeltaTime, float(CursorPosition.X), float(CursorPosition.Y), bHasCursor ? 1 : 0);
+}
+
+void FStrategyInputRecorder::Record(EStrategyInputRecordType Type, float A, float B, float C, uint8 Flags)
+{
+	FStrategyInputRecord& Entry = Records[NextSequence % Records.Num()];
+	Entry.Type = Type;
+	Entry.Flags = Flags;
+	Entry.A = A;
+	Entry.B = B;
+	Entry.C = C;
+	++NextSequence;
+}
+
+bool FStrategyInputRecorder::Save(const FString& Filename) const
+{
+	using namespace StrategyInputRecording;
+
+	if (Records.IsEmpty())
+	{
+		return false;
+	}
+
+	// The replay must start at a snapshot whose records haven't been overwritten yet; take the oldest such one.
+	const uint64 OldestSequence = NextSequence > uint64(Records.Num()) ? NextSequence - Records.Num() : 0;
+	const FSnapshotEntry* Start = nullptr;
+	for (const FSnapshotEntry& Entry : Snapshots)
+	{
+		if (Entry.bValid && Entry.Sequence >= OldestSequence && Entry.Sequence < NextSequence && (!Start || Entry.Sequence < Start->Sequence))
+		{
+			Start = &Entry;
+		}
+	}
+	if (!Start)
+	{
+		UE_LOG(LogStrategyCamera, Warning, TEXT("[INPUT] No snapshot covers the recorded frames; nothing saved."));
+		return false;
+	}
+
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Writer)
+	{
+		return false;
+	}
+
+	FFileHeader Header;
+	Header.Magic = Magic;
+	Header.Version = Version;
+	Header.SnapshotSize = sizeof(FStrategyInputSnapshot);
+	Header.RecordSize = sizeof(FStrategyInputRecord);
+	Header.NumRecords = NextSequence - Start->Sequence;
+	Header.RecordsOffset = GetRecordsOffset();
+	Writer->Serialize(&Header, sizeof(Header));
+	Writer->Serialize(const_cast<FStrategyInputSnapshot*>(&Start->State), sizeof(FStrategyInputSnapshot));
+
+	uint8 Padding[16] = {};
+	Writer->Serialize(Padding, Header.RecordsOffset - sizeof(Header) - sizeof(FStrategyInputSnapshot));
+
+	// At most two contiguous runs, either side of the ring's wrap point.
+	for (uint64 Sequence = Start->Sequence; Sequence < NextSequence;)
+	{
+		const int32 Index = int32(Sequence % Records.Num());
+		const int32 Count = int32(FMath::Min<uint64>(NextSequence - Sequence, uint64(Records.Num() - Index)));
+		Writer->Serialize(const_cast<FStrategyInputRecord*>(&Records[Index]), Count * sizeof(FStrategyInputRecord));
+		Sequence += Count;
+	}
+
+	return Writer->Close() && !Writer->IsError();
+}
+
+// --- Player ---
+FStrategyInputPlayer::FStrategyInputPlayer() = default;
+FStrategyInputPlayer::~FStrategyInputPlayer() = default;
+
+bool FStrategyInputPlayer::Open(const FString& Filename)
+{
+	using namespace StrategyInputRecording;
+
+	Close();
+
+	MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+	if (!MappedFile || MappedFile->GetFileSize() < int64(GetRecordsOffset()))
+	{
+		UE_LOG(LogStrategyCamera, Warning, TEXT("[INPUT] Could not map '%s'."), *Filename);
+		Close();
+		return false;
+	}
+
+	MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	if (!MappedRegion)
+	{
+		Close();
+		return false;
+	}
+
+	const uint8* Data = MappedRegion->GetMappedPtr();
+	FFileHeader Header;
+	FMemory::Memcpy(&Header, Data, sizeof(Header));
+	const uint64 RecordsSize = Header.NumRecords * sizeof(FStrategyInputRecord);
+	if (Header.Magic != Magic || Header.Version != Version || Header.SnapshotSize != sizeof(FStrategyInputSnapshot)
+		|| Header.RecordSize != sizeof(FStrategyInputRecord) || Header.RecordsOffset != GetRecordsOffset()
+		|| Header.RecordsOffset + RecordsSize > uint64(MappedRegion->GetMappedSize()))
+	{
+		UE_LOG(LogStrategyCamera, Warning, TEXT("[INPUT] '%s' is not a recording of this build."), *Filename);
+		Close();
+		return false;
+	}
+
+	FMemory::Memcpy(&Snapshot, Data + sizeof(Header), sizeof(FStrategyInputSnapshot));
+	// Mapped regions are page aligned and the records start 16-byte aligned, so they are read in place.
+	Records = MakeArrayView(reinterpret_cast<const FStrategyInputRecord*>(Data + Header.RecordsOffset), int32(Header.NumRecords));
+	ReadIndex = 0;
+	NumFrames = 0;
+	for (const FStrategyInputRecord& Record : Records)
+	{
+		NumFrames += Record.Type == EStrategyInputRecordType::Frame ? 1 : 0;
+	}
+	return true;
+}
+
+void FStrategyInputPlayer::Close()
+{
+	Records = TConstArrayView<FStrategyInputRecord>();
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	ReadIndex = 0;
+	NumFrames = 0;
+}
+
+bool FStrategyInputPlayer::NextFrame(const FStrategyInputRecord*& OutFrame, TConstArrayView<FStrategyInputRecord>& OutEvents)
+{
+	// Skip anything before the first frame start.
+	while (ReadIndex < Records.Num() && Records[ReadIndex].Type != EStrategyInputRecordType::Frame)
+	{
+		++ReadIndex;
+	}
+	if (ReadIndex >= Records.Num())
+	{
+		return false;
+	}
+
+	OutFrame = &Records[ReadIndex++];
+	const int32 FirstEvent = ReadIndex;
+	while (ReadIndex < Records.Num() && Records[ReadIndex].Type != EStrategyInputRecordType::Frame)
+	{
+		++ReadIndex;
+	}
+	OutEvents = Records.Slice(FirstEvent, ReadIndex - FirstEvent);
+	return true;
+}
+
+float FStrategyInputPlayer::PeekDeltaTime() const
+{
+	return Records.IsValidIndex(ReadIndex) && Records[ReadIndex].Type == EStrategyInputRecordType::Frame ? Records[ReadIndex].A : 0.f;
+}
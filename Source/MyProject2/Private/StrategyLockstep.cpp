@@ -0,0 +1,548 @@
+// StrategyLockstep.cpp
+#include "StrategyLockstep.h"
+#include "MyProject2.h"
+#include "Misc/Crc.h"
+
+namespace StrategyLockstep
+{
+	void WriteVarint(TArray<uint8>& Bytes, uint64 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Bytes.Add(uint8(Value) | 0x80);
+			Value >>= 7;
+		}
+		Bytes.Add(uint8(Value));
+	}
+
+	void WriteSignedVarint(TArray<uint8>& Bytes, int64 Value)
+	{
+		WriteVarint(Bytes, (uint64(Value) << 1) ^ uint64(Value >> 63));
+	}
+
+	// Bounds-checked reads; any read past the end fails the whole packet.
+	struct FReader
+	{
+		TConstArrayView<uint8> Bytes;
+		int32 Offset = 0;
+		bool bError = false;
+
+		int32 GetRemaining() const { return Bytes.Num() - Offset; }
+
+		uint8 ReadByte()
+		{
+			if (Offset >= Bytes.Num())
+			{
+				bError = true;
+				return 0;
+			}
+			return Bytes[Offset++];
+		}
+
+		uint64 ReadVarint()
+		{
+			uint64 Value = 0;
+			for (int32 Shift = 0; Shift < 64 && !bError; Shift += 7)
+			{
+				const uint8 Byte = ReadByte();
+				Value |= uint64(Byte & 0x7F) << Shift;
+				if ((Byte & 0x80) == 0)
+				{
+					return Value;
+				}
+			}
+			bError = true;
+			return 0;
+		}
+
+		int64 ReadSignedVarint()
+		{
+			const uint64 Value = ReadVarint();
+			return int64(Value >> 1) ^ -int64(Value & 1);
+		}
+	};
+}
+
+uint32 StrategyFixed::Sqrt(uint64 Value)
+{
+	uint64 Result = 0;
+	uint64 Bit = uint64(1) << 62;
+	while (Bit > Value)
+	{
+		Bit >>= 2;
+	}
+	while (Bit != 0)
+	{
+		if (Value >= Result + Bit)
+		{
+			Value -= Result + Bit;
+			Result = (Result >> 1) + Bit;
+		}
+		else
+		{
+			Result >>= 1;
+		}
+		Bit >>= 2;
+	}
+	return uint32(Result);
+}
+
+// --- Packet ---
+void FStrategyLockstepPacket::Serialize(TArray<uint8>& OutBytes) const
+{
+	using namespace StrategyLockstep;
+
+	OutBytes.Reset();
+	WriteVarint(OutBytes, Turn);
+	OutBytes.Add(Player);
+	// 0 when there is no checksum yet, else how many turns back it is.
+	WriteVarint(OutBytes, ChecksumTurn == MAX_uint32 ? 0 : uint64(Turn - ChecksumTurn));
+	for (int32 Byte = 0; Byte < int32(sizeof(Checksum)); ++Byte)
+	{
+		OutBytes.Add(uint8(Checksum >> (Byte * 8)));
+	}
+	WriteVarint(OutBytes, Commands.Num());
+
+	for (const FStrategyLockstepCommand& Command : Commands)
+	{
+		OutBytes.Add(uint8(Command.Type));
+		switch (Command.Type)
+		{
+		case EStrategyLockstepCommandType::Select:
+		{
+			WriteVarint(OutBytes, Command.Units.Num());
+			int32 Previous = 0;
+			for (const int32 Unit : Command.Units)
+			{
+				WriteVarint(OutBytes, uint32(Unit - Previous));
+				Previous = Unit;
+			}
+			break;
+		}
+		case EStrategyLockstepCommandType::Move:
+			WriteSignedVarint(OutBytes, Command.Target.X);
+			WriteSignedVarint(OutBytes, Command.Target.Y);
+			WriteVarint(OutBytes, uint32(FMath::Max(Command.Spacing, 0)));
+			break;
+		}
+	}
+}
+
+bool FStrategyLockstepPacket::Deserialize(TConstArrayView<uint8> Bytes)
+{
+	using namespace StrategyLockstep;
+
+	FReader Reader{Bytes};
+	Turn = uint32(Reader.ReadVarint());
+	Player = Reader.ReadByte();
+	const uint64 ChecksumDistance = Reader.ReadVarint();
+	ChecksumTurn = ChecksumDistance == 0 || ChecksumDistance > Turn ? MAX_uint32 : uint32(Turn - ChecksumDistance);
+	Checksum = 0;
+	for (int32 Byte = 0; Byte < int32(sizeof(Checksum)); ++Byte)
+	{
+		Checksum |= uint32(Reader.ReadByte()) << (Byte * 8);
+	}
+
+	// Every command takes at least a byte, so larger counts are corrupt rather than a reason to allocate.
+	const uint64 NumCommands = Reader.ReadVarint();
+	if (Reader.bError || NumCommands > uint64(Reader.GetRemaining()))
+	{
+		return false;
+	}
+
+	Commands.Reset();
+	Commands.SetNum(int32(NumCommands));
+	for (FStrategyLockstepCommand& Command : Commands)
+	{
+		Command.Player = Player;
+		const uint8 Type = Reader.ReadByte();
+		if (Type == uint8(EStrategyLockstepCommandType::Select))
+		{
+			Command.Type = EStrategyLockstepCommandType::Select;
+			const uint64 NumUnits = Reader.ReadVarint();
+			if (Reader.bError || NumUnits > uint64(Reader.GetRemaining()))
+			{
+				return false;
+			}
+			Command.Units.SetNumUninitialized(int32(NumUnits));
+			int64 Unit = 0;
+			for (int32& OutUnit : Command.Units)
+			{
+				Unit += int64(Reader.ReadVarint());
+				OutUnit = int32(FMath::Min<int64>(Unit, MAX_int32));
+			}
+		}
+		else if (Type == uint8(EStrategyLockstepCommandType::Move))
+		{
+			Command.Type = EStrategyLockstepCommandType::Move;
+			Command.Target.X = int32(Reader.ReadSignedVarint());
+			Command.Target.Y = int32(Reader.ReadSignedVarint());
+			Command.Spacing = int32(FMath::Min<uint64>(Reader.ReadVarint(), MAX_int32));
+		}
+		else
+		{
+			return false;
+		}
+
+		if (Reader.bError)
+		{
+			return false;
+		}
+	}
+
+	return Reader.GetRemaining() == 0;
+}
+
+// --- Simulation ---
+void FStrategyLockstepSim::Reset(TConstArrayView<FVector> Locations, int32 NumPlayers, float UnitSpeed, float TickRate)
+{
+	Positions.Reset(Locations.Num());
+	for (const FVector& Location : Locations)
+	{
+		Positions.Add(StrategyFixed::FromLocation(Location));
+	}
+	Targets = Positions;
+	Moving.Init(false, Positions.Num());
+	MovingUnits.Reset();
+	Selections.Reset();
+	Selections.SetNum(FMath::Max(NumPlayers, 1));
+	StepPerTick = FMath::Max(StrategyFixed::FromCm(UnitSpeed / FMath::Max(TickRate, 1.f)), 1);
+	NumTicks = 0;
+}
+
+void FStrategyLockstepSim::ApplyCommand(const FStrategyLockstepCommand& Command)
+{
+	if (!Selections.IsValidIndex(Command.Player))
+	{
+		return;
+	}
+
+	TArray<int32>& Selection = Selections[Command.Player];
+	switch (Command.Type)
+	{
+	case EStrategyLockstepCommandType::Select:
+		Selection.Reset(Command.Units.Num());
+		for (const int32 Unit : Command.Units)
+		{
+			if (Positions.IsValidIndex(Unit) && (Selection.IsEmpty() || Unit > Selection.Last()))
+			{
+				Selection.Add(Unit);
+			}
+		}
+		break;
+
+	case EStrategyLockstepCommandType::Move:
+	{
+		// Same slot layout as UStrategyUnitSimulationSubsystem::MoveUnits, in integers: slot I of a GridSide-wide grid is
+		// (2 * column - (GridSide - 1)) * Spacing / 2 from the target.
+		int32 GridSide = int32(StrategyFixed::Sqrt(uint64(Selection.Num())));
+		GridSide += GridSide * GridSide < Selection.Num() ? 1 : 0;
+		GridSide = FMath::Max(GridSide, 1);
+		for (int32 Slot = 0; Slot < Selection.Num(); ++Slot)
+		{
+			const int32 Unit = Selection[Slot];
+			const int64 OffsetX = (2 * int64(Slot % GridSide) - (GridSide - 1)) * Command.Spacing / 2;
+			const int64 OffsetY = (2 * int64(Slot / GridSide) - (GridSide - 1)) * Command.Spacing / 2;
+			Targets[Unit] = FIntPoint(int32(Command.Target.X + OffsetX), int32(Command.Target.Y + OffsetY));
+			if (!Moving[Unit])
+			{
+				Moving[Unit] = true;
+				MovingUnits.Add(Unit);
+			}
+		}
+		MovingUnits.Sort();
+		break;
+	}
+	}
+}
+
+void FStrategyLockstepSim::Tick()
+{
+	++NumTicks;
+
+	bool bAnyArrived = false;
+	for (const int32 Unit : MovingUnits)
+	{
+		FIntPoint& Position = Positions[Unit];
+		const FIntPoint& Target = Targets[Unit];
+		const int64 DeltaX = int64(Target.X) - Position.X;
+		const int64 DeltaY = int64(Target.Y) - Position.Y;
+		const uint32 Distance = StrategyFixed::Sqrt(uint64(DeltaX * DeltaX) + uint64(DeltaY * DeltaY));
+		if (Distance <= uint32(StepPerTick))
+		{
+			Position = Target;
+			Moving[Unit] = false;
+			bAnyArrived = true;
+			continue;
+		}
+
+		// Integer division truncates towards zero everywhere, so this is the same on every peer.
+		Position.X += int32(DeltaX * StepPerTick / Distance);
+		Position.Y += int32(DeltaY * StepPerTick / Distance);
+	}
+
+	if (bAnyArrived)
+	{
+		MovingUnits.RemoveAll([this](int32 Unit) { return !Moving[Unit]; });
+	}
+}
+
+uint32 FStrategyLockstepSim::ComputeChecksum() const
+{
+	uint32 Crc = FCrc::MemCrc32(&NumTicks, sizeof(NumTicks));
+	Crc = FCrc::MemCrc32(Positions.GetData(), Positions.Num() * sizeof(FIntPoint), Crc);
+	Crc = FCrc::MemCrc32(Targets.GetData(), Targets.Num() * sizeof(FIntPoint), Crc);
+	Crc = FCrc::MemCrc32(MovingUnits.GetData(), MovingUnits.Num() * sizeof(int32), Crc);
+	for (const TArray<int32>& Selection : Selections)
+	{
+		Crc = FCrc::MemCrc32(Selection.GetData(), Selection.Num() * sizeof(int32), Crc);
+	}
+	return Crc;
+}
+
+// --- Loopback ---
+FStrategyLockstepLoopback::FStrategyLockstepLoopback(int32 NumPlayers, double InLatency)
+	: Latency(FMath::Max(InLatency, 0.0))
+{
+	Queues.SetNum(NumPlayers);
+}
+
+void FStrategyLockstepLoopback::Send(uint8 FromPlayer, TConstArrayView<uint8> Bytes, double Now)
+{
+	for (int32 Player = 0; Player < Queues.Num(); ++Player)
+	{
+		if (Player != FromPlayer)
+		{
+			Queues[Player].Add(FInFlight{Now + Latency, TArray<uint8>(Bytes)});
+		}
+	}
+}
+
+bool FStrategyLockstepLoopback::Receive(uint8 Player, double Now, TArray<uint8>& OutBytes)
+{
+	if (!Queues.IsValidIndex(Player) || Queues[Player].IsEmpty() || Queues[Player][0].DeliverAt > Now)
+	{
+		return false;
+	}
+
+	OutBytes = MoveTemp(Queues[Player][0].Bytes);
+	Queues[Player].RemoveAt(0, EAllowShrinking::No);
+	return true;
+}
+
+// --- Peer ---
+void FStrategyLockstepPeer::Start(const FStrategyLockstepSettings& InSettings, TConstArrayView<FVector> UnitLocations, double Now)
+{
+	Settings = InSettings;
+	Settings.NumPlayers = FMath::Clamp(Settings.NumPlayers, 1, MaxPlayers);
+	Settings.TurnSeconds = FMath::Max(Settings.TurnSeconds, 0.001f);
+	// A turn's own packet has to be sent before the turn is due.
+	Settings.InputDelayTurns = FMath::Max(Settings.InputDelayTurns, 1);
+	Settings.SimTicksPerTurn = FMath::Max(Settings.SimTicksPerTurn, 1);
+
+	Sim.Reset(UnitLocations, Settings.NumPlayers, Settings.UnitSpeed, Settings.SimTicksPerTurn / Settings.TurnSeconds);
+	StartTime = Now;
+	NextSendTurn = 0;
+	NextTurn = 0;
+	PendingCommands.Reset();
+	PendingCommandTimes.Reset();
+	SentIssueTimes.Reset();
+	Slots.Reset();
+	ChecksumsByTurn.Init(0, ChecksumHistory);
+	DeferredChecksums.Reset();
+	DesyncTurn = MAX_uint32;
+	Metrics = FStrategyLockstepMetrics();
+}
+
+void FStrategyLockstepPeer::QueueCommand(FStrategyLockstepCommand Command, double Now)
+{
+	Command.Player = Settings.LocalPlayer;
+	PendingCommands.Add(MoveTemp(Command));
+	PendingCommandTimes.Add(Now);
+}
+
+void FStrategyLockstepPeer::Update(double Now, IStrategyLockstepTransport& Transport)
+{
+	while (Transport.Receive(Settings.LocalPlayer, Now, ScratchBytes))
+	{
+		FStrategyLockstepPacket Packet;
+		if (Packet.Deserialize(ScratchBytes))
+		{
+			ReceivePacket(MoveTemp(Packet));
+		}
+		else
+		{
+			UE_LOG(LogStrategyUnits, Warning, TEXT("[LOCKSTEP] Player %d dropped a malformed packet (%d bytes)."), Settings.LocalPlayer, ScratchBytes.Num());
+		}
+	}
+
+	// Commands issued during turn K go out at its end, for execution InputDelayTurns later. A peer doesn't send further
+	// ahead of its own execution than that, so a stalled session queues commands instead of scheduling them far out.
+	while (NextSendTurn <= NextTurn + Settings.InputDelayTurns
+		&& Now >= StartTime + (double(NextSendTurn) - Settings.InputDelayTurns + 1) * Settings.TurnSeconds)
+	{
+		SendTurn(NextSendTurn++, Now, Transport);
+	}
+
+	while (TryExecuteTurn(Now))
+	{
+	}
+}
+
+bool FStrategyLockstepPeer::GetTurnChecksum(uint32 Turn, uint32& OutChecksum) const
+{
+	if (Turn >= NextTurn || Turn + ChecksumHistory < NextTurn)
+	{
+		return false;
+	}
+	OutChecksum = ChecksumsByTurn[Turn % ChecksumHistory];
+	return true;
+}
+
+FStrategyLockstepPeer::FTurnSlot& FStrategyLockstepPeer::GetSlot(uint32 Turn)
+{
+	FTurnSlot& Slot = Slots.FindOrAdd(Turn);
+	if (Slot.Packets.IsEmpty())
+	{
+		Slot.Packets.SetNum(Settings.NumPlayers);
+	}
+	return Slot;
+}
+
+void FStrategyLockstepPeer::ReceivePacket(FStrategyLockstepPacket&& Packet)
+{
+	if (Packet.Player >= Settings.NumPlayers || Packet.Turn < NextTurn)
+	{
+		return;
+	}
+
+	if (Packet.ChecksumTurn != MAX_uint32)
+	{
+		CheckRemoteChecksum(Packet.Player, Packet.ChecksumTurn, Packet.Checksum);
+	}
+
+	FTurnSlot& Slot = GetSlot(Packet.Turn);
+	const uint32 PlayerBit = 1u << Packet.Player;
+	if ((Slot.ReceivedMask & PlayerBit) == 0)
+	{
+		Slot.ReceivedMask |= PlayerBit;
+		Slot.Packets[Packet.Player] = MoveTemp(Packet);
+	}
+}
+
+void FStrategyLockstepPeer::CheckRemoteChecksum(uint8 Player, uint32 Turn, uint32 Checksum)
+{
+	if (Turn >= NextTurn)
+	{
+		DeferredChecksums.Emplace(Player, Turn, Checksum);
+		return;
+	}
+
+	if (Turn + ChecksumHistory < NextTurn || IsDesynced())
+	{
+		return;
+	}
+
+	const uint32 LocalChecksum = ChecksumsByTurn[Turn % ChecksumHistory];
+	if (LocalChecksum != Checksum)
+	{
+		DesyncTurn = Turn;
+		UE_LOG(LogStrategyUnits, Error, TEXT("[LOCKSTEP] Player %d desynced from player %d at turn %u (checksum %08x, theirs %08x)."),
+			Settings.LocalPlayer, Player, Turn, LocalChecksum, Checksum);
+	}
+}
+
+void FStrategyLockstepPeer::SendTurn(uint32 Turn, double Now, IStrategyLockstepTransport& Transport)
+{
+	FStrategyLockstepPacket Packet;
+	Packet.Turn = Turn;
+	Packet.Player = Settings.LocalPlayer;
+	if (NextTurn > 0)
+	{
+		Packet.ChecksumTurn = NextTurn - 1;
+		Packet.Checksum = ChecksumsByTurn[Packet.ChecksumTurn % ChecksumHistory];
+	}
+	Packet.Commands = MoveTemp(PendingCommands);
+	PendingCommands.Reset();
+
+	Packet.Serialize(ScratchBytes);
+	Transport.Send(Settings.LocalPlayer, ScratchBytes, Now);
+
+	++Metrics.PacketsSent;
+	Metrics.BytesSent += ScratchBytes.Num();
+	Metrics.CommandsSent += Packet.Commands.Num();
+	Metrics.LastPacketBytes = ScratchBytes.Num();
+	Metrics.MaxPacketBytes = FMath::Max(Metrics.MaxPacketBytes, ScratchBytes.Num());
+
+	if (!PendingCommandTimes.IsEmpty())
+	{
+		SentIssueTimes.Add(Turn, MoveTemp(PendingCommandTimes));
+		PendingCommandTimes.Reset();
+	}
+
+	FTurnSlot& Slot = GetSlot(Turn);
+	Slot.ReceivedMask |= 1u << Settings.LocalPlayer;
+	Slot.Packets[Settings.LocalPlayer] = MoveTemp(Packet);
+}
+
+bool FStrategyLockstepPeer::TryExecuteTurn(double Now)
+{
+	if (Now < StartTime + double(NextTurn) * Settings.TurnSeconds)
+	{
+		return false;
+	}
+
+	const uint32 AllPlayers = Settings.NumPlayers == 32 ? MAX_uint32 : (1u << Settings.NumPlayers) - 1;
+	FTurnSlot* Slot = Slots.Find(NextTurn);
+	if (!Slot || Slot->ReceivedMask != AllPlayers)
+	{
+		++Metrics.StalledUpdates;
+		return false;
+	}
+
+	// Player order, then send order: the same on every peer.
+	for (const FStrategyLockstepPacket& Packet : Slot->Packets)
+	{
+		for (const FStrategyLockstepCommand& Command : Packet.Commands)
+		{
+			Sim.ApplyCommand(Command);
+			if (OnCommandExecuted)
+			{
+				OnCommandExecuted(Command);
+			}
+		}
+	}
+	for (int32 Tick = 0; Tick < Settings.SimTicksPerTurn; ++Tick)
+	{
+		Sim.Tick();
+	}
+
+	ChecksumsByTurn[NextTurn % ChecksumHistory] = Sim.ComputeChecksum();
+	if (TArray<double>* IssueTimes = SentIssueTimes.Find(NextTurn))
+	{
+		for (const double IssueTime : *IssueTimes)
+		{
+			Metrics.CommandLatencies.Add(Now - IssueTime);
+		}
+		SentIssueTimes.Remove(NextTurn);
+		if (Metrics.CommandLatencies.Num() > MaxLatencySamples)
+		{
+			Metrics.CommandLatencies.RemoveAt(0, Metrics.CommandLatencies.Num() - MaxLatencySamples, EAllowShrinking::No);
+		}
+	}
+
+	Slots.Remove(NextTurn);
+	++NextTurn;
+	++Metrics.TurnsExecuted;
+
+	for (int32 Index = DeferredChecksums.Num() - 1; Index >= 0; --Index)
+	{
+		const TTuple<uint8, uint32, uint32> Deferred = DeferredChecksums[Index];
+		if (Deferred.Get<1>() < NextTurn)
+		{
+			DeferredChecksums.RemoveAtSwap(Index, EAllowShrinking::No);
+			CheckRemoteChecksum(Deferred.Get<0>(), Deferred.Get<1>(), Deferred.Get<2>());
+		}
+	}
+	return true;
+}
@@ -0,0 +1,139 @@
+// StrategyLockstepSubsystem.cpp
+#include "StrategyLockstepSubsystem.h"
+#include "StrategyUnitSimulationSubsystem.h"
+#include "MyProject2.h"
+
+DECLARE_CYCLE_STAT(TEXT("Lockstep Update"), STAT_StrategyLockstepUpdate, STATGROUP_StrategyUnits);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Lockstep Bytes Sent"), STAT_StrategyLockstepBytesSent, STATGROUP_StrategyUnits);
+
+void UStrategyLockstepSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Simulation = Collection.InitializeDependency<UStrategyUnitSimulationSubsystem>();
+	Super::Initialize(Collection);
+}
+
+void UStrategyLockstepSubsystem::Deinitialize()
+{
+	// The simulation tears down with the world; its units go with it.
+	Transport.Reset();
+	Peer.OnCommandExecuted = nullptr;
+	UnitHandles.Reset();
+	UnitIds.Reset();
+
+	Super::Deinitialize();
+}
+
+void UStrategyLockstepSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!Transport.IsValid())
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_StrategyLockstepUpdate);
+	const uint64 BytesBefore = Peer.GetMetrics().BytesSent;
+	Peer.Update(FPlatformTime::Seconds(), *Transport);
+	INC_DWORD_STAT_BY(STAT_StrategyLockstepBytesSent, uint32(Peer.GetMetrics().BytesSent - BytesBefore));
+}
+
+TStatId UStrategyLockstepSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyLockstepSubsystem, STATGROUP_Tickables);
+}
+
+// --- SESSION ---
+void UStrategyLockstepSubsystem::StartSession(const FStrategyLockstepSettings& Settings, TSharedRef<IStrategyLockstepTransport> InTransport, TConstArrayView<FVector> UnitLocations)
+{
+	EndSession();
+
+	UnitHandles.Reset(UnitLocations.Num());
+	Simulation->SpawnUnits(UnitLocations, &UnitHandles);
+	check(UnitHandles.Num() == UnitLocations.Num());
+	UnitIds.Reserve(UnitHandles.Num());
+	for (int32 Unit = 0; Unit < UnitHandles.Num(); ++Unit)
+	{
+		UnitIds.Add(UnitHandles[Unit], Unit);
+	}
+
+	Transport = InTransport;
+	SentSelection.Reset();
+	Peer.Start(Settings, UnitLocations, FPlatformTime::Seconds());
+	Peer.OnCommandExecuted = [this](const FStrategyLockstepCommand& Command) { PresentCommand(Command); };
+
+	UE_LOG(LogStrategyUnits, Log, TEXT("[LOCKSTEP] Session started: player %d of %d, %d units, %.0f ms turns, %d turns input delay."),
+		Settings.LocalPlayer, Settings.NumPlayers, UnitHandles.Num(), Settings.TurnSeconds * 1000.f, Settings.InputDelayTurns);
+}
+
+void UStrategyLockstepSubsystem::EndSession()
+{
+	if (!Transport.IsValid())
+	{
+		return;
+	}
+
+	const FStrategyLockstepMetrics& Metrics = Peer.GetMetrics();
+	UE_LOG(LogStrategyUnits, Log, TEXT("[LOCKSTEP] Session ended after %llu turns: %llu bytes in %llu packets, %llu commands%s."),
+		Metrics.TurnsExecuted, Metrics.BytesSent, Metrics.PacketsSent, Metrics.CommandsSent, Peer.IsDesynced() ? TEXT(", DESYNCED") : TEXT(""));
+
+	Transport.Reset();
+	Peer.OnCommandExecuted = nullptr;
+	// Only the session's units; others in the world (spawned before or outside the session) stay.
+	Simulation->DestroyUnits(UnitHandles);
+	UnitHandles.Reset();
+	UnitIds.Reset();
+	SentSelection.Reset();
+}
+
+// --- COMMANDS ---
+int32 UStrategyLockstepSubsystem::IssueMoveOrder(TConstArrayView<FStrategyUnitHandle> Units, const FVector& Destination, float Spacing)
+{
+	if (!Transport.IsValid())
+	{
+		return 0;
+	}
+
+	ScratchSelection.Reset(Units.Num());
+	for (const FStrategyUnitHandle& Unit : Units)
+	{
+		if (const int32* Id = UnitIds.Find(Unit))
+		{
+			ScratchSelection.Add(*Id);
+		}
+	}
+	ScratchSelection.Sort();
+
+	const double Now = FPlatformTime::Seconds();
+	if (ScratchSelection != SentSelection)
+	{
+		SentSelection = ScratchSelection;
+		FStrategyLockstepCommand Select;
+		Select.Type = EStrategyLockstepCommandType::Select;
+		Select.Units = SentSelection;
+		Peer.QueueCommand(MoveTemp(Select), Now);
+	}
+
+	FStrategyLockstepCommand Move;
+	Move.Type = EStrategyLockstepCommandType::Move;
+	Move.Target = StrategyFixed::FromLocation(Destination);
+	Move.Spacing = StrategyFixed::FromCm(Spacing);
+	Peer.QueueCommand(MoveTemp(Move), Now);
+	return SentSelection.Num();
+}
+
+void UStrategyLockstepSubsystem::PresentCommand(const FStrategyLockstepCommand& Command)
+{
+	if (Command.Type != EStrategyLockstepCommandType::Move)
+	{
+		return;
+	}
+
+	// Same destination and spacing as the lockstep simulation; the Mass units lay out the same grid slots.
+	ScratchHandles.Reset();
+	for (const int32 Unit : Peer.GetSim().GetSelection(Command.Player))
+	{
+		ScratchHandles.Add(UnitHandles[Unit]);
+	}
+	Simulation->MoveUnits(ScratchHandles, StrategyFixed::ToLocation(Command.Target), float(StrategyFixed::ToCm(Command.Spacing)));
+}
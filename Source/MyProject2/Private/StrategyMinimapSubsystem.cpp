@@ -0,0 +1,485 @@
+// StrategyMinimapSubsystem.cpp
+#include "StrategyMinimapSubsystem.h"
+#include "StrategyUnitRegistrySubsystem.h"
+#include "StrategyFogOfWarSubsystem.h"
+#include "StrategyCameraPawn.h"
+#include "MyProject2.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/Level.h"
+#include "Engine/Texture2D.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/SpringArmComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Minimap Update"), STAT_StrategyMinimapUpdate, STATGROUP_StrategyUnits);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Minimap Blocks Uploaded"), STAT_StrategyMinimapBlocks, STATGROUP_StrategyUnits);
+
+namespace StrategyMinimap
+{
+	FColor Scale(const FColor& Color, float Brightness)
+	{
+		return FColor(uint8(Color.R * Brightness), uint8(Color.G * Brightness), uint8(Color.B * Brightness), Color.A);
+	}
+}
+
+void UStrategyMinimapSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Registry = Collection.InitializeDependency<UStrategyUnitRegistrySubsystem>();
+	FogOfWar = Collection.InitializeDependency<UStrategyFogOfWarSubsystem>();
+	Super::Initialize(Collection);
+
+	// Streamed-in or streamed-out cells change the terrain under the base layer.
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UStrategyMinimapSubsystem::OnLevelChanged);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UStrategyMinimapSubsystem::OnLevelChanged);
+
+	Configure(Settings);
+}
+
+void UStrategyMinimapSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	MinimapTexture = nullptr;
+	BasePixels.Empty();
+	Pixels.Empty();
+
+	Super::Deinitialize();
+}
+
+void UStrategyMinimapSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (MinimapTexture)
+	{
+		UpdateMinimap();
+	}
+}
+
+TStatId UStrategyMinimapSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyMinimapSubsystem, STATGROUP_Tickables);
+}
+
+void UStrategyMinimapSubsystem::Configure(const FStrategyMinimapSettings& InSettings)
+{
+	Settings = InSettings;
+	Settings.BlockSize = FMath::Max(Settings.BlockSize, 4);
+	Resolution = Align(FMath::Max(Settings.Resolution, Settings.BlockSize), Settings.BlockSize);
+	BlocksPerSide = Resolution / Settings.BlockSize;
+	const FVector2D WorldSize = (Settings.WorldMax - Settings.WorldMin).ComponentMax(FVector2D(1.0));
+	PixelsPerCm = FVector2D(Resolution) / WorldSize;
+
+	const int32 NumBlocks = BlocksPerSide * BlocksPerSide;
+	BasePixels.SetNumZeroed(Resolution * Resolution);
+	Pixels.SetNumZeroed(Resolution * Resolution);
+	DirtyBlocks.SetNumZeroed(NumBlocks);
+	BlockUnitPixels.SetNum(NumBlocks);
+	BlockUnitHashes.SetNumZeroed(NumBlocks);
+	BlockFogRevisions.SetNumZeroed(NumBlocks);
+	BlockFootprintPixels.SetNum(NumBlocks);
+	bHasFootprint = false;
+	bBaseDirty = true;
+	bRedrawAll = true;
+
+	if (MinimapTexture && (MinimapTexture->GetSizeX() != Resolution || MinimapTexture->GetSizeY() != Resolution))
+	{
+		// Recreated at the new size on next use.
+		MinimapTexture = nullptr;
+	}
+}
+
+void UStrategyMinimapSubsystem::OnLevelChanged(ULevel* Level, UWorld* World)
+{
+	if (World == GetWorld())
+	{
+		bBaseDirty = true;
+	}
+}
+
+// --- COORDINATES ---
+FVector UStrategyMinimapSubsystem::MinimapToWorld(const FVector2D& UV) const
+{
+	const FVector2D Location = Settings.WorldMin + (Settings.WorldMax - Settings.WorldMin) * UV;
+	return FVector(Location.X, Location.Y, 0.0);
+}
+
+FVector2D UStrategyMinimapSubsystem::WorldToMinimap(const FVector& Location) const
+{
+	return (FVector2D(Location) - Settings.WorldMin) / (Settings.WorldMax - Settings.WorldMin).ComponentMax(FVector2D(1.0));
+}
+
+FIntPoint UStrategyMinimapSubsystem::WorldToPixel(double X, double Y) const
+{
+	return FIntPoint(FMath::FloorToInt32((X - Settings.WorldMin.X) * PixelsPerCm.X), FMath::FloorToInt32((Y - Settings.WorldMin.Y) * PixelsPerCm.Y));
+}
+
+void UStrategyMinimapSubsystem::MarkBlocksDirty(const FIntPoint& PixelMin, const FIntPoint& PixelMax)
+{
+	const int32 MinX = FMath::Clamp(PixelMin.X, 0, Resolution - 1) / Settings.BlockSize;
+	const int32 MinY = FMath::Clamp(PixelMin.Y, 0, Resolution - 1) / Settings.BlockSize;
+	const int32 MaxX = FMath::Clamp(PixelMax.X, 0, Resolution - 1) / Settings.BlockSize;
+	const int32 MaxY = FMath::Clamp(PixelMax.Y, 0, Resolution - 1) / Settings.BlockSize;
+	for (int32 BlockY = MinY; BlockY <= MaxY; ++BlockY)
+	{
+		for (int32 BlockX = MinX; BlockX <= MaxX; ++BlockX)
+		{
+			DirtyBlocks[BlockY * BlocksPerSide + BlockX] = true;
+		}
+	}
+}
+
+// --- BASE LAYER ---
+void UStrategyMinimapSubsystem::RasterizeBase()
+{
+	// Highest geometry top per pixel; -UE_MAX_FLT where nothing blocks.
+	TArray<float> Heights;
+	Heights.Init(-UE_MAX_FLT, Resolution * Resolution);
+
+	int32 NumPrimitives = 0;
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		// Pawns and units move; the base only shows what the ground traces would hit.
+		if (It->IsA<APawn>())
+		{
+			continue;
+		}
+
+		It->ForEachComponent<UPrimitiveComponent>(false, [this, &Heights, &NumPrimitives](const UPrimitiveComponent* Primitive)
+		{
+			if (!Primitive->IsRegistered() || !Primitive->IsQueryCollisionEnabled() || Primitive->GetCollisionResponseToChannel(ECC_Visibility) != ECR_Block)
+			{
+				return;
+			}
+
+			const FBox Bounds = Primitive->Bounds.GetBox();
+			const FIntPoint Min = WorldToPixel(Bounds.Min.X, Bounds.Min.Y).ComponentMax(FIntPoint(0, 0));
+			const FIntPoint Max = WorldToPixel(Bounds.Max.X, Bounds.Max.Y).ComponentMin(FIntPoint(Resolution - 1, Resolution - 1));
+			const float Top = float(Bounds.Max.Z);
+			for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+			{
+				float* Row = &Heights[Y * Resolution];
+				for (int32 X = Min.X; X <= Max.X; ++X)
+				{
+					Row[X] = FMath::Max(Row[X], Top);
+				}
+			}
+			++NumPrimitives;
+		});
+	}
+
+	const float HeightRange = FMath::Max(Settings.HighHeight - Settings.LowHeight, 1.f);
+	for (int32 Index = 0; Index < Heights.Num(); ++Index)
+	{
+		if (Heights[Index] == -UE_MAX_FLT)
+		{
+			BasePixels[Index] = Settings.EmptyColor;
+			continue;
+		}
+		const float Alpha = FMath::Clamp((Heights[Index] - Settings.LowHeight) / HeightRange, 0.f, 1.f);
+		BasePixels[Index] = FColor(
+			uint8(FMath::Lerp(float(Settings.LowColor.R), float(Settings.HighColor.R), Alpha)),
+			uint8(FMath::Lerp(float(Settings.LowColor.G), float(Settings.HighColor.G), Alpha)),
+			uint8(FMath::Lerp(float(Settings.LowColor.B), float(Settings.HighColor.B), Alpha)));
+	}
+
+	UE_LOG(LogStrategyUnits, Log, TEXT("[MINIMAP] Rasterized the base layer from %d primitives."), NumPrimitives);
+}
+
+// --- DIRTY TRACKING ---
+void UStrategyMinimapSubsystem::GatherUnits()
+{
+	for (TArray<int32>& UnitPixels : BlockUnitPixels)
+	{
+		UnitPixels.Reset();
+	}
+	if (!Registry)
+	{
+		return;
+	}
+
+	const TConstArrayView<double> PositionsX = Registry->GetUnitPositionsX();
+	const TConstArrayView<double> PositionsY = Registry->GetUnitPositionsY();
+	for (int32 Index = 0; Index < PositionsX.Num(); ++Index)
+	{
+		const FIntPoint Pixel = WorldToPixel(PositionsX[Index], PositionsY[Index]);
+		if (Pixel.X < 0 || Pixel.Y < 0 || Pixel.X >= Resolution || Pixel.Y >= Resolution)
+		{
+			continue;
+		}
+		const int32 Block = (Pixel.Y / Settings.BlockSize) * BlocksPerSide + Pixel.X / Settings.BlockSize;
+		BlockUnitPixels[Block].Add(Pixel.Y * Resolution + Pixel.X);
+	}
+
+	// Units moving within a pixel, or not at all, leave their block's hash as it was.
+	for (int32 Block = 0; Block < BlockUnitPixels.Num(); ++Block)
+	{
+		uint32 Hash = 2166136261u;
+		for (const int32 PixelIndex : BlockUnitPixels[Block])
+		{
+			Hash = (Hash ^ uint32(PixelIndex + 1)) * 16777619u;
+		}
+		if (Hash != BlockUnitHashes[Block])
+		{
+			BlockUnitHashes[Block] = Hash;
+			DirtyBlocks[Block] = true;
+		}
+	}
+}
+
+void UStrategyMinimapSubsystem::GatherFogOfWar()
+{
+	if (!FogOfWar || !Settings.bApplyFogOfWar)
+	{
+		return;
+	}
+
+	const FStrategyFogOfWarGrid& FogGrid = FogOfWar->GetGrid();
+	const double FogTileSize = FogGrid.CellSize * UStrategyFogOfWarSubsystem::TileSize;
+	const FVector2D BlockWorldSize = FVector2D(Settings.BlockSize) / PixelsPerCm;
+	for (int32 BlockY = 0; BlockY < BlocksPerSide; ++BlockY)
+	{
+		for (int32 BlockX = 0; BlockX < BlocksPerSide; ++BlockX)
+		{
+			// Fog tiles under the block's world rectangle.
+			const FVector2D BlockMin = Settings.WorldMin + BlockWorldSize * FVector2D(BlockX, BlockY) - FogGrid.Origin;
+			const FVector2D BlockMax = BlockMin + BlockWorldSize;
+			const int32 MinTileX = FMath::Max(FMath::FloorToInt32(BlockMin.X / FogTileSize), 0);
+			const int32 MinTileY = FMath::Max(FMath::FloorToInt32(BlockMin.Y / FogTileSize), 0);
+			const int32 MaxTileX = FMath::Min(FMath::FloorToInt32(BlockMax.X / FogTileSize), FogOfWar->GetNumTilesX() - 1);
+			const int32 MaxTileY = FMath::Min(FMath::FloorToInt32(BlockMax.Y / FogTileSize), FogOfWar->GetNumTilesY() - 1);
+
+			uint32 Revision = 0;
+			for (int32 TileY = MinTileY; TileY <= MaxTileY; ++TileY)
+			{
+				for (int32 TileX = MinTileX; TileX <= MaxTileX; ++TileX)
+				{
+					Revision += FogOfWar->GetTileRevision(TileX, TileY);
+				}
+			}
+
+			const int32 Block = BlockY * BlocksPerSide + BlockX;
+			if (Revision != BlockFogRevisions[Block])
+			{
+				BlockFogRevisions[Block] = Revision;
+				DirtyBlocks[Block] = true;
+			}
+		}
+	}
+}
+
+void UStrategyMinimapSubsystem::GatherFootprint()
+{
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	const AStrategyCameraPawn* CameraPawn = PlayerController ? Cast<AStrategyCameraPawn>(PlayerController->GetPawn()) : nullptr;
+	const USpringArmComponent* CameraBoom = CameraPawn ? CameraPawn->GetCameraBoom() : nullptr;
+
+	FIntPoint Corners[4];
+	const bool bHasNewFootprint = CameraBoom != nullptr;
+	if (bHasNewFootprint)
+	{
+		const FStrategyGroundFootprint Footprint = CameraPawn->ComputeGroundFootprint(CameraPawn->GetActorLocation(), CameraBoom->TargetArmLength, CameraBoom->GetRelativeRotation().Pitch);
+		for (int32 Index = 0; Index < 4; ++Index)
+		{
+			Corners[Index] = WorldToPixel(Footprint.Corners[Index].X, Footprint.Corners[Index].Y);
+		}
+	}
+
+	if (bHasNewFootprint == bHasFootprint && (!bHasFootprint || FMemory::Memcmp(Corners, FootprintCorners, sizeof(Corners)) == 0))
+	{
+		return;
+	}
+
+	auto MarkOutline = [this](const FIntPoint (&Outline)[4])
+	{
+		FIntPoint Min = Outline[0];
+		FIntPoint Max = Outline[0];
+		for (const FIntPoint& Corner : Outline)
+		{
+			Min = Min.ComponentMin(Corner);
+			Max = Max.ComponentMax(Corner);
+		}
+		if (Max.X >= 0 && Max.Y >= 0 && Min.X < Resolution && Min.Y < Resolution)
+		{
+			MarkBlocksDirty(Min, Max);
+		}
+	};
+
+	if (bHasFootprint)
+	{
+		MarkOutline(FootprintCorners);
+	}
+	for (TArray<int32>& FootprintPixels : BlockFootprintPixels)
+	{
+		FootprintPixels.Reset();
+	}
+
+	bHasFootprint = bHasNewFootprint;
+	if (!bHasFootprint)
+	{
+		return;
+	}
+	FMemory::Memcpy(FootprintCorners, Corners, sizeof(Corners));
+	MarkOutline(FootprintCorners);
+
+	// Bresenham along the four edges, keeping the pixels on the map.
+	for (int32 Edge = 0; Edge < 4; ++Edge)
+	{
+		FIntPoint Pixel = FootprintCorners[Edge];
+		const FIntPoint End = FootprintCorners[(Edge + 1) % 4];
+		const FIntPoint Delta(FMath::Abs(End.X - Pixel.X), -FMath::Abs(End.Y - Pixel.Y));
+		const FIntPoint Step(Pixel.X < End.X ? 1 : -1, Pixel.Y < End.Y ? 1 : -1);
+		int32 Error = Delta.X + Delta.Y;
+		while (true)
+		{
+			if (Pixel.X >= 0 && Pixel.Y >= 0 && Pixel.X < Resolution && Pixel.Y < Resolution)
+			{
+				const int32 Block = (Pixel.Y / Settings.BlockSize) * BlocksPerSide + Pixel.X / Settings.BlockSize;
+				BlockFootprintPixels[Block].Add(Pixel.Y * Resolution + Pixel.X);
+			}
+			if (Pixel == End)
+			{
+				break;
+			}
+			const int32 DoubleError = 2 * Error;
+			if (DoubleError >= Delta.Y)
+			{
+				Error += Delta.Y;
+				Pixel.X += Step.X;
+			}
+			if (DoubleError <= Delta.X)
+			{
+				Error += Delta.X;
+				Pixel.Y += Step.Y;
+			}
+		}
+	}
+}
+
+// --- COMPOSITION ---
+void UStrategyMinimapSubsystem::ComposeBlock(int32 Block)
+{
+	const int32 MinX = (Block % BlocksPerSide) * Settings.BlockSize;
+	const int32 MinY = (Block / BlocksPerSide) * Settings.BlockSize;
+	const bool bApplyFog = FogOfWar && Settings.bApplyFogOfWar;
+	const FStrategyFogOfWarGrid* FogGrid = bApplyFog ? &FogOfWar->GetGrid() : nullptr;
+
+	// 1. Base, darkened by the fog at each pixel's center.
+	for (int32 Y = MinY; Y < MinY + Settings.BlockSize; ++Y)
+	{
+		const FColor* Base = &BasePixels[Y * Resolution];
+		FColor* Row = &Pixels[Y * Resolution];
+		const double WorldY = Settings.WorldMin.Y + (Y + 0.5) / PixelsPerCm.Y;
+		for (int32 X = MinX; X < MinX + Settings.BlockSize; ++X)
+		{
+			if (!bApplyFog)
+			{
+				Row[X] = Base[X];
+				continue;
+			}
+
+			const FIntPoint Cell = FogGrid->GetCell(FVector(Settings.WorldMin.X + (X + 0.5) / PixelsPerCm.X, WorldY, 0.0));
+			Row[X] = FogOfWar->IsCellVisible(Cell) ? Base[X]
+				: StrategyMinimap::Scale(Base[X], FogOfWar->IsCellExplored(Cell) ? Settings.ExploredBrightness : Settings.UnexploredBrightness);
+		}
+	}
+
+	// 2. Units and 3. the camera footprint on top.
+	for (const int32 PixelIndex : BlockUnitPixels[Block])
+	{
+		Pixels[PixelIndex] = Settings.UnitColor;
+	}
+	for (const int32 PixelIndex : BlockFootprintPixels[Block])
+	{
+		Pixels[PixelIndex] = Settings.FootprintColor;
+	}
+}
+
+void UStrategyMinimapSubsystem::UpdateMinimap()
+{
+	SCOPE_CYCLE_COUNTER(STAT_StrategyMinimapUpdate);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	if (bBaseDirty)
+	{
+		RasterizeBase();
+		bBaseDirty = false;
+		bRedrawAll = true;
+	}
+
+	GatherUnits();
+	GatherFogOfWar();
+	GatherFootprint();
+
+	ScratchBlocks.Reset();
+	for (int32 Block = 0; Block < DirtyBlocks.Num(); ++Block)
+	{
+		if (DirtyBlocks[Block] || bRedrawAll)
+		{
+			ComposeBlock(Block);
+			ScratchBlocks.Add(Block);
+			DirtyBlocks[Block] = false;
+		}
+	}
+	bRedrawAll = false;
+
+	if (MinimapTexture)
+	{
+		UploadBlocks(ScratchBlocks);
+	}
+
+	INC_DWORD_STAT_BY(STAT_StrategyMinimapBlocks, ScratchBlocks.Num());
+	LastNumDirtyBlocks = ScratchBlocks.Num();
+	LastUpdateMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+}
+
+// --- TEXTURE ---
+UTexture2D* UStrategyMinimapSubsystem::GetMinimapTexture()
+{
+	if (!MinimapTexture)
+	{
+		MinimapTexture = UTexture2D::CreateTransient(Resolution, Resolution, PF_B8G8R8A8, TEXT("StrategyMinimap"));
+		if (!MinimapTexture)
+		{
+			return nullptr;
+		}
+		MinimapTexture->Filter = TF_Bilinear;
+		MinimapTexture->AddressX = TA_Clamp;
+		MinimapTexture->AddressY = TA_Clamp;
+		MinimapTexture->UpdateResource();
+
+		// The first update uploads every block.
+		bRedrawAll = true;
+	}
+	return MinimapTexture;
+}
+
+void UStrategyMinimapSubsystem::UploadBlocks(TConstArrayView<int32> Blocks)
+{
+	if (Blocks.IsEmpty())
+	{
+		return;
+	}
+
+	FUpdateTextureRegion2D* Regions = new FUpdateTextureRegion2D[Blocks.Num()];
+	for (int32 Index = 0; Index < Blocks.Num(); ++Index)
+	{
+		const int32 X = (Blocks[Index] % BlocksPerSide) * Settings.BlockSize;
+		const int32 Y = (Blocks[Index] / BlocksPerSide) * Settings.BlockSize;
+		Regions[Index] = FUpdateTextureRegion2D(X, Y, X, Y, Settings.BlockSize, Settings.BlockSize);
+	}
+
+	// The render thread uploads after this frame may have moved on, so it gets its own copy of the pixels.
+	const int32 NumBytes = Pixels.Num() * sizeof(FColor);
+	uint8* Data = static_cast<uint8*>(FMemory::Malloc(NumBytes));
+	FMemory::Memcpy(Data, Pixels.GetData(), NumBytes);
+
+	MinimapTexture->UpdateTextureRegions(0, Blocks.Num(), Regions, Resolution * sizeof(FColor), sizeof(FColor), Data,
+		[](uint8* SrcData, const FUpdateTextureRegion2D* SrcRegions)
+		{
+			FMemory::Free(SrcData);
+			delete[] SrcRegions;
+		});
+}
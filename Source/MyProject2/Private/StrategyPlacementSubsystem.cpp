@@ -0,0 +1,236 @@
+// StrategyPlacementSubsystem.cpp
+#include "StrategyPlacementSubsystem.h"
+#include "MyProject2.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Placed Footprints"), STAT_StrategyPlacedFootprints, STATGROUP_StrategyUnits);
+
+// --- FOOTPRINT ---
+FStrategyPlacementFootprint FStrategyPlacementFootprint::MakeRectangle(int32 InWidth, int32 InHeight)
+{
+	FStrategyPlacementFootprint Footprint;
+	Footprint.Width = FMath::Clamp(InWidth, 1, MaxSize);
+	Footprint.Height = FMath::Clamp(InHeight, 1, MaxSize);
+	const uint64 RowMask = Footprint.Width == 64 ? MAX_uint64 : (uint64(1) << Footprint.Width) - 1;
+	Footprint.Rows.Init(RowMask, Footprint.Height);
+	return Footprint;
+}
+
+FStrategyPlacementFootprint FStrategyPlacementFootprint::Rotated(int32 QuarterTurns) const
+{
+	QuarterTurns = ((QuarterTurns % 4) + 4) % 4;
+	if (QuarterTurns == 0)
+	{
+		return *this;
+	}
+
+	FStrategyPlacementFootprint Result;
+	Result.Width = QuarterTurns == 2 ? Width : Height;
+	Result.Height = QuarterTurns == 2 ? Height : Width;
+	Result.Rows.Init(0, Result.Height);
+	for (int32 Y = 0; Y < Height; ++Y)
+	{
+		for (int32 X = 0; X < Width; ++X)
+		{
+			if (!IsCellSet(X, Y))
+			{
+				continue;
+			}
+			// (X, Y) turned about the origin by 90, 180 or 270 degrees, then moved back to non-negative cells.
+			const FIntPoint Cell = QuarterTurns == 1 ? FIntPoint(Height - 1 - Y, X)
+				: QuarterTurns == 2 ? FIntPoint(Width - 1 - X, Height - 1 - Y)
+				: FIntPoint(Y, Width - 1 - X);
+			Result.Rows[Cell.Y] |= uint64(1) << Cell.X;
+		}
+	}
+	return Result;
+}
+
+int32 FStrategyPlacementFootprint::GetNumCells() const
+{
+	int32 NumCells = 0;
+	for (const uint64 Row : Rows)
+	{
+		NumCells += int32(FMath::CountBits(Row));
+	}
+	return NumCells;
+}
+
+// --- GRID ---
+void UStrategyPlacementSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Configure(Grid);
+}
+
+void UStrategyPlacementSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_StrategyPlacedFootprints, NumFootprints);
+	OccupancyCounts.Empty();
+	OccupiedBits.Empty();
+	BuildableBits.Empty();
+	BlockedBits.Empty();
+	Footprints.Empty();
+
+	Super::Deinitialize();
+}
+
+void UStrategyPlacementSubsystem::Configure(const FStrategyPlacementGrid& InGrid)
+{
+	ensureMsgf(NumFootprints == 0, TEXT("Configure the placement grid before adding footprints."));
+	DEC_DWORD_STAT_BY(STAT_StrategyPlacedFootprints, NumFootprints);
+
+	Grid = InGrid;
+	Grid.Width = Align(FMath::Max(Grid.Width, 64), 64);
+	Grid.Height = FMath::Max(Grid.Height, 1);
+	WordsPerRow = Grid.Width / 64;
+
+	const int32 NumWords = WordsPerRow * Grid.Height;
+	OccupancyCounts.Init(0, Grid.Width * Grid.Height);
+	OccupiedBits.Init(0, NumWords);
+	BuildableBits.Init(MAX_uint64, NumWords);
+	BlockedBits.Init(0, NumWords);
+
+	Footprints.Reset();
+	FootprintCells.Reset();
+	SerialById.Reset();
+	UsedById.Reset();
+	FreeIds.Reset();
+	NumFootprints = 0;
+	++Revision;
+}
+
+FIntPoint UStrategyPlacementSubsystem::GetFootprintMinCell(const FVector& Location, const FStrategyPlacementFootprint& Footprint) const
+{
+	// The corner whose footprint center is nearest to Location: cell centers for odd sizes, cell corners for even ones.
+	return FIntPoint(
+		FMath::FloorToInt32((Location.X - Grid.Origin.X) / Grid.CellSize - Footprint.Width * 0.5 + 0.5),
+		FMath::FloorToInt32((Location.Y - Grid.Origin.Y) / Grid.CellSize - Footprint.Height * 0.5 + 0.5));
+}
+
+FVector UStrategyPlacementSubsystem::GetFootprintCenter(const FIntPoint& MinCell, const FStrategyPlacementFootprint& Footprint) const
+{
+	return FVector(
+		Grid.Origin.X + (MinCell.X + Footprint.Width * 0.5) * Grid.CellSize,
+		Grid.Origin.Y + (MinCell.Y + Footprint.Height * 0.5) * Grid.CellSize,
+		0.0);
+}
+
+bool UStrategyPlacementSubsystem::CanPlace(const FStrategyPlacementFootprint& Footprint, const FIntPoint& MinCell) const
+{
+	if (MinCell.X < 0 || MinCell.Y < 0 || MinCell.X + Footprint.Width > Grid.Width || MinCell.Y + Footprint.Height > Grid.Height)
+	{
+		return false;
+	}
+
+	// Each row lands in word Word at bit Shift, spilling into the next word when it crosses a word boundary.
+	const int32 Word = MinCell.X / 64;
+	const int32 Shift = MinCell.X % 64;
+	const bool bSpills = Shift + Footprint.Width > 64;
+	const uint64* Blocked = BlockedBits.GetData() + MinCell.Y * WordsPerRow + Word;
+	for (int32 Y = 0; Y < Footprint.Height; ++Y, Blocked += WordsPerRow)
+	{
+		const uint64 Row = Footprint.Rows[Y];
+		if ((Blocked[0] & (Row << Shift)) != 0 || (bSpills && (Blocked[1] & (Row >> (64 - Shift))) != 0))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// --- FOOTPRINTS ---
+FStrategyPlacementHandle UStrategyPlacementSubsystem::AddFootprint(const FStrategyPlacementFootprint& Footprint, const FIntPoint& MinCell)
+{
+	int32 Id;
+	if (FreeIds.Num() > 0)
+	{
+		Id = FreeIds.Pop(EAllowShrinking::No);
+		Footprints[Id] = Footprint;
+		FootprintCells[Id] = MinCell;
+	}
+	else
+	{
+		Id = Footprints.Add(Footprint);
+		FootprintCells.Add(MinCell);
+		SerialById.Add(0);
+		UsedById.Add(false);
+	}
+
+	UsedById[Id] = true;
+	++NumFootprints;
+	INC_DWORD_STAT(STAT_StrategyPlacedFootprints);
+	StampFootprint(Footprint, MinCell, 1);
+	return FStrategyPlacementHandle{ Id, SerialById[Id] };
+}
+
+void UStrategyPlacementSubsystem::RemoveFootprint(FStrategyPlacementHandle Handle)
+{
+	if (!UsedById.IsValidIndex(Handle.Id) || !UsedById[Handle.Id] || SerialById[Handle.Id] != Handle.Serial)
+	{
+		return;
+	}
+
+	StampFootprint(Footprints[Handle.Id], FootprintCells[Handle.Id], -1);
+	UsedById[Handle.Id] = false;
+	++SerialById[Handle.Id];
+	FreeIds.Add(Handle.Id);
+	--NumFootprints;
+	DEC_DWORD_STAT(STAT_StrategyPlacedFootprints);
+}
+
+void UStrategyPlacementSubsystem::StampFootprint(const FStrategyPlacementFootprint& Footprint, const FIntPoint& MinCell, int32 Delta)
+{
+	for (int32 Y = 0; Y < Footprint.Height; ++Y)
+	{
+		const int32 CellY = MinCell.Y + Y;
+		if (CellY < 0 || CellY >= Grid.Height)
+		{
+			continue;
+		}
+
+		for (uint64 Row = Footprint.Rows[Y]; Row != 0; Row &= Row - 1)
+		{
+			const int32 CellX = MinCell.X + int32(FMath::CountTrailingZeros64(Row));
+			if (CellX < 0 || CellX >= Grid.Width)
+			{
+				continue;
+			}
+
+			uint16& Count = OccupancyCounts[CellY * Grid.Width + CellX];
+			Count = uint16(FMath::Clamp(int32(Count) + Delta, 0, int32(MAX_uint16)));
+
+			const int32 WordIndex = CellY * WordsPerRow + CellX / 64;
+			const uint64 Bit = uint64(1) << (CellX % 64);
+			OccupiedBits[WordIndex] = Count > 0 ? OccupiedBits[WordIndex] | Bit : OccupiedBits[WordIndex] & ~Bit;
+			UpdateBlockedWord(WordIndex);
+		}
+	}
+	++Revision;
+}
+
+void UStrategyPlacementSubsystem::SetBuildable(const FIntPoint& MinCell, const FIntPoint& MaxCell, bool bBuildable)
+{
+	const FIntPoint Min = FIntPoint::ComponentMax(MinCell, FIntPoint::ZeroValue);
+	const FIntPoint Max = FIntPoint::ComponentMin(MaxCell, FIntPoint(Grid.Width - 1, Grid.Height - 1));
+	if (Min.X > Max.X || Min.Y > Max.Y)
+	{
+		return;
+	}
+
+	for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+	{
+		for (int32 Word = Min.X / 64; Word <= Max.X / 64; ++Word)
+		{
+			// Bits Min.X..Max.X clipped to this word.
+			const int32 First = FMath::Max(Min.X - Word * 64, 0);
+			const int32 Last = FMath::Min(Max.X - Word * 64, 63);
+			const uint64 Mask = (Last == 63 ? MAX_uint64 : (uint64(1) << (Last + 1)) - 1) & ~((uint64(1) << First) - 1);
+
+			const int32 WordIndex = Y * WordsPerRow + Word;
+			BuildableBits[WordIndex] = bBuildable ? BuildableBits[WordIndex] | Mask : BuildableBits[WordIndex] & ~Mask;
+			UpdateBlockedWord(WordIndex);
+		}
+	}
+	++Revision;
+}
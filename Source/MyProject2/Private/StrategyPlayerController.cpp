@@ -1,12 +1,63 @@
 // StrategyPlayerController.cpp
 #include "StrategyPlayerController.h"
+#include "StrategyGameMode.h"
 #include "StrategyCameraPawn.h" // Include our new pawn
+#include "StrategyCursorQueryComponent.h"
+#include "StrategyUnitSimulationSubsystem.h"
+#include "StrategyTerrainHeightSubsystem.h"
+#include "StrategyMinimapSubsystem.h"
+#include "StrategyLockstepSubsystem.h"
+#include "StrategyPlacementSubsystem.h"
+#include "StrategyBuildingFootprintComponent.h"
+#include "StrategyCameraDebug.h"
+#include "StrategyCameraProfiler.h"
+#include "DrawDebugHelpers.h"
+#include "MyProject2.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Camera/CameraComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "EnhancedInputComponent.h"
 #include "InputMappingContext.h"
+#include "Curves/CurveFloat.h"
 #include "Kismet/GameplayStatics.h"
+#include "GameFramework/PawnMovementComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Camera Update Ticks"), STAT_StrategyCameraUpdateTicks, STATGROUP_StrategyCamera);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Camera Substeps"), STAT_StrategyCameraSubsteps, STATGROUP_StrategyCamera);
+DECLARE_CYCLE_STAT(TEXT("Controller Tick"), STAT_StrategyControllerTick, STATGROUP_StrategyCamera);
+DECLARE_CYCLE_STAT(TEXT("Camera Tick"), STAT_StrategyCameraTick, STATGROUP_StrategyCamera);
+DECLARE_CYCLE_STAT(TEXT("Camera Movement"), STAT_StrategyCameraMovement, STATGROUP_StrategyCamera);
+DECLARE_CYCLE_STAT(TEXT("Camera Springs"), STAT_StrategyCameraSprings, STATGROUP_StrategyCamera);
+DECLARE_CYCLE_STAT(TEXT("HandleMoveInput"), STAT_StrategyHandleMoveInput, STATGROUP_StrategyCamera);
+DECLARE_CYCLE_STAT(TEXT("HandlePanDrag"), STAT_StrategyHandlePanDrag, STATGROUP_StrategyCamera);
+DECLARE_CYCLE_STAT(TEXT("HandleZoomInput"), STAT_StrategyHandleZoomInput, STATGROUP_StrategyCamera);
+DECLARE_CYCLE_STAT(TEXT("HandleRotateCamera"), STAT_StrategyHandleRotateCamera, STATGROUP_StrategyCamera);
+DECLARE_CYCLE_STAT(TEXT("HandleSelect"), STAT_StrategyHandleSelect, STATGROUP_StrategyCamera);
+DECLARE_CYCLE_STAT(TEXT("HandleMoveOrder"), STAT_StrategyHandleMoveOrder, STATGROUP_StrategyCamera);
+
+// --- CAMERA TICK FUNCTION ---
+void FStrategyCameraTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && IsValidChecked(Target) && !Target->IsUnreachable() && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Target->TickCamera(DeltaTime * Target->CustomTimeDilation);
+	}
+}
+
+FString FStrategyCameraTickFunction::DiagnosticMessage()
+{
+	return Target ? Target->GetFullName() + TEXT("[TickCamera]") : TEXT("<null>[TickCamera]");
+}
+
+FName FStrategyCameraTickFunction::DiagnosticContext(bool bDetailed)
+{
+	return Target ? Target->GetClass()->GetFName() : NAME_None;
+}
 
 // --- CONSTRUCTOR: Gutted of camera components ---
 AStrategyPlayerController::AStrategyPlayerController()
@@ -15,48 +66,88 @@ AStrategyPlayerController::AStrategyPlayerController()
 	bShowMouseCursor = true;
 	DefaultMouseCursor = EMouseCursor::Default;
 
+	CursorQuery = CreateDefaultSubobject<UStrategyCursorQueryComponent>(TEXT("CursorQuery"));
+
+	// The camera only ticks while something is converging; input handlers wake it up.
+	CameraTickFunction.bCanEverTick = true;
+	CameraTickFunction.bStartWithTickEnabled = false;
+	CameraTickFunction.TickGroup = TG_PrePhysics;
+
 	// Initialize pointers
 	PossessedCameraPawn = nullptr;
 	TargetZoomLength = 1500.f; // Set a sensible default
 
+	// Near: full detail. Mid and Far trade LOD, draw distance and shadow/GI quality for the wider view.
+	FStrategyZoomTier& NearTier = ZoomTiers.AddDefaulted_GetRef();
+	NearTier.MinArmLength = 0.f;
+
+	FStrategyZoomTier& MidTier = ZoomTiers.AddDefaulted_GetRef();
+	MidTier.MinArmLength = 1800.f;
+	MidTier.StaticMeshLODDistanceScale = 1.5f;
+	MidTier.SkeletalMeshLODBias = 1;
+	MidTier.MaxShadowQuality = 2;
+	MidTier.MaxGlobalIlluminationQuality = 2;
+
+	FStrategyZoomTier& FarTier = ZoomTiers.AddDefaulted_GetRef();
+	FarTier.MinArmLength = 3500.f;
+	FarTier.ViewDistanceScale = 0.75f;
+	FarTier.StaticMeshLODDistanceScale = 2.5f;
+	FarTier.SkeletalMeshLODBias = 2;
+	FarTier.MaxShadowQuality = 1;
+	FarTier.MaxGlobalIlluminationQuality = 1;
+
 	DebugBeforeZoomLocation = FVector(FLT_MAX);
 	DebugAfterZoomLocation = FVector(FLT_MAX);
 }
 
+void AStrategyPlayerController::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	if (!GetWorld()->IsGameWorld())
+	{
+		return;
+	}
+
+	const AStrategyGameMode* GameMode = GetWorld()->GetAuthGameMode<AStrategyGameMode>();
+	StartupStartSeconds = GameMode ? GameMode->GetStartupStartSeconds() : FPlatformTime::Seconds();
+
+	// Usually already in flight since the game mode's InitGame; the streamable manager shares the pending load.
+	TArray<FSoftObjectPath> Assets;
+	GetStartupAssets(Assets);
+	if (Assets.Num() > 0)
+	{
+		StartupAssets = UAssetManager::GetStreamableManager().RequestAsyncLoad(Assets, FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+	}
+}
+
 // --- ON POSSESS: The new place to initialize everything ---
 void AStrategyPlayerController::OnPossess(APawn* InPawn)
 {
 	Super::OnPossess(InPawn);
 
-	UE_LOG(LogTemp, Log, TEXT("[CONTROLLER] OnPossess: Possessing Pawn '%s'."), *GetNameSafe(InPawn));
+	UE_LOG(LogStrategyCamera, Log, TEXT("[CONTROLLER] OnPossess: Possessing Pawn '%s'."), *GetNameSafe(InPawn));
 
 	// Cache a reference to the pawn we possessed
 	PossessedCameraPawn = Cast<AStrategyCameraPawn>(InPawn);
 	if (!PossessedCameraPawn)
 	{
-		UE_LOG(LogTemp, Error, TEXT("[CONTROLLER] OnPossess: FAILED to cast Pawn to AStrategyCameraPawn! Controls will not work."));
+		UE_LOG(LogStrategyCamera, Error, TEXT("[CONTROLLER] OnPossess: FAILED to cast Pawn to AStrategyCameraPawn! Controls will not work."));
 		return;
 	}
-	UE_LOG(LogTemp, Log, TEXT("[CONTROLLER] OnPossess: Successfully cast and cached PossessedCameraPawn."));
-
-	// --- THIS IS THE CRITICAL ADDITION ---
-	// Add Input Mapping Context
-	if (DefaultMappingContext)
+	UE_LOG(LogStrategyCamera, Log, TEXT("[CONTROLLER] OnPossess: Successfully cast and cached PossessedCameraPawn."));
+	ObservePawnRoot(PossessedCameraPawn->GetRootComponent());
+	TerrainHeights = GetWorld()->GetSubsystem<UStrategyTerrainHeightSubsystem>();
+	if (StartupMetrics.PawnPossessedMs < 0.0)
 	{
-		if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(GetLocalPlayer()))
-		{
-			Subsystem->ClearAllMappings();
-			Subsystem->AddMappingContext(DefaultMappingContext, 0);
-			UE_LOG(LogTemp, Log, TEXT("[CONTROLLER] OnPossess: Successfully added Mapping Context '%s' to subsystem."), *DefaultMappingContext->GetName());
-		}
-		else
-		{
-			UE_LOG(LogTemp, Error, TEXT("[CONTROLLER] OnPossess: Failed to get EnhancedInputLocalPlayerSubsystem."));
-		}
+		StartupMetrics.PawnPossessedMs = (FPlatformTime::Seconds() - StartupStartSeconds) * 1000.0;
 	}
-	else
+
+	// --- THIS IS THE CRITICAL ADDITION ---
+	// The mapping context is added once the startup assets are in (UpdateStartup); a later possess re-adds it here.
+	if (StartupMetrics.IsInputReady())
 	{
-		UE_LOG(LogTemp, Error, TEXT("[CONTROLLER] OnPossess: DefaultMappingContext is not set in the Blueprint! Cannot add to subsystem."));
+		AddDefaultMappingContext();
 	}
 
 	// Set input mode to allow game and UI interaction
@@ -64,92 +155,378 @@ void AStrategyPlayerController::OnPossess(APawn* InPawn)
 	InputModeData.SetLockMouseToViewportBehavior(EMouseLockMode::DoNotLock);
 	InputModeData.SetHideCursorDuringCapture(false);
 	SetInputMode(InputModeData);
-	UE_LOG(LogTemp, Log, TEXT("[CONTROLLER] OnPossess: Set Input Mode to GameAndUI."));
+	UE_LOG(LogStrategyCamera, Log, TEXT("[CONTROLLER] OnPossess: Set Input Mode to GameAndUI."));
 	// --- END OF CRITICAL ADDITION ---
 
 
 	// Now that we have a pawn and input is set up, initialize its camera settings
+	BakePitchCurveTable();
 	InitializeCameraSettings();
+	WakeCameraUpdate();
+	UpdateStartup();
+}
+
+void AStrategyPlayerController::AddDefaultMappingContext()
+{
+	UInputMappingContext* MappingContext = DefaultMappingContext.Get();
+	if (!MappingContext)
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[CONTROLLER] DefaultMappingContext is not set (or failed to load) in the Blueprint! Cannot add to subsystem."));
+		return;
+	}
+
+	if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(GetLocalPlayer()))
+	{
+		Subsystem->ClearAllMappings();
+		Subsystem->AddMappingContext(MappingContext, 0);
+		UE_LOG(LogStrategyCamera, Log, TEXT("[CONTROLLER] Successfully added Mapping Context '%s' to subsystem."), *MappingContext->GetName());
+	}
+	else
+	{
+		UE_LOG(LogStrategyCamera, Error, TEXT("[CONTROLLER] Failed to get EnhancedInputLocalPlayerSubsystem."));
+	}
+}
+
+void AStrategyPlayerController::OnUnPossess()
+{
+	ObservePawnRoot(nullptr);
+	Super::OnUnPossess();
+}
+
+void AStrategyPlayerController::ObservePawnRoot(USceneComponent* Root)
+{
+	if (USceneComponent* PreviousRoot = ObservedPawnRoot.Get())
+	{
+		PreviousRoot->TransformUpdated.Remove(PawnTransformUpdatedHandle);
+	}
+	PawnTransformUpdatedHandle.Reset();
+	ObservedPawnRoot = Root;
+	if (Root)
+	{
+		PawnTransformUpdatedHandle = Root->TransformUpdated.AddUObject(this, &AStrategyPlayerController::HandlePawnTransformUpdated);
+	}
+}
+
+void AStrategyPlayerController::HandlePawnTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	++NumPawnMoves;
+}
+
+void AStrategyPlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ObservePawnRoot(nullptr);
+	StopInputReplay();
+	ZoomTierSelector.Restore();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // --- TICK: Now operates on the pawn's camera boom ---
 void AStrategyPlayerController::Tick(float DeltaTime)
 {
+	STRATEGY_CAMERA_SCOPE(ControllerTick, STAT_StrategyControllerTick);
 	Super::Tick(DeltaTime);
 
+	if (!StartupMetrics.IsInputReady() || StartupMetrics.WorldStreamedMs < 0.0)
+	{
+		UpdateStartup();
+	}
+
 	if (!PossessedCameraPawn)
 	{
 		// Log once every 120 frames if our pawn is missing
 		if (GFrameCounter % 120 == 0)
 		{
-			UE_LOG(LogTemp, Error, TEXT("[CONTROLLER] Tick: PossessedCameraPawn is NULL! Cannot update."));
+			UE_LOG(LogStrategyCamera, Error, TEXT("[CONTROLLER] Tick: PossessedCameraPawn is NULL! Cannot update."));
 		}
 		return;
 	}
 
-	UpdateCameraZoomAndPitch(DeltaTime);
+	// Pan input from every source is gathered once here; camera smoothing runs in TickCamera, only while it is converging.
+	SampleCameraPanInput();
+
+	if (bCameraJumpPending)
+	{
+		UpdateCameraJump();
+	}
+	if (PlacementClass)
+	{
+		UpdatePlacementPreview();
+	}
 
+#if STRATEGY_CAMERA_DEBUG
 	// Log a detailed status update every 120 frames
-	if (GFrameCounter % 120 == 0)
+	if (GFrameCounter % 120 == 0 && StrategyCameraDebug::IsEnabled(StrategyCameraDebug::Log))
 	{
 		USpringArmComponent* CameraBoom = PossessedCameraPawn->GetCameraBoom();
-		UE_LOG(LogTemp, Verbose, TEXT("--- [CONTROLLER] Tick Status ---"));
-		UE_LOG(LogTemp, Verbose, TEXT("  Controller Control Rotation: %s"), *GetControlRotation().ToString());
-		UE_LOG(LogTemp, Verbose, TEXT("  Possessed Pawn Location: %s"), *PossessedCameraPawn->GetActorLocation().ToString());
-		UE_LOG(LogTemp, Verbose, TEXT("  Possessed Pawn Rotation: %s"), *PossessedCameraPawn->GetActorRotation().ToString());
+		UE_LOG(LogStrategyCamera, Verbose, TEXT("--- [CONTROLLER] Tick Status ---"));
+		UE_LOG(LogStrategyCamera, Verbose, TEXT("  Controller Control Rotation: %s"), *GetControlRotation().ToString());
+		UE_LOG(LogStrategyCamera, Verbose, TEXT("  Possessed Pawn Location: %s"), *PossessedCameraPawn->GetActorLocation().ToString());
+		UE_LOG(LogStrategyCamera, Verbose, TEXT("  Possessed Pawn Rotation: %s"), *PossessedCameraPawn->GetActorRotation().ToString());
 		if (CameraBoom)
 		{
-			UE_LOG(LogTemp, Verbose, TEXT("  Boom Target Length: %.2f (Controller) vs %.2f (Actual)"), TargetZoomLength, CameraBoom->TargetArmLength);
+			UE_LOG(LogStrategyCamera, Verbose, TEXT("  Boom Target Length: %.2f (Controller) vs %.2f (Actual)"), TargetZoomLength, CameraBoom->TargetArmLength);
 		}
-		UE_LOG(LogTemp, Verbose, TEXT("---------------------------------"));
+		UE_LOG(LogStrategyCamera, Verbose, TEXT("---------------------------------"));
 	}
-	
 
 	// Draw the "Before" sphere in Green if its location is valid
 	if (DebugBeforeZoomLocation.X != FLT_MAX)
 	{
-		DrawDebugSphere(GetWorld(), DebugBeforeZoomLocation, 50.f, 12, FColor::Green, false, -1.f, 0, 2.f);
+		STRATEGY_CAMERA_DRAW(DrawDebugSphere(GetWorld(), DebugBeforeZoomLocation, 50.f, 12, FColor::Green, false, -1.f, 0, 2.f));
 	}
 	// Draw the "After" sphere in Red if its location is valid
 	if (DebugAfterZoomLocation.X != FLT_MAX)
 	{
-		DrawDebugSphere(GetWorld(), DebugAfterZoomLocation, 50.f, 12, FColor::Red, false, -1.f, 0, 2.f);
+		STRATEGY_CAMERA_DRAW(DrawDebugSphere(GetWorld(), DebugAfterZoomLocation, 50.f, 12, FColor::Red, false, -1.f, 0, 2.f));
+	}
+#endif
+}
+
+void AStrategyPlayerController::PlayerTick(float DeltaTime)
+{
+	// Replayed input goes through the same handlers as live input, at the point the engine processes input. When
+	// recording, this opens the frame even if no input arrives during it.
+	if (InputPlayer.IsOpen())
+	{
+		ReplayInputFrame();
+	}
+	else
+	{
+		RecordInput(EStrategyInputRecordType::Frame);
+	}
+
+	Super::PlayerTick(DeltaTime);
+}
+
+void AStrategyPlayerController::RegisterActorTickFunctions(bool bRegister)
+{
+	Super::RegisterActorTickFunctions(bRegister);
+
+	if (bRegister)
+	{
+		if (CameraTickFunction.bCanEverTick)
+		{
+			CameraTickFunction.Target = this;
+			CameraTickFunction.SetTickFunctionEnable(CameraTickFunction.bStartWithTickEnabled || CameraTickFunction.IsTickFunctionEnabled());
+			CameraTickFunction.RegisterTickFunction(GetLevel());
+			// Run after the controller has processed this frame's input.
+			CameraTickFunction.AddPrerequisite(this, PrimaryActorTick);
+		}
+	}
+	else if (CameraTickFunction.IsTickFunctionRegistered())
+	{
+		CameraTickFunction.UnRegisterTickFunction();
+	}
+}
+
+// --- CAMERA SETTLE STATE MACHINE ---
+void AStrategyPlayerController::WakeCameraUpdate()
+{
+	if (!PossessedCameraPawn)
+	{
+		return;
+	}
+
+	if (CameraSettleState == EStrategyCameraSettleState::Settled)
+	{
+		// The pawn or boom may have been moved from outside while the camera slept.
+		ResetCameraIntegrator();
+		CameraSettleState = EStrategyCameraSettleState::Converging;
+		CameraTickFunction.SetTickFunctionEnable(true);
+		STRATEGY_CAMERA_LOG(Verbose, TEXT("[CONTROLLER] Camera waking up."));
+	}
+}
+
+void AStrategyPlayerController::TickCamera(float DeltaTime)
+{
+	STRATEGY_CAMERA_SCOPE(CameraTick, STAT_StrategyCameraTick);
+	++NumCameraUpdateTicks;
+	INC_DWORD_STAT(STAT_StrategyCameraUpdateTicks);
+	STRATEGY_CAMERA_PROFILE_COUNT(InterpolatingFrames, 1);
+
+	if (ReplayDeltaTime >= 0.f)
+	{
+		DeltaTime = ReplayDeltaTime;
+	}
+
+	if (!PossessedCameraPawn)
+	{
+		SettleCamera();
+		return;
+	}
+
+	UpdateCameraMovement(DeltaTime);
+	UpdateCameraSprings(DeltaTime);
+
+	if (IsCameraSettled())
+	{
+		SettleCamera();
+	}
+}
+
+bool AStrategyPlayerController::IsCameraSettled() const
+{
+	if (!PossessedCameraPawn->GetCameraBoom())
+	{
+		return true;
+	}
+
+	if (ZoomAnchor.IsActive() || !PossessedCameraPawn->GetPendingMovementInputVector().IsNearlyZero())
+	{
+		return false;
 	}
+
+	return CameraIntegrator.IsSettled(MakeCameraSpringTargets(), ZoomSettleTolerance, PitchSettleTolerance, MovementSettleSpeed);
+}
+
+void AStrategyPlayerController::SettleCamera()
+{
+	CameraSettleState = EStrategyCameraSettleState::Settled;
+	CameraTickFunction.SetTickFunctionEnable(false);
+
+	if (PossessedCameraPawn)
+	{
+		if (UPawnMovementComponent* MovementComponent = PossessedCameraPawn->GetMovementComponent())
+		{
+			MovementComponent->StopMovementImmediately();
+		}
+	}
+
+	STRATEGY_CAMERA_LOG(Verbose, TEXT("[CONTROLLER] Camera settled after %llu update ticks."), NumCameraUpdateTicks);
 }
 
 // --- SETUP INPUT COMPONENT: Stays mostly the same ---
 void AStrategyPlayerController::SetupInputComponent()
 {
 	Super::SetupInputComponent();
-	// (Your existing SetupInputComponent code for binding actions is correct and can stay here)
-	if (UEnhancedInputComponent* EnhancedInput = Cast<UEnhancedInputComponent>(InputComponent))
-    {
-        if (MoveAction) EnhancedInput->BindAction(MoveAction.Get(), ETriggerEvent::Triggered, this, &AStrategyPlayerController::HandleMoveInput);
-        if (ZoomAction) EnhancedInput->BindAction(ZoomAction.Get(), ETriggerEvent::Triggered, this, &AStrategyPlayerController::HandleZoomInput);
-        if (RotateActionTrigger) EnhancedInput->BindAction(RotateActionTrigger.Get(), ETriggerEvent::Triggered, this, &AStrategyPlayerController::HandleRotateCameraTrigger);
-        if (RotateActionValue) EnhancedInput->BindAction(RotateActionValue.Get(), ETriggerEvent::Triggered, this, &AStrategyPlayerController::HandleRotateCameraValue);
-    }
+	// Actions still loading are bound again by UpdateStartup once they are in.
+	BindInputActions();
+}
+
+void AStrategyPlayerController::BindInputActions()
+{
+	UEnhancedInputComponent* EnhancedInput = Cast<UEnhancedInputComponent>(InputComponent);
+	if (!EnhancedInput)
+	{
+		return;
+	}
+
+	EnhancedInput->ClearActionBindings();
+	if (MoveAction) EnhancedInput->BindAction(MoveAction.Get(), ETriggerEvent::Triggered, this, &AStrategyPlayerController::HandleMoveInput);
+	if (PanDragAction)
+	{
+		EnhancedInput->BindAction(PanDragAction.Get(), ETriggerEvent::Started, this, &AStrategyPlayerController::HandlePanDragStarted);
+		EnhancedInput->BindAction(PanDragAction.Get(), ETriggerEvent::Completed, this, &AStrategyPlayerController::HandlePanDragCompleted);
+	}
+	if (ZoomAction) EnhancedInput->BindAction(ZoomAction.Get(), ETriggerEvent::Triggered, this, &AStrategyPlayerController::HandleZoomInput);
+	if (RotateActionTrigger) EnhancedInput->BindAction(RotateActionTrigger.Get(), ETriggerEvent::Triggered, this, &AStrategyPlayerController::HandleRotateCameraTrigger);
+	if (RotateActionValue) EnhancedInput->BindAction(RotateActionValue.Get(), ETriggerEvent::Triggered, this, &AStrategyPlayerController::HandleRotateCameraValue);
+	if (SelectAction)
+	{
+		EnhancedInput->BindAction(SelectAction.Get(), ETriggerEvent::Started, this, &AStrategyPlayerController::HandleSelectStarted);
+		EnhancedInput->BindAction(SelectAction.Get(), ETriggerEvent::Completed, this, &AStrategyPlayerController::HandleSelectCompleted);
+	}
+	if (MoveOrderAction) EnhancedInput->BindAction(MoveOrderAction.Get(), ETriggerEvent::Started, this, &AStrategyPlayerController::HandleMoveOrder);
+	if (RotatePlacementAction) EnhancedInput->BindAction(RotatePlacementAction.Get(), ETriggerEvent::Started, this, &AStrategyPlayerController::HandleRotatePlacement);
+}
+
+// --- STARTUP ---
+void AStrategyPlayerController::GetStartupAssets(TArray<FSoftObjectPath>& OutAssets) const
+{
+	auto AddAsset = [&OutAssets](const auto& Asset)
+	{
+		if (!Asset.IsNull())
+		{
+			OutAssets.AddUnique(Asset.ToSoftObjectPath());
+		}
+	};
+	AddAsset(DefaultMappingContext);
+	AddAsset(MoveAction);
+	AddAsset(PanDragAction);
+	AddAsset(ZoomAction);
+	AddAsset(RotateActionTrigger);
+	AddAsset(RotateActionValue);
+	AddAsset(SelectAction);
+	AddAsset(MoveOrderAction);
+	AddAsset(RotatePlacementAction);
+	AddAsset(CameraPitchByZoomCurve);
+}
+
+void AStrategyPlayerController::UpdateStartup()
+{
+	const double NowMs = (FPlatformTime::Seconds() - StartupStartSeconds) * 1000.0;
+	const bool bWasComplete = StartupMetrics.IsInputReady() && StartupMetrics.WorldStreamedMs >= 0.0;
+
+	if (StartupMetrics.AssetsLoadedMs < 0.0 && (!StartupAssets.IsValid() || StartupAssets->HasLoadCompleted() || StartupAssets->WasCanceled()))
+	{
+		StartupMetrics.AssetsLoadedMs = NowMs;
+	}
+	if (!PossessedCameraPawn)
+	{
+		return;
+	}
+
+	if (StartupMetrics.WorldStreamedMs < 0.0 && PossessedCameraPawn->IsViewStreamed())
+	{
+		StartupMetrics.WorldStreamedMs = NowMs;
+	}
+
+	// Input doesn't wait for the world: the camera can move while the rest of the map streams in.
+	if (!StartupMetrics.IsInputReady() && StartupMetrics.AssetsLoadedMs >= 0.0)
+	{
+		AddDefaultMappingContext();
+		BindInputActions();
+		BakePitchCurveTable();
+		InitializeCameraSettings();
+		WakeCameraUpdate();
+		StartupMetrics.InputReadyMs = NowMs;
+	}
+
+	if (!bWasComplete && StartupMetrics.IsInputReady() && StartupMetrics.WorldStreamedMs >= 0.0)
+	{
+		UE_LOG(LogStrategyCamera, Log, TEXT("[CONTROLLER] Startup: pawn possessed %.1f ms, assets loaded %.1f ms, input ready %.1f ms, view streamed %.1f ms after map load."),
+			StartupMetrics.PawnPossessedMs, StartupMetrics.AssetsLoadedMs, StartupMetrics.InputReadyMs, StartupMetrics.WorldStreamedMs);
+	}
+}
+
+void AStrategyPlayerController::NoteInputProcessed()
+{
+	if (StartupMetrics.FirstInputMs >= 0.0)
+	{
+		return;
+	}
+
+	StartupMetrics.FirstInputMs = (FPlatformTime::Seconds() - StartupStartSeconds) * 1000.0;
+	StartupMetrics.FirstInputFrame = GFrameCounter;
+	UE_LOG(LogStrategyCamera, Log, TEXT("[CONTROLLER] Startup: first input processed %.1f ms after map load."), StartupMetrics.FirstInputMs);
 }
 
 void AStrategyPlayerController::UpdateDebugAfterSphere()
 {
+#if STRATEGY_CAMERA_DEBUG
+	if (!StrategyCameraDebug::IsEnabled(StrategyCameraDebug::Log))
+	{
+		return;
+	}
+
 	FHitResult AfterHit;
-	if (GetHitResultUnderCursor(ECollisionChannel::ECC_Visibility, false, AfterHit) && AfterHit.bBlockingHit)
+	if (CursorQuery->GetCursorHit(AfterHit))
 	{
 		// Capture the "after" location.
 		DebugAfterZoomLocation = AfterHit.Location;
 
-		// --- ADDED LOGGING ---
-		UE_LOG(LogTemp, Warning, TEXT("[DEBUG SPHERES] AFTER zoom location captured:  %s"), *DebugAfterZoomLocation.ToString());
+		UE_LOG(LogStrategyCamera, Warning, TEXT("[DEBUG SPHERES] AFTER zoom location captured:  %s"), *DebugAfterZoomLocation.ToString());
 
 		// Also log the error vector and distance if the "before" location is valid
 		if (DebugBeforeZoomLocation.X != FLT_MAX)
 		{
 			const FVector ErrorVector = DebugAfterZoomLocation - DebugBeforeZoomLocation;
 			const float ErrorDistance = ErrorVector.Size();
-			UE_LOG(LogTemp, Error, TEXT("[DEBUG SPHERES] Zoom Error Vector (After - Before): %s | Distance: %.2f"), *ErrorVector.ToString(), ErrorDistance);
+			UE_LOG(LogStrategyCamera, Error, TEXT("[DEBUG SPHERES] Zoom Error Vector (After - Before): %s | Distance: %.2f"), *ErrorVector.ToString(), ErrorDistance);
 		}
 	}
+#endif
 }
 
 // --- INITIALIZE CAMERA: Now operates on the pawn's boom ---
@@ -162,173 +539,1167 @@ void AStrategyPlayerController::InitializeCameraSettings()
 
 	TargetZoomLength = FMath::Clamp(CameraBoom->TargetArmLength, MinZoomLength, MaxZoomLength);
 	
-	if (CameraPitchByZoomCurve)
+	if (PitchCurveTable.IsBaked())
 	{
-		const float CurveTargetPitchValue = CameraPitchByZoomCurve->GetFloatValue(TargetZoomLength);
 		FRotator BoomNewRelativeRotation = CameraBoom->GetRelativeRotation();
-		BoomNewRelativeRotation.Pitch = CurveTargetPitchValue * -1.f;
+		BoomNewRelativeRotation.Pitch = GetBoomPitchForArmLength(TargetZoomLength);
 		CameraBoom->SetRelativeRotation(BoomNewRelativeRotation);
 	}
+
+	ResetCameraIntegrator();
+	UpdateStreamingTarget();
 }
 
+void AStrategyPlayerController::UpdateStreamingTarget()
+{
+	// Lets the pawn stream in the footprint of the zoom target before the boom gets there.
+	const float TargetPitch = PitchCurveTable.IsBaked() ? GetBoomPitchForArmLength(TargetZoomLength) : PossessedCameraPawn->GetCameraBoom()->GetRelativeRotation().Pitch;
+	PossessedCameraPawn->SetStreamingTarget(TargetZoomLength, TargetPitch);
+}
 
-void AStrategyPlayerController::UpdateCameraZoomAndPitch(float DeltaTime)
+void AStrategyPlayerController::BakePitchCurveTable()
 {
-	if (!PossessedCameraPawn) return;
-	USpringArmComponent* CameraBoom = PossessedCameraPawn->GetCameraBoom();
-	if (!CameraBoom) return;
+	PitchCurveTable.Bake(CameraPitchByZoomCurve.Get(), MinZoomLength, MaxZoomLength, PitchCurveTableResolution);
+}
 
-	// 1. Smoothly interpolate the actual arm length towards our target.
-	const float InterpolatedArmLength = FMath::FInterpTo(CameraBoom->TargetArmLength, TargetZoomLength, DeltaTime, ZoomInterpSpeed);
-	CameraBoom->TargetArmLength = InterpolatedArmLength;
+#if WITH_EDITOR
+void AStrategyPlayerController::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
 
-	// 2. Smoothly interpolate the pitch based on the curve and the *current* interpolated length.
-	if (CameraPitchByZoomCurve)
+	const FName PropertyName = PropertyChangedEvent.GetMemberPropertyName();
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(AStrategyPlayerController, CameraPitchByZoomCurve)
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(AStrategyPlayerController, MinZoomLength)
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(AStrategyPlayerController, MaxZoomLength)
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(AStrategyPlayerController, PitchCurveTableResolution))
 	{
-		const float TargetPitchValue = CameraPitchByZoomCurve->GetFloatValue(InterpolatedArmLength);
-		FRotator CurrentBoomRotation = CameraBoom->GetRelativeRotation();
-		CurrentBoomRotation.Pitch = FMath::RInterpTo(CurrentBoomRotation, FRotator(TargetPitchValue * -1.f, 0, 0), DeltaTime, RotationInterpSpeed).Pitch;
-		CameraBoom->SetRelativeRotation(CurrentBoomRotation);
+		BakePitchCurveTable();
 	}
 }
+#endif
 
-// --- HANDLE MOVE INPUT: Now uses AddMovementInput on the pawn ---
-void AStrategyPlayerController::HandleMoveInput(const FInputActionValue& Value)
-{
-	const FVector2D MovementVector = Value.Get<FVector2D>();
-	UE_LOG(LogTemp, Warning, TEXT("[CONTROLLER] HandleMoveInput TRIGGERED! Value: %s"), *MovementVector.ToString());
 
-	if (!PossessedCameraPawn)
+// --- CAMERA SPRINGS ---
+void AStrategyPlayerController::ResetCameraIntegrator()
+{
+	if (!PossessedCameraPawn || !PossessedCameraPawn->GetCameraBoom())
 	{
-		UE_LOG(LogTemp, Error, TEXT("[CONTROLLER] HandleMoveInput: Cannot move because PossessedCameraPawn is NULL."));
 		return;
 	}
 
-	const FRotator Rotation = GetControlRotation();
-	const FRotator YawRotation(0, Rotation.Yaw, 0);
-
-	const FVector ForwardDirection = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X);
-	const FVector RightDirection = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y);
-	
-	UE_LOG(LogTemp, Log, TEXT("[CONTROLLER] HandleMoveInput: Calling AddMovementInput on Pawn."));
-	PossessedCameraPawn->AddMovementInput(ForwardDirection, MovementVector.Y * CameraMoveSpeed);
-	PossessedCameraPawn->AddMovementInput(RightDirection, MovementVector.X * CameraMoveSpeed);
-
-
+	USpringArmComponent* CameraBoom = PossessedCameraPawn->GetCameraBoom();
+	FStrategyCameraSpringState State;
+	State.ArmLength = CameraBoom->TargetArmLength;
+	State.Pitch = CameraBoom->GetRelativeRotation().Pitch;
+	State.Yaw = PossessedCameraPawn->GetActorRotation().Yaw;
+	State.Pan = PossessedCameraPawn->GetActorLocation();
+	CameraIntegrator.Reset(State);
+	TargetPanLocation = State.Pan;
 }
 
+FStrategyCameraSpringTargets AStrategyPlayerController::MakeCameraSpringTargets() const
+{
+	FStrategyCameraSpringTargets Targets;
+	Targets.ArmLength = TargetZoomLength;
+	// Without a pitch curve the pitch stays where it is.
+	Targets.Pitch = CameraIntegrator.GetCurrentState().Pitch;
+	Targets.Yaw = GetControlRotation().Yaw;
+	Targets.Pan = TargetPanLocation;
+	Targets.PitchByArmLength = &PitchCurveTable;
+	return Targets;
+}
 
+FStrategyCameraSpringSettings AStrategyPlayerController::MakeCameraSpringSettings() const
+{
+	FStrategyCameraSpringSettings Settings;
+	Settings.SubstepRate = CameraSubstepRate;
+	Settings.MaxSubstepsPerFrame = MaxCameraSubstepsPerFrame;
+	Settings.ArmLengthFrequency = ZoomSpringFrequency;
+	Settings.PitchFrequency = PitchSpringFrequency;
+	Settings.YawFrequency = YawSpringFrequency;
+	Settings.PanFrequency = PanSpringFrequency;
+	return Settings;
+}
 
-// (HandleZoomInput, HandleRotateCameraTrigger, HandleRotateCameraValue, etc., do not need to change as they only modify controller state or call controller functions like AddYawInput)
-// (Your existing correct versions of these functions are fine)
-
+void AStrategyPlayerController::UpdateCameraSprings(float DeltaTime)
+{
+	STRATEGY_CAMERA_SCOPE(CameraSprings, STAT_StrategyCameraSprings);
+	if (!PossessedCameraPawn) return;
+	USpringArmComponent* CameraBoom = PossessedCameraPawn->GetCameraBoom();
+	if (!CameraBoom) return;
 
+	// Boom state rendered last frame, for the zoom anchor.
+	const FStrategyCameraSpringState PreviousState = CameraIntegrator.GetRenderState();
 
-void AStrategyPlayerController::HandleZoomInput(const FInputActionValue& Value)
-{
-	const float ZoomAxisValue = Value.Get<float>();
-	if (FMath::IsNearlyZero(ZoomAxisValue) || !PossessedCameraPawn)
-	{
-		return;
-	}
+	// 1. Step arm length, pitch (following the pitch curve at the current arm length), yaw and pan at the fixed rate.
+	FollowTerrain();
+	const int32 NumSubsteps = CameraIntegrator.Advance(DeltaTime, MakeCameraSpringTargets(), MakeCameraSpringSettings());
+	INC_DWORD_STAT_BY(STAT_StrategyCameraSubsteps, NumSubsteps);
+	STRATEGY_CAMERA_PROFILE_COUNT(CameraSubsteps, NumSubsteps);
+	FStrategyCameraSpringState State = CameraIntegrator.GetRenderState();
 
-	USpringArmComponent* CameraBoom = PossessedCameraPawn->GetCameraBoom();
-	if (!CameraBoom)
+	// 2. Pick the rendering tier for the new arm length; console variables are only touched when the tier changes.
+	if (IsLocalController() && ZoomTierSelector.Update(ZoomTiers, State.ArmLength, ZoomTierHysteresis))
 	{
-		return;
+		ZoomTierSelector.ApplyTier(ZoomTiers[ZoomTierSelector.GetCurrentTier()]);
 	}
 
-	// --- Final, Correct Logic (ONLY for Zooming IN) ---
-	if (ZoomAxisValue > 0)
+	// 3. Keep the anchored ground point under the cursor for the new boom state. The offset moves the pan
+	// channel and its target together, so it is applied in full this frame instead of being smoothed.
+	if (ZoomAnchor.IsActive())
 	{
-		FHitResult HitResult;
-		if (GetHitResultUnderCursor(ECollisionChannel::ECC_Visibility, false, HitResult) && HitResult.bBlockingHit)
+		FVector PawnOffset;
+		if (ZoomAnchor.ComputePawnOffset(FRotator(PreviousState.Pitch, PreviousState.Yaw, 0.0), PreviousState.ArmLength, PreviousState.Pan.Z,
+			FRotator(State.Pitch, State.Yaw, 0.0), State.ArmLength, State.Pan.Z, PawnOffset))
 		{
-			// --- The "What-If" Calculation ---
-			
-			// 1. Get the properties of the camera boom BEFORE the zoom.
-			const float CurrentArmLength = CameraBoom->TargetArmLength;
-			const FRotator CurrentBoomRotation = CameraBoom->GetRelativeRotation();
-
-			// 2. Calculate the properties of the camera boom AFTER the zoom.
-			const float NewArmLength = FMath::Clamp(CurrentArmLength - (ZoomAxisValue * ZoomStepAmount), MinZoomLength, MaxZoomLength);
-			FRotator NewBoomRotation = CurrentBoomRotation;
-			if (CameraPitchByZoomCurve)
-			{
-				NewBoomRotation.Pitch = CameraPitchByZoomCurve->GetFloatValue(NewArmLength) * -1.f;
-			}
+			CameraIntegrator.OffsetPan(PawnOffset);
+			TargetPanLocation += PawnOffset;
+			State.Pan += PawnOffset;
+		}
 
-			// 3. Find the location of the point under the mouse.
-			const FVector FocusPoint = HitResult.Location;
-
-			// 4. Calculate the camera's ground footprint vector BEFORE and AFTER the zoom.
-			const FVector PawnLocation = PossessedCameraPawn->GetActorLocation();
-			const FVector CameraOffset_Before = CurrentBoomRotation.Vector() * CurrentArmLength;
-			const FVector CameraOffset_After = NewBoomRotation.Vector() * NewArmLength;
-
-			// The ground footprint is the camera's XY offset from the pawn.
-			const FVector GroundFootprint_Before(CameraOffset_Before.X, CameraOffset_Before.Y, 0.f);
-			const FVector GroundFootprint_After(CameraOffset_After.X, CameraOffset_After.Y, 0.f);
-			
-			// 5. Calculate the vector from the pawn to the focus point.
-			const FVector PawnToFocus = FocusPoint - PawnLocation;
-
-			// 6. The required pawn offset is the difference in how the ground footprint affects the focus point.
-			const FVector WorldOffset = (PawnToFocus.GetSafeNormal() * GroundFootprint_After.Size()) - (PawnToFocus.GetSafeNormal() * GroundFootprint_Before.Size());
-			
-			// Invert the offset because we are moving the pawn, not the camera.
-			PossessedCameraPawn->AddActorWorldOffset(WorldOffset * -1.f, true);
+		// The gesture ends once both the arm and the pitch have converged.
+		const float TargetPitch = PitchCurveTable.IsBaked() ? GetBoomPitchForArmLength(TargetZoomLength) : float(State.Pitch);
+		if (FMath::IsNearlyEqual(State.ArmLength, double(TargetZoomLength), 0.1) && FMath::IsNearlyEqual(State.Pitch, double(TargetPitch), 0.01))
+		{
+			ZoomAnchor.Reset();
 		}
 	}
 
-	// --- Apply the new zoom target for the Tick function to handle ---
-	TargetZoomLength = FMath::Clamp(CameraBoom->TargetArmLength - (ZoomAxisValue * ZoomStepAmount), MinZoomLength, MaxZoomLength);
-}
-
-void AStrategyPlayerController::HandleRotateCameraTrigger(const FInputActionValue& Value)
-{
-	const bool bPressed = Value.Get<bool>();
-	UE_LOG(LogTemp, Warning, TEXT("HandleRotateCameraTrigger TRIGGERED! bPressed: %s. Current bIsRotatingCamera: %s"), bPressed ? TEXT("true") : TEXT("false"), bIsRotatingCamera ? TEXT("true") : TEXT("false"));
-	bIsRotatingCamera = bPressed;
+	// 4. Apply: boom length and pitch, then one move of the pawn to the smoothed location and yaw.
+	CameraBoom->TargetArmLength = float(State.ArmLength);
+	FRotator BoomRotation = CameraBoom->GetRelativeRotation();
+	BoomRotation.Pitch = State.Pitch;
+	CameraBoom->SetRelativeRotation(BoomRotation);
 
-	if (bIsRotatingCamera)
+	const FQuat PawnRotation = FRotator(0.0, State.Yaw, 0.0).Quaternion();
+	if (UPawnMovementComponent* MovementComponent = PossessedCameraPawn->GetMovementComponent())
 	{
-		if(GetMousePosition(LastMousePositionForRotation.X, LastMousePositionForRotation.Y))
-		{
-			UE_LOG(LogTemp, Log, TEXT("HandleRotateCameraTrigger: Rotation STARTED. LastMousePos: %s"), *LastMousePositionForRotation.ToString());
-		}
-		else
-		{
-			UE_LOG(LogTemp, Warning, TEXT("HandleRotateCameraTrigger: Rotation STARTED but GetMousePosition failed!"));
-		}
+		MovementComponent->MoveUpdatedComponent(State.Pan - PossessedCameraPawn->GetActorLocation(), PawnRotation, false);
+		// Exposed as the pawn velocity, which streaming uses for its look-ahead.
+		MovementComponent->Velocity = CameraIntegrator.GetVelocity().Pan;
+		MovementComponent->UpdateComponentVelocity();
 	}
 	else
 	{
-		UE_LOG(LogTemp, Log, TEXT("HandleRotateCameraTrigger: Rotation ENDED."));
+		PossessedCameraPawn->SetActorLocationAndRotation(State.Pan, PawnRotation);
 	}
 }
 
-void AStrategyPlayerController::HandleRotateCameraValue(const FInputActionValue& Value)
+void AStrategyPlayerController::FollowTerrain()
 {
-	const FVector2D MouseDelta = Value.Get<FVector2D>();
-	UE_LOG(LogTemp, Warning, TEXT("HandleRotateCameraValue TRIGGERED! MouseDelta: X=%.2f, Y=%.2f. bIsRotatingCamera: %s"), MouseDelta.X, MouseDelta.Y, bIsRotatingCamera ? TEXT("true") : TEXT("false"));
-
-	if (!bIsRotatingCamera)
+	if (!bFollowTerrain || !TerrainHeights)
 	{
-		UE_LOG(LogTemp, Log, TEXT("HandleRotateCameraValue: Not currently rotating. Ignoring value."));
 		return;
 	}
-	if (MouseDelta.IsNearlyZero())
+
+	// Heights come from the cache only; where a tile isn't sampled yet the pan target keeps its height for now.
+	const FVector2D PanTarget(TargetPanLocation);
+	TerrainHeights->RequestArea(PanTarget, FMath::Max(double(TargetZoomLength) * TerrainPrefetchArmLengthScale, TerrainHeights->GetSettings().TileSize));
+
+	float GroundHeight = 0.f;
+	if (TerrainHeights->GetHeight(PanTarget, GroundHeight))
 	{
-		 UE_LOG(LogTemp, Log, TEXT("HandleRotateCameraValue: MouseDelta is zero. No rotation applied."));
-		return;
+		TargetPanLocation.Z = GroundHeight;
 	}
+}
 
-	AddYawInput(MouseDelta.X * CameraRotationSpeed);
-	UE_LOG(LogTemp, Log, TEXT("HandleRotateCameraValue: Added YawInput: %.2f. Controller New ControlRotation: %s"), MouseDelta.X * CameraRotationSpeed, *GetControlRotation().ToString());
+FRotator AStrategyPlayerController::GetBoomWorldRotation(float BoomPitch) const
+{
+	// The boom inherits only the pawn's yaw, and the pawn takes its yaw from the control rotation.
+	const float Yaw = PossessedCameraPawn ? PossessedCameraPawn->GetActorRotation().Yaw : GetControlRotation().Yaw;
+	return FRotator(BoomPitch, Yaw, 0.f);
 }
 
-void AStrategyPlayerController::UpdateCameraMovement(float DeltaTime)
+bool AStrategyPlayerController::BeginZoomAnchor()
 {
-	// Placeholder for continuous movement logic like edge scroll
+	USpringArmComponent* CameraBoom = PossessedCameraPawn->GetCameraBoom();
+
+	// The cursor ray against the cached heightfield, or where the heightfield isn't sampled yet, the cursor query's hit.
+	// That one is used only if it was traced from the current cursor and view; otherwise one synchronous trace, at most
+	// once per gesture (later wheel ticks of the gesture reuse the anchor).
+	FVector FocusPoint;
+	FVector RayOrigin;
+	FVector RayDirection;
+	const bool bHitHeightfield = bFollowTerrain && TerrainHeights && CursorQuery->GetCursorRay(RayOrigin, RayDirection)
+		&& TerrainHeights->Raycast(RayOrigin, RayDirection, MaxZoomLength * 10.0, FocusPoint);
+	if (!bHitHeightfield)
+	{
+		FHitResult HitResult;
+		if (!CursorQuery->GetCurrentCursorHit(HitResult))
+		{
+			ZoomAnchor.Reset();
+			return false;
+		}
+		FocusPoint = HitResult.Location;
+	}
+
+	CursorQuery->GetMousePosition(ZoomAnchorMousePosition);
+	DebugBeforeZoomLocation = FocusPoint;
+	return ZoomAnchor.Begin(PossessedCameraPawn->GetActorLocation(), GetBoomWorldRotation(CameraBoom->GetRelativeRotation().Pitch), CameraBoom->TargetArmLength, FocusPoint);
+}
+
+// --- PAN INPUT ---
+void AStrategyPlayerController::HandleMoveInput(const FInputActionValue& Value)
+{
+	STRATEGY_CAMERA_SCOPE(MoveInput, STAT_StrategyHandleMoveInput);
+	// Only accumulated here; SampleCameraPanInput turns it into this frame's pan together with edge scroll and drag.
+	const FVector2D MoveValue = Value.Get<FVector2D>();
+	RecordInput(EStrategyInputRecordType::Move, float(MoveValue.X), float(MoveValue.Y));
+	PendingPanKeyInput += MoveValue;
+}
+
+void AStrategyPlayerController::HandlePanDragStarted(const FInputActionValue& Value)
+{
+	STRATEGY_CAMERA_SCOPE(PanDragInput, STAT_StrategyHandlePanDrag);
+	RecordInput(EStrategyInputRecordType::PanDragStarted);
+	bIsPanDragging = CursorQuery->GetMousePosition(LastPanDragMousePosition);
+}
+
+void AStrategyPlayerController::HandlePanDragCompleted(const FInputActionValue& Value)
+{
+	STRATEGY_CAMERA_SCOPE(PanDragInput, STAT_StrategyHandlePanDrag);
+	RecordInput(EStrategyInputRecordType::PanDragCompleted);
+	bIsPanDragging = false;
+}
+
+void AStrategyPlayerController::SampleCameraPanInput()
+{
+	// The only viewport and mouse reads for panning this frame.
+	FIntPoint ViewportSize(0, 0);
+	FVector2D MousePosition;
+	const bool bHasCursor = CursorQuery->GetViewportSize(ViewportSize) && CursorQuery->GetMousePosition(MousePosition);
+	FrameViewportWidth = ViewportSize.X;
+
+	// 1. Keys.
+	FVector2D Intent = PendingPanKeyInput;
+	PendingPanKeyInput = FVector2D::ZeroVector;
+
+	// 2. Edge scroll, ramping up from the inner edge of the margin to the border. Off while dragging or rotating.
+	const bool bCursorInViewport = bHasCursor && MousePosition.X >= 0.0 && MousePosition.Y >= 0.0 && MousePosition.X <= ViewportSize.X && MousePosition.Y <= ViewportSize.Y;
+	if (bEnableEdgeScroll && EdgeScrollMargin > 0.f && bCursorInViewport && !bIsPanDragging && !bIsRotatingCamera)
+	{
+		auto EdgeWeight = [this](double DistanceToBorder) { return FMath::Clamp(1.0 - DistanceToBorder / EdgeScrollMargin, 0.0, 1.0); };
+		Intent.X += EdgeWeight(ViewportSize.X - MousePosition.X) - EdgeWeight(MousePosition.X);
+		Intent.Y += EdgeWeight(MousePosition.Y) - EdgeWeight(ViewportSize.Y - MousePosition.Y);
+	}
+	FramePanIntent = Intent.GetClampedToMaxSize(1.0);
+
+	// 3. Drag: how far the cursor moved since last frame while the drag is held.
+	if (bIsPanDragging && bHasCursor)
+	{
+		FramePanDragPixels += MousePosition - LastPanDragMousePosition;
+		LastPanDragMousePosition = MousePosition;
+	}
+
+	if (!FramePanIntent.IsNearlyZero() || !FramePanDragPixels.IsNearlyZero())
+	{
+		WakeCameraUpdate();
+	}
+}
+
+float AStrategyPlayerController::GetPanSpeedScale(double ArmLength) const
+{
+	const float ZoomAlpha = MaxZoomLength > MinZoomLength ? FMath::Clamp(float((ArmLength - MinZoomLength) / (MaxZoomLength - MinZoomLength)), 0.f, 1.f) : 0.f;
+	return FMath::Lerp(PanSpeedScaleAtMinZoom, PanSpeedScaleAtMaxZoom, ZoomAlpha);
+}
+
+void AStrategyPlayerController::HandleZoomInput(const FInputActionValue& Value)
+{
+	STRATEGY_CAMERA_SCOPE(ZoomInput, STAT_StrategyHandleZoomInput);
+	const float ZoomAxisValue = Value.Get<float>();
+	RecordInput(EStrategyInputRecordType::Zoom, ZoomAxisValue);
+	if (FMath::IsNearlyZero(ZoomAxisValue) || !PossessedCameraPawn)
+	{
+		return;
+	}
+
+	USpringArmComponent* CameraBoom = PossessedCameraPawn->GetCameraBoom();
+	if (!CameraBoom)
+	{
+		return;
+	}
+
+	// --- Zoom-to-cursor (ONLY for Zooming IN) ---
+	// The ground point is traced once per gesture; the pawn translation itself is solved every tick
+	// in UpdateCameraSprings as the arm length and pitch converge.
+	if (ZoomAxisValue > 0)
+	{
+		FVector2D MousePosition;
+		if (CursorQuery->GetMousePosition(MousePosition))
+		{
+			if (!ZoomAnchor.IsActive() || FVector2D::DistSquared(MousePosition, ZoomAnchorMousePosition) > FMath::Square(ZoomAnchorCursorTolerance))
+			{
+				BeginZoomAnchor();
+			}
+		}
+		else
+		{
+			ZoomAnchor.Reset();
+		}
+	}
+	else
+	{
+		ZoomAnchor.Reset();
+	}
+
+	// --- Apply the new zoom target for the Tick function to handle ---
+	TargetZoomLength = FMath::Clamp(CameraBoom->TargetArmLength - (ZoomAxisValue * ZoomStepAmount), MinZoomLength, MaxZoomLength);
+	UpdateStreamingTarget();
+	WakeCameraUpdate();
+}
+
+void AStrategyPlayerController::HandleRotateCameraTrigger(const FInputActionValue& Value)
+{
+	STRATEGY_CAMERA_SCOPE(RotateInput, STAT_StrategyHandleRotateCamera);
+	const bool bPressed = Value.Get<bool>();
+	RecordInput(EStrategyInputRecordType::RotateTrigger, 0.f, 0.f, bPressed ? 1 : 0);
+	STRATEGY_CAMERA_LOG(Warning, TEXT("HandleRotateCameraTrigger TRIGGERED! bPressed: %s. Current bIsRotatingCamera: %s"), bPressed ? TEXT("true") : TEXT("false"), bIsRotatingCamera ? TEXT("true") : TEXT("false"));
+	bIsRotatingCamera = bPressed;
+
+	if (bIsRotatingCamera)
+	{
+		if (CursorQuery->GetMousePosition(LastMousePositionForRotation))
+		{
+			STRATEGY_CAMERA_LOG(Log, TEXT("HandleRotateCameraTrigger: Rotation STARTED. LastMousePos: %s"), *LastMousePositionForRotation.ToString());
+		}
+		else
+		{
+			STRATEGY_CAMERA_LOG(Warning, TEXT("HandleRotateCameraTrigger: Rotation STARTED but GetMousePosition failed!"));
+		}
+	}
+	else
+	{
+		STRATEGY_CAMERA_LOG(Log, TEXT("HandleRotateCameraTrigger: Rotation ENDED."));
+	}
+}
+
+void AStrategyPlayerController::HandleRotateCameraValue(const FInputActionValue& Value)
+{
+	STRATEGY_CAMERA_SCOPE(RotateInput, STAT_StrategyHandleRotateCamera);
+	const FVector2D MouseDelta = Value.Get<FVector2D>();
+	RecordInput(EStrategyInputRecordType::RotateValue, float(MouseDelta.X), float(MouseDelta.Y));
+	STRATEGY_CAMERA_LOG(Warning, TEXT("HandleRotateCameraValue TRIGGERED! MouseDelta: X=%.2f, Y=%.2f. bIsRotatingCamera: %s"), MouseDelta.X, MouseDelta.Y, bIsRotatingCamera ? TEXT("true") : TEXT("false"));
+
+	if (!bIsRotatingCamera)
+	{
+		STRATEGY_CAMERA_LOG(Log, TEXT("HandleRotateCameraValue: Not currently rotating. Ignoring value."));
+		return;
+	}
+	if (MouseDelta.IsNearlyZero())
+	{
+		STRATEGY_CAMERA_LOG(Log, TEXT("HandleRotateCameraValue: MouseDelta is zero. No rotation applied."));
+		return;
+	}
+
+	AddYawInput(MouseDelta.X * CameraRotationSpeed);
+	WakeCameraUpdate();
+	STRATEGY_CAMERA_LOG(Log, TEXT("HandleRotateCameraValue: Added YawInput: %.2f. Controller New ControlRotation: %s"), MouseDelta.X * CameraRotationSpeed, *GetControlRotation().ToString());
+}
+
+// --- INPUT RECORDING AND REPLAY ---
+void AStrategyPlayerController::StartInputRecording(int32 MaxRecords)
+{
+	StopInputReplay();
+	InputRecorder.Start(MaxRecords, InputRecordingSnapshotInterval);
+}
+
+void AStrategyPlayerController::RecordInput(EStrategyInputRecordType Type, float A, float B, uint8 Flags)
+{
+	// Every camera input handler passes through here.
+	if (Type != EStrategyInputRecordType::Frame)
+	{
+		NoteInputProcessed();
+	}
+
+	if (!InputRecorder.IsRecording())
+	{
+		return;
+	}
+
+	if (!InputRecorder.IsFrameOpen(GFrameCounter))
+	{
+		// Snapshots are only taken before the frame's first input and outside zoom gestures, whose anchor isn't recorded.
+		if (InputRecorder.WantsSnapshot() && !ZoomAnchor.IsActive() && PossessedCameraPawn)
+		{
+			InputRecorder.AddSnapshot(MakeInputSnapshot());
+		}
+
+		FVector2D CursorPosition = FVector2D::ZeroVector;
+		const bool bHasCursor = CursorQuery->GetMousePosition(CursorPosition);
+		InputRecorder.BeginFrame(GFrameCounter, GetWorld()->GetDeltaSeconds() * CustomTimeDilation, bHasCursor, CursorPosition);
+	}
+
+	if (Type != EStrategyInputRecordType::Frame)
+	{
+		InputRecorder.Record(Type, A, B, 0.f, Flags);
+	}
+}
+
+FStrategyInputSnapshot AStrategyPlayerController::MakeInputSnapshot() const
+{
+	FStrategyInputSnapshot Snapshot;
+	Snapshot.CameraIntegrator = CameraIntegrator;
+	Snapshot.PawnLocation = PossessedCameraPawn->GetActorLocation();
+	Snapshot.PawnRotation = PossessedCameraPawn->GetActorRotation();
+	Snapshot.ControlRotation = GetControlRotation();
+	if (const USpringArmComponent* CameraBoom = PossessedCameraPawn->GetCameraBoom())
+	{
+		Snapshot.BoomRotation = CameraBoom->GetRelativeRotation();
+		Snapshot.BoomArmLength = CameraBoom->TargetArmLength;
+	}
+	Snapshot.TargetPanLocation = TargetPanLocation;
+	Snapshot.TargetZoomLength = TargetZoomLength;
+	Snapshot.LastPanDragMousePosition = LastPanDragMousePosition;
+	Snapshot.FramePanDragPixels = FramePanDragPixels;
+	CursorQuery->GetViewportSize(Snapshot.ViewportSize);
+	Snapshot.bIsRotatingCamera = bIsRotatingCamera;
+	Snapshot.bIsPanDragging = bIsPanDragging;
+	Snapshot.bCameraConverging = CameraSettleState == EStrategyCameraSettleState::Converging;
+	return Snapshot;
+}
+
+void AStrategyPlayerController::ApplyInputSnapshot(const FStrategyInputSnapshot& Snapshot)
+{
+	ZoomAnchor.Reset();
+	PossessedCameraPawn->SetActorLocationAndRotation(Snapshot.PawnLocation, Snapshot.PawnRotation);
+	if (USpringArmComponent* CameraBoom = PossessedCameraPawn->GetCameraBoom())
+	{
+		CameraBoom->SetRelativeRotation(Snapshot.BoomRotation);
+		CameraBoom->TargetArmLength = Snapshot.BoomArmLength;
+	}
+	SetControlRotation(Snapshot.ControlRotation);
+
+	CameraIntegrator = Snapshot.CameraIntegrator;
+	TargetPanLocation = Snapshot.TargetPanLocation;
+	TargetZoomLength = Snapshot.TargetZoomLength;
+	LastPanDragMousePosition = Snapshot.LastPanDragMousePosition;
+	FramePanDragPixels = Snapshot.FramePanDragPixels;
+	PendingPanKeyInput = FVector2D::ZeroVector;
+	FramePanIntent = FVector2D::ZeroVector;
+	bIsRotatingCamera = Snapshot.bIsRotatingCamera;
+	bIsPanDragging = Snapshot.bIsPanDragging;
+	CursorQuery->SetSimulatedViewportSize(Snapshot.ViewportSize);
+
+	if (Snapshot.bCameraConverging)
+	{
+		CameraSettleState = EStrategyCameraSettleState::Converging;
+		CameraTickFunction.SetTickFunctionEnable(true);
+	}
+	else
+	{
+		SettleCamera();
+	}
+	UpdateStreamingTarget();
+}
+
+bool AStrategyPlayerController::StartInputReplay(const FString& Filename, bool bMaxSpeed)
+{
+	StopInputReplay();
+	if (!PossessedCameraPawn || !InputPlayer.Open(Filename))
+	{
+		return false;
+	}
+
+	InputRecorder.Stop();
+	SetLiveInputEnabled(false);
+
+	bReplayAtMaxSpeed = bMaxSpeed;
+	if (bReplayAtMaxSpeed)
+	{
+		bSavedUseFixedTimeStep = FApp::UseFixedTimeStep();
+		SavedFixedDeltaTime = FApp::GetFixedDeltaTime();
+		FApp::SetUseFixedTimeStep(true);
+		FApp::SetFixedDeltaTime(InputPlayer.PeekDeltaTime());
+	}
+
+	UE_LOG(LogStrategyCamera, Log, TEXT("[CONTROLLER] Replaying %d frames from '%s'."), InputPlayer.GetNumFrames(), *Filename);
+	return true;
+}
+
+void AStrategyPlayerController::StopInputReplay()
+{
+	if (!InputPlayer.IsOpen())
+	{
+		return;
+	}
+
+	InputPlayer.Close();
+	ReplayDeltaTime = -1.f;
+	CursorQuery->ClearSimulatedCursor();
+	SetLiveInputEnabled(true);
+
+	if (bReplayAtMaxSpeed)
+	{
+		FApp::SetUseFixedTimeStep(bSavedUseFixedTimeStep);
+		FApp::SetFixedDeltaTime(SavedFixedDeltaTime);
+		bReplayAtMaxSpeed = false;
+	}
+}
+
+void AStrategyPlayerController::ReplayInputFrame()
+{
+	if (!PossessedCameraPawn)
+	{
+		StopInputReplay();
+		return;
+	}
+
+	// The snapshot is applied at the first replayed frame, so nothing from the frame the replay was started in leaks in.
+	if (InputPlayer.IsAtStart())
+	{
+		ApplyInputSnapshot(InputPlayer.GetSnapshot());
+	}
+
+	const FStrategyInputRecord* Frame = nullptr;
+	TConstArrayView<FStrategyInputRecord> Events;
+	if (!InputPlayer.NextFrame(Frame, Events))
+	{
+		UE_LOG(LogStrategyCamera, Log, TEXT("[CONTROLLER] Input replay finished."));
+		StopInputReplay();
+		return;
+	}
+
+	ReplayDeltaTime = Frame->A;
+	if (Frame->Flags != 0)
+	{
+		CursorQuery->SetSimulatedScreenPosition(FVector2D(Frame->B, Frame->C), InputPlayer.GetSnapshot().ViewportSize);
+	}
+
+	for (const FStrategyInputRecord& Event : Events)
+	{
+		switch (Event.Type)
+		{
+		case EStrategyInputRecordType::Move:
+			HandleMoveInput(FInputActionValue(FVector2D(Event.A, Event.B)));
+			break;
+		case EStrategyInputRecordType::Zoom:
+			HandleZoomInput(FInputActionValue(Event.A));
+			break;
+		case EStrategyInputRecordType::RotateTrigger:
+			HandleRotateCameraTrigger(FInputActionValue(Event.Flags != 0));
+			break;
+		case EStrategyInputRecordType::RotateValue:
+			HandleRotateCameraValue(FInputActionValue(FVector2D(Event.A, Event.B)));
+			break;
+		case EStrategyInputRecordType::PanDragStarted:
+			HandlePanDragStarted(FInputActionValue(true));
+			break;
+		case EStrategyInputRecordType::PanDragCompleted:
+			HandlePanDragCompleted(FInputActionValue(false));
+			break;
+		default:
+			break;
+		}
+	}
+
+	// The engine's next frame runs at the next recorded frame time.
+	const float NextDeltaTime = InputPlayer.PeekDeltaTime();
+	if (bReplayAtMaxSpeed && NextDeltaTime > 0.f)
+	{
+		FApp::SetFixedDeltaTime(NextDeltaTime);
+	}
+}
+
+void AStrategyPlayerController::SetLiveInputEnabled(bool bEnabled)
+{
+	UInputMappingContext* MappingContext = DefaultMappingContext.Get();
+	if (!MappingContext)
+	{
+		return;
+	}
+
+	if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(GetLocalPlayer()))
+	{
+		if (bEnabled)
+		{
+			Subsystem->AddMappingContext(MappingContext, 0);
+		}
+		else
+		{
+			Subsystem->RemoveMappingContext(MappingContext);
+		}
+	}
+}
+
+// --- SELECTION ---
+void AStrategyPlayerController::HandleSelectStarted(const FInputActionValue& Value)
+{
+	STRATEGY_CAMERA_SCOPE(SelectInput, STAT_StrategyHandleSelect);
+	NoteInputProcessed();
+	if (PlacementClass)
+	{
+		// Shift-click keeps placing copies of the building.
+		ConfirmPlacement();
+		if (!IsInputKeyDown(EKeys::LeftShift) && !IsInputKeyDown(EKeys::RightShift))
+		{
+			CancelPlacement();
+		}
+		return;
+	}
+	bIsMarqueeSelecting = CursorQuery->GetMousePosition(MarqueeStartPosition);
+}
+
+void AStrategyPlayerController::HandleSelectCompleted(const FInputActionValue& Value)
+{
+	STRATEGY_CAMERA_SCOPE(SelectInput, STAT_StrategyHandleSelect);
+	FVector2D MarqueeEndPosition;
+	if (!bIsMarqueeSelecting || !CursorQuery->GetMousePosition(MarqueeEndPosition))
+	{
+		bIsMarqueeSelecting = false;
+		return;
+	}
+	bIsMarqueeSelecting = false;
+
+	const bool bAddToSelection = IsInputKeyDown(EKeys::LeftShift) || IsInputKeyDown(EKeys::RightShift);
+	const int32 NumSelected = SelectUnitsInMarquee(MarqueeStartPosition, MarqueeEndPosition, bAddToSelection);
+	STRATEGY_CAMERA_LOG(Log, TEXT("[CONTROLLER] Marquee %s - %s selected %d units (%d total)."), *MarqueeStartPosition.ToString(), *MarqueeEndPosition.ToString(), NumSelected, SelectedUnits.Num());
+}
+
+int32 AStrategyPlayerController::SelectUnitsInMarquee(const FVector2D& ScreenStart, const FVector2D& ScreenEnd, bool bAddToSelection)
+{
+	if (!bAddToSelection)
+	{
+		SelectedUnits.Reset();
+	}
+
+	UStrategyUnitRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistrySubsystem>();
+	int32 ViewportWidth = 0;
+	int32 ViewportHeight = 0;
+	GetViewportSize(ViewportWidth, ViewportHeight);
+	if (!Registry || !PlayerCameraManager || ViewportWidth <= 0 || ViewportHeight <= 0)
+	{
+		return 0;
+	}
+
+	FVector2D RectStart = ScreenStart;
+	FVector2D RectEnd = ScreenEnd;
+	if (FVector2D::DistSquared(ScreenStart, ScreenEnd) < FMath::Square(MarqueeClickRadius))
+	{
+		const FVector2D Center = (ScreenStart + ScreenEnd) * 0.5;
+		RectStart = Center - FVector2D(MarqueeClickRadius);
+		RectEnd = Center + FVector2D(MarqueeClickRadius);
+	}
+
+	const FStrategyScreenQuery Query = FStrategyScreenQuery::Make(PlayerCameraManager->GetCameraCacheView(), FIntPoint(ViewportWidth, ViewportHeight), RectStart, RectEnd);
+	if (!bAddToSelection)
+	{
+		return Registry->SelectInScreenRect(Query, SelectedUnits);
+	}
+
+	MarqueeScratch.Reset();
+	Registry->SelectInScreenRect(Query, MarqueeScratch);
+
+	// One hashed lookup per candidate instead of a scan of the selection.
+	MarqueeSelectedSet.Reset();
+	MarqueeSelectedSet.Append(SelectedUnits);
+	int32 NumAdded = 0;
+	for (const FStrategyUnitHandle& Unit : MarqueeScratch)
+	{
+		bool bAlreadySelected = false;
+		MarqueeSelectedSet.Add(Unit, &bAlreadySelected);
+		if (!bAlreadySelected)
+		{
+			SelectedUnits.Add(Unit);
+			++NumAdded;
+		}
+	}
+	return NumAdded;
+}
+
+// --- ORDERS ---
+void AStrategyPlayerController::HandleMoveOrder(const FInputActionValue& Value)
+{
+	STRATEGY_CAMERA_SCOPE(MoveOrderInput, STAT_StrategyHandleMoveOrder);
+	NoteInputProcessed();
+	if (PlacementClass)
+	{
+		CancelPlacement();
+		return;
+	}
+
+	FHitResult HitResult;
+	if (SelectedUnits.IsEmpty() || !CursorQuery->GetCursorHit(HitResult))
+	{
+		return;
+	}
+
+	const int32 NumOrdered = IssueMoveOrder(HitResult.Location);
+	STRATEGY_CAMERA_LOG(Log, TEXT("[CONTROLLER] Move order to %s for %d units."), *HitResult.Location.ToString(), NumOrdered);
+}
+
+int32 AStrategyPlayerController::IssueMoveOrder(const FVector& Destination)
+{
+	// In a lockstep session orders execute on every peer's turn instead of immediately.
+	UStrategyLockstepSubsystem* Lockstep = GetWorld()->GetSubsystem<UStrategyLockstepSubsystem>();
+	if (Lockstep && Lockstep->IsSessionActive())
+	{
+		return Lockstep->IssueMoveOrder(SelectedUnits, Destination, MoveOrderSpacing);
+	}
+
+	UStrategyUnitSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UStrategyUnitSimulationSubsystem>();
+	return Simulation ? Simulation->MoveUnitsInFormation(SelectedUnits, Destination, MoveOrderFormation, GetControlRotation().Yaw, MoveOrderSpacing) : 0;
+}
+
+// --- CAMERA JUMPS ---
+void AStrategyPlayerController::JumpCameraTo(const FVector& Location)
+{
+	if (!PossessedCameraPawn)
+	{
+		return;
+	}
+
+	WakeCameraUpdate();
+
+	// The pan channel and its target move together, so the springs don't sweep the camera across the map; terrain
+	// following corrects the height once the destination's tiles are sampled.
+	const FVector Offset(Location.X - CameraIntegrator.GetCurrentState().Pan.X, Location.Y - CameraIntegrator.GetCurrentState().Pan.Y, 0.0);
+	CameraIntegrator.OffsetPan(Offset);
+	TargetPanLocation.X = Location.X;
+	TargetPanLocation.Y = Location.Y;
+	ZoomAnchor.Reset();
+}
+
+bool AStrategyPlayerController::JumpCameraToMinimap(FVector2D MinimapUV)
+{
+	const UStrategyMinimapSubsystem* Minimap = GetWorld()->GetSubsystem<UStrategyMinimapSubsystem>();
+	if (!Minimap || MinimapUV.X < 0.0 || MinimapUV.Y < 0.0 || MinimapUV.X > 1.0 || MinimapUV.Y > 1.0)
+	{
+		return false;
+	}
+
+	JumpCameraTo(Minimap->MinimapToWorld(MinimapUV));
+	return true;
+}
+
+// --- BUILDING PLACEMENT ---
+void AStrategyPlayerController::BeginPlacement(TSubclassOf<AActor> BuildingClass, FIntPoint FootprintSize)
+{
+	PlacementClass = BuildingClass;
+	PlacementSize = FIntPoint(FMath::Clamp(FootprintSize.X, 1, FStrategyPlacementFootprint::MaxSize), FMath::Clamp(FootprintSize.Y, 1, FStrategyPlacementFootprint::MaxSize));
+	PlacementQuarterTurns = 0;
+	PlacementFootprint = FStrategyPlacementFootprint::MakeRectangle(PlacementSize.X, PlacementSize.Y);
+	PlacementCell = FIntPoint(MAX_int32, MAX_int32);
+	bPlacementValid = false;
+	bIsMarqueeSelecting = false;
+}
+
+void AStrategyPlayerController::CancelPlacement()
+{
+	PlacementClass = nullptr;
+	bPlacementValid = false;
+}
+
+void AStrategyPlayerController::RotatePlacement()
+{
+	if (!PlacementClass)
+	{
+		return;
+	}
+
+	PlacementQuarterTurns = (PlacementQuarterTurns + 1) & 3;
+	PlacementFootprint = FStrategyPlacementFootprint::MakeRectangle(PlacementSize.X, PlacementSize.Y).Rotated(PlacementQuarterTurns);
+	PlacementCell = FIntPoint(MAX_int32, MAX_int32);
+	SetPlacementLocation(PlacementGroundPoint);
+}
+
+void AStrategyPlayerController::HandleRotatePlacement(const FInputActionValue& Value)
+{
+	RotatePlacement();
+}
+
+void AStrategyPlayerController::UpdatePlacementPreview()
+{
+	FVector GroundPoint;
+	SetPlacementLocation(GetCursorGroundPoint(GroundPoint) ? GroundPoint : PlacementGroundPoint);
+}
+
+void AStrategyPlayerController::SetPlacementLocation(const FVector& Location)
+{
+	const UStrategyPlacementSubsystem* Placement = GetWorld()->GetSubsystem<UStrategyPlacementSubsystem>();
+	if (!Placement || !PlacementClass)
+	{
+		bPlacementValid = false;
+		return;
+	}
+
+	PlacementGroundPoint = Location;
+	const FIntPoint Cell = Placement->GetFootprintMinCell(Location, PlacementFootprint);
+	if (Cell == PlacementCell && Placement->GetRevision() == PlacementRevision)
+	{
+		return;
+	}
+
+	PlacementCell = Cell;
+	PlacementRevision = Placement->GetRevision();
+	bPlacementValid = Placement->CanPlace(PlacementFootprint, Cell);
+}
+
+FTransform AStrategyPlayerController::GetPlacementTransform() const
+{
+	const UStrategyPlacementSubsystem* Placement = GetWorld()->GetSubsystem<UStrategyPlacementSubsystem>();
+	if (!Placement || !PlacementClass)
+	{
+		return FTransform::Identity;
+	}
+
+	const FVector Center = Placement->GetFootprintCenter(PlacementCell, PlacementFootprint);
+	return FTransform(FRotator(0.0, PlacementQuarterTurns * 90.0, 0.0), FVector(Center.X, Center.Y, PlacementGroundPoint.Z));
+}
+
+AActor* AStrategyPlayerController::ConfirmPlacement()
+{
+	// Something may have been built there since the preview was last validated.
+	PlacementRevision = MAX_uint32;
+	SetPlacementLocation(PlacementGroundPoint);
+	if (!bPlacementValid)
+	{
+		return nullptr;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParameters.Owner = this;
+	AActor* Building = GetWorld()->SpawnActor<AActor>(PlacementClass, GetPlacementTransform(), SpawnParameters);
+	if (!Building)
+	{
+		return nullptr;
+	}
+
+	// A building class without its own footprint component gets one for the previewed size.
+	if (!Building->FindComponentByClass<UStrategyBuildingFootprintComponent>())
+	{
+		UStrategyBuildingFootprintComponent* Footprint = NewObject<UStrategyBuildingFootprintComponent>(Building);
+		Footprint->FootprintSize = PlacementSize;
+		Building->AddInstanceComponent(Footprint);
+		Footprint->RegisterComponent();
+	}
+
+	UE_LOG(LogStrategyUnits, Log, TEXT("[CONTROLLER] Placed %s at cell %s."), *GetNameSafe(Building), *PlacementCell.ToString());
+	return Building;
+}
+
+bool AStrategyPlayerController::GetCursorGroundPoint(FVector& OutPoint) const
+{
+	FVector RayOrigin;
+	FVector RayDirection;
+	if (!CursorQuery || !CursorQuery->GetCursorRay(RayOrigin, RayDirection))
+	{
+		return false;
+	}
+
+	if (bFollowTerrain && TerrainHeights && TerrainHeights->Raycast(RayOrigin, RayDirection, MaxZoomLength * 10.0, OutPoint))
+	{
+		return true;
+	}
+
+	// The pawn sits on the ground it pans over.
+	const double GroundHeight = PossessedCameraPawn ? PossessedCameraPawn->GetActorLocation().Z : 0.0;
+	if (RayDirection.Z > -UE_KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+	OutPoint = RayOrigin + RayDirection * ((GroundHeight - RayOrigin.Z) / RayDirection.Z);
+	return true;
+}
+
+// --- CAMERA BOOKMARKS ---
+void AStrategyPlayerController::SetCameraBookmark(int32 Slot)
+{
+	if (!PossessedCameraPawn || Slot < 0 || Slot >= NumCameraBookmarkSlots)
+	{
+		return;
+	}
+
+	if (CameraBookmarks.Num() <= Slot)
+	{
+		CameraBookmarks.SetNum(Slot + 1);
+	}
+
+	// Where the camera is heading; a sleeping camera is at rest wherever the pawn was left.
+	FStrategyCameraBookmark& Bookmark = CameraBookmarks[Slot];
+	Bookmark.Location = CameraSettleState == EStrategyCameraSettleState::Settled ? PossessedCameraPawn->GetActorLocation() : TargetPanLocation;
+	Bookmark.Yaw = GetControlRotation().Yaw;
+	Bookmark.ZoomLength = TargetZoomLength;
+	Bookmark.bIsSet = true;
+}
+
+const FStrategyCameraBookmark* AStrategyPlayerController::GetCameraBookmark(int32 Slot) const
+{
+	return CameraBookmarks.IsValidIndex(Slot) && CameraBookmarks[Slot].bIsSet ? &CameraBookmarks[Slot] : nullptr;
+}
+
+bool AStrategyPlayerController::JumpToCameraBookmark(int32 Slot, bool bCutWhenReady)
+{
+	const FStrategyCameraBookmark* Bookmark = GetCameraBookmark(Slot);
+	return Bookmark && JumpToCameraBookmarkData(*Bookmark, bCutWhenReady);
+}
+
+bool AStrategyPlayerController::JumpToCameraBookmarkData(const FStrategyCameraBookmark& Bookmark, bool bCutWhenReady)
+{
+	if (!PossessedCameraPawn || !PossessedCameraPawn->GetCameraBoom())
+	{
+		return false;
+	}
+
+	PendingJumpBookmark = Bookmark;
+	PendingJumpBookmark.ZoomLength = FMath::Clamp(Bookmark.ZoomLength, MinZoomLength, MaxZoomLength);
+	bCameraJumpPending = true;
+	bCameraJumpCut = bCutWhenReady;
+	bCameraJumpPrefetched = false;
+	CameraJumpStartCycles = FPlatformTime::Cycles64();
+	CameraJumpStartFrame = GFrameCounter;
+	LastCameraJumpMetrics = FStrategyCameraJumpMetrics();
+	LastCameraJumpMetrics.bCut = bCutWhenReady;
+
+	// Everything the destination view needs is requested up front: its World Partition cells through the pawn's
+	// prefetch source, its assets, and the ground heights terrain following will sample there.
+	const float Pitch = PitchCurveTable.IsBaked() ? GetBoomPitchForArmLength(PendingJumpBookmark.ZoomLength) : float(CameraIntegrator.GetCurrentState().Pitch);
+	PossessedCameraPawn->SetStreamingPrefetch(PendingJumpBookmark.Location, PendingJumpBookmark.ZoomLength, Pitch, PendingJumpBookmark.Yaw);
+
+	CameraJumpAssets.Reset();
+	if (PendingJumpBookmark.PrefetchAssets.Num() > 0)
+	{
+		CameraJumpAssets = UAssetManager::GetStreamableManager().RequestAsyncLoad(PendingJumpBookmark.PrefetchAssets, FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+	}
+
+	if (bFollowTerrain && TerrainHeights)
+	{
+		TerrainHeights->RequestArea(FVector2D(PendingJumpBookmark.Location), FMath::Max(double(PendingJumpBookmark.ZoomLength) * TerrainPrefetchArmLengthScale, TerrainHeights->GetSettings().TileSize));
+	}
+
+	if (!bCutWhenReady)
+	{
+		MoveToCameraBookmark(PendingJumpBookmark, false);
+	}
+	return true;
+}
+
+void AStrategyPlayerController::MoveToCameraBookmark(const FStrategyCameraBookmark& Bookmark, bool bCut)
+{
+	WakeCameraUpdate();
+
+	FRotator Rotation = GetControlRotation();
+	Rotation.Yaw = Bookmark.Yaw;
+	SetControlRotation(Rotation);
+	TargetPanLocation = Bookmark.Location;
+	TargetZoomLength = Bookmark.ZoomLength;
+	ZoomAnchor.Reset();
+
+	if (bCut)
+	{
+		// Rests the springs at the destination; the next camera tick puts the pawn and boom there.
+		FStrategyCameraSpringState State;
+		State.ArmLength = Bookmark.ZoomLength;
+		State.Pitch = PitchCurveTable.IsBaked() ? GetBoomPitchForArmLength(Bookmark.ZoomLength) : CameraIntegrator.GetCurrentState().Pitch;
+		State.Yaw = Bookmark.Yaw;
+		State.Pan = Bookmark.Location;
+		CameraIntegrator.Reset(State);
+	}
+
+	UpdateStreamingTarget();
+}
+
+void AStrategyPlayerController::UpdateCameraJump()
+{
+	const double ElapsedMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - CameraJumpStartCycles);
+
+	if (!bCameraJumpPrefetched)
+	{
+		const bool bAssetsLoaded = !CameraJumpAssets.IsValid() || CameraJumpAssets->HasLoadCompleted() || CameraJumpAssets->WasCanceled();
+		const bool bHeightsSampled = !bFollowTerrain || !TerrainHeights || TerrainHeights->GetNumPendingTiles() == 0;
+		const bool bTimedOut = ElapsedMs >= JumpPrefetchTimeout * 1000.0;
+		if (!(PossessedCameraPawn->IsPrefetchStreamed() && bAssetsLoaded && bHeightsSampled) && !bTimedOut)
+		{
+			return;
+		}
+
+		bCameraJumpPrefetched = true;
+		LastCameraJumpMetrics.PrefetchMs = ElapsedMs;
+		LastCameraJumpMetrics.bPrefetchTimedOut = bTimedOut;
+		PossessedCameraPawn->ClearStreamingPrefetch();
+
+		if (bCameraJumpCut)
+		{
+			MoveToCameraBookmark(PendingJumpBookmark, true);
+			// The camera settles on the cut's own tick at the earliest.
+			return;
+		}
+	}
+
+	if (CameraSettleState != EStrategyCameraSettleState::Settled || !PossessedCameraPawn->IsViewStreamed())
+	{
+		return;
+	}
+
+	bCameraJumpPending = false;
+	LastCameraJumpMetrics.StableMs = ElapsedMs;
+	LastCameraJumpMetrics.StableFrames = int32(GFrameCounter - CameraJumpStartFrame);
+	UE_LOG(LogStrategyCamera, Log, TEXT("[CONTROLLER] Camera jump (%s) stable after %.1f ms, %d frames; prefetch %.1f ms%s."),
+		bCameraJumpCut ? TEXT("cut") : TEXT("animated"), LastCameraJumpMetrics.StableMs, LastCameraJumpMetrics.StableFrames,
+		LastCameraJumpMetrics.PrefetchMs, LastCameraJumpMetrics.bPrefetchTimedOut ? TEXT(" (timed out)") : TEXT(""));
+}
+
+void AStrategyPlayerController::UpdateCameraMovement(float DeltaTime)
+{
+	STRATEGY_CAMERA_SCOPE(CameraMovement, STAT_StrategyCameraMovement);
+	const UPawnMovementComponent* MovementComponent = PossessedCameraPawn->GetMovementComponent();
+	const float MaxSpeed = MovementComponent ? MovementComponent->GetMaxSpeed() : 3000.f;
+	const double ArmLength = CameraIntegrator.GetCurrentState().ArmLength;
+
+	// Pan in screen axes (X right, Y forward), in cm: keys and edge scroll at the zoom-scaled speed...
+	FVector2D ScreenPan = FramePanIntent * (MaxSpeed * CameraMoveSpeed * GetPanSpeedScale(ArmLength) * DeltaTime);
+
+	// ...plus the drag, keeping the ground under the cursor (measured at the pawn's distance from the camera).
+	if (!FramePanDragPixels.IsZero() && FrameViewportWidth > 0)
+	{
+		const float FieldOfView = PossessedCameraPawn->GetViewCamera() ? PossessedCameraPawn->GetViewCamera()->FieldOfView : 90.f;
+		const double CmPerPixel = 2.0 * ArmLength * FMath::Tan(FMath::DegreesToRadians(FieldOfView * 0.5)) / FrameViewportWidth;
+		ScreenPan += FVector2D(-FramePanDragPixels.X, FramePanDragPixels.Y) * CmPerPixel;
+	}
+	FramePanIntent = FVector2D::ZeroVector;
+	FramePanDragPixels = FVector2D::ZeroVector;
+
+	// Movement input other code added to the pawn is honoured the same way.
+	const FVector ExternalInput = PossessedCameraPawn->ConsumeMovementInputVector().GetClampedToMaxSize(1.0);
+	if (ScreenPan.IsZero() && ExternalInput.IsNearlyZero())
+	{
+		return;
+	}
+
+	// One yaw basis for the frame; the pan target moves once and the pawn follows it in UpdateCameraSprings.
+	double SinYaw = 0.0;
+	double CosYaw = 1.0;
+	FMath::SinCos(&SinYaw, &CosYaw, FMath::DegreesToRadians(GetControlRotation().Yaw));
+	const FVector Forward(CosYaw, SinYaw, 0.0);
+	const FVector Right(-SinYaw, CosYaw, 0.0);
+	TargetPanLocation += Right * ScreenPan.X + Forward * ScreenPan.Y + ExternalInput * (MaxSpeed * DeltaTime);
+}
+
+void AStrategyPlayerController::StrategySpawnUnits(int32 Count, float Radius)
+{
+#if !UE_BUILD_SHIPPING
+	UStrategyUnitSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UStrategyUnitSimulationSubsystem>();
+	if (!Simulation || !PossessedCameraPawn || Count <= 0)
+	{
+		return;
+	}
+
+	if (UnitMesh)
+	{
+		Simulation->SetRepresentationMesh(UnitMesh);
+	}
+
+	const FVector Center = PossessedCameraPawn->GetActorLocation();
+	FRandomStream Random(Count);
+	TArray<FVector> Locations;
+	Locations.Reserve(Count);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FVector2D Offset = FVector2D(Random.GetUnitVector()).GetSafeNormal() * Radius * FMath::Sqrt(Random.GetFraction());
+		Locations.Add(Center + FVector(Offset, 0.0));
+	}
+
+	SelectedUnits.Reset();
+	Simulation->SpawnUnits(Locations, &SelectedUnits);
+	UE_LOG(LogStrategyUnits, Log, TEXT("[CONTROLLER] StrategySpawnUnits: %d units spawned and selected."), Count);
+#endif
+}
+
+void AStrategyPlayerController::StrategyStartLockstep(int32 Count, float Radius, float TurnMs)
+{
+#if !UE_BUILD_SHIPPING
+	UStrategyLockstepSubsystem* Lockstep = GetWorld()->GetSubsystem<UStrategyLockstepSubsystem>();
+	UStrategyUnitSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UStrategyUnitSimulationSubsystem>();
+	if (!Lockstep || !Simulation || !PossessedCameraPawn || Count <= 0)
+	{
+		return;
+	}
+
+	if (UnitMesh)
+	{
+		Simulation->SetRepresentationMesh(UnitMesh);
+	}
+
+	const FVector Center = PossessedCameraPawn->GetActorLocation();
+	FRandomStream Random(Count);
+	TArray<FVector> Locations;
+	Locations.Reserve(Count);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FVector2D Offset = FVector2D(Random.GetUnitVector()).GetSafeNormal() * Radius * FMath::Sqrt(Random.GetFraction());
+		Locations.Add(Center + FVector(Offset, 0.0));
+	}
+
+	FStrategyLockstepSettings Settings;
+	Settings.NumPlayers = 1;
+	Settings.TurnSeconds = FMath::Max(TurnMs, 1.f) / 1000.f;
+	Lockstep->StartSession(Settings, MakeShared<FStrategyLockstepLoopback>(Settings.NumPlayers, 0.0), Locations);
+
+	SelectedUnits.Reset(Count);
+	for (int32 Unit = 0; Unit < Count; ++Unit)
+	{
+		SelectedUnits.Add(Lockstep->GetUnitHandle(Unit));
+	}
+	UE_LOG(LogStrategyUnits, Log, TEXT("[CONTROLLER] StrategyStartLockstep: session with %d units started; they are selected."), Count);
+#endif
+}
+
+void AStrategyPlayerController::StrategyEndLockstep()
+{
+#if !UE_BUILD_SHIPPING
+	if (UStrategyLockstepSubsystem* Lockstep = GetWorld()->GetSubsystem<UStrategyLockstepSubsystem>())
+	{
+		Lockstep->EndSession();
+	}
+	ClearSelection();
+#endif
+}
+
+void AStrategyPlayerController::StrategyRecordInput(int32 MaxRecords)
+{
+#if !UE_BUILD_SHIPPING
+	StartInputRecording(MaxRecords);
+	UE_LOG(LogStrategyCamera, Log, TEXT("[CONTROLLER] StrategyRecordInput: recording into %d records (%.1f MB)."), MaxRecords, MaxRecords * sizeof(FStrategyInputRecord) / (1024.0 * 1024.0));
+#endif
+}
+
+void AStrategyPlayerController::StrategySaveInput(const FString& Filename)
+{
+#if !UE_BUILD_SHIPPING
+	const FString Path = FPaths::IsRelative(Filename) ? FPaths::ProjectSavedDir() / TEXT("InputRecordings") / Filename : Filename;
+	const bool bSaved = SaveInputRecording(Path);
+	UE_LOG(LogStrategyCamera, Log, TEXT("[CONTROLLER] StrategySaveInput: %s '%s' (%d records)."), bSaved ? TEXT("saved") : TEXT("failed to save"), *Path, InputRecorder.GetNumRecords());
+#endif
+}
+
+void AStrategyPlayerController::StrategyReplayInput(const FString& Filename, bool bMaxSpeed)
+{
+#if !UE_BUILD_SHIPPING
+	const FString Path = FPaths::IsRelative(Filename) ? FPaths::ProjectSavedDir() / TEXT("InputRecordings") / Filename : Filename;
+	if (!StartInputReplay(Path, bMaxSpeed))
+	{
+		UE_LOG(LogStrategyCamera, Warning, TEXT("[CONTROLLER] StrategyReplayInput: could not replay '%s'."), *Path);
+	}
+#endif
+}
+
+void AStrategyPlayerController::StrategySetBookmark(int32 Slot)
+{
+#if !UE_BUILD_SHIPPING
+	SetCameraBookmark(Slot);
+	if (const FStrategyCameraBookmark* Bookmark = GetCameraBookmark(Slot))
+	{
+		UE_LOG(LogStrategyCamera, Log, TEXT("[CONTROLLER] StrategySetBookmark: slot %d at %s, yaw %.1f, zoom %.0f."), Slot, *Bookmark->Location.ToCompactString(), Bookmark->Yaw, Bookmark->ZoomLength);
+	}
+#endif
+}
+
+void AStrategyPlayerController::StrategyJumpBookmark(int32 Slot, bool bCutWhenReady)
+{
+#if !UE_BUILD_SHIPPING
+	if (!JumpToCameraBookmark(Slot, bCutWhenReady))
+	{
+		UE_LOG(LogStrategyCamera, Warning, TEXT("[CONTROLLER] StrategyJumpBookmark: slot %d is empty."), Slot);
+	}
+#endif
 }
@@ -0,0 +1,49 @@
+// StrategySelectableComponent.cpp
+#include "StrategySelectableComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "MyProject2.h"
+
+UStrategySelectableComponent::UStrategySelectableComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UStrategySelectableComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	AActor* Owner = GetOwner();
+	UStrategyUnitRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistrySubsystem>();
+	if (!Registry || !Owner->GetRootComponent())
+	{
+		UE_LOG(LogStrategyUnits, Warning, TEXT("[SELECTABLE] %s has no root component or unit registry; it will not be selectable."), *GetNameSafe(Owner));
+		return;
+	}
+
+	UnitHandle = Registry->RegisterUnit(Owner, Owner->GetActorLocation());
+	TransformUpdatedHandle = Owner->GetRootComponent()->TransformUpdated.AddUObject(this, &UStrategySelectableComponent::OnRootTransformUpdated);
+}
+
+void UStrategySelectableComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USceneComponent* RootComponent = GetOwner()->GetRootComponent())
+	{
+		RootComponent->TransformUpdated.Remove(TransformUpdatedHandle);
+	}
+	if (UStrategyUnitRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistrySubsystem>())
+	{
+		Registry->UnregisterUnit(UnitHandle);
+	}
+	UnitHandle = FStrategyUnitHandle();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UStrategySelectableComponent::OnRootTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	if (UStrategyUnitRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistrySubsystem>())
+	{
+		Registry->UpdateUnitLocation(UnitHandle, UpdatedComponent->GetComponentLocation());
+	}
+}
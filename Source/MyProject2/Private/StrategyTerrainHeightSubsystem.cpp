@@ -0,0 +1,340 @@
+// StrategyTerrainHeightSubsystem.cpp
+#include "StrategyTerrainHeightSubsystem.h"
+#include "MyProject2.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Terrain Height Lookups"), STAT_StrategyTerrainHeightLookups, STATGROUP_StrategyCamera);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Terrain Height Tiles Sampled"), STAT_StrategyTerrainHeightTilesSampled, STATGROUP_StrategyCamera);
+
+void UStrategyTerrainHeightSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Streamed-in or streamed-out geometry changes the ground under already sampled tiles.
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UStrategyTerrainHeightSubsystem::OnLevelChanged);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UStrategyTerrainHeightSubsystem::OnLevelChanged);
+}
+
+void UStrategyTerrainHeightSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	// Traces still in flight find no tile (or a newer serial) and are ignored.
+	Tiles.Reset();
+	RequestQueue.Reset();
+	NumReadyTiles = 0;
+	NumPendingTiles = 0;
+
+	Super::Deinitialize();
+}
+
+void UStrategyTerrainHeightSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	FlushRequests();
+	EvictTiles();
+}
+
+TStatId UStrategyTerrainHeightSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyTerrainHeightSubsystem, STATGROUP_Tickables);
+}
+
+void UStrategyTerrainHeightSubsystem::Configure(const FStrategyTerrainHeightSettings& InSettings)
+{
+	Settings = InSettings;
+	Settings.SamplesPerTileSide = FMath::Max(Settings.SamplesPerTileSide, 2);
+	Settings.TileSize = FMath::Max(Settings.TileSize, 1.0);
+
+	Tiles.Reset();
+	RequestQueue.Reset();
+	NumReadyTiles = 0;
+	NumPendingTiles = 0;
+	MaxSampledHeight = -UE_MAX_FLT;
+}
+
+// --- LOOKUPS ---
+FIntPoint UStrategyTerrainHeightSubsystem::GetTileKey(const FVector2D& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / Settings.TileSize), FMath::FloorToInt32(Location.Y / Settings.TileSize));
+}
+
+bool UStrategyTerrainHeightSubsystem::GetHeight(const FVector2D& Location, float& OutHeight)
+{
+	INC_DWORD_STAT(STAT_StrategyTerrainHeightLookups);
+
+	const FIntPoint Key = GetTileKey(Location);
+	FTile& Tile = FindOrAddTile(Key);
+	Tile.LastUsedFrame = GFrameCounter;
+	if (!Tile.bReady)
+	{
+		QueueTile(Key, Tile);
+		return false;
+	}
+
+	const double Spacing = Settings.GetSampleSpacing();
+	const int32 Side = Settings.SamplesPerTileSide;
+	const double LocalX = (Location.X - Key.X * Settings.TileSize) / Spacing;
+	const double LocalY = (Location.Y - Key.Y * Settings.TileSize) / Spacing;
+	const int32 X = FMath::Clamp(int32(LocalX), 0, Side - 2);
+	const int32 Y = FMath::Clamp(int32(LocalY), 0, Side - 2);
+	const float AlphaX = float(FMath::Clamp(LocalX - X, 0.0, 1.0));
+	const float AlphaY = float(FMath::Clamp(LocalY - Y, 0.0, 1.0));
+
+	const float* Row = &Tile.Heights[Y * Side + X];
+	const float Bottom = FMath::Lerp(Row[0], Row[1], AlphaX);
+	const float Top = FMath::Lerp(Row[Side], Row[Side + 1], AlphaX);
+	OutHeight = FMath::Lerp(Bottom, Top, AlphaY);
+	return true;
+}
+
+bool UStrategyTerrainHeightSubsystem::Raycast(const FVector& Origin, const FVector& Direction, double MaxDistance, FVector& OutHit)
+{
+	const FVector RayDirection = Direction.GetSafeNormal();
+	if (RayDirection.IsZero() || NumReadyTiles == 0)
+	{
+		return false;
+	}
+
+	// Nothing sampled is higher than MaxSampledHeight, so start marching where the ray comes down to it.
+	double Distance = 0.0;
+	if (Origin.Z > MaxSampledHeight)
+	{
+		if (RayDirection.Z >= -UE_KINDA_SMALL_NUMBER)
+		{
+			return false;
+		}
+		Distance = (MaxSampledHeight - Origin.Z) / RayDirection.Z;
+	}
+
+	const double Step = Settings.GetSampleSpacing();
+	double PreviousDistance = Distance;
+	for (; Distance <= MaxDistance; Distance += Step)
+	{
+		const FVector Point = Origin + RayDirection * Distance;
+		float Height = 0.f;
+		if (!GetHeight(FVector2D(Point), Height))
+		{
+			return false;
+		}
+
+		if (Point.Z <= Height)
+		{
+			// Crossed the surface within the last step; refine between the two samples.
+			double Above = PreviousDistance;
+			double Below = Distance;
+			for (int32 Iteration = 0; Iteration < 8; ++Iteration)
+			{
+				const double Middle = (Above + Below) * 0.5;
+				const FVector MiddlePoint = Origin + RayDirection * Middle;
+				float MiddleHeight = Height;
+				GetHeight(FVector2D(MiddlePoint), MiddleHeight);
+				(MiddlePoint.Z <= MiddleHeight ? Below : Above) = Middle;
+			}
+
+			OutHit = Origin + RayDirection * Below;
+			GetHeight(FVector2D(OutHit), Height);
+			OutHit.Z = Height;
+			return true;
+		}
+
+		PreviousDistance = Distance;
+	}
+
+	return false;
+}
+
+// --- REQUESTS ---
+void UStrategyTerrainHeightSubsystem::RequestArea(const FVector2D& Center, double Radius)
+{
+	const FIntPoint MinKey = GetTileKey(Center - FVector2D(Radius));
+	const FIntPoint MaxKey = GetTileKey(Center + FVector2D(Radius));
+	const FIntPoint CenterKey = GetTileKey(Center);
+
+	// Tiles outside the disc are skipped; the rest are queued nearest first.
+	TArray<FIntPoint, TInlineAllocator<64>> Keys;
+	for (int32 Y = MinKey.Y; Y <= MaxKey.Y; ++Y)
+	{
+		for (int32 X = MinKey.X; X <= MaxKey.X; ++X)
+		{
+			const FBox2D TileBounds(FVector2D(X, Y) * Settings.TileSize, FVector2D(X + 1, Y + 1) * Settings.TileSize);
+			if (TileBounds.ComputeSquaredDistanceToPoint(Center) <= FMath::Square(Radius))
+			{
+				Keys.Add(FIntPoint(X, Y));
+			}
+		}
+	}
+	Keys.Sort([CenterKey](const FIntPoint& A, const FIntPoint& B) { return (A - CenterKey).SizeSquared() < (B - CenterKey).SizeSquared(); });
+
+	for (const FIntPoint& Key : Keys)
+	{
+		FTile& Tile = FindOrAddTile(Key);
+		Tile.LastUsedFrame = GFrameCounter;
+		if (!Tile.bReady || Tile.bStale)
+		{
+			QueueTile(Key, Tile);
+		}
+	}
+}
+
+void UStrategyTerrainHeightSubsystem::Invalidate(const FBox2D& Bounds)
+{
+	const FIntPoint MinKey = GetTileKey(Bounds.Min);
+	const FIntPoint MaxKey = GetTileKey(Bounds.Max);
+	for (int32 Y = MinKey.Y; Y <= MaxKey.Y; ++Y)
+	{
+		for (int32 X = MinKey.X; X <= MaxKey.X; ++X)
+		{
+			const FIntPoint Key(X, Y);
+			if (FTile* Tile = Tiles.Find(Key))
+			{
+				Tile->bStale = true;
+				QueueTile(Key, *Tile);
+			}
+		}
+	}
+}
+
+void UStrategyTerrainHeightSubsystem::InvalidateAll()
+{
+	for (TPair<FIntPoint, FTile>& Pair : Tiles)
+	{
+		Pair.Value.bStale = true;
+		QueueTile(Pair.Key, Pair.Value);
+	}
+}
+
+UStrategyTerrainHeightSubsystem::FTile& UStrategyTerrainHeightSubsystem::FindOrAddTile(const FIntPoint& Key)
+{
+	return Tiles.FindOrAdd(Key);
+}
+
+void UStrategyTerrainHeightSubsystem::QueueTile(const FIntPoint& Key, FTile& Tile)
+{
+	if (Tile.bQueued)
+	{
+		return;
+	}
+
+	// A tile with traces in flight is already counted as pending.
+	if (Tile.NumPendingSamples == 0)
+	{
+		++NumPendingTiles;
+	}
+	Tile.bQueued = true;
+	RequestQueue.Add(Key);
+}
+
+void UStrategyTerrainHeightSubsystem::FlushRequests()
+{
+	int32 NumIssued = 0;
+	int32 QueueIndex = 0;
+	for (; QueueIndex < RequestQueue.Num() && NumIssued < Settings.MaxTilesPerFrame; ++QueueIndex)
+	{
+		if (FTile* Tile = Tiles.Find(RequestQueue[QueueIndex]))
+		{
+			IssueTileTraces(RequestQueue[QueueIndex], *Tile);
+			++NumIssued;
+		}
+	}
+	RequestQueue.RemoveAt(0, QueueIndex, EAllowShrinking::No);
+}
+
+void UStrategyTerrainHeightSubsystem::IssueTileTraces(const FIntPoint& Key, FTile& Tile)
+{
+	UWorld* World = GetWorld();
+	const int32 Side = Settings.SamplesPerTileSide;
+	const double Spacing = Settings.GetSampleSpacing();
+
+	Tile.bQueued = false;
+	Tile.RequestSerial = ++NextRequestSerial;
+	Tile.NumPendingSamples = Side * Side;
+	Tile.PendingHeights.SetNumUninitialized(Side * Side);
+	INC_DWORD_STAT(STAT_StrategyTerrainHeightTilesSampled);
+
+	// One delegate per tile; the sample index travels as the trace's user data.
+	const FTraceDelegate Delegate = FTraceDelegate::CreateUObject(this, &UStrategyTerrainHeightSubsystem::OnSampleTraced, Key, Tile.RequestSerial);
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(StrategyTerrainHeight), false);
+	const FVector2D TileOrigin = FVector2D(Key) * Settings.TileSize;
+	for (int32 Sample = 0; Sample < Side * Side; ++Sample)
+	{
+		const FVector2D Location = TileOrigin + FVector2D(Sample % Side, Sample / Side) * Spacing;
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single, FVector(Location, Settings.TraceTopZ), FVector(Location, Settings.TraceBottomZ),
+			Settings.TraceChannel, QueryParams, FCollisionResponseParams::DefaultResponseParam, &Delegate, uint32(Sample));
+	}
+}
+
+void UStrategyTerrainHeightSubsystem::OnSampleTraced(const FTraceHandle& Handle, FTraceDatum& Data, FIntPoint TileKey, uint32 RequestSerial)
+{
+	FTile* Tile = Tiles.Find(TileKey);
+	if (!Tile || Tile->RequestSerial != RequestSerial || !Tile->PendingHeights.IsValidIndex(int32(Data.UserData)))
+	{
+		return;
+	}
+
+	const bool bHit = Data.OutHits.Num() > 0 && Data.OutHits[0].bBlockingHit;
+	Tile->PendingHeights[Data.UserData] = bHit ? float(Data.OutHits[0].ImpactPoint.Z) : Settings.NoGroundHeight;
+
+	if (--Tile->NumPendingSamples > 0)
+	{
+		return;
+	}
+
+	// Last sample of the batch: publish the new heights.
+	Swap(Tile->Heights, Tile->PendingHeights);
+	Tile->MaxHeight = -UE_MAX_FLT;
+	for (const float Height : Tile->Heights)
+	{
+		Tile->MaxHeight = FMath::Max(Tile->MaxHeight, Height);
+	}
+	MaxSampledHeight = FMath::Max(MaxSampledHeight, Tile->MaxHeight);
+	Tile->bStale = false;
+	if (!Tile->bReady)
+	{
+		Tile->bReady = true;
+		++NumReadyTiles;
+	}
+	if (!Tile->bQueued)
+	{
+		--NumPendingTiles;
+	}
+}
+
+void UStrategyTerrainHeightSubsystem::EvictTiles()
+{
+	if (Tiles.Num() <= Settings.MaxCachedTiles)
+	{
+		return;
+	}
+
+	// Only idle tiles can go; their keys may still be referenced by the queue or by traces in flight otherwise.
+	TArray<TPair<uint64, FIntPoint>> Candidates;
+	for (const TPair<FIntPoint, FTile>& Pair : Tiles)
+	{
+		if (!Pair.Value.bQueued && Pair.Value.NumPendingSamples == 0)
+		{
+			Candidates.Emplace(Pair.Value.LastUsedFrame, Pair.Key);
+		}
+	}
+	Candidates.Sort([](const TPair<uint64, FIntPoint>& A, const TPair<uint64, FIntPoint>& B) { return A.Key < B.Key; });
+
+	const int32 NumToEvict = FMath::Min(Tiles.Num() - Settings.MaxCachedTiles, Candidates.Num());
+	for (int32 Index = 0; Index < NumToEvict; ++Index)
+	{
+		const FTile& Tile = Tiles.FindChecked(Candidates[Index].Value);
+		NumReadyTiles -= Tile.bReady ? 1 : 0;
+		Tiles.Remove(Candidates[Index].Value);
+	}
+}
+
+void UStrategyTerrainHeightSubsystem::OnLevelChanged(ULevel* Level, UWorld* World)
+{
+	if (World == GetWorld() && !Tiles.IsEmpty())
+	{
+		UE_LOG(LogStrategyCamera, Verbose, TEXT("[TERRAIN] Level %s changed; re-sampling %d tiles."), *GetNameSafe(Level), Tiles.Num());
+		InvalidateAll();
+	}
+}
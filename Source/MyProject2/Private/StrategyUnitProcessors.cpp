@@ -0,0 +1,177 @@
+// StrategyUnitProcessors.cpp
+#include "StrategyUnitProcessors.h"
+#include "StrategyUnitFragments.h"
+#include "StrategyUnitSimulationSubsystem.h"
+#include "MassExecutionContext.h"
+#include "MassCommandBuffer.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "HAL/IConsoleManager.h"
+
+namespace StrategyUnits
+{
+	static bool GParallelMovement = true;
+	static FAutoConsoleVariableRef CVarParallelMovement(
+		TEXT("Strategy.Units.ParallelMovement"),
+		GParallelMovement,
+		TEXT("Run the unit movement processor over chunks in parallel (default) or on the game thread."));
+}
+
+// --- MOVEMENT ---
+UStrategyUnitMovementProcessor::UStrategyUnitMovementProcessor()
+	: EntityQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = false;
+	ExecutionFlags = int32(EProcessorExecutionFlags::All);
+}
+
+void UStrategyUnitMovementProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FStrategyUnitTransformFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FStrategyUnitVelocityFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FStrategyUnitMoveTargetFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddTagRequirement<FStrategyUnitMovingTag>(EMassFragmentPresence::All);
+}
+
+void UStrategyUnitMovementProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	const float DeltaTime = Context.GetDeltaTimeSeconds();
+	if (DeltaTime <= 0.f)
+	{
+		return;
+	}
+
+	const TMap<int32, FStrategyFlowFieldRef>* ReadyFlowFields = FlowFields;
+	auto MoveChunk = [DeltaTime, ReadyFlowFields](FMassExecutionContext& ChunkContext)
+	{
+		const TArrayView<FStrategyUnitTransformFragment> Transforms = ChunkContext.GetMutableFragmentView<FStrategyUnitTransformFragment>();
+		const TArrayView<FStrategyUnitVelocityFragment> Velocities = ChunkContext.GetMutableFragmentView<FStrategyUnitVelocityFragment>();
+		const TArrayView<FStrategyUnitMoveTargetFragment> Targets = ChunkContext.GetMutableFragmentView<FStrategyUnitMoveTargetFragment>();
+
+		// Units of one order share a field and tend to share chunks, so the last lookup is usually the right one.
+		int32 CachedFieldId = INDEX_NONE;
+		const FStrategyFlowField* CachedField = nullptr;
+
+		for (int32 Index = 0; Index < ChunkContext.GetNumEntities(); ++Index)
+		{
+			FStrategyUnitTransformFragment& Transform = Transforms[Index];
+			FStrategyUnitMoveTargetFragment& Target = Targets[Index];
+
+			const FVector ToTarget = (Target.Target - Transform.Location) * FVector(1.0, 1.0, 0.0);
+			const double Distance = ToTarget.Size();
+			if (Distance <= Target.AcceptanceRadius)
+			{
+				Velocities[Index].Velocity = FVector::ZeroVector;
+				Target.bArrived = true;
+				continue;
+			}
+
+			FVector Direction = ToTarget / Distance;
+			if (Target.FlowFieldId != INDEX_NONE && ReadyFlowFields)
+			{
+				if (Target.FlowFieldId != CachedFieldId)
+				{
+					const FStrategyFlowFieldRef* Field = ReadyFlowFields->Find(Target.FlowFieldId);
+					CachedField = Field ? Field->Get() : nullptr;
+					CachedFieldId = Target.FlowFieldId;
+				}
+
+				// Follow the field until the unit is about as close to the order's destination as its own slot is.
+				if (CachedField)
+				{
+					const double SlotRadius = FVector::Dist2D(Target.Target, CachedField->Destination);
+					if (FVector::Dist2D(Transform.Location, CachedField->Destination) > SlotRadius + CachedField->Grid.CellSize * 3.0)
+					{
+						const FVector FieldDirection = CachedField->GetDirection(Transform.Location);
+						if (!FieldDirection.IsZero())
+						{
+							Direction = FieldDirection;
+						}
+					}
+				}
+			}
+
+			// Full speed, but never past the target in one step.
+			const double Speed = FMath::Min(double(Target.MaxSpeed), Distance / DeltaTime);
+			Velocities[Index].Velocity = Direction * Speed;
+			Transform.Location += Velocities[Index].Velocity * DeltaTime;
+			Transform.Yaw = float(FMath::RadiansToDegrees(FMath::Atan2(Direction.Y, Direction.X)));
+		}
+	};
+
+	if (StrategyUnits::GParallelMovement)
+	{
+		EntityQuery.ParallelForEachEntityChunk(EntityManager, Context, MoveChunk);
+	}
+	else
+	{
+		EntityQuery.ForEachEntityChunk(EntityManager, Context, MoveChunk);
+	}
+}
+
+// --- SYNC ---
+UStrategyUnitSyncProcessor::UStrategyUnitSyncProcessor()
+	: EntityQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = false;
+	bRequiresGameThreadExecution = true;
+	ExecutionFlags = int32(EProcessorExecutionFlags::All);
+}
+
+void UStrategyUnitSyncProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FStrategyUnitTransformFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FStrategyUnitMoveTargetFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FStrategyUnitInstanceFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddTagRequirement<FStrategyUnitMovingTag>(EMassFragmentPresence::All);
+}
+
+void UStrategyUnitSyncProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	if (!Simulation)
+	{
+		return;
+	}
+
+	UStrategyUnitRegistrySubsystem* Registry = Simulation->Registry;
+	UStrategyFogOfWarSubsystem* FogOfWar = Simulation->FogOfWar;
+	TArray<FTransform>& InstanceTransforms = Simulation->InstanceTransforms;
+	const bool bHasRepresentation = Simulation->Representation != nullptr;
+
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [this, Registry, FogOfWar, &InstanceTransforms, bHasRepresentation](FMassExecutionContext& ChunkContext)
+	{
+		const TConstArrayView<FStrategyUnitTransformFragment> Transforms = ChunkContext.GetFragmentView<FStrategyUnitTransformFragment>();
+		const TArrayView<FStrategyUnitMoveTargetFragment> Targets = ChunkContext.GetMutableFragmentView<FStrategyUnitMoveTargetFragment>();
+		const TConstArrayView<FStrategyUnitInstanceFragment> Instances = ChunkContext.GetFragmentView<FStrategyUnitInstanceFragment>();
+
+		for (int32 Index = 0; Index < ChunkContext.GetNumEntities(); ++Index)
+		{
+			const FStrategyUnitTransformFragment& Transform = Transforms[Index];
+			const FStrategyUnitInstanceFragment& Instance = Instances[Index];
+
+			if (Registry)
+			{
+				Registry->UpdateUnitLocation(Instance.UnitHandle, Transform.Location);
+			}
+
+			// Only re-stamps vision when the unit entered another fog cell.
+			if (FogOfWar)
+			{
+				FogOfWar->UpdateVisionSource(Instance.VisionHandle, Transform.Location);
+			}
+
+			if (bHasRepresentation && InstanceTransforms.IsValidIndex(Instance.InstanceIndex))
+			{
+				InstanceTransforms[Instance.InstanceIndex] = FTransform(FRotator(0.f, Transform.Yaw, 0.f), Transform.Location);
+				Simulation->DirtyInstanceMin = FMath::Min(Simulation->DirtyInstanceMin, Instance.InstanceIndex);
+				Simulation->DirtyInstanceMax = FMath::Max(Simulation->DirtyInstanceMax, Instance.InstanceIndex);
+			}
+
+			if (Targets[Index].bArrived)
+			{
+				// Arrived units no longer hold their flow field in the cache.
+				Simulation->SetFlowField(Targets[Index], INDEX_NONE);
+				ChunkContext.Defer().RemoveTag<FStrategyUnitMovingTag>(ChunkContext.GetEntity(Index));
+			}
+		}
+	});
+}
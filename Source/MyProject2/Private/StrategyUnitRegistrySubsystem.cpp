@@ -0,0 +1,408 @@
+// StrategyUnitRegistrySubsystem.cpp
+#include "StrategyUnitRegistrySubsystem.h"
+#include "MyProject2.h"
+#include "Camera/CameraTypes.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Registered Units"), STAT_StrategyRegisteredUnits, STATGROUP_StrategyUnits);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Selection Candidates"), STAT_StrategySelectionCandidates, STATGROUP_StrategyUnits);
+
+namespace
+{
+	// Corner rays that never reach the units' height range are clamped to this distance (cm) when bounding the query.
+	constexpr double MaxQueryDistance = 1000000.0;
+}
+
+FStrategyScreenQuery FStrategyScreenQuery::Make(const FMinimalViewInfo& View, const FIntPoint& ViewportSize, const FVector2D& ScreenStart, const FVector2D& ScreenEnd)
+{
+	FStrategyScreenQuery Query;
+	Query.ViewOrigin = View.Location;
+
+	const double Width = FMath::Max(ViewportSize.X, 1);
+	const double Height = FMath::Max(ViewportSize.Y, 1);
+
+	FMinimalViewInfo ProjectionView = View;
+	ProjectionView.AspectRatio = float(Width / Height);
+
+	// World axes to UE's view axes (X right, Y up, Z forward), without the translation.
+	const FMatrix ViewRotationMatrix = FInverseRotationMatrix(View.Rotation) * FMatrix(
+		FPlane(0, 0, 1, 0),
+		FPlane(1, 0, 0, 0),
+		FPlane(0, 1, 0, 0),
+		FPlane(0, 0, 0, 1));
+	Query.TranslatedViewProjection = ViewRotationMatrix * ProjectionView.CalculateProjectionMatrix();
+
+	const FVector2D PixelMin(FMath::Min(ScreenStart.X, ScreenEnd.X), FMath::Min(ScreenStart.Y, ScreenEnd.Y));
+	const FVector2D PixelMax(FMath::Max(ScreenStart.X, ScreenEnd.X), FMath::Max(ScreenStart.Y, ScreenEnd.Y));
+	Query.NdcMin = FVector2f(float(2.0 * PixelMin.X / Width - 1.0), float(1.0 - 2.0 * PixelMax.Y / Height));
+	Query.NdcMax = FVector2f(float(2.0 * PixelMax.X / Width - 1.0), float(1.0 - 2.0 * PixelMin.Y / Height));
+
+	// Perspective only; FOV is horizontal.
+	const FRotationMatrix ViewAxes(View.Rotation);
+	const FVector Forward = ViewAxes.GetUnitAxis(EAxis::X);
+	const FVector Right = ViewAxes.GetUnitAxis(EAxis::Y);
+	const FVector Up = ViewAxes.GetUnitAxis(EAxis::Z);
+	const double TanHalfHorizontal = FMath::Tan(FMath::DegreesToRadians(View.FOV * 0.5));
+	const double TanHalfVertical = TanHalfHorizontal * Height / Width;
+
+	const FVector2f NdcCorners[4] = { Query.NdcMin, FVector2f(Query.NdcMax.X, Query.NdcMin.Y), Query.NdcMax, FVector2f(Query.NdcMin.X, Query.NdcMax.Y) };
+	for (int32 Index = 0; Index < 4; ++Index)
+	{
+		Query.CornerRays[Index] = (Forward + Right * (NdcCorners[Index].X * TanHalfHorizontal) + Up * (NdcCorners[Index].Y * TanHalfVertical)).GetSafeNormal();
+	}
+
+	return Query;
+}
+
+// --- REGISTRATION ---
+FStrategyUnitHandle UStrategyUnitRegistrySubsystem::RegisterUnit(AActor* Actor, const FVector& Location)
+{
+	int32 Id;
+	if (!FreeIds.IsEmpty())
+	{
+		Id = FreeIds.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		Id = DenseIndexById.Add(INDEX_NONE);
+		SerialById.Add(0);
+	}
+
+	const int32 DenseIndex = DenseIds.Add(Id);
+	PositionX.Add(Location.X);
+	PositionY.Add(Location.Y);
+	PositionZ.Add(Location.Z);
+	UnitCells.Add(GetCellCoord(Location.X, Location.Y));
+	UnitSlotsInCell.Add(INDEX_NONE);
+	UnitActors.Add(Actor);
+	DenseIndexById[Id] = DenseIndex;
+	AddToCell(DenseIndex);
+
+	INC_DWORD_STAT(STAT_StrategyRegisteredUnits);
+	return FStrategyUnitHandle{ Id, SerialById[Id] };
+}
+
+void UStrategyUnitRegistrySubsystem::UnregisterUnit(FStrategyUnitHandle Handle)
+{
+	const int32 DenseIndex = FindDenseIndex(Handle);
+	if (DenseIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	RemoveFromCell(DenseIndex);
+
+	// Swap the last unit into the hole so the arrays stay dense.
+	const int32 LastIndex = DenseIds.Num() - 1;
+	if (DenseIndex != LastIndex)
+	{
+		DenseIds[DenseIndex] = DenseIds[LastIndex];
+		PositionX[DenseIndex] = PositionX[LastIndex];
+		PositionY[DenseIndex] = PositionY[LastIndex];
+		PositionZ[DenseIndex] = PositionZ[LastIndex];
+		UnitCells[DenseIndex] = UnitCells[LastIndex];
+		UnitSlotsInCell[DenseIndex] = UnitSlotsInCell[LastIndex];
+		UnitActors[DenseIndex] = UnitActors[LastIndex];
+
+		DenseIndexById[DenseIds[DenseIndex]] = DenseIndex;
+		Cells.FindChecked(UnitCells[DenseIndex]).Units[UnitSlotsInCell[DenseIndex]] = DenseIndex;
+	}
+
+	DenseIds.Pop(EAllowShrinking::No);
+	PositionX.Pop(EAllowShrinking::No);
+	PositionY.Pop(EAllowShrinking::No);
+	PositionZ.Pop(EAllowShrinking::No);
+	UnitCells.Pop(EAllowShrinking::No);
+	UnitSlotsInCell.Pop(EAllowShrinking::No);
+	UnitActors.Pop(EAllowShrinking::No);
+
+	DenseIndexById[Handle.Id] = INDEX_NONE;
+	++SerialById[Handle.Id];
+	FreeIds.Add(Handle.Id);
+
+	DEC_DWORD_STAT(STAT_StrategyRegisteredUnits);
+}
+
+void UStrategyUnitRegistrySubsystem::UnregisterAllUnits()
+{
+	for (const int32 Id : DenseIds)
+	{
+		DenseIndexById[Id] = INDEX_NONE;
+		++SerialById[Id];
+		FreeIds.Add(Id);
+	}
+	DEC_DWORD_STAT_BY(STAT_StrategyRegisteredUnits, DenseIds.Num());
+
+	DenseIds.Reset();
+	PositionX.Reset();
+	PositionY.Reset();
+	PositionZ.Reset();
+	UnitCells.Reset();
+	UnitSlotsInCell.Reset();
+	UnitActors.Reset();
+	Cells.Reset();
+	UnitsMinZ = UE_DOUBLE_BIG_NUMBER;
+	UnitsMaxZ = -UE_DOUBLE_BIG_NUMBER;
+}
+
+void UStrategyUnitRegistrySubsystem::UpdateUnitLocation(FStrategyUnitHandle Handle, const FVector& Location)
+{
+	const int32 DenseIndex = FindDenseIndex(Handle);
+	if (DenseIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	const bool bZChanged = PositionZ[DenseIndex] != Location.Z;
+	PositionX[DenseIndex] = Location.X;
+	PositionY[DenseIndex] = Location.Y;
+	PositionZ[DenseIndex] = Location.Z;
+
+	const FIntPoint NewCell = GetCellCoord(Location.X, Location.Y);
+	if (NewCell != UnitCells[DenseIndex])
+	{
+		RemoveFromCell(DenseIndex);
+		UnitCells[DenseIndex] = NewCell;
+		AddToCell(DenseIndex);
+	}
+	else if (bZChanged)
+	{
+		FCell& Cell = Cells.FindChecked(NewCell);
+		Cell.MinZ = FMath::Min(Cell.MinZ, Location.Z);
+		Cell.MaxZ = FMath::Max(Cell.MaxZ, Location.Z);
+		UnitsMinZ = FMath::Min(UnitsMinZ, Location.Z);
+		UnitsMaxZ = FMath::Max(UnitsMaxZ, Location.Z);
+	}
+}
+
+bool UStrategyUnitRegistrySubsystem::IsValidUnit(FStrategyUnitHandle Handle) const
+{
+	return FindDenseIndex(Handle) != INDEX_NONE;
+}
+
+FVector UStrategyUnitRegistrySubsystem::GetUnitLocation(FStrategyUnitHandle Handle) const
+{
+	const int32 DenseIndex = FindDenseIndex(Handle);
+	return DenseIndex != INDEX_NONE ? FVector(PositionX[DenseIndex], PositionY[DenseIndex], PositionZ[DenseIndex]) : FVector::ZeroVector;
+}
+
+AActor* UStrategyUnitRegistrySubsystem::GetUnitActor(FStrategyUnitHandle Handle) const
+{
+	const int32 DenseIndex = FindDenseIndex(Handle);
+	return DenseIndex != INDEX_NONE ? UnitActors[DenseIndex].Get() : nullptr;
+}
+
+FIntPoint UStrategyUnitRegistrySubsystem::GetCellCoord(double X, double Y)
+{
+	return FIntPoint(FMath::FloorToInt32(X / CellSize), FMath::FloorToInt32(Y / CellSize));
+}
+
+int32 UStrategyUnitRegistrySubsystem::FindDenseIndex(FStrategyUnitHandle Handle) const
+{
+	if (!SerialById.IsValidIndex(Handle.Id) || SerialById[Handle.Id] != Handle.Serial)
+	{
+		return INDEX_NONE;
+	}
+	return DenseIndexById[Handle.Id];
+}
+
+void UStrategyUnitRegistrySubsystem::AddToCell(int32 DenseIndex)
+{
+	FCell& Cell = Cells.FindOrAdd(UnitCells[DenseIndex]);
+	UnitSlotsInCell[DenseIndex] = Cell.Units.Add(DenseIndex);
+
+	const double Z = PositionZ[DenseIndex];
+	Cell.MinZ = FMath::Min(Cell.MinZ, Z);
+	Cell.MaxZ = FMath::Max(Cell.MaxZ, Z);
+	UnitsMinZ = FMath::Min(UnitsMinZ, Z);
+	UnitsMaxZ = FMath::Max(UnitsMaxZ, Z);
+}
+
+void UStrategyUnitRegistrySubsystem::RemoveFromCell(int32 DenseIndex)
+{
+	const FIntPoint CellCoord = UnitCells[DenseIndex];
+	FCell& Cell = Cells.FindChecked(CellCoord);
+	const int32 Slot = UnitSlotsInCell[DenseIndex];
+
+	Cell.Units.RemoveAtSwap(Slot, EAllowShrinking::No);
+	if (Cell.Units.IsValidIndex(Slot))
+	{
+		UnitSlotsInCell[Cell.Units[Slot]] = Slot;
+	}
+	else if (Cell.Units.IsEmpty())
+	{
+		Cells.Remove(CellCoord);
+	}
+	UnitSlotsInCell[DenseIndex] = INDEX_NONE;
+}
+
+// --- SELECTION ---
+int32 UStrategyUnitRegistrySubsystem::SelectInScreenRect(const FStrategyScreenQuery& Query, TArray<FStrategyUnitHandle>& OutUnits)
+{
+	LastNumCandidates = 0;
+	if (DenseIds.IsEmpty() || Query.NdcMin.X > Query.NdcMax.X || Query.NdcMin.Y > Query.NdcMax.Y)
+	{
+		return 0;
+	}
+
+	// 1. Cell cull against the frustum of the rectangle.
+	ScratchCells.Reset();
+	GatherCandidateCells(Query, ScratchCells);
+
+	ScratchCandidates.Reset();
+	for (const FCell* Cell : ScratchCells)
+	{
+		ScratchCandidates.Append(Cell->Units);
+	}
+
+	const int32 NumCandidates = ScratchCandidates.Num();
+	LastNumCandidates = NumCandidates;
+	INC_DWORD_STAT_BY(STAT_StrategySelectionCandidates, NumCandidates);
+	if (NumCandidates == 0)
+	{
+		return 0;
+	}
+
+	// 2. Gather candidate positions relative to the view origin. Padding lanes sit at the origin, where clip W is 0,
+	// so they always fail the in-front test.
+	const int32 NumPadded = Align(NumCandidates, 4);
+	ScratchX.SetNumUninitialized(NumPadded, EAllowShrinking::No);
+	ScratchY.SetNumUninitialized(NumPadded, EAllowShrinking::No);
+	ScratchZ.SetNumUninitialized(NumPadded, EAllowShrinking::No);
+	for (int32 Index = 0; Index < NumCandidates; ++Index)
+	{
+		const int32 DenseIndex = ScratchCandidates[Index];
+		ScratchX[Index] = float(PositionX[DenseIndex] - Query.ViewOrigin.X);
+		ScratchY[Index] = float(PositionY[DenseIndex] - Query.ViewOrigin.Y);
+		ScratchZ[Index] = float(PositionZ[DenseIndex] - Query.ViewOrigin.Z);
+	}
+	for (int32 Index = NumCandidates; Index < NumPadded; ++Index)
+	{
+		ScratchX[Index] = 0.f;
+		ScratchY[Index] = 0.f;
+		ScratchZ[Index] = 0.f;
+	}
+
+	// 3. Project four candidates at a time. Only clip X, Y and W are needed, and the rectangle test is done in
+	// clip space (NdcMin * W <= Clip <= NdcMax * W) so there is no divide.
+	const FMatrix44f M(Query.TranslatedViewProjection);
+	const VectorRegister4Float M00 = VectorSetFloat1(M.M[0][0]), M10 = VectorSetFloat1(M.M[1][0]), M20 = VectorSetFloat1(M.M[2][0]), M30 = VectorSetFloat1(M.M[3][0]);
+	const VectorRegister4Float M01 = VectorSetFloat1(M.M[0][1]), M11 = VectorSetFloat1(M.M[1][1]), M21 = VectorSetFloat1(M.M[2][1]), M31 = VectorSetFloat1(M.M[3][1]);
+	const VectorRegister4Float M03 = VectorSetFloat1(M.M[0][3]), M13 = VectorSetFloat1(M.M[1][3]), M23 = VectorSetFloat1(M.M[2][3]), M33 = VectorSetFloat1(M.M[3][3]);
+	const VectorRegister4Float NdcMinX = VectorSetFloat1(Query.NdcMin.X), NdcMaxX = VectorSetFloat1(Query.NdcMax.X);
+	const VectorRegister4Float NdcMinY = VectorSetFloat1(Query.NdcMin.Y), NdcMaxY = VectorSetFloat1(Query.NdcMax.Y);
+	const VectorRegister4Float Zero = VectorZeroFloat();
+
+	const int32 NumBefore = OutUnits.Num();
+	for (int32 Index = 0; Index < NumPadded; Index += 4)
+	{
+		const VectorRegister4Float X = VectorLoad(&ScratchX[Index]);
+		const VectorRegister4Float Y = VectorLoad(&ScratchY[Index]);
+		const VectorRegister4Float Z = VectorLoad(&ScratchZ[Index]);
+
+		const VectorRegister4Float ClipX = VectorMultiplyAdd(X, M00, VectorMultiplyAdd(Y, M10, VectorMultiplyAdd(Z, M20, M30)));
+		const VectorRegister4Float ClipY = VectorMultiplyAdd(X, M01, VectorMultiplyAdd(Y, M11, VectorMultiplyAdd(Z, M21, M31)));
+		const VectorRegister4Float ClipW = VectorMultiplyAdd(X, M03, VectorMultiplyAdd(Y, M13, VectorMultiplyAdd(Z, M23, M33)));
+
+		VectorRegister4Float Inside = VectorCompareGT(ClipW, Zero);
+		Inside = VectorBitwiseAnd(Inside, VectorCompareGE(ClipX, VectorMultiply(NdcMinX, ClipW)));
+		Inside = VectorBitwiseAnd(Inside, VectorCompareLE(ClipX, VectorMultiply(NdcMaxX, ClipW)));
+		Inside = VectorBitwiseAnd(Inside, VectorCompareGE(ClipY, VectorMultiply(NdcMinY, ClipW)));
+		Inside = VectorBitwiseAnd(Inside, VectorCompareLE(ClipY, VectorMultiply(NdcMaxY, ClipW)));
+
+		for (uint32 Mask = VectorMaskBits(Inside); Mask != 0; Mask &= Mask - 1)
+		{
+			const int32 Id = DenseIds[ScratchCandidates[Index + FMath::CountTrailingZeros(Mask)]];
+			OutUnits.Add(FStrategyUnitHandle{ Id, SerialById[Id] });
+		}
+	}
+
+	return OutUnits.Num() - NumBefore;
+}
+
+void UStrategyUnitRegistrySubsystem::GatherCandidateCells(const FStrategyScreenQuery& Query, TArray<const FCell*>& OutCells) const
+{
+	const FVector& Origin = Query.ViewOrigin;
+
+	// Frustum planes through the view origin, normals pointing inside: the four sides and one facing forward.
+	FVector PlaneNormals[5];
+	FVector CenterRay = FVector::ZeroVector;
+	for (const FVector& Ray : Query.CornerRays)
+	{
+		CenterRay += Ray;
+	}
+	for (int32 Index = 0; Index < 4; ++Index)
+	{
+		FVector Normal = FVector::CrossProduct(Query.CornerRays[Index], Query.CornerRays[(Index + 1) % 4]);
+		if (FVector::DotProduct(Normal, CenterRay) < 0.0)
+		{
+			Normal = -Normal;
+		}
+		PlaneNormals[Index] = Normal;
+	}
+	PlaneNormals[4] = CenterRay;
+
+	// 2D bounds of the frustum clipped to the units' height range: the corner rays hitting the lowest and highest unit
+	// planes, plus the view origin itself in case the camera is inside the range.
+	FBox2D Bounds(FVector2D(Origin), FVector2D(Origin));
+	for (const FVector& Ray : Query.CornerRays)
+	{
+		for (const double PlaneZ : { UnitsMinZ, UnitsMaxZ })
+		{
+			double Distance = MaxQueryDistance;
+			if (!FMath::IsNearlyZero(Ray.Z))
+			{
+				const double HitDistance = (PlaneZ - Origin.Z) / Ray.Z;
+				if (HitDistance > 0.0)
+				{
+					Distance = FMath::Min(HitDistance, MaxQueryDistance);
+				}
+			}
+			Bounds += FVector2D(Origin + Ray * Distance);
+		}
+	}
+
+	const FIntPoint MinCell = GetCellCoord(Bounds.Min.X, Bounds.Min.Y);
+	const FIntPoint MaxCell = GetCellCoord(Bounds.Max.X, Bounds.Max.Y);
+
+	auto IsCellInFrustum = [&PlaneNormals, &Origin](const FIntPoint& Coord, const FCell& Cell)
+	{
+		const FVector Center((Coord.X + 0.5) * CellSize - Origin.X, (Coord.Y + 0.5) * CellSize - Origin.Y, (Cell.MinZ + Cell.MaxZ) * 0.5 - Origin.Z);
+		const FVector Extent(CellSize * 0.5, CellSize * 0.5, (Cell.MaxZ - Cell.MinZ) * 0.5);
+		for (const FVector& Normal : PlaneNormals)
+		{
+			if (FVector::DotProduct(Normal, Center) + FVector::DotProduct(Normal.GetAbs(), Extent) < 0.0)
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+
+	// Walk whichever is smaller: the cell range under the bounds, or the occupied cells.
+	const int64 NumRangeCells = int64(MaxCell.X - MinCell.X + 1) * int64(MaxCell.Y - MinCell.Y + 1);
+	if (NumRangeCells <= Cells.Num())
+	{
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+		{
+			for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+			{
+				const FIntPoint Coord(CellX, CellY);
+				if (const FCell* Cell = Cells.Find(Coord); Cell && IsCellInFrustum(Coord, *Cell))
+				{
+					OutCells.Add(Cell);
+				}
+			}
+		}
+	}
+	else
+	{
+		for (const TPair<FIntPoint, FCell>& Pair : Cells)
+		{
+			const FIntPoint& Coord = Pair.Key;
+			if (Coord.X >= MinCell.X && Coord.X <= MaxCell.X && Coord.Y >= MinCell.Y && Coord.Y <= MaxCell.Y && IsCellInFrustum(Coord, Pair.Value))
+			{
+				OutCells.Add(&Pair.Value);
+			}
+		}
+	}
+}
@@ -0,0 +1,351 @@
+// StrategyUnitSimulationSubsystem.cpp
+#include "StrategyUnitSimulationSubsystem.h"
+#include "StrategyUnitFragments.h"
+#include "StrategyUnitProcessors.h"
+#include "MyProject2.h"
+#include "MassEntitySubsystem.h"
+#include "MassExecutor.h"
+#include "MassProcessingTypes.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Simulated Units"), STAT_StrategySimulatedUnits, STATGROUP_StrategyUnits);
+
+void UStrategyUnitSimulationSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Collection.InitializeDependency<UMassEntitySubsystem>();
+	Registry = Collection.InitializeDependency<UStrategyUnitRegistrySubsystem>();
+	FlowFields = Collection.InitializeDependency<UStrategyFlowFieldSubsystem>();
+	FogOfWar = Collection.InitializeDependency<UStrategyFogOfWarSubsystem>();
+	Super::Initialize(Collection);
+
+	const UScriptStruct* UnitFragments[] =
+	{
+		FStrategyUnitTransformFragment::StaticStruct(),
+		FStrategyUnitVelocityFragment::StaticStruct(),
+		FStrategyUnitMoveTargetFragment::StaticStruct(),
+		FStrategyUnitInstanceFragment::StaticStruct(),
+	};
+	UnitArchetype = GetEntityManager().CreateArchetype(MakeArrayView(UnitFragments));
+
+	MovementProcessor = NewObject<UStrategyUnitMovementProcessor>(this);
+	MovementProcessor->SetFlowFields(&ReadyFlowFields);
+	MovementProcessor->Initialize(*this);
+
+	SyncProcessor = NewObject<UStrategyUnitSyncProcessor>(this);
+	SyncProcessor->SetSimulation(this);
+	SyncProcessor->Initialize(*this);
+}
+
+void UStrategyUnitSimulationSubsystem::Deinitialize()
+{
+	// The entity manager and the registry tear down with the world; only drop our references to their contents.
+	DEC_DWORD_STAT_BY(STAT_StrategySimulatedUnits, Entities.Num());
+	Entities.Reset();
+	InstanceTransforms.Reset();
+	ReadyFlowFields.Reset();
+	Representation = nullptr;
+
+	Super::Deinitialize();
+}
+
+void UStrategyUnitSimulationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	RunSimulation(DeltaTime);
+}
+
+TStatId UStrategyUnitSimulationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyUnitSimulationSubsystem, STATGROUP_Tickables);
+}
+
+FMassEntityManager& UStrategyUnitSimulationSubsystem::GetEntityManager() const
+{
+	return GetWorld()->GetSubsystem<UMassEntitySubsystem>()->GetMutableEntityManager();
+}
+
+void UStrategyUnitSimulationSubsystem::SetRepresentationMesh(UStaticMesh* Mesh)
+{
+	if (!Representation)
+	{
+		AActor* RepresentationActor = GetWorld()->SpawnActor<AActor>();
+		Representation = NewObject<UInstancedStaticMeshComponent>(RepresentationActor, TEXT("StrategyUnits"));
+		Representation->SetMobility(EComponentMobility::Movable);
+		Representation->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Representation->SetCanEverAffectNavigation(false);
+		RepresentationActor->SetRootComponent(Representation);
+		Representation->RegisterComponent();
+	}
+
+	Representation->SetStaticMesh(Mesh);
+}
+
+// --- SPAWNING ---
+void UStrategyUnitSimulationSubsystem::SpawnUnits(TConstArrayView<FVector> Locations, TArray<FStrategyUnitHandle>* OutUnits)
+{
+	if (Locations.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<int32> InstanceIndices;
+	if (Representation)
+	{
+		TArray<FTransform> NewTransforms;
+		NewTransforms.Reserve(Locations.Num());
+		for (const FVector& Location : Locations)
+		{
+			NewTransforms.Add(FTransform(Location));
+		}
+		InstanceIndices = Representation->AddInstances(NewTransforms, true, true, false);
+		InstanceTransforms.SetNum(Representation->GetInstanceCount());
+		for (int32 Index = 0; Index < InstanceIndices.Num(); ++Index)
+		{
+			InstanceTransforms[InstanceIndices[Index]] = NewTransforms[Index];
+		}
+	}
+
+	FMassEntityManager& EntityManager = GetEntityManager();
+	TArray<FMassEntityHandle> NewEntities;
+	NewEntities.Reserve(Locations.Num());
+	{
+		TSharedRef<FMassEntityManager::FEntityCreationContext> CreationContext = EntityManager.BatchCreateEntities(UnitArchetype, Locations.Num(), NewEntities);
+
+		for (int32 Index = 0; Index < NewEntities.Num(); ++Index)
+		{
+			const FMassEntityHandle Entity = NewEntities[Index];
+			const FVector& Location = Locations[Index];
+
+			EntityManager.GetFragmentDataChecked<FStrategyUnitTransformFragment>(Entity).Location = Location;
+			EntityManager.GetFragmentDataChecked<FStrategyUnitMoveTargetFragment>(Entity).Target = Location;
+
+			FStrategyUnitInstanceFragment& Instance = EntityManager.GetFragmentDataChecked<FStrategyUnitInstanceFragment>(Entity);
+			Instance.UnitHandle = Registry->RegisterUnit(nullptr, Location);
+			Instance.InstanceIndex = InstanceIndices.IsValidIndex(Index) ? InstanceIndices[Index] : INDEX_NONE;
+			if (FogOfWar && UnitVisionRadius > 0.f)
+			{
+				Instance.VisionHandle = FogOfWar->AddVisionSource(Location, UnitVisionRadius);
+			}
+
+			Entities.Add(Instance.UnitHandle, Entity);
+			if (OutUnits)
+			{
+				OutUnits->Add(Instance.UnitHandle);
+			}
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_StrategySimulatedUnits, NewEntities.Num());
+	UE_LOG(LogStrategyUnits, Log, TEXT("[SIMULATION] Spawned %d units (%d total)."), NewEntities.Num(), Entities.Num());
+}
+
+void UStrategyUnitSimulationSubsystem::DestroyUnits(TConstArrayView<FStrategyUnitHandle> Units)
+{
+	FMassEntityManager& EntityManager = GetEntityManager();
+	TArray<FMassEntityHandle> EntitiesToDestroy;
+	EntitiesToDestroy.Reserve(Units.Num());
+	for (const FStrategyUnitHandle& Unit : Units)
+	{
+		FMassEntityHandle Entity;
+		if (!Entities.RemoveAndCopyValue(Unit, Entity))
+		{
+			continue;
+		}
+
+		Registry->UnregisterUnit(Unit);
+		if (EntityManager.IsEntityValid(Entity))
+		{
+			SetFlowField(EntityManager.GetFragmentDataChecked<FStrategyUnitMoveTargetFragment>(Entity), INDEX_NONE);
+			const FStrategyUnitInstanceFragment& Instance = EntityManager.GetFragmentDataChecked<FStrategyUnitInstanceFragment>(Entity);
+			if (FogOfWar)
+			{
+				FogOfWar->RemoveVisionSource(Instance.VisionHandle);
+			}
+			if (InstanceTransforms.IsValidIndex(Instance.InstanceIndex))
+			{
+				InstanceTransforms[Instance.InstanceIndex] = FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+				DirtyInstanceMin = FMath::Min(DirtyInstanceMin, Instance.InstanceIndex);
+				DirtyInstanceMax = FMath::Max(DirtyInstanceMax, Instance.InstanceIndex);
+			}
+		}
+		EntitiesToDestroy.Add(Entity);
+	}
+	EntityManager.BatchDestroyEntities(EntitiesToDestroy);
+
+	DEC_DWORD_STAT_BY(STAT_StrategySimulatedUnits, EntitiesToDestroy.Num());
+	FlushRepresentation();
+}
+
+void UStrategyUnitSimulationSubsystem::DestroyAllUnits()
+{
+	FMassEntityManager& EntityManager = GetEntityManager();
+	TArray<FMassEntityHandle> EntitiesToDestroy;
+	EntitiesToDestroy.Reserve(Entities.Num());
+	for (const TPair<FStrategyUnitHandle, FMassEntityHandle>& Pair : Entities)
+	{
+		Registry->UnregisterUnit(Pair.Key);
+		if (EntityManager.IsEntityValid(Pair.Value))
+		{
+			SetFlowField(EntityManager.GetFragmentDataChecked<FStrategyUnitMoveTargetFragment>(Pair.Value), INDEX_NONE);
+			if (FogOfWar)
+			{
+				FogOfWar->RemoveVisionSource(EntityManager.GetFragmentDataChecked<FStrategyUnitInstanceFragment>(Pair.Value).VisionHandle);
+			}
+		}
+		EntitiesToDestroy.Add(Pair.Value);
+	}
+	EntityManager.BatchDestroyEntities(EntitiesToDestroy);
+
+	DEC_DWORD_STAT_BY(STAT_StrategySimulatedUnits, Entities.Num());
+	Entities.Reset();
+
+	if (Representation)
+	{
+		Representation->ClearInstances();
+	}
+	InstanceTransforms.Reset();
+	DirtyInstanceMin = MAX_int32;
+	DirtyInstanceMax = INDEX_NONE;
+}
+
+// --- ORDERS ---
+int32 UStrategyUnitSimulationSubsystem::MoveUnits(TConstArrayView<FStrategyUnitHandle> Units, const FVector& Destination, float Spacing)
+{
+	FMassEntityManager& EntityManager = GetEntityManager();
+	const int32 GridSide = FMath::Max(FMath::CeilToInt32(FMath::Sqrt(double(Units.Num()))), 1);
+	const double GridCenter = (GridSide - 1) * 0.5;
+
+	FBox2D UnitBounds(ForceInit);
+	for (const FStrategyUnitHandle& Unit : Units)
+	{
+		const FMassEntityHandle* Entity = Entities.Find(Unit);
+		if (Entity && EntityManager.IsEntityValid(*Entity))
+		{
+			UnitBounds += FVector2D(EntityManager.GetFragmentDataChecked<FStrategyUnitTransformFragment>(*Entity).Location);
+		}
+	}
+	const int32 FlowFieldId = FlowFields ? FlowFields->RequestFlowField(Destination, UnitBounds) : INDEX_NONE;
+
+	int32 NumOrdered = 0;
+	for (const FStrategyUnitHandle& Unit : Units)
+	{
+		const FMassEntityHandle* Entity = Entities.Find(Unit);
+		if (!Entity || !EntityManager.IsEntityValid(*Entity))
+		{
+			continue;
+		}
+
+		const FVector SlotOffset(((NumOrdered % GridSide) - GridCenter) * Spacing, ((NumOrdered / GridSide) - GridCenter) * Spacing, 0.0);
+		FStrategyUnitMoveTargetFragment& Target = EntityManager.GetFragmentDataChecked<FStrategyUnitMoveTargetFragment>(*Entity);
+		Target.Target = Destination + SlotOffset;
+		SetFlowField(Target, FlowFieldId);
+		Target.bArrived = false;
+		EntityManager.AddTagToEntity(*Entity, FStrategyUnitMovingTag::StaticStruct());
+		++NumOrdered;
+	}
+
+	return NumOrdered;
+}
+
+int32 UStrategyUnitSimulationSubsystem::MoveUnitsInFormation(TConstArrayView<FStrategyUnitHandle> Units, const FVector& Destination, EStrategyFormationShape Shape, float Yaw, float Spacing)
+{
+	FMassEntityManager& EntityManager = GetEntityManager();
+	FormationEntities.Reset();
+	FormationUnitLocations.Reset();
+	for (const FStrategyUnitHandle& Unit : Units)
+	{
+		const FMassEntityHandle* Entity = Entities.Find(Unit);
+		if (Entity && EntityManager.IsEntityValid(*Entity))
+		{
+			FormationEntities.Add(*Entity);
+			FormationUnitLocations.Add(EntityManager.GetFragmentDataChecked<FStrategyUnitTransformFragment>(*Entity).Location);
+		}
+	}
+
+	StrategyFormation::MakeSlots(Shape, FormationEntities.Num(), Destination, Yaw, Spacing, FormationSlots);
+	FormationSolver.Solve(FormationUnitLocations, FormationSlots, FormationAssignment);
+
+	FBox2D UnitBounds(ForceInit);
+	for (const FVector& Location : FormationUnitLocations)
+	{
+		UnitBounds += FVector2D(Location);
+	}
+	const int32 FlowFieldId = FlowFields && FormationEntities.Num() > 0 ? FlowFields->RequestFlowField(Destination, UnitBounds) : INDEX_NONE;
+	for (int32 Unit = 0; Unit < FormationEntities.Num(); ++Unit)
+	{
+		FStrategyUnitMoveTargetFragment& Target = EntityManager.GetFragmentDataChecked<FStrategyUnitMoveTargetFragment>(FormationEntities[Unit]);
+		Target.Target = FormationSlots[FormationAssignment[Unit]];
+		SetFlowField(Target, FlowFieldId);
+		Target.bArrived = false;
+		EntityManager.AddTagToEntity(FormationEntities[Unit], FStrategyUnitMovingTag::StaticStruct());
+	}
+
+	return FormationEntities.Num();
+}
+
+void UStrategyUnitSimulationSubsystem::SetFlowField(FStrategyUnitMoveTargetFragment& Target, int32 FlowFieldId)
+{
+	if (Target.FlowFieldId == FlowFieldId)
+	{
+		return;
+	}
+
+	if (FlowFields)
+	{
+		FlowFields->AddFlowFieldUsers(Target.FlowFieldId, -1);
+		FlowFields->AddFlowFieldUsers(FlowFieldId, 1);
+	}
+	Target.FlowFieldId = FlowFieldId;
+}
+
+// --- SIMULATION ---
+void UStrategyUnitSimulationSubsystem::RunSimulation(float DeltaTime)
+{
+	if (Entities.IsEmpty() || !MovementProcessor || !SyncProcessor)
+	{
+		LastMovementMs = 0.0;
+		LastSyncMs = 0.0;
+		return;
+	}
+
+	FMassEntityManager& EntityManager = GetEntityManager();
+	if (FlowFields)
+	{
+		FlowFields->GatherReadyFlowFields(ReadyFlowFields);
+	}
+
+	const uint64 MovementStart = FPlatformTime::Cycles64();
+	{
+		FMassProcessingContext ProcessingContext(EntityManager, DeltaTime);
+		UE::Mass::Executor::Run(*MovementProcessor, ProcessingContext);
+	}
+	const uint64 SyncStart = FPlatformTime::Cycles64();
+	{
+		FMassProcessingContext ProcessingContext(EntityManager, DeltaTime);
+		UE::Mass::Executor::Run(*SyncProcessor, ProcessingContext);
+	}
+	FlushRepresentation();
+	const uint64 SyncEnd = FPlatformTime::Cycles64();
+
+	LastMovementMs = FPlatformTime::ToMilliseconds64(SyncStart - MovementStart);
+	LastSyncMs = FPlatformTime::ToMilliseconds64(SyncEnd - SyncStart);
+}
+
+void UStrategyUnitSimulationSubsystem::FlushRepresentation()
+{
+	if (!Representation || DirtyInstanceMax < DirtyInstanceMin)
+	{
+		return;
+	}
+
+	// One batched update covering the moved instances.
+	ScratchTransforms.Reset();
+	ScratchTransforms.Append(&InstanceTransforms[DirtyInstanceMin], DirtyInstanceMax - DirtyInstanceMin + 1);
+	Representation->BatchUpdateInstancesTransforms(DirtyInstanceMin, ScratchTransforms, true, true, false);
+
+	DirtyInstanceMin = MAX_int32;
+	DirtyInstanceMax = INDEX_NONE;
+}
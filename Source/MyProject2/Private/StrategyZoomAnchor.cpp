@@ -0,0 +1,65 @@
+// StrategyZoomAnchor.cpp
+#include "StrategyZoomAnchor.h"
+
+bool FStrategyZoomAnchor::Begin(const FVector& PawnLocation, const FRotator& BoomRotation, float ArmLength, const FVector& InFocusPoint)
+{
+	Reset();
+
+	const FVector CameraLocation = PawnLocation + GetCameraOffset(BoomRotation, ArmLength);
+	const FVector CameraToFocus = InFocusPoint - CameraLocation;
+	if (CameraToFocus.IsNearlyZero() || CameraToFocus.Z >= 0.0)
+	{
+		return false;
+	}
+
+	FocusPoint = InFocusPoint;
+	LocalCursorDirection = BoomRotation.UnrotateVector(CameraToFocus.GetUnsafeNormal());
+	bActive = true;
+	return true;
+}
+
+void FStrategyZoomAnchor::Reset()
+{
+	bActive = false;
+}
+
+bool FStrategyZoomAnchor::GetPawnToFocus(const FRotator& BoomRotation, float ArmLength, double PawnHeight, FVector& OutPawnToFocus) const
+{
+	if (!bActive)
+	{
+		return false;
+	}
+
+	// The cursor stays on the same pixel, so its camera-space ray is unchanged; only the camera moves.
+	// Focus = Pawn + CameraOffset + T * CursorDirection, with Focus.Z and Pawn.Z known -> solve for T.
+	const FVector CursorDirection = BoomRotation.RotateVector(LocalCursorDirection);
+	if (CursorDirection.Z >= -UE_KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	const FVector CameraOffset = GetCameraOffset(BoomRotation, ArmLength);
+	const double T = (FocusPoint.Z - PawnHeight - CameraOffset.Z) / CursorDirection.Z;
+	if (T <= 0.0)
+	{
+		return false;
+	}
+
+	OutPawnToFocus = CameraOffset + CursorDirection * T;
+	return true;
+}
+
+bool FStrategyZoomAnchor::ComputePawnOffset(const FRotator& FromBoomRotation, float FromArmLength, double FromPawnHeight, const FRotator& ToBoomRotation, float ToArmLength, double ToPawnHeight, FVector& OutPawnOffset) const
+{
+	FVector PawnToFocusBefore;
+	FVector PawnToFocusAfter;
+	if (!GetPawnToFocus(FromBoomRotation, FromArmLength, FromPawnHeight, PawnToFocusBefore) || !GetPawnToFocus(ToBoomRotation, ToArmLength, ToPawnHeight, PawnToFocusAfter))
+	{
+		return false;
+	}
+
+	// The focus point is fixed in the world, so the pawn moves by the change in its offset to it.
+	OutPawnOffset = PawnToFocusBefore - PawnToFocusAfter;
+	OutPawnOffset.Z = 0.0;
+	return true;
+}
@@ -0,0 +1,126 @@
+// StrategyZoomTiers.cpp
+#include "StrategyZoomTiers.h"
+#include "StrategyCameraDebug.h"
+#include "Scalability.h"
+
+bool FStrategyZoomTierSelector::Update(TConstArrayView<FStrategyZoomTier> Tiers, float ArmLength, float Hysteresis)
+{
+	if (Tiers.IsEmpty())
+	{
+		return false;
+	}
+
+	int32 NewTier = CurrentTier;
+	if (!Tiers.IsValidIndex(NewTier))
+	{
+		// First update: no hysteresis, just the band the arm length is in.
+		NewTier = 0;
+		while (NewTier + 1 < Tiers.Num() && ArmLength >= Tiers[NewTier + 1].MinArmLength)
+		{
+			++NewTier;
+		}
+	}
+	else
+	{
+		// A boundary has to be crossed by Hysteresis before the tier switches, in either direction,
+		// so an arm length sitting on a boundary (or oscillating around it) keeps the current tier.
+		while (NewTier + 1 < Tiers.Num() && ArmLength >= Tiers[NewTier + 1].MinArmLength + Hysteresis)
+		{
+			++NewTier;
+		}
+		while (NewTier > 0 && ArmLength < Tiers[NewTier].MinArmLength - Hysteresis)
+		{
+			--NewTier;
+		}
+	}
+
+	if (NewTier == CurrentTier)
+	{
+		return false;
+	}
+
+	STRATEGY_CAMERA_LOG(Log, TEXT("[ZOOM TIERS] Arm length %.1f: tier %d -> %d"), ArmLength, CurrentTier, NewTier);
+	CurrentTier = NewTier;
+	return true;
+}
+
+void FStrategyZoomTierSelector::ApplyTier(const FStrategyZoomTier& Tier)
+{
+	SetSaved(TEXT("r.ViewDistanceScale"), FString::SanitizeFloat(Tier.ViewDistanceScale));
+	SetSaved(TEXT("r.StaticMeshLODDistanceScale"), FString::SanitizeFloat(Tier.StaticMeshLODDistanceScale));
+	SetSaved(TEXT("r.SkeletalMeshLODBias"), FString::FromInt(Tier.SkeletalMeshLODBias));
+
+	// Quality tiers only ever lower the user's scalability setting, and go through the scalability system like the
+	// user's own changes, so the settings menu keeps working.
+	Scalability::FQualityLevels Levels = Scalability::GetQualityLevels();
+	if (Levels.ShadowQuality != AppliedShadowQuality)
+	{
+		UserShadowQuality = Levels.ShadowQuality;
+	}
+	if (Levels.GlobalIlluminationQuality != AppliedGlobalIlluminationQuality)
+	{
+		UserGlobalIlluminationQuality = Levels.GlobalIlluminationQuality;
+	}
+	Levels.ShadowQuality = FMath::Min(UserShadowQuality, Tier.MaxShadowQuality);
+	Levels.GlobalIlluminationQuality = FMath::Min(UserGlobalIlluminationQuality, Tier.MaxGlobalIlluminationQuality);
+	Scalability::SetQualityLevels(Levels);
+
+	// Read back: a level held at a higher priority than scalability wins, and is then the user's.
+	const Scalability::FQualityLevels AppliedLevels = Scalability::GetQualityLevels();
+	AppliedShadowQuality = AppliedLevels.ShadowQuality;
+	AppliedGlobalIlluminationQuality = AppliedLevels.GlobalIlluminationQuality;
+}
+
+void FStrategyZoomTierSelector::Restore()
+{
+	for (const FSavedConsoleVariable& Saved : SavedVariables)
+	{
+		if (Saved.Variable->GetString() == Saved.AppliedValue)
+		{
+			Saved.Variable->Set(*Saved.Value, Saved.Priority);
+		}
+	}
+	SavedVariables.Reset();
+
+	if (AppliedShadowQuality != INDEX_NONE)
+	{
+		Scalability::FQualityLevels Levels = Scalability::GetQualityLevels();
+		if (Levels.ShadowQuality == AppliedShadowQuality || Levels.GlobalIlluminationQuality == AppliedGlobalIlluminationQuality)
+		{
+			Levels.ShadowQuality = Levels.ShadowQuality == AppliedShadowQuality ? UserShadowQuality : Levels.ShadowQuality;
+			Levels.GlobalIlluminationQuality = Levels.GlobalIlluminationQuality == AppliedGlobalIlluminationQuality ? UserGlobalIlluminationQuality : Levels.GlobalIlluminationQuality;
+			Scalability::SetQualityLevels(Levels);
+		}
+	}
+	UserShadowQuality = INDEX_NONE;
+	UserGlobalIlluminationQuality = INDEX_NONE;
+	AppliedShadowQuality = INDEX_NONE;
+	AppliedGlobalIlluminationQuality = INDEX_NONE;
+	CurrentTier = INDEX_NONE;
+}
+
+void FStrategyZoomTierSelector::SetSaved(const TCHAR* Name, const FString& Value)
+{
+	IConsoleVariable* Variable = IConsoleManager::Get().FindConsoleVariable(Name);
+	if (!Variable)
+	{
+		return;
+	}
+
+	FSavedConsoleVariable* Saved = SavedVariables.FindByPredicate([Variable](const FSavedConsoleVariable& Entry) { return Entry.Variable == Variable; });
+	if (!Saved)
+	{
+		Saved = &SavedVariables.AddDefaulted_GetRef();
+		Saved->Variable = Variable;
+	}
+	if (Saved->AppliedValue.IsEmpty() || Variable->GetString() != Saved->AppliedValue)
+	{
+		// First touch, or changed from outside since: that is the value to go back to.
+		Saved->Value = Variable->GetString();
+		Saved->Priority = EConsoleVariableFlags(Variable->GetFlags() & ECVF_SetByMask);
+	}
+
+	// Same priority as the current value: never outranks the user's settings, and Set succeeds.
+	Variable->Set(*Value, EConsoleVariableFlags(Variable->GetFlags() & ECVF_SetByMask));
+	Saved->AppliedValue = Variable->GetString();
+}
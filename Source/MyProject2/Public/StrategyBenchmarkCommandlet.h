@@ -0,0 +1,164 @@
+// StrategyBenchmarkCommandlet.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "StrategyBenchmarkCommandlet.generated.h"
+
+class UWorld;
+class UGameInstance;
+class AStrategyPlayerController;
+class AGameModeBase;
+
+/**
+ * Headless benchmark suites for the strategy module. Needs no GPU and no renderer.
+ *
+ *   UnrealEditor-Cmd MyProject2.uproject -run=StrategyBenchmark -nullrhi -unattended [-Suite=Camera] [-Output=<csv path>]
+ *     [-NoAllocCount]
+ *
+ * Allocations are counted by wrapping GMalloc once at startup, for the whole process; -NoAllocCount leaves the
+ * allocator alone and reports zero allocations.
+ *
+ * Camera suite: [-Frames=600] [-DeltaTime=0.016667] [-Scenario=WheelBurst|Pan|RotateDrag|Mixed|CombinedPan|ZoomToCursor|Idle]
+ *     [-ControllerClass=/Game/BP_StrategyController.BP_StrategyController_C]
+ *   Builds a game world with AStrategyGameMode, spawns and possesses an AStrategyCameraPawn and replays synthetic
+ *   input streams through the controller's Handle*Input functions. Writes per-frame game-thread time, allocation
+ *   count, cursor trace counts and pawn moves as CSV (Saved/Benchmarks by default) and logs a summary per scenario,
+ *   followed by the Strategy.Camera.ProfileDump percentiles for that scenario. Each scenario starts from a settled camera.
+ *   Fails if the pawn's root component moves more than once in any frame (CombinedPan holds keys, edge scroll and drag
+ *   together), or if the ground point under the cursor drifts 1 cm or more from where a ZoomToCursor wheel gesture
+ *   began (the cursor jumps to another pixel as each gesture begins), or if the camera updates or the pawn's movement
+ *   component ticks at all during Idle (no input; 600 frames at 1/60 s by default).
+ *
+ * ZoomTiers suite: [-ControllerClass=...]
+ *   Drives FStrategyZoomTierSelector with the controller's default ZoomTiers through a slow sweep, jitter around every
+ *   boundary and a random walk. Fails (non-zero exit) if a tier is wrong outside the hysteresis band, a switch happens
+ *   inside it, or the tier flickers. No world is created and no console variables are touched.
+ *
+ * PitchTable suite: [-Resolution=<PitchCurveTableResolution>] [-MaxError=0.05] [-Calls=1000000] [-ControllerClass=...]
+ *   Bakes the controller's CameraPitchByZoomCurve (or, without one, a three-key cubic stand-in) at the configured
+ *   resolution and compares FStrategyCurveTable::Evaluate with UCurveFloat::GetFloatValue at 100000 arm lengths
+ *   spread over [MinZoomLength, MaxZoomLength]. Times both per call on the same random arm lengths. Fails if the
+ *   maximum error exceeds MaxError degrees.
+ *
+ * CameraSpring suite: [-Rates=30,60,144,240] [-Duration=4] [-Tolerance=0.5] [-ControllerClass=...]
+ *   Replays one timeline of zoom, yaw and pan targets through FStrategyCameraIntegrator (with the controller's smoothing
+ *   settings) at each frame rate, plus a 60 FPS run with a 250 ms hitch, and compares every rendered frame against a
+ *   1000 FPS reference. Fails if arm length or pan (cm), or pitch or yaw (degrees), differ by more than Tolerance.
+ *
+ * InputReplay suite: [-Frames=600] [-DeltaTime=0.016667] [-Tolerance=0.01] [-Records=1000000] [-File=<recording>]
+ *   Records a session of pan, rotate drag, pan drag and wheel input through the controller's input recorder, saves
+ *   it, then replays the file twice through the same handlers and compares pawn location, arm length and yaw frame by
+ *   frame against the recorded session (or, with -File, the two replays against each other). Terrain following is
+ *   off, so the height cache filling at different times doesn't enter the comparison. Also times the recorder per
+ *   record and fails if recording allocates.
+ *
+ * TerrainHeight suite: [-Lookups=100000] [-Radius=16000] [-Hills=40]
+ *   Scatters box "hills" on the ground, lets UStrategyTerrainHeightSubsystem sample the area through the world tick and
+ *   times bilinear height lookups against one LineTraceSingleByChannel per lookup, with the height error between them.
+ *   Also reports how many frames an invalidated area takes to be re-sampled.
+ *
+ * Selection suite: [-Units=1000,10000,50000] [-Queries=200] [-EdgeEpsilon=0.5]
+ *   Registers actor-less units scattered around the camera with UStrategyUnitRegistrySubsystem and times random
+ *   1920x1080 marquee queries through the cell cull + batched projection against a per-unit
+ *   FSceneView::ProjectWorldToScreen loop, plus registration and incremental position updates. Fails if the two
+ *   select different units, other than units within EdgeEpsilon pixels of the rectangle's edge.
+ *
+ * Units suite: [-Entities=10000,100000] [-Frames=300] [-DeltaTime=0.016667]
+ *   Spawns Mass units through UStrategyUnitSimulationSubsystem, orders all of them across the map and reports the
+ *   movement (parallel and game-thread) and sync milliseconds per simulated frame.
+ *
+ * FlowField suite: [-Groups=50,500,5000] [-Obstacles=40]
+ *   Scatters blocking boxes over the flow-field grid and, per group size, times one flow-field build, a cached
+ *   re-request, one frame of field sampling for the whole group and the rebuild after an obstacle change. Compares
+ *   with one UNavigationSystemV1 path query per unit on a navmesh built synchronously over the grid (the obstacles are
+ *   solid boxes too). Fails if the build produces no navigation data, a group finds no path, or removing one of two
+ *   overlapping blockers reopens cells the other still covers.
+ *
+ * FogOfWar suite: [-Sources=1000,10000] [-Frames=120] [-DeltaTime=0.016667] [-Queries=1000000]
+ *   Moves vision sources (8-15 m radius, 3-6 m/s) over UStrategyFogOfWarSubsystem's 512x512 grid and times the
+ *   initial stamp, the per-frame source updates and incremental tile updates (parallel and game-thread), a full
+ *   rebuild for comparison, and IsVisible queries. Fails if the incremental grid differs from a full rebuild, or a
+ *   sampled cell's visibility differs from a brute-force distance check against every source.
+ *
+ * Minimap suite: [-Units=5000] [-Frames=300] [-DeltaTime=0.016667] [-Budget=0.3] [-ControllerClass=...]
+ *   Spawns Mass units (with fog-of-war vision) over the map, orders them across it and ticks the world with the
+ *   minimap texture live, reporting UStrategyMinimapSubsystem's update time and dirty blocks per frame against Budget
+ *   (ms). Fails if the incremental image differs from a full redraw, a unit's pixel is missing, or a minimap click
+ *   doesn't bring the camera to the clicked point.
+ *
+ * Bookmarks suite: [-Distance=40000] [-MaxFrames=900] [-DeltaTime=0.016667] [-ControllerClass=...]
+ *   Jumps the camera back and forth between two bookmarks Distance apart (different yaw and zoom), animated and as
+ *   cuts, and reports each jump's prefetch and request-to-stable time and frames. Also round-trips a bookmark through
+ *   SetCameraBookmark. Fails if a jump doesn't become stable within MaxFrames or leaves the camera off the bookmark.
+ *
+ * Lockstep suite: [-Clients=4] [-Units=1000,100000] [-Turns=600] [-TurnMs=100] [-Latency=0.05] [-OrderRate=0.3] [-SessionUnits=200]
+ *   Runs Clients FStrategyLockstepPeers in one process over a loopback transport with Latency seconds one way, on a
+ *   virtual 60 Hz clock. Each client randomly selects up to 200 units and orders them somewhere in OrderRate of its
+ *   turns. Reports bytes per packet, command latency (issue to execution) and update time per turn for each unit
+ *   count, so bandwidth can be compared across unit counts. Then starts two UStrategyLockstepSubsystem sessions in two
+ *   worlds over one loopback and orders SessionUnits units through the first world's controller. Fails if the peers'
+ *   checksums differ, a unit nudged on one peer goes undetected as a desync, the controller's order doesn't execute
+ *   and move the units in both worlds, or ending a session destroys units it didn't spawn.
+ *
+ * Placement suite: [-Grid=1024] [-Footprints=10000] [-Queries=1000000] [-Verify=20000] [-NoOverlap]
+ *   First places a building through the controller in each quarter turn. Then marks some unbuildable areas on a
+ *   Grid x Grid UStrategyPlacementSubsystem grid and places Footprints random 2-8 cell buildings in random quarter turns
+ *   where they fit. Times CanPlace for random footprints and positions, and adding and removing footprints (with
+ *   overlapping ones stacked over those removed). Unless -NoOverlap, also times the same queries as
+ *   OverlapBlockingTestByChannel against one box per building. Fails if CanPlace disagrees with a per-cell check
+ *   against a mirrored grid at any stage, or a placed building's footprint component stamps other cells than the
+ *   preview showed.
+ *
+ * Startup suite: [-GameMode=/Game/BP_StrategyGameMode.BP_StrategyGameMode_C] [-MaxFrames=600] [-DeltaTime=0.016667]
+ *   Builds the world with GameMode, whose player controller should reference its input assets, and lets it spawn and
+ *   possess the camera pawn. Ticks the world (pumping async loading) and, from the first frame the controller reports
+ *   input ready, injects its MoveAction through the Enhanced Input subsystem. Reports the startup phases and the time
+ *   from InitGame to the first processed input. Fails if any of the controller's startup assets is already loaded
+ *   before InitGame (a Blueprint still hard-references it), or no input is processed within MaxFrames. Only the first
+ *   run in a process can pass: the loaded assets stay in memory.
+ *
+ * Formation suite: [-Units=50,500,5000] [-Runs=20] [-LeafSize=64] [-OptimalMax=1000] [-MaxRatio=1.25]
+ *   For each group size, shape (Line, Box, Wedge) and move (Far: across the map, Near: overlapping the group), scatters
+ *   units on a disc, lays out the slots and times FStrategyFormationSolver in parallel and on one thread (median of
+ *   Runs). Reports its total path length against the exact assignment (Hungarian method, up to OptimalMax units; a
+ *   nearest-slot lower bound above that) and against assigning slots in selection order, with crossing paths for both.
+ *   Fails if an assignment isn't one slot per unit or the solver's path length exceeds MaxRatio times the exact one.
+ */
+UCLASS()
+class MYPROJECT2_API UStrategyBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UStrategyBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	int32 RunCameraSuite(const FString& Params, FString& OutCsv) const;
+	int32 RunZoomTierSuite(const FString& Params, FString& OutCsv) const;
+	int32 RunPitchTableSuite(const FString& Params, FString& OutCsv) const;
+	int32 RunCameraSpringSuite(const FString& Params, FString& OutCsv) const;
+	int32 RunTerrainHeightSuite(const FString& Params, FString& OutCsv) const;
+	int32 RunInputReplaySuite(const FString& Params, FString& OutCsv) const;
+	int32 RunSelectionSuite(const FString& Params, FString& OutCsv) const;
+	int32 RunUnitSimulationSuite(const FString& Params, FString& OutCsv) const;
+	int32 RunFlowFieldSuite(const FString& Params, FString& OutCsv) const;
+	int32 RunFogOfWarSuite(const FString& Params, FString& OutCsv) const;
+	int32 RunMinimapSuite(const FString& Params, FString& OutCsv) const;
+	int32 RunBookmarkSuite(const FString& Params, FString& OutCsv) const;
+	int32 RunLockstepSuite(const FString& Params, FString& OutCsv) const;
+	int32 RunPlacementSuite(const FString& Params, FString& OutCsv) const;
+	int32 RunStartupSuite(const FString& Params, FString& OutCsv) const;
+	int32 RunFormationSuite(const FString& Params, FString& OutCsv) const;
+
+	using FInputStep = TFunction<void(AStrategyPlayerController&, int32 /*Frame*/)>;
+
+	UWorld* CreateBenchmarkWorld(UGameInstance*& OutGameInstance, TSubclassOf<AGameModeBase> GameModeClass = nullptr) const;
+	// Unless bFinishStartup is false, waits for the controller's startup assets so it starts with input and pitch curve set up.
+	AStrategyPlayerController* CreatePlayer(UWorld& World, UGameInstance& GameInstance, const FString& Params, bool bFinishStartup = true) const;
+	// Returns the most pawn moves seen in one frame. FrameCheck, if set, runs after each frame's tick, outside the timing.
+	uint64 RunCameraScenario(const FString& Name, UWorld& World, AStrategyPlayerController& Controller, int32 NumFrames, float DeltaTime, const FInputStep& InputStep, FString& InOutCsv, const FInputStep& FrameCheck = FInputStep()) const;
+	void DestroyBenchmarkWorld(UWorld* World, UGameInstance* GameInstance) const;
+};
@@ -0,0 +1,40 @@
+// StrategyBuildingFootprintComponent.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "StrategyPlacementSubsystem.h"
+#include "StrategyBuildingFootprintComponent.generated.h"
+
+/**
+ * Makes the owning actor a building on UStrategyPlacementSubsystem's grid: occupies a rectangle of cells centered on
+ * the actor, turned by its yaw snapped to quarter turns, from BeginPlay to EndPlay. The same rectangle blocks
+ * UStrategyFlowFieldSubsystem's cost grid so units route around it. Buildings are expected to stay put; later moves
+ * are not tracked. Does not tick.
+ */
+UCLASS(ClassGroup = (Strategy), meta = (BlueprintSpawnableComponent))
+class MYPROJECT2_API UStrategyBuildingFootprintComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UStrategyBuildingFootprintComponent();
+
+	// Cells along the actor's X and Y axes before rotation.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Placement", meta = (ClampMin = "1", ClampMax = "64"))
+	FIntPoint FootprintSize = FIntPoint(4, 4);
+
+	FStrategyPlacementHandle GetPlacementHandle() const { return PlacementHandle; }
+
+	// Quarter turns (0-3) closest to Yaw, as used to rotate footprints.
+	static int32 GetQuarterTurns(float Yaw) { return FMath::RoundToInt32(FRotator::NormalizeAxis(Yaw) / 90.f) & 3; }
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	FStrategyPlacementHandle PlacementHandle;
+	// World X/Y box added as a flow-field blocker; invalid if none was added.
+	FBox2D FlowFieldBlocker = FBox2D(ForceInit);
+};
@@ -0,0 +1,57 @@
+// StrategyCameraDebug.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MyProject2.h"
+
+// Diagnostic logging and debug draws for the camera/controller stack. Compiled out entirely in Shipping and Test,
+// and gated at runtime by Strategy.Camera.Debug so the hot input path pays nothing (no formatting) when it is off.
+#ifndef STRATEGY_CAMERA_DEBUG
+#define STRATEGY_CAMERA_DEBUG !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+#endif
+
+#if STRATEGY_CAMERA_DEBUG
+
+namespace StrategyCameraDebug
+{
+	enum ELevel : int32
+	{
+		Off = 0,
+		// State changes and per-event input logging.
+		Log = 1,
+		// Logging plus debug draws in the world.
+		Draw = 2,
+	};
+
+	// Backed by the Strategy.Camera.Debug console variable.
+	extern MYPROJECT2_API int32 GLevel;
+
+	FORCEINLINE bool IsEnabled(ELevel Level) { return GLevel >= Level; }
+}
+
+// Arguments are only evaluated when logging is enabled.
+#define STRATEGY_CAMERA_LOG(Verbosity, Format, ...) \
+	do \
+	{ \
+		if (StrategyCameraDebug::IsEnabled(StrategyCameraDebug::Log)) \
+		{ \
+			UE_LOG(LogStrategyCamera, Verbosity, Format, ##__VA_ARGS__); \
+		} \
+	} while (0)
+
+// Wraps a debug draw statement so it only runs (and only compiles) when draws are enabled.
+#define STRATEGY_CAMERA_DRAW(Statement) \
+	do \
+	{ \
+		if (StrategyCameraDebug::IsEnabled(StrategyCameraDebug::Draw)) \
+		{ \
+			Statement; \
+		} \
+	} while (0)
+
+#else
+
+#define STRATEGY_CAMERA_LOG(Verbosity, Format, ...) do { } while (0)
+#define STRATEGY_CAMERA_DRAW(Statement) do { } while (0)
+
+#endif
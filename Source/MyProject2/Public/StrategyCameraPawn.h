@@ -2,20 +2,64 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Pawn.h"
+#include "WorldPartition/WorldPartitionStreamingSource.h"
 #include "StrategyCameraPawn.generated.h"
 
 class USpringArmComponent;
 class UCameraComponent;
 class UFloatingPawnMovement;
 
+// The area of the ground plane (at the pawn's height) covered by the view frustum.
+struct FStrategyGroundFootprint
+{
+	// Bottom-left, bottom-right, top-right, top-left of the screen, projected on the ground.
+	FVector Corners[4];
+	FVector Center = FVector::ZeroVector;
+	// Distance from Center to the farthest corner.
+	double Radius = 0.0;
+};
+
+// Samples of whether the streamed regions around the camera were ready, see AStrategyCameraPawn::SampleStreamingMetrics.
+struct FStrategyStreamingMetrics
+{
+	int32 NumSamples = 0;
+	// Samples where the predicted region was still streaming: cells requested ahead of the view.
+	int32 NumRequestedAhead = 0;
+	// Samples where the region currently in view was still streaming: cells that loaded late.
+	int32 NumLoadedLate = 0;
+};
+
 UCLASS()
-class MYPROJECT2_API AStrategyCameraPawn : public APawn
+class MYPROJECT2_API AStrategyCameraPawn : public APawn, public IWorldPartitionStreamingSourceProvider
 {
 	GENERATED_BODY()
 
 public:
 	AStrategyCameraPawn();
-	virtual void Tick(float DeltaSeconds) override;
+	virtual UPawnMovementComponent* GetMovementComponent() const override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// --- IWorldPartitionStreamingSourceProvider ---
+	virtual bool GetStreamingSources(TArray<FWorldPartitionStreamingSource>& OutStreamingSources) const override;
+	virtual const UObject* GetStreamingSourceOwner() const override { return this; }
+
+	// Where the boom is heading (the controller's zoom target), so streaming can prepare the zoomed-out footprint early.
+	void SetStreamingTarget(float TargetArmLength, float TargetBoomPitch);
+
+	// Frustum footprint on the ground for a boom state, relative to the given pawn location, at the pawn's yaw or at Yaw.
+	FStrategyGroundFootprint ComputeGroundFootprint(const FVector& PawnLocation, float ArmLength, float BoomPitch) const;
+	FStrategyGroundFootprint ComputeGroundFootprint(const FVector& PawnLocation, float ArmLength, float BoomPitch, float Yaw) const;
+
+	// Streams in the footprint of a camera state the view is about to jump to, as a third source, until cleared.
+	void SetStreamingPrefetch(const FVector& PawnLocation, float ArmLength, float BoomPitch, float Yaw);
+	void ClearStreamingPrefetch() { bHasStreamingPrefetch = false; }
+	// True once the cells of the prefetch footprint (IsViewStreamed: of the current view) are activated. Always true
+	// without World Partition.
+	bool IsPrefetchStreamed() const;
+	bool IsViewStreamed() const;
+
+	const FStrategyStreamingMetrics& GetStreamingMetrics() const { return StreamingMetrics; }
 	
 	// --- Component Getters ---
 	// We expose these so the PlayerController can easily access them.
@@ -38,4 +82,36 @@ protected:
 	// The component that handles movement logic (e.g., from AddMovementInput)
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	TObjectPtr<UFloatingPawnMovement> MovementComponent;
+
+	// --- Streaming ---
+	// How far ahead (seconds) the pawn velocity is extrapolated for the predicted streaming source.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming", meta = (ClampMin = "0.0"))
+	float StreamingLookAheadTime = 1.0f;
+
+	// Loading radius as a multiple of the visible ground footprint radius.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming", meta = (ClampMin = "1.0"))
+	float StreamingRadiusScale = 1.25f;
+
+	// Footprint rays that reach the horizon are clamped to this distance (cm).
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming", meta = (ClampMin = "0.0"))
+	float MaxStreamingDistance = 40000.0f;
+
+	// How often (seconds) streaming completeness is sampled for FStrategyStreamingMetrics. 0 disables sampling.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming", meta = (ClampMin = "0.0"))
+	float StreamingMetricsInterval = 0.25f;
+
+private:
+	void SampleStreamingMetrics();
+	FWorldPartitionStreamingSource MakeStreamingSource(FName Name, const FStrategyGroundFootprint& Footprint, EStreamingSourcePriority Priority) const;
+	bool IsSourceStreamed(const FWorldPartitionStreamingSource& StreamingSource) const;
+
+	float StreamingTargetArmLength = 0.f;
+	float StreamingTargetBoomPitch = 0.f;
+	bool bHasStreamingTarget = false;
+
+	FStrategyGroundFootprint StreamingPrefetchFootprint;
+	bool bHasStreamingPrefetch = false;
+
+	FStrategyStreamingMetrics StreamingMetrics;
+	FTimerHandle StreamingMetricsTimerHandle;
 };
\ No newline at end of file
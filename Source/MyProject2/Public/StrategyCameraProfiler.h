@@ -0,0 +1,145 @@
+// StrategyCameraProfiler.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MyProject2.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+// Rolling per-frame timings of the camera/controller stack, summarized by Strategy.Camera.ProfileDump. Compiled out in
+// Shipping; in other builds it is gated at runtime by Strategy.Camera.Profile and costs two timestamps per scope.
+#ifndef STRATEGY_CAMERA_PROFILE
+#define STRATEGY_CAMERA_PROFILE !UE_BUILD_SHIPPING
+#endif
+
+enum class EStrategyCameraMetric : uint8
+{
+	ControllerTick,
+	CameraTick,
+	CameraMovement,
+	CameraSprings,
+	MoveInput,
+	PanDragInput,
+	ZoomInput,
+	RotateInput,
+	SelectInput,
+	MoveOrderInput,
+	CursorQuery,
+	Num
+};
+
+enum class EStrategyCameraCounter : uint8
+{
+	CursorTraces,
+	CameraSubsteps,
+	// 1 on frames where the camera tick ran, i.e. something was still interpolating.
+	InterpolatingFrames,
+	Num
+};
+
+// Percentiles of one metric (ms) or counter (per frame) over the frames in the window where it was recorded.
+struct FStrategyCameraProfileStat
+{
+	const TCHAR* Name = TEXT("");
+	int32 NumFrames = 0;
+	double P50 = 0.0;
+	double P95 = 0.0;
+	double P99 = 0.0;
+	double Max = 0.0;
+	double Total = 0.0;
+};
+
+struct FStrategyCameraProfileSummary
+{
+	int32 NumFrames = 0;
+	TArray<FStrategyCameraProfileStat> Metrics;
+	TArray<FStrategyCameraProfileStat> Counters;
+
+	void Log(FOutputDevice& Ar) const;
+};
+
+/**
+ * Game-thread ring buffer of the last WindowSize frames. Scopes and counters add to the current frame;
+ * a frame is committed when the first record of the next frame (by GFrameCounter) arrives.
+ */
+class MYPROJECT2_API FStrategyCameraProfiler
+{
+public:
+	static constexpr int32 WindowSize = 1024;
+
+	static FStrategyCameraProfiler& Get();
+	static bool IsEnabled();
+
+	void AddTime(EStrategyCameraMetric Metric, uint64 Cycles);
+	void AddCount(EStrategyCameraCounter Counter, uint32 Count = 1);
+
+	// Summary of the last NumFrames committed frames (all of the window when <= 0).
+	FStrategyCameraProfileSummary Summarize(int32 NumFrames = 0) const;
+	void Reset();
+
+	static const TCHAR* GetMetricName(EStrategyCameraMetric Metric);
+	static const TCHAR* GetCounterName(EStrategyCameraCounter Counter);
+
+private:
+	static constexpr int32 NumMetrics = int32(EStrategyCameraMetric::Num);
+	static constexpr int32 NumCounters = int32(EStrategyCameraCounter::Num);
+
+	struct FFrame
+	{
+		// Cycles per metric, summed over every scope of the frame; 0 means the metric did not run.
+		uint64 Cycles[NumMetrics] = {};
+		uint32 Counts[NumCounters] = {};
+	};
+
+	FFrame& GetCurrentFrame();
+
+	TArray<FFrame> Frames;
+	FFrame Current;
+	uint64 CurrentFrameNumber = 0;
+	int32 NextFrame = 0;
+	int32 NumCommittedFrames = 0;
+};
+
+#if STRATEGY_CAMERA_PROFILE
+
+struct FStrategyCameraProfileScope
+{
+	explicit FStrategyCameraProfileScope(EStrategyCameraMetric InMetric)
+		: Metric(InMetric)
+		, StartCycles(FStrategyCameraProfiler::IsEnabled() ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FStrategyCameraProfileScope()
+	{
+		if (StartCycles != 0)
+		{
+			FStrategyCameraProfiler::Get().AddTime(Metric, FPlatformTime::Cycles64() - StartCycles);
+		}
+	}
+
+	EStrategyCameraMetric Metric;
+	uint64 StartCycles;
+};
+
+#define STRATEGY_CAMERA_PROFILE_SCOPE(Metric) FStrategyCameraProfileScope PREPROCESSOR_JOIN(StrategyCameraProfileScope_, __LINE__)(EStrategyCameraMetric::Metric)
+#define STRATEGY_CAMERA_PROFILE_COUNT(Counter, Count) \
+	do \
+	{ \
+		if (FStrategyCameraProfiler::IsEnabled()) \
+		{ \
+			FStrategyCameraProfiler::Get().AddCount(EStrategyCameraCounter::Counter, Count); \
+		} \
+	} while (0)
+
+#else
+
+#define STRATEGY_CAMERA_PROFILE_SCOPE(Metric)
+#define STRATEGY_CAMERA_PROFILE_COUNT(Counter, Count) do { } while (0)
+
+#endif
+
+// One cycle stat, one Unreal Insights CPU event (StrategyCamera_<Metric>) and one rolling profiler sample for the enclosing scope.
+#define STRATEGY_CAMERA_SCOPE(Metric, Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(StrategyCamera_##Metric); \
+	STRATEGY_CAMERA_PROFILE_SCOPE(Metric)
@@ -0,0 +1,85 @@
+// StrategyCameraSpring.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FStrategyCurveTable;
+
+// Camera state driven by FStrategyCameraIntegrator. Also used for the per-channel velocities.
+struct FStrategyCameraSpringState
+{
+	double ArmLength = 0.0;
+	// Boom pitch in degrees, negative when looking down.
+	double Pitch = 0.0;
+	// Pawn yaw in degrees. Not normalized, so it stays continuous across +-180.
+	double Yaw = 0.0;
+	// Pawn location.
+	FVector Pan = FVector::ZeroVector;
+};
+
+// Where the camera is heading, set once per frame from input.
+struct FStrategyCameraSpringTargets
+{
+	double ArmLength = 0.0;
+	// Used when PitchByArmLength is null or not baked; otherwise the pitch target follows the current arm length.
+	double Pitch = 0.0;
+	double Yaw = 0.0;
+	FVector Pan = FVector::ZeroVector;
+	// Pitch (degrees, positive looking down) by arm length, sampled every substep.
+	const FStrategyCurveTable* PitchByArmLength = nullptr;
+};
+
+struct FStrategyCameraSpringSettings
+{
+	// Fixed simulation rate (Hz). Rendering interpolates between the last two substeps.
+	float SubstepRate = 120.f;
+	// Substeps run in one frame at most. The time beyond that is dropped, so a long hitch makes the camera lag, never jump.
+	int32 MaxSubstepsPerFrame = 32;
+	// Angular frequencies (rad/s) of the critically damped springs; higher is snappier.
+	float ArmLengthFrequency = 10.f;
+	float PitchFrequency = 10.f;
+	float YawFrequency = 12.f;
+	float PanFrequency = 12.f;
+};
+
+/**
+ * Frame-rate independent camera smoothing: critically damped springs for arm length, pitch, yaw and pan,
+ * stepped at a fixed rate with the exact solution of the spring (never overshoots, stable for any step).
+ * Replaying the same targets at any frame rate gives the same trajectory, up to the interpolation between substeps.
+ */
+struct MYPROJECT2_API FStrategyCameraIntegrator
+{
+public:
+	// Places the camera at State, at rest.
+	void Reset(const FStrategyCameraSpringState& State);
+
+	// Advances the simulation by DeltaTime in fixed substeps towards Targets. Returns the number of substeps run.
+	int32 Advance(float DeltaTime, const FStrategyCameraSpringTargets& Targets, const FStrategyCameraSpringSettings& Settings);
+
+	// State to render this frame: interpolated between the last two substeps.
+	FStrategyCameraSpringState GetRenderState() const;
+
+	// Shifts the pan channel (both substeps) without changing its velocity, e.g. for the zoom anchor. The pan target is the caller's to shift.
+	void OffsetPan(const FVector& Offset);
+
+	// True once every channel is within the tolerances of Targets and nearly at rest.
+	// Tolerances are in cm (arm length), degrees (pitch, yaw) and cm for pan distance and cm/s for pan speed.
+	bool IsSettled(const FStrategyCameraSpringTargets& Targets, double ArmLengthTolerance, double AngleTolerance, double PanTolerance) const;
+
+	const FStrategyCameraSpringState& GetCurrentState() const { return Current; }
+	const FStrategyCameraSpringState& GetVelocity() const { return Velocity; }
+
+	// One critically damped spring step of length DeltaTime: updates Value and ValueVelocity in place.
+	static void StepSpring(double& Value, double& ValueVelocity, double Target, double AngularFrequency, double DeltaTime);
+
+private:
+	double GetPitchTarget(const FStrategyCameraSpringTargets& Targets, double ArmLength) const;
+
+	FStrategyCameraSpringState Previous;
+	FStrategyCameraSpringState Current;
+	FStrategyCameraSpringState Velocity;
+
+	// Simulated time not yet consumed by a substep, and the substep it was measured against.
+	double Accumulator = 0.0;
+	double SubstepTime = 1.0 / 120.0;
+};
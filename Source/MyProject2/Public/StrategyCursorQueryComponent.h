@@ -0,0 +1,115 @@
+// StrategyCursorQueryComponent.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/HitResult.h"
+#include "WorldCollision.h"
+#include "StrategyCursorQueryComponent.generated.h"
+
+class APlayerController;
+
+// The last ground hit under the cursor, stamped with the view and frame it was traced on.
+struct FStrategyCursorQueryResult
+{
+	FHitResult Hit;
+	// Off-screen until the first trace completes, so no real cursor matches it.
+	FVector2D MousePosition = FVector2D(-1.0, -1.0);
+	FVector CameraLocation = FVector::ZeroVector;
+	FRotator CameraRotation = FRotator::ZeroRotator;
+	uint64 FrameNumber = 0;
+	bool bBlockingHit = false;
+};
+
+/**
+ * Per-controller cursor ground query service.
+ *
+ * Issues at most one asynchronous line trace per frame under the mouse cursor and serves every consumer
+ * (zoom anchor, debug spheres, selection, placement previews...) from the cached result. The trace is skipped
+ * while neither the mouse nor the camera has moved.
+ */
+UCLASS(ClassGroup = (Strategy), meta = (BlueprintSpawnableComponent))
+class MYPROJECT2_API UStrategyCursorQueryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UStrategyCursorQueryComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Returns the cached hit under the cursor. False if there is no blocking hit (or no trace has completed yet).
+	bool GetCursorHit(FHitResult& OutHit) const;
+
+	// The cached hit if it was traced from the current mouse position and camera view; otherwise traces synchronously
+	// now and caches the result. For consumers that must not act on a stale point (the zoom anchor at the start of a
+	// gesture); everything else should use GetCursorHit.
+	bool GetCurrentCursorHit(FHitResult& OutHit);
+
+	// The full cached result, including the mouse position and frame it was traced on.
+	const FStrategyCursorQueryResult& GetCachedResult() const { return CachedResult; }
+
+	// Mouse position used for the query: the viewport cursor, or the simulated one when set.
+	bool GetMousePosition(FVector2D& OutMousePosition) const;
+
+	// World-space ray under the cursor, deprojected now (no trace): the viewport cursor, or the simulated ray.
+	bool GetCursorRay(FVector& OutOrigin, FVector& OutDirection) const;
+
+	// Size of the viewport the mouse position is in: the game viewport, or the simulated one while a simulated cursor is set.
+	bool GetViewportSize(FIntPoint& OutViewportSize) const;
+
+	// Replaces the viewport cursor with a fixed screen position and world-space ray, for headless tools and input replay.
+	void SetSimulatedCursor(const FVector2D& ScreenPosition, const FVector& WorldOrigin, const FVector& WorldDirection);
+	void SetSimulatedViewportSize(const FIntPoint& ViewportSize) { SimulatedViewportSize = ViewportSize; }
+	// Simulated cursor at ScreenPosition in a viewport of ViewportSize, with the ray deprojected through the owner's current camera view.
+	void SetSimulatedScreenPosition(const FVector2D& ScreenPosition, const FIntPoint& ViewportSize);
+	void ClearSimulatedCursor() { bUseSimulatedCursor = false; }
+
+	// Forces a new trace on the next tick even if nothing moved (e.g. after the world under the cursor changed).
+	void Invalidate() { bForceTrace = true; }
+
+	uint64 GetNumTracesIssued() const { return NumTracesIssued; }
+	uint64 GetNumSyncTraces() const { return NumSyncTraces; }
+	uint64 GetNumQueriesServed() const { return NumQueriesServed; }
+
+protected:
+	// Collision channel used for the ground trace.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cursor")
+	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_Visibility;
+
+	// Re-trace at least this often (seconds) even if nothing moved, so moving objects under a still cursor are picked up. 0 disables.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cursor", meta = (ClampMin = "0.0"))
+	float MaxResultAge = 0.25f;
+
+	// Camera movement (cm / degrees) below which the cached result is still considered valid.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cursor", meta = (ClampMin = "0.0"))
+	float CameraMoveTolerance = 0.1f;
+
+private:
+	void OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Data);
+	bool HasViewChanged(const FVector2D& MousePosition, const FVector& CameraLocation, const FRotator& CameraRotation) const;
+
+	FStrategyCursorQueryResult CachedResult;
+	FTraceDelegate TraceDelegate;
+	FTraceHandle PendingTrace;
+	FVector2D PendingMousePosition = FVector2D::ZeroVector;
+	FVector PendingCameraLocation = FVector::ZeroVector;
+	FRotator PendingCameraRotation = FRotator::ZeroRotator;
+
+	// View state of the last issued trace.
+	FVector2D LastTracedMousePosition = FVector2D(-1.0, -1.0);
+	FVector LastTracedCameraLocation = FVector::ZeroVector;
+	FRotator LastTracedCameraRotation = FRotator::ZeroRotator;
+	float TimeSinceLastTrace = 0.f;
+	bool bForceTrace = true;
+
+	bool bUseSimulatedCursor = false;
+	FVector2D SimulatedScreenPosition = FVector2D::ZeroVector;
+	FVector SimulatedRayOrigin = FVector::ZeroVector;
+	FVector SimulatedRayDirection = -FVector::UpVector;
+	FIntPoint SimulatedViewportSize = FIntPoint(1920, 1080);
+
+	uint64 NumTracesIssued = 0;
+	uint64 NumSyncTraces = 0;
+	mutable uint64 NumQueriesServed = 0;
+};
@@ -0,0 +1,43 @@
+// StrategyCurveTable.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UCurveFloat;
+
+/**
+ * A UCurveFloat baked into a fixed-size table of evenly spaced samples over [MinTime, MaxTime].
+ * Lookups are a clamp, a multiply and a lerp between two adjacent floats; no key search or tangent evaluation.
+ */
+struct MYPROJECT2_API FStrategyCurveTable
+{
+public:
+	static constexpr int32 MaxSamples = 256;
+
+	// Samples Curve at NumSamples points (clamped to [2, MaxSamples]). Clears the table if Curve is null or the range is empty.
+	void Bake(const UCurveFloat* Curve, float InMinTime, float InMaxTime, int32 NumSamples);
+
+	void Reset();
+
+	bool IsBaked() const { return NumSamples >= 2; }
+
+	// Linear lookup; Time is clamped to the baked range.
+	float Evaluate(float Time) const
+	{
+		checkSlow(IsBaked());
+		const float Position = FMath::Clamp((Time - MinTime) * InvSampleSpacing, 0.f, float(NumSamples - 1));
+		const int32 Index = FMath::Min(int32(Position), NumSamples - 2);
+		return FMath::Lerp(Samples[Index], Samples[Index + 1], Position - float(Index));
+	}
+
+	float GetMinTime() const { return MinTime; }
+	float GetMaxTime() const { return MaxTime; }
+	int32 GetNumSamples() const { return NumSamples; }
+
+private:
+	float Samples[MaxSamples];
+	float MinTime = 0.f;
+	float MaxTime = 0.f;
+	float InvSampleSpacing = 0.f;
+	int32 NumSamples = 0;
+};
@@ -0,0 +1,159 @@
+// StrategyFlowFieldSubsystem.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "StrategyFlowFieldSubsystem.generated.h"
+
+// Cost of a cell in the flow-field grid. Blocked cells are never entered.
+namespace StrategyFlowField
+{
+	constexpr uint8 OpenCost = 1;
+	constexpr uint8 BlockedCost = 255;
+	// Direction index for cells with no way on (the destination itself, blocked or unreachable cells).
+	constexpr uint8 NoDirection = 255;
+}
+
+// Placement of the flow-field grid in the world (X/Y plane).
+struct FStrategyFlowFieldGrid
+{
+	FVector2D Origin = FVector2D(-25600.0, -25600.0);
+	double CellSize = 100.0;
+	int32 Width = 512;
+	int32 Height = 512;
+
+	int32 GetNumCells() const { return Width * Height; }
+	bool IsValidCell(const FIntPoint& Cell) const { return Cell.X >= 0 && Cell.Y >= 0 && Cell.X < Width && Cell.Y < Height; }
+	int32 GetCellIndex(const FIntPoint& Cell) const { return Cell.Y * Width + Cell.X; }
+	FIntPoint GetCell(const FVector& Location) const
+	{
+		return FIntPoint(FMath::FloorToInt32((Location.X - Origin.X) / CellSize), FMath::FloorToInt32((Location.Y - Origin.Y) / CellSize));
+	}
+};
+
+/**
+ * Integration and direction fields towards one destination cell over a snapshot of the cost grid.
+ * Immutable once built, so it is shared between the background build and every unit that samples it.
+ */
+struct MYPROJECT2_API FStrategyFlowField
+{
+	FStrategyFlowFieldGrid Grid;
+	FIntPoint DestinationCell = FIntPoint::ZeroValue;
+	FVector Destination = FVector::ZeroVector;
+
+	// Path cost to the destination per cell (10 per straight step, 14 per diagonal, scaled by cell cost); MAX_uint32 if unreachable.
+	TArray<uint32> Integration;
+	// Index into GetDirectionVector per cell, or StrategyFlowField::NoDirection.
+	TArray<uint8> Directions;
+
+	// Obstacle version of the cost grid the field was built from.
+	uint32 ObstacleVersion = 0;
+	double BuildMs = 0.0;
+
+	// Unit 2D direction to follow at Location, or zero outside the grid, at the destination or where there is no path.
+	FVector GetDirection(const FVector& Location) const
+	{
+		const FIntPoint Cell = Grid.GetCell(Location);
+		if (!Grid.IsValidCell(Cell))
+		{
+			return FVector::ZeroVector;
+		}
+		const uint8 Direction = Directions[Grid.GetCellIndex(Cell)];
+		return Direction != StrategyFlowField::NoDirection ? GetDirectionVector(Direction) : FVector::ZeroVector;
+	}
+
+	static const FIntPoint& GetDirectionOffset(uint8 Direction);
+	static const FVector& GetDirectionVector(uint8 Direction);
+
+	// Builds the field with Dijkstra over 8-connected cells; diagonals may not cut blocked corners.
+	static TSharedRef<const FStrategyFlowField, ESPMode::ThreadSafe> Build(const FStrategyFlowFieldGrid& Grid, const TArray<uint8>& Costs, const FVector& Destination, uint32 ObstacleVersion);
+};
+
+using FStrategyFlowFieldRef = TSharedPtr<const FStrategyFlowField, ESPMode::ThreadSafe>;
+
+/**
+ * Flow-field pathfinding for group move orders. One field is built per destination cell on a background task and
+ * shared by every unit ordered there, instead of one path query per unit.
+ *
+ * Obstacles are counted per cell, so overlapping blockers (buildings from UStrategyBuildingFootprintComponent) can be
+ * added and removed in any order. Fields are cached by destination cell and identified by an id that stays valid while
+ * cached. An obstacle change rebuilds, in the background, the cached fields whose region (destination and the ordered
+ * units, with a margin) it overlaps; units keep following the previous field until the new one is ready. Other fields
+ * are rebuilt when next requested.
+ */
+UCLASS()
+class MYPROJECT2_API UStrategyFlowFieldSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Replaces the grid (all cells open) and drops every cached field.
+	void Configure(const FStrategyFlowFieldGrid& InGrid);
+	const FStrategyFlowFieldGrid& GetGrid() const { return Grid; }
+
+	// Adds or removes one blocker over the cells overlapping Box (X/Y). A cell is blocked while any blocker covers it;
+	// every AddBlocker must be matched by a RemoveBlocker with the same box.
+	void AddBlocker(const FBox2D& Box);
+	void RemoveBlocker(const FBox2D& Box);
+	int32 GetNumBlockers(const FIntPoint& Cell) const { return Grid.IsValidCell(Cell) ? BlockerCounts[Grid.GetCellIndex(Cell)] : 0; }
+
+	// Returns the id of the field towards Destination, starting a background build if it isn't cached (or was built
+	// before the last obstacle change). UnitBounds (X/Y) are where the ordered units are, widening the field's region.
+	// INDEX_NONE if Destination is outside the grid.
+	int32 RequestFlowField(const FVector& Destination, const FBox2D& UnitBounds = FBox2D(ForceInit));
+
+	// The built field for an id, or null while it is still building (or if it was evicted).
+	FStrategyFlowFieldRef FindFlowField(int32 FlowFieldId) const;
+
+	// Counts moving units following a field (FStrategyUnitMoveTargetFragment::FlowFieldId). A field with users is never
+	// evicted. Unknown ids and INDEX_NONE are ignored.
+	void AddFlowFieldUsers(int32 FlowFieldId, int32 Delta);
+
+	// Picks up finished builds and collects every ready field by id. Call once per frame on the game thread.
+	void GatherReadyFlowFields(TMap<int32, FStrategyFlowFieldRef>& OutFields);
+
+	// Blocks until every pending build has finished. For benchmarks and tests.
+	void WaitForPendingBuilds();
+
+	uint32 GetObstacleVersion() const { return ObstacleVersion; }
+	int32 GetNumCachedFields() const { return Entries.Num(); }
+
+	// Fields kept in the cache; the least recently requested one without users is evicted beyond this. While every
+	// cached field has users, the cache grows past it instead.
+	static constexpr int32 MaxCachedFields = 32;
+
+private:
+	struct FEntry
+	{
+		int32 Id = INDEX_NONE;
+		FVector Destination = FVector::ZeroVector;
+		FStrategyFlowFieldRef Field;
+		UE::Tasks::TTask<FStrategyFlowFieldRef> PendingBuild;
+		double LastRequestTime = 0.0;
+		int32 NumUsers = 0;
+		// Destination and ordered units' bounds, with a margin; obstacle changes outside it don't rebuild the field.
+		FBox2D Region = FBox2D(ForceInit);
+		// ObstacleVersion the latest build started from.
+		uint32 LaunchedVersion = 0;
+	};
+
+	void UpdateBlockers(const FBox2D& Box, int32 Delta);
+	void LaunchBuild(FEntry& Entry);
+	void PollBuild(FEntry& Entry);
+	void EvictLeastRecentlyRequested();
+
+	FStrategyFlowFieldGrid Grid;
+	// Blockers covering each cell; Costs is derived from it.
+	TArray<uint16> BlockerCounts;
+	// Copy-on-write: builds in flight keep the snapshot they started with.
+	TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> Costs;
+	uint32 ObstacleVersion = 0;
+
+	TMap<FIntPoint, FEntry> Entries;
+	TMap<int32, FIntPoint> CellById;
+	int32 NextFlowFieldId = 0;
+};
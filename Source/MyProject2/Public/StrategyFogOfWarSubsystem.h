@@ -0,0 +1,163 @@
+// StrategyFogOfWarSubsystem.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyFogOfWarSubsystem.generated.h"
+
+class UTexture2D;
+
+// Stable reference to a vision source. Stale handles (source removed, slot reused) are detected by the serial.
+struct FStrategyVisionHandle
+{
+	int32 Id = INDEX_NONE;
+	uint32 Serial = 0;
+
+	bool IsSet() const { return Id != INDEX_NONE; }
+	bool operator==(const FStrategyVisionHandle& Other) const { return Id == Other.Id && Serial == Other.Serial; }
+};
+
+// Placement of the visibility grid in the world (X/Y plane). Width and height are rounded up to whole tiles.
+struct FStrategyFogOfWarGrid
+{
+	FVector2D Origin = FVector2D(-25600.0, -25600.0);
+	double CellSize = 100.0;
+	int32 Width = 512;
+	int32 Height = 512;
+
+	int32 GetNumCells() const { return Width * Height; }
+	bool IsValidCell(const FIntPoint& Cell) const { return Cell.X >= 0 && Cell.Y >= 0 && Cell.X < Width && Cell.Y < Height; }
+	FIntPoint GetCell(const FVector& Location) const
+	{
+		return FIntPoint(FMath::FloorToInt32((Location.X - Origin.X) / CellSize), FMath::FloorToInt32((Location.Y - Origin.Y) / CellSize));
+	}
+};
+
+/**
+ * Fog of war: which cells of a grid are currently seen by at least one vision source, and which were ever seen.
+ *
+ * Every cell counts the vision circles covering it; the visible and explored bits (one bit per cell, 64 cells per
+ * word) are derived from the counts. A source only re-stamps its circle (remove the old one, add the new one) when it
+ * crosses into another cell, so idle and slow units cost nothing. Stamps are applied once per frame in Tick, in
+ * parallel over 64x64-cell tiles: each tile owns its counts and its bit words, so workers never share memory.
+ *
+ * Queries read the grid as of the last update, i.e. up to a frame behind source movement.
+ */
+UCLASS()
+class MYPROJECT2_API UStrategyFogOfWarSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Cells per tile side; a tile row is one bit word.
+	static constexpr int32 TileSize = 64;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Replaces the grid and clears visibility and exploration. Meant for setup, before any source is added.
+	void Configure(const FStrategyFogOfWarGrid& InGrid);
+	const FStrategyFogOfWarGrid& GetGrid() const { return Grid; }
+
+	// --- Sources ---
+	// Radius in cm; cells whose centers are within it are seen.
+	FStrategyVisionHandle AddVisionSource(const FVector& Location, float Radius);
+	// Cheap when the source stays in its cell: only a crossing schedules a re-stamp.
+	void UpdateVisionSource(FStrategyVisionHandle Handle, const FVector& Location);
+	void RemoveVisionSource(FStrategyVisionHandle Handle);
+	void RemoveAllVisionSources();
+	int32 GetNumVisionSources() const { return SourceIds.Num(); }
+
+	// Applies the pending stamps now instead of waiting for Tick.
+	void FlushVisionUpdates();
+	// Clears the counts and stamps every source from scratch, touching every tile.
+	void RebuildVisibility();
+
+	// --- Queries ---
+	bool IsVisible(const FVector& Location) const { return IsCellVisible(Grid.GetCell(Location)); }
+	bool IsExplored(const FVector& Location) const { return IsCellExplored(Grid.GetCell(Location)); }
+	bool IsCellVisible(const FIntPoint& Cell) const { return Grid.IsValidCell(Cell) && TestBit(VisibleBits, Cell); }
+	bool IsCellExplored(const FIntPoint& Cell) const { return Grid.IsValidCell(Cell) && TestBit(ExploredBits, Cell); }
+
+	// Bit-packed rows: cell (X, Y) is bit X % 64 of word Y * GetWordsPerRow() + X / 64.
+	const TArray<uint64>& GetVisibleBits() const { return VisibleBits; }
+	const TArray<uint64>& GetExploredBits() const { return ExploredBits; }
+	int32 GetWordsPerRow() const { return Grid.Width / TileSize; }
+	int32 GetNumVisibleCells() const;
+
+	// One G8 texel per cell (255 visible, ExploredTexelValue explored, 0 unseen), updated per changed tile on the render
+	// thread. Created on first use; the grid is not mirrored into texels until then.
+	UTexture2D* GetVisibilityTexture();
+	static constexpr uint8 ExploredTexelValue = 96;
+
+	// Tiles re-derived by the last update, for benchmarks and stats.
+	int32 GetLastNumUpdatedTiles() const { return LastNumUpdatedTiles; }
+
+	// Bumped every time a tile's bits are re-derived, so other layers (the minimap) can tell which areas changed.
+	int32 GetNumTilesX() const { return TilesX; }
+	int32 GetNumTilesY() const { return TilesY; }
+	uint32 GetTileRevision(int32 TileX, int32 TileY) const { return TileRevisions[TileY * TilesX + TileX]; }
+
+private:
+	struct FStamp
+	{
+		FIntPoint Center;
+		int32 Radius;
+		int32 Delta;
+	};
+
+	bool TestBit(const TArray<uint64>& Bits, const FIntPoint& Cell) const
+	{
+		return (Bits[Cell.Y * GetWordsPerRow() + Cell.X / TileSize] >> (Cell.X % TileSize)) & 1;
+	}
+
+	int32 FindDenseIndex(FStrategyVisionHandle Handle) const;
+	int32 GetRadiusInCells(float Radius) const;
+	// Half-widths (cells) of the circle of Radius cells per row offset 0..Radius. Built on the game thread.
+	const TArray<int32>& GetCircleSpans(int32 Radius);
+	// Applies Stamps to the tiles they overlap (every tile if bAllTiles) and re-derives their bits and texels.
+	void ApplyStamps(bool bAllTiles);
+	void UpdateTexture(TConstArrayView<int32> Tiles);
+
+	FStrategyFogOfWarGrid Grid;
+	int32 TilesX = 0;
+	int32 TilesY = 0;
+
+	// Per cell: number of vision circles covering it.
+	TArray<uint16> VisionCounts;
+	TArray<uint64> VisibleBits;
+	TArray<uint64> ExploredBits;
+	// Mirrors the bits as texels once the texture exists.
+	TArray<uint8> Texels;
+
+	UPROPERTY()
+	TObjectPtr<UTexture2D> VisibilityTexture;
+
+	// --- Sources (dense, by dense index) ---
+	TArray<FIntPoint> SourceCells;
+	TArray<int32> SourceRadii;
+	// Where the source's circle is currently stamped; INDEX_NONE X if it isn't.
+	TArray<FIntPoint> SourceStampedCells;
+	TArray<int32> SourceIds;
+
+	// --- Handle table, by id ---
+	TArray<int32> DenseIndexById;
+	TArray<uint32> SerialById;
+	TArray<bool> DirtyById;
+	TArray<int32> FreeIds;
+
+	// Ids of the sources that changed cell since the last update, and circles of removed sources still to clear.
+	TArray<int32> DirtySourceIds;
+	TArray<FStamp> PendingRemovals;
+
+	TArray<TArray<int32>> CircleSpans;
+
+	// Scratch reused by every update.
+	TArray<FStamp> Stamps;
+	TArray<TArray<int32>> StampsByTile;
+	TArray<int32> UpdatedTiles;
+	int32 LastNumUpdatedTiles = 0;
+	TArray<uint32> TileRevisions;
+};
@@ -0,0 +1,72 @@
+// StrategyFormation.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StrategyFormation.generated.h"
+
+// Slot layout of a group move order.
+UENUM(BlueprintType)
+enum class EStrategyFormationShape : uint8
+{
+	// Shallow ranks, about four times as wide as deep.
+	Line,
+	// About as wide as deep.
+	Box,
+	// One slot at the point, each rank behind it two slots wider.
+	Wedge,
+};
+
+namespace StrategyFormation
+{
+	// NumSlots slot locations centered on Center, facing Yaw (degrees), Spacing (cm) apart. Front rank first; a rank
+	// that isn't full is centered.
+	MYPROJECT2_API void MakeSlots(EStrategyFormationShape Shape, int32 NumSlots, const FVector& Center, float Yaw, float Spacing, TArray<FVector>& OutSlots);
+
+	// Sum of the straight-line distances (cm) from each unit to its slot.
+	MYPROJECT2_API double GetTotalPathLength(TConstArrayView<FVector> Units, TConstArrayView<FVector> Slots, TConstArrayView<int32> SlotForUnit);
+
+	// The assignment with the least total path length (Hungarian method). O(n^3): a reference to measure
+	// FStrategyFormationSolver against, not for gameplay group sizes.
+	MYPROJECT2_API void SolveOptimal(TConstArrayView<FVector> Units, TConstArrayView<FVector> Slots, TArray<int32>& OutSlotForUnit);
+}
+
+/**
+ * Assigns units to formation slots, approximately minimizing the total path length without crossing paths.
+ *
+ * Units and slots are split together into buckets by recursive median bisection, each set relative to its own
+ * centroid: the units on the group's left get the slots on the formation's left, and so on, until buckets hold at most
+ * LeafSize units. Each bucket is then an independent assignment problem, solved exactly (to within a centimetre) by an
+ * epsilon-scaled auction on the task graph's workers. O(n log^2 n + n * LeafSize^2) instead of O(n^3).
+ */
+class MYPROJECT2_API FStrategyFormationSolver
+{
+public:
+	int32 LeafSize = 64;
+	bool bParallel = true;
+
+	// OutSlotForUnit[Unit] is the unit's slot. Units and Slots must have the same number of entries.
+	void Solve(TConstArrayView<FVector> Units, TConstArrayView<FVector> Slots, TArray<int32>& OutSlotForUnit);
+
+	int32 GetLastNumBuckets() const { return Buckets.Num(); }
+	double GetLastSolveMs() const { return LastSolveMs; }
+
+private:
+	struct FBucket
+	{
+		int32 Begin = 0;
+		int32 Num = 0;
+	};
+
+	// Assigns UnitOrder[Bucket] to SlotOrder[Bucket].
+	void SolveBucket(const FBucket& Bucket, TConstArrayView<FVector> Units, TConstArrayView<FVector> Slots, TArray<int32>& OutSlotForUnit) const;
+
+	// Unit and slot indices, grouped by bucket: bucket B pairs UnitOrder[B.Begin, B.Begin + B.Num) with the same range
+	// of SlotOrder.
+	TArray<int32> UnitOrder;
+	TArray<int32> SlotOrder;
+	// Positions relative to each set's centroid, which the bisection sorts by.
+	TArray<FVector2D> UnitPoints;
+	TArray<FVector2D> SlotPoints;
+	TArray<FBucket> Buckets;
+	double LastSolveMs = 0.0;
+};
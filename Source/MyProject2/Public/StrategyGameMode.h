@@ -6,8 +6,13 @@
 #include "GameFramework/GameModeBase.h"
 #include "StrategyGameMode.generated.h"
 
+class AStrategyCameraPawn;
+struct FStreamableHandle;
+
 /**
- * 
+ * Spawns and possesses the camera pawn for each new player itself, and starts loading the player controller's
+ * soft-referenced startup assets (see AStrategyPlayerController::GetStartupAssets) in InitGame, so they load while the
+ * map's initial World Partition cells stream in instead of after them.
  */
 UCLASS()
 class MYPROJECT2_API AStrategyGameMode : public AGameModeBase
@@ -16,5 +21,19 @@ class MYPROJECT2_API AStrategyGameMode : public AGameModeBase
 	
 public:
 	AStrategyGameMode();
-	
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
+
+	// FPlatformTime::Seconds() at InitGame, right after the map loaded. Startup phases are timed from here.
+	double GetStartupStartSeconds() const { return StartupStartSeconds; }
+
+protected:
+	// Spawned at the player start for each new player, unless the level has a camera pawn that possesses itself.
+	UPROPERTY(EditDefaultsOnly, Category = "Classes")
+	TSubclassOf<AStrategyCameraPawn> CameraPawnClass;
+
+private:
+	TSharedPtr<FStreamableHandle> StartupAssets;
+	double StartupStartSeconds = 0.0;
 };
@@ -0,0 +1,138 @@
+// StrategyInputRecording.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StrategyCameraSpring.h"
+#include <type_traits>
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+enum class EStrategyInputRecordType : uint8
+{
+	// Starts a frame: A = delta time, B/C = cursor position (Flags != 0 when the cursor was in the viewport).
+	Frame,
+	// A/B = axis value.
+	Move,
+	// A = axis value.
+	Zoom,
+	// Flags = pressed.
+	RotateTrigger,
+	// A/B = mouse delta.
+	RotateValue,
+	PanDragStarted,
+	PanDragCompleted,
+};
+
+// One fixed-size entry of a recording. A frame is its Frame record followed by the input events handled during it.
+struct FStrategyInputRecord
+{
+	EStrategyInputRecordType Type = EStrategyInputRecordType::Frame;
+	uint8 Flags = 0;
+	uint16 Reserved = 0;
+	float A = 0.f;
+	float B = 0.f;
+	float C = 0.f;
+};
+static_assert(sizeof(FStrategyInputRecord) == 16, "Recordings are read in place from the mapped file.");
+
+// Controller and camera state a replay starts from. Only taken at frame starts without an active zoom anchor.
+struct FStrategyInputSnapshot
+{
+	FStrategyCameraIntegrator CameraIntegrator;
+	FVector PawnLocation = FVector::ZeroVector;
+	FRotator PawnRotation = FRotator::ZeroRotator;
+	FRotator ControlRotation = FRotator::ZeroRotator;
+	FRotator BoomRotation = FRotator::ZeroRotator;
+	float BoomArmLength = 0.f;
+	FVector TargetPanLocation = FVector::ZeroVector;
+	float TargetZoomLength = 0.f;
+	FVector2D LastPanDragMousePosition = FVector2D::ZeroVector;
+	FVector2D FramePanDragPixels = FVector2D::ZeroVector;
+	FIntPoint ViewportSize = FIntPoint::ZeroValue;
+	bool bIsRotatingCamera = false;
+	bool bIsPanDragging = false;
+	bool bCameraConverging = false;
+};
+static_assert(std::is_trivially_copyable_v<FStrategyInputSnapshot>, "Snapshots are stored and saved bitwise.");
+
+/**
+ * Ring buffer of input records with periodic state snapshots. Memory is allocated once by Start; recording a frame or
+ * an event is a copy into it. The oldest records are overwritten when full, so Save keeps the most recent stretch of
+ * the session, starting at the oldest snapshot still covered.
+ *
+ * Files are this build's in-memory layout (header, snapshot, records), meant for replaying on the same build.
+ */
+class MYPROJECT2_API FStrategyInputRecorder
+{
+public:
+	static constexpr int32 MaxSnapshots = 16;
+
+	void Start(int32 InMaxRecords, int32 InSnapshotIntervalFrames);
+	void Stop();
+	bool IsRecording() const { return bRecording; }
+
+	// True if FrameNumber has already been opened with BeginFrame.
+	bool IsFrameOpen(uint64 FrameNumber) const { return bHasOpenFrame && OpenFrameNumber == FrameNumber; }
+	// True once SnapshotIntervalFrames frames have passed since the last snapshot.
+	bool WantsSnapshot() const { return FramesSinceSnapshot >= SnapshotIntervalFrames; }
+	// Stores State as the state at the start of the next frame; call right before BeginFrame.
+	void AddSnapshot(const FStrategyInputSnapshot& State);
+	void BeginFrame(uint64 FrameNumber, float DeltaTime, bool bHasCursor, const FVector2D& CursorPosition);
+	void Record(EStrategyInputRecordType Type, float A = 0.f, float B = 0.f, float C = 0.f, uint8 Flags = 0);
+
+	bool Save(const FString& Filename) const;
+
+	int32 GetNumRecords() const { return int32(FMath::Min<uint64>(NextSequence, uint64(Records.Num()))); }
+
+private:
+	struct FSnapshotEntry
+	{
+		uint64 Sequence = 0;
+		FStrategyInputSnapshot State;
+		bool bValid = false;
+	};
+
+	TArray<FStrategyInputRecord> Records;
+	TArray<FSnapshotEntry> Snapshots;
+	// Total records written; the record with sequence S lives at S % Records.Num().
+	uint64 NextSequence = 0;
+	int32 NextSnapshot = 0;
+	int32 SnapshotIntervalFrames = 600;
+	int32 FramesSinceSnapshot = 0;
+	uint64 OpenFrameNumber = 0;
+	bool bHasOpenFrame = false;
+	bool bRecording = false;
+};
+
+// Reads a recording through a memory-mapped view of the file and hands it out one frame at a time.
+class MYPROJECT2_API FStrategyInputPlayer
+{
+public:
+	FStrategyInputPlayer();
+	~FStrategyInputPlayer();
+
+	bool Open(const FString& Filename);
+	void Close();
+	bool IsOpen() const { return MappedRegion.IsValid(); }
+
+	const FStrategyInputSnapshot& GetSnapshot() const { return Snapshot; }
+
+	// The next frame's Frame record and the events handled during it. False at the end of the recording.
+	bool NextFrame(const FStrategyInputRecord*& OutFrame, TConstArrayView<FStrategyInputRecord>& OutEvents);
+	// Delta time of the frame NextFrame returns next, or 0 at the end.
+	float PeekDeltaTime() const;
+	void Rewind() { ReadIndex = 0; }
+
+	int32 GetNumRecords() const { return Records.Num(); }
+	int32 GetNumFrames() const { return NumFrames; }
+	bool IsAtStart() const { return ReadIndex == 0; }
+
+private:
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TConstArrayView<FStrategyInputRecord> Records;
+	FStrategyInputSnapshot Snapshot;
+	int32 ReadIndex = 0;
+	int32 NumFrames = 0;
+};
@@ -0,0 +1,232 @@
+// StrategyLockstep.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Fixed-point world coordinates for the lockstep simulation: 1/256 cm per unit in an int32 (about +-83 km).
+namespace StrategyFixed
+{
+	constexpr int32 FractionBits = 8;
+	constexpr int32 One = 1 << FractionBits;
+
+	inline int32 FromCm(double Cm) { return int32(FMath::RoundToInt64(Cm * One)); }
+	inline double ToCm(int32 Fixed) { return double(Fixed) / One; }
+	inline FIntPoint FromLocation(const FVector& Location) { return FIntPoint(FromCm(Location.X), FromCm(Location.Y)); }
+	inline FVector ToLocation(const FIntPoint& Fixed) { return FVector(ToCm(Fixed.X), ToCm(Fixed.Y), 0.0); }
+
+	// Floor of the square root, in integer operations only so every machine gets the same bits.
+	MYPROJECT2_API uint32 Sqrt(uint64 Value);
+}
+
+enum class EStrategyLockstepCommandType : uint8
+{
+	// Replaces the player's selection with Units.
+	Select,
+	// Orders the player's selection to Target, on a square grid with Spacing between slots.
+	Move,
+};
+
+// One player command. Move acts on the selection the player last sent, so its size doesn't grow with the selection.
+struct FStrategyLockstepCommand
+{
+	EStrategyLockstepCommandType Type = EStrategyLockstepCommandType::Move;
+	uint8 Player = 0;
+	// Fixed point.
+	FIntPoint Target = FIntPoint::ZeroValue;
+	int32 Spacing = 0;
+	// Lockstep unit ids, ascending.
+	TArray<int32> Units;
+};
+
+/**
+ * Every player's commands for one turn, as sent over the wire. Also carries the sender's state checksum of an earlier
+ * turn, so peers detect a desync within a few turns of it.
+ *
+ * Encoding: varint turn, player byte, varint turn distance back to the checksummed turn, 4-byte checksum, varint
+ * command count, then per command a type byte and its payload (Select: varint count and varint deltas between the
+ * sorted ids; Move: zigzag varint target X/Y and varint spacing).
+ */
+struct MYPROJECT2_API FStrategyLockstepPacket
+{
+	uint32 Turn = 0;
+	uint8 Player = 0;
+	// MAX_uint32 while the sender has not executed a turn yet.
+	uint32 ChecksumTurn = MAX_uint32;
+	uint32 Checksum = 0;
+	TArray<FStrategyLockstepCommand> Commands;
+
+	void Serialize(TArray<uint8>& OutBytes) const;
+	bool Deserialize(TConstArrayView<uint8> Bytes);
+};
+
+/**
+ * Deterministic unit simulation for lockstep: unit positions and move targets in fixed point, advanced by integer
+ * math at a fixed tick, so peers that apply the same commands in the same order stay bit-identical.
+ */
+class MYPROJECT2_API FStrategyLockstepSim
+{
+public:
+	// Replaces all units; every peer must start from the same list.
+	void Reset(TConstArrayView<FVector> Locations, int32 NumPlayers, float UnitSpeed, float TickRate);
+
+	void ApplyCommand(const FStrategyLockstepCommand& Command);
+	void Tick();
+
+	// CRC of the tick count and every unit's position, target and moving flag.
+	uint32 ComputeChecksum() const;
+
+	int32 GetNumUnits() const { return Positions.Num(); }
+	FVector GetUnitLocation(int32 Unit) const { return StrategyFixed::ToLocation(Positions[Unit]); }
+	const TArray<int32>& GetSelection(uint8 Player) const { return Selections[Player]; }
+	uint64 GetNumTicks() const { return NumTicks; }
+
+	// Moves a unit off its deterministic path, for desync tests.
+	void DebugNudgeUnit(int32 Unit) { Positions[Unit].X += StrategyFixed::One; }
+
+private:
+	TArray<FIntPoint> Positions;
+	TArray<FIntPoint> Targets;
+	TArray<bool> Moving;
+	// Ids of the moving units, ascending, so idle units cost nothing per tick.
+	TArray<int32> MovingUnits;
+	TArray<TArray<int32>> Selections;
+	// Fixed-point distance per tick.
+	int32 StepPerTick = 0;
+	uint64 NumTicks = 0;
+};
+
+// Delivers encoded turn packets between players. Time is passed in, so tests can run on a virtual clock.
+class IStrategyLockstepTransport
+{
+public:
+	virtual ~IStrategyLockstepTransport() = default;
+
+	// Sends to every other player.
+	virtual void Send(uint8 FromPlayer, TConstArrayView<uint8> Bytes, double Now) = 0;
+	// Pops the next packet for Player that has arrived by Now.
+	virtual bool Receive(uint8 Player, double Now, TArray<uint8>& OutBytes) = 0;
+};
+
+// In-process transport for several peers in one process, with a fixed one-way latency.
+class MYPROJECT2_API FStrategyLockstepLoopback : public IStrategyLockstepTransport
+{
+public:
+	FStrategyLockstepLoopback(int32 NumPlayers, double InLatency);
+
+	virtual void Send(uint8 FromPlayer, TConstArrayView<uint8> Bytes, double Now) override;
+	virtual bool Receive(uint8 Player, double Now, TArray<uint8>& OutBytes) override;
+
+private:
+	struct FInFlight
+	{
+		double DeliverAt = 0.0;
+		TArray<uint8> Bytes;
+	};
+
+	// Per receiving player, in send order (and so delivery order: the latency is fixed).
+	TArray<TArray<FInFlight>> Queues;
+	double Latency = 0.0;
+};
+
+struct FStrategyLockstepSettings
+{
+	int32 NumPlayers = 2;
+	uint8 LocalPlayer = 0;
+	// Length of a turn; commands issued during one are sent together at its end.
+	float TurnSeconds = 0.1f;
+	// Turns between sending a player's commands and executing them, to hide the latency between peers.
+	int32 InputDelayTurns = 2;
+	int32 SimTicksPerTurn = 3;
+	// Unit speed, cm/s.
+	float UnitSpeed = 600.f;
+};
+
+// Send and execution statistics of one peer.
+struct FStrategyLockstepMetrics
+{
+	uint64 TurnsExecuted = 0;
+	uint64 PacketsSent = 0;
+	uint64 BytesSent = 0;
+	uint64 CommandsSent = 0;
+	int32 LastPacketBytes = 0;
+	int32 MaxPacketBytes = 0;
+	// Updates that had a turn due but were missing a peer's packet for it.
+	uint64 StalledUpdates = 0;
+	// Seconds from issuing a command to executing it, for the most recent commands.
+	TArray<double> CommandLatencies;
+};
+
+/**
+ * One player's end of a lockstep session: queues local commands, sends them as one packet per turn, and executes turn
+ * T on its simulation once every player's packet for T has arrived, in player order. Compares the checksums peers send
+ * with its own and reports the first turn that differs.
+ */
+class MYPROJECT2_API FStrategyLockstepPeer
+{
+public:
+	static constexpr int32 MaxLatencySamples = 1024;
+	// Players are tracked as bits of a turn's received mask.
+	static constexpr int32 MaxPlayers = 32;
+
+	void Start(const FStrategyLockstepSettings& InSettings, TConstArrayView<FVector> UnitLocations, double Now);
+
+	// Sends with the packet of the current turn.
+	void QueueCommand(FStrategyLockstepCommand Command, double Now);
+
+	// Receives, sends the turns that have ended by Now, and executes every turn whose packets are all in.
+	void Update(double Now, IStrategyLockstepTransport& Transport);
+
+	// Called for every command as it executes, after the simulation has applied it.
+	TFunction<void(const FStrategyLockstepCommand&)> OnCommandExecuted;
+
+	const FStrategyLockstepSim& GetSim() const { return Sim; }
+	FStrategyLockstepSim& GetMutableSim() { return Sim; }
+	const FStrategyLockstepSettings& GetSettings() const { return Settings; }
+	const FStrategyLockstepMetrics& GetMetrics() const { return Metrics; }
+	uint32 GetNextTurn() const { return NextTurn; }
+	// State checksum after Turn, if it was executed recently enough to still be kept.
+	bool GetTurnChecksum(uint32 Turn, uint32& OutChecksum) const;
+
+	bool IsDesynced() const { return DesyncTurn != MAX_uint32; }
+	uint32 GetDesyncTurn() const { return DesyncTurn; }
+
+private:
+	// Checksums kept for comparing against peers; covers any delay a session could have between them.
+	static constexpr int32 ChecksumHistory = 256;
+
+	struct FTurnSlot
+	{
+		TArray<FStrategyLockstepPacket> Packets;
+		// Bit per player whose packet is in.
+		uint32 ReceivedMask = 0;
+	};
+
+	FTurnSlot& GetSlot(uint32 Turn);
+	void ReceivePacket(FStrategyLockstepPacket&& Packet);
+	void CheckRemoteChecksum(uint8 Player, uint32 Turn, uint32 Checksum);
+	void SendTurn(uint32 Turn, double Now, IStrategyLockstepTransport& Transport);
+	bool TryExecuteTurn(double Now);
+
+	FStrategyLockstepSettings Settings;
+	FStrategyLockstepSim Sim;
+	double StartTime = 0.0;
+
+	// Next turn to send local commands for, and next turn to execute.
+	uint32 NextSendTurn = 0;
+	uint32 NextTurn = 0;
+
+	// Local commands of the current turn and when they were issued.
+	TArray<FStrategyLockstepCommand> PendingCommands;
+	TArray<double> PendingCommandTimes;
+	// Issue times of the commands in each sent-but-not-executed local packet.
+	TMap<uint32, TArray<double>> SentIssueTimes;
+
+	TMap<uint32, FTurnSlot> Slots;
+	TArray<uint32> ChecksumsByTurn;
+	// Remote checksums of turns this peer had not executed yet when they arrived.
+	TArray<TTuple<uint8, uint32, uint32>> DeferredChecksums;
+	uint32 DesyncTurn = MAX_uint32;
+
+	TArray<uint8> ScratchBytes;
+	FStrategyLockstepMetrics Metrics;
+};
@@ -0,0 +1,61 @@
+// StrategyLockstepSubsystem.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyLockstep.h"
+#include "StrategyUnitRegistrySubsystem.h"
+#include "StrategyLockstepSubsystem.generated.h"
+
+class UStrategyUnitSimulationSubsystem;
+
+/**
+ * Runs the local player's FStrategyLockstepPeer in a world. While a session is active the controller's orders go out as
+ * lockstep commands instead of straight to the unit simulation; the units are spawned from the session's shared list,
+ * and each executed move order is handed to UStrategyUnitSimulationSubsystem, whose Mass units present the move.
+ *
+ * The fixed-point FStrategyLockstepSim is the state peers agree on (and checksum); the Mass units only present it.
+ */
+UCLASS()
+class MYPROJECT2_API UStrategyLockstepSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Spawns one unit per location (every peer must pass the same list) and starts exchanging turns over Transport.
+	void StartSession(const FStrategyLockstepSettings& Settings, TSharedRef<IStrategyLockstepTransport> Transport, TConstArrayView<FVector> UnitLocations);
+	// Stops the session and destroys the units it spawned.
+	void EndSession();
+	bool IsSessionActive() const { return Transport.IsValid(); }
+
+	// Sends the selection (only when it changed since the last order) and a move order. Returns the number of session
+	// units among Units.
+	int32 IssueMoveOrder(TConstArrayView<FStrategyUnitHandle> Units, const FVector& Destination, float Spacing);
+
+	const FStrategyLockstepPeer& GetPeer() const { return Peer; }
+	// Registry handle of a session unit, by lockstep id.
+	FStrategyUnitHandle GetUnitHandle(int32 Unit) const { return UnitHandles.IsValidIndex(Unit) ? UnitHandles[Unit] : FStrategyUnitHandle(); }
+
+private:
+	void PresentCommand(const FStrategyLockstepCommand& Command);
+
+	UPROPERTY()
+	TObjectPtr<UStrategyUnitSimulationSubsystem> Simulation;
+
+	FStrategyLockstepPeer Peer;
+	TSharedPtr<IStrategyLockstepTransport> Transport;
+
+	// Lockstep id -> registry handle, and back.
+	TArray<FStrategyUnitHandle> UnitHandles;
+	TMap<FStrategyUnitHandle, int32> UnitIds;
+
+	// Selection last sent, to skip resending it with every order.
+	TArray<int32> SentSelection;
+	TArray<int32> ScratchSelection;
+	TArray<FStrategyUnitHandle> ScratchHandles;
+};
@@ -0,0 +1,140 @@
+// StrategyMinimapSubsystem.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyMinimapSubsystem.generated.h"
+
+class UTexture2D;
+class ULevel;
+class UStrategyUnitRegistrySubsystem;
+class UStrategyFogOfWarSubsystem;
+
+// World area shown by the minimap and its layers' look.
+struct FStrategyMinimapSettings
+{
+	// X/Y world rectangle covered by the map; matches the default fog-of-war grid.
+	FVector2D WorldMin = FVector2D(-25600.0, -25600.0);
+	FVector2D WorldMax = FVector2D(25600.0, 25600.0);
+	// Square map, in pixels. Rounded up to whole blocks.
+	int32 Resolution = 256;
+	// Side (pixels) of the blocks the map is recomposed and uploaded in.
+	int32 BlockSize = 32;
+
+	// Terrain base colors by the top height of the geometry under a pixel.
+	float LowHeight = 0.f;
+	float HighHeight = 3000.f;
+	FColor LowColor = FColor(44, 62, 38);
+	FColor HighColor = FColor(168, 156, 120);
+	FColor EmptyColor = FColor(12, 14, 18);
+
+	FColor UnitColor = FColor(90, 220, 255);
+	FColor FootprintColor = FColor::White;
+
+	// Brightness of explored-but-not-visible and never-seen pixels when fog of war is applied.
+	float ExploredBrightness = 0.55f;
+	float UnexploredBrightness = 0.15f;
+	bool bApplyFogOfWar = true;
+};
+
+/**
+ * Minimap drawn on the CPU instead of with a second scene capture.
+ *
+ * The terrain base is rasterized once from the top of every visibility-blocking primitive's bounds, and again when
+ * levels (World Partition cells) stream in or out. Each frame the units, the fog of war and the camera's ground
+ * footprint are checked per block; only blocks whose contents changed are recomposed (base, fog, units, footprint)
+ * and uploaded to the texture.
+ *
+ * Nothing is drawn until GetMinimapTexture is first called.
+ */
+UCLASS()
+class MYPROJECT2_API UStrategyMinimapSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void Configure(const FStrategyMinimapSettings& InSettings);
+	const FStrategyMinimapSettings& GetSettings() const { return Settings; }
+
+	// BGRA8 texture of Resolution x Resolution pixels; created on first use, after which the minimap updates every tick.
+	UFUNCTION(BlueprintCallable, Category = "Minimap")
+	UTexture2D* GetMinimapTexture();
+
+	// Recomposes the dirty blocks and uploads them; called by Tick, and directly by benchmarks.
+	void UpdateMinimap();
+	// Re-rasterizes the terrain base and recomposes every block on the next update.
+	void InvalidateBase() { bBaseDirty = true; }
+	// Recomposes every block on the next update, e.g. to check the incremental result.
+	void RedrawAll() { bRedrawAll = true; }
+
+	// Minimap UV (0..1, V down = +Y) to world X/Y and back. Z is 0.
+	FVector MinimapToWorld(const FVector2D& UV) const;
+	FVector2D WorldToMinimap(const FVector& Location) const;
+
+	// The composited pixels, row by row.
+	const TArray<FColor>& GetPixels() const { return Pixels; }
+	int32 GetResolution() const { return Resolution; }
+
+	double GetLastUpdateMs() const { return LastUpdateMs; }
+	int32 GetLastNumDirtyBlocks() const { return LastNumDirtyBlocks; }
+
+private:
+	void OnLevelChanged(ULevel* Level, UWorld* World);
+
+	void RasterizeBase();
+	// Each Gather* pass marks the blocks whose layer content differs from when they were last composed.
+	// Units: bins this frame's unit pixels by block and compares a hash of each block's set with last frame's.
+	void GatherUnits();
+	void GatherFogOfWar();
+	void GatherFootprint();
+	void ComposeBlock(int32 Block);
+	void UploadBlocks(TConstArrayView<int32> Blocks);
+
+	FIntPoint WorldToPixel(double X, double Y) const;
+	void MarkBlocksDirty(const FIntPoint& PixelMin, const FIntPoint& PixelMax);
+
+	FStrategyMinimapSettings Settings;
+	int32 Resolution = 0;
+	int32 BlocksPerSide = 0;
+	FVector2D PixelsPerCm = FVector2D::ZeroVector;
+
+	UPROPERTY()
+	TObjectPtr<UTexture2D> MinimapTexture;
+
+	UPROPERTY()
+	TObjectPtr<UStrategyUnitRegistrySubsystem> Registry;
+
+	UPROPERTY()
+	TObjectPtr<UStrategyFogOfWarSubsystem> FogOfWar;
+
+	TArray<FColor> BasePixels;
+	TArray<FColor> Pixels;
+
+	// --- Per block ---
+	TArray<bool> DirtyBlocks;
+	// Unit pixel indices inside each block this frame, and a hash of them to compare against last frame's.
+	TArray<TArray<int32>> BlockUnitPixels;
+	TArray<uint32> BlockUnitHashes;
+	// Sum of the revisions of the fog tiles under each block when it was last composed.
+	TArray<uint32> BlockFogRevisions;
+	// Footprint outline pixels inside each block.
+	TArray<TArray<int32>> BlockFootprintPixels;
+
+	FIntPoint FootprintCorners[4];
+	bool bHasFootprint = false;
+
+	bool bBaseDirty = true;
+	bool bRedrawAll = true;
+
+	TArray<int32> ScratchBlocks;
+	double LastUpdateMs = 0.0;
+	int32 LastNumDirtyBlocks = 0;
+
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+};
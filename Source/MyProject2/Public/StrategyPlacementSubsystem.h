@@ -0,0 +1,122 @@
+// StrategyPlacementSubsystem.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyPlacementSubsystem.generated.h"
+
+// Stable reference to a placed footprint. Stale handles (footprint removed, slot reused) are detected by the serial.
+struct FStrategyPlacementHandle
+{
+	int32 Id = INDEX_NONE;
+	uint32 Serial = 0;
+
+	bool IsSet() const { return Id != INDEX_NONE; }
+	bool operator==(const FStrategyPlacementHandle& Other) const { return Id == Other.Id && Serial == Other.Serial; }
+};
+
+// Placement of the building grid in the world (X/Y plane). Width is rounded up to whole 64-cell words.
+struct FStrategyPlacementGrid
+{
+	FVector2D Origin = FVector2D(-25600.0, -25600.0);
+	double CellSize = 50.0;
+	int32 Width = 1024;
+	int32 Height = 1024;
+
+	bool IsValidCell(const FIntPoint& Cell) const { return Cell.X >= 0 && Cell.Y >= 0 && Cell.X < Width && Cell.Y < Height; }
+	FIntPoint GetCell(const FVector& Location) const
+	{
+		return FIntPoint(FMath::FloorToInt32((Location.X - Origin.X) / CellSize), FMath::FloorToInt32((Location.Y - Origin.Y) / CellSize));
+	}
+};
+
+// Cells a building covers, as one bit mask per row (bit X of Rows[Y]), so a row is tested against the grid in one or
+// two word operations. Up to 64 cells on a side.
+struct MYPROJECT2_API FStrategyPlacementFootprint
+{
+	static constexpr int32 MaxSize = 64;
+
+	TArray<uint64, TInlineAllocator<16>> Rows;
+	int32 Width = 0;
+	int32 Height = 0;
+
+	static FStrategyPlacementFootprint MakeRectangle(int32 InWidth, int32 InHeight);
+	// The footprint turned by QuarterTurns * 90 degrees of yaw (+X towards +Y), like an actor with that yaw.
+	FStrategyPlacementFootprint Rotated(int32 QuarterTurns) const;
+	bool IsCellSet(int32 X, int32 Y) const { return (Rows[Y] >> X) & 1; }
+	int32 GetNumCells() const;
+};
+
+/**
+ * Occupancy and buildability of a building grid, as bit-packed rows, so placement previews validate without physics
+ * queries. Placed footprints are stamped in and out as buildings spawn and despawn (see
+ * UStrategyBuildingFootprintComponent); a per-cell count keeps overlapping footprints right when one is removed.
+ *
+ * CanPlace shifts each footprint row into the one or two grid words it spans and tests it against the blocked bits
+ * (occupied, or not buildable): a 6x6 building costs a dozen word operations wherever it is on the map.
+ */
+UCLASS()
+class MYPROJECT2_API UStrategyPlacementSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Replaces the grid, making every cell buildable and unoccupied. Meant for setup, before any footprint is added.
+	void Configure(const FStrategyPlacementGrid& InGrid);
+	const FStrategyPlacementGrid& GetGrid() const { return Grid; }
+
+	// Min-corner cell that centers Footprint on Location, and the world center of a footprint placed there.
+	FIntPoint GetFootprintMinCell(const FVector& Location, const FStrategyPlacementFootprint& Footprint) const;
+	FVector GetFootprintCenter(const FIntPoint& MinCell, const FStrategyPlacementFootprint& Footprint) const;
+
+	// True if every cell of Footprint at MinCell is on the grid, buildable and unoccupied.
+	bool CanPlace(const FStrategyPlacementFootprint& Footprint, const FIntPoint& MinCell) const;
+
+	// --- Footprints ---
+	// Marks the cells occupied; does not check CanPlace.
+	FStrategyPlacementHandle AddFootprint(const FStrategyPlacementFootprint& Footprint, const FIntPoint& MinCell);
+	void RemoveFootprint(FStrategyPlacementHandle Handle);
+	int32 GetNumFootprints() const { return NumFootprints; }
+
+	// Marks a rectangle of cells (inclusive) buildable or not, e.g. cliffs, water or the map border.
+	void SetBuildable(const FIntPoint& MinCell, const FIntPoint& MaxCell, bool bBuildable);
+
+	bool IsCellOccupied(const FIntPoint& Cell) const { return Grid.IsValidCell(Cell) && TestBit(OccupiedBits, Cell); }
+	bool IsCellBuildable(const FIntPoint& Cell) const { return Grid.IsValidCell(Cell) && TestBit(BuildableBits, Cell); }
+
+	// Bumped by every change to the grid, so previews only re-validate when something changed.
+	uint32 GetRevision() const { return Revision; }
+
+private:
+	bool TestBit(const TArray<uint64>& Bits, const FIntPoint& Cell) const
+	{
+		return (Bits[Cell.Y * WordsPerRow + Cell.X / 64] >> (Cell.X % 64)) & 1;
+	}
+
+	// Applies +1/-1 to the counts under the footprint and re-derives the touched words.
+	void StampFootprint(const FStrategyPlacementFootprint& Footprint, const FIntPoint& MinCell, int32 Delta);
+	void UpdateBlockedWord(int32 Word) { BlockedBits[Word] = OccupiedBits[Word] | ~BuildableBits[Word]; }
+
+	FStrategyPlacementGrid Grid;
+	int32 WordsPerRow = 0;
+
+	// Per cell: number of footprints covering it.
+	TArray<uint16> OccupancyCounts;
+	TArray<uint64> OccupiedBits;
+	TArray<uint64> BuildableBits;
+	// OccupiedBits | ~BuildableBits, the only bits CanPlace reads.
+	TArray<uint64> BlockedBits;
+
+	// --- Footprints, by id ---
+	TArray<FStrategyPlacementFootprint> Footprints;
+	TArray<FIntPoint> FootprintCells;
+	TArray<uint32> SerialById;
+	TArray<bool> UsedById;
+	TArray<int32> FreeIds;
+	int32 NumFootprints = 0;
+
+	uint32 Revision = 0;
+};
@@ -5,13 +5,108 @@
 #include "GameFramework/PlayerController.h"
 #include "InputActionValue.h"
 #include "TimerManager.h"
-#include "DrawDebugHelpers.h"
+#include "StrategyZoomAnchor.h"
+#include "StrategyCurveTable.h"
+#include "StrategyZoomTiers.h"
+#include "StrategyCameraSpring.h"
+#include "StrategyInputRecording.h"
+#include "StrategyUnitRegistrySubsystem.h"
+#include "StrategyPlacementSubsystem.h"
+#include "StrategyFormation.h"
 #include "StrategyPlayerController.generated.h"
 
 class UInputMappingContext;
 class UInputAction;
 class UCurveFloat;
+class UStaticMesh;
 class AStrategyCameraPawn; // Forward declare our new pawn
+class UStrategyCursorQueryComponent;
+class UStrategyTerrainHeightSubsystem;
+class AStrategyPlayerController;
+struct FStreamableHandle;
+
+// Camera update tick, separate from the controller's actor tick (which must keep running to process input).
+// Only enabled while the camera is converging; see AStrategyPlayerController::WakeCameraUpdate.
+USTRUCT()
+struct FStrategyCameraTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	AStrategyPlayerController* Target = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+	virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FStrategyCameraTickFunction> : public TStructOpsTypeTraitsBase2<FStrategyCameraTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+enum class EStrategyCameraSettleState : uint8
+{
+	// Zoom, pitch and movement are at rest; the camera tick is disabled.
+	Settled,
+	// Something is still interpolating; the camera tick runs every frame.
+	Converging,
+};
+
+// A saved camera position to jump back to.
+USTRUCT(BlueprintType)
+struct FStrategyCameraBookmark
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Bookmark")
+	FVector Location = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Bookmark")
+	float Yaw = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Bookmark")
+	float ZoomLength = 1500.f;
+
+	// Loaded before a jump here completes, e.g. the meshes and materials of the base at this spot.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Bookmark")
+	TArray<FSoftObjectPath> PrefetchAssets;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Bookmark")
+	bool bIsSet = false;
+};
+
+// Timings of the last bookmark jump, in milliseconds from the request.
+struct FStrategyCameraJumpMetrics
+{
+	// Until the destination's streaming cells were activated, its assets loaded and its ground heights sampled.
+	double PrefetchMs = 0.0;
+	// Until the first frame with the camera settled at the destination and its view fully streamed.
+	double StableMs = 0.0;
+	int32 StableFrames = 0;
+	// The prefetch gave up after JumpPrefetchTimeout instead of completing.
+	bool bPrefetchTimedOut = false;
+	bool bCut = false;
+};
+
+// Startup phases, in milliseconds from the map load (AStrategyGameMode::InitGame); negative until reached.
+struct FStrategyStartupMetrics
+{
+	double PawnPossessedMs = -1.0;
+	// The soft-referenced input and curve assets finished their async load.
+	double AssetsLoadedMs = -1.0;
+	// The World Partition cells under the first view were activated.
+	double WorldStreamedMs = -1.0;
+	// Mapping context added and actions bound: the first frame input can be processed.
+	double InputReadyMs = -1.0;
+	double FirstInputMs = -1.0;
+	uint64 FirstInputFrame = 0;
+
+	bool IsInputReady() const { return InputReadyMs >= 0.0; }
+};
 
 UCLASS()
 class MYPROJECT2_API AStrategyPlayerController : public APlayerController
@@ -21,27 +116,155 @@ class MYPROJECT2_API AStrategyPlayerController : public APlayerController
 public:
 	AStrategyPlayerController();
 
+	// Shared cursor-under-ground query. Features that need the ground under the mouse should read it from here instead of tracing.
+	UStrategyCursorQueryComponent* GetCursorQuery() const { return CursorQuery; }
+
+	// Re-enables the camera tick (and the pawn's movement tick) until zoom, pitch and movement have converged again.
+	// Anything that changes a camera target must call this.
+	void WakeCameraUpdate();
+
+	EStrategyCameraSettleState GetCameraSettleState() const { return CameraSettleState; }
+	uint64 GetNumCameraUpdateTicks() const { return NumCameraUpdateTicks; }
+	// Times the possessed pawn's root component actually moved, from any source (camera update, minimap or bookmark
+	// cuts); the camera keeps it to at most once per frame.
+	uint64 GetNumPawnMoves() const { return NumPawnMoves; }
+
+	// --- Selection ---
+	// Selects the registered units inside the screen rectangle (viewport pixels), replacing the selection unless bAddToSelection.
+	// A rectangle smaller than MarqueeClickRadius selects around its center instead. Returns the number of units selected.
+	int32 SelectUnitsInMarquee(const FVector2D& ScreenStart, const FVector2D& ScreenEnd, bool bAddToSelection = false);
+	const TArray<FStrategyUnitHandle>& GetSelectedUnits() const { return SelectedUnits; }
+	void ClearSelection() { SelectedUnits.Reset(); }
+
+	// Orders the selected simulated units into a MoveOrderFormation at Destination, or, while a lockstep session is
+	// active, as a lockstep command (on the lockstep simulation's square grid). Returns the number of units ordered.
+	int32 IssueMoveOrder(const FVector& Destination);
+
+	// --- Camera jumps ---
+	// Cuts the camera to Location (X/Y) instead of panning across the map. Zoom and rotation carry on as they were.
+	void JumpCameraTo(const FVector& Location);
+	// Jumps to the world point under a click on the minimap texture (UV 0..1), for the minimap widget.
+	UFUNCTION(BlueprintCallable, Category = "Minimap")
+	bool JumpCameraToMinimap(FVector2D MinimapUV);
+
+	// --- Camera bookmarks ---
+	// Slots 0-9, one per number key.
+	static constexpr int32 NumCameraBookmarkSlots = 10;
+
+	// Stores where the camera is heading (pan target, yaw and zoom target) in a slot, keeping the slot's prefetch assets.
+	UFUNCTION(BlueprintCallable, Category = "Camera|Bookmarks")
+	void SetCameraBookmark(int32 Slot);
+	const FStrategyCameraBookmark* GetCameraBookmark(int32 Slot) const;
+
+	// Requests the destination's World Partition cells, its bookmark assets and its ground heights, then moves there:
+	// right away along the camera springs, or with bCutWhenReady as one cut once the prefetch has completed (or
+	// JumpPrefetchTimeout has passed). Returns false for an empty slot.
+	UFUNCTION(BlueprintCallable, Category = "Camera|Bookmarks")
+	bool JumpToCameraBookmark(int32 Slot, bool bCutWhenReady = false);
+	// As JumpToCameraBookmark, to a bookmark that isn't in a slot; named apart so the UFUNCTION has no overload.
+	bool JumpToCameraBookmarkData(const FStrategyCameraBookmark& Bookmark, bool bCutWhenReady = false);
+
+	bool IsCameraJumpPending() const { return bCameraJumpPending; }
+	const FStrategyCameraJumpMetrics& GetLastCameraJumpMetrics() const { return LastCameraJumpMetrics; }
+
+	// --- Startup ---
+	// Soft-referenced assets the controller needs before it takes input, preloaded by AStrategyGameMode::InitGame
+	// while the map's initial cells stream in.
+	void GetStartupAssets(TArray<FSoftObjectPath>& OutAssets) const;
+	const FStrategyStartupMetrics& GetStartupMetrics() const { return StartupMetrics; }
+
+	// --- Building placement ---
+	// Previews a FootprintSize (cells) building of BuildingClass under the cursor until confirmed or cancelled. While
+	// placing, the select action confirms and the move order action cancels. The preview is validated against
+	// UStrategyPlacementSubsystem's grid and the cursor is put on the ground through the height cache, so moving it
+	// issues no physics queries.
+	UFUNCTION(BlueprintCallable, Category = "Placement")
+	void BeginPlacement(TSubclassOf<AActor> BuildingClass, FIntPoint FootprintSize);
+	UFUNCTION(BlueprintCallable, Category = "Placement")
+	void CancelPlacement();
+	// Turns the preview a quarter turn.
+	UFUNCTION(BlueprintCallable, Category = "Placement")
+	void RotatePlacement();
+	// Spawns the building at the preview if the spot is free; the building's footprint component then occupies it.
+	UFUNCTION(BlueprintCallable, Category = "Placement")
+	AActor* ConfirmPlacement();
+
+	UFUNCTION(BlueprintPure, Category = "Placement")
+	bool IsPlacing() const { return PlacementClass != nullptr; }
+	// Where the building would go (centered on its cells, yaw in quarter turns), for the ghost.
+	UFUNCTION(BlueprintPure, Category = "Placement")
+	FTransform GetPlacementTransform() const;
+	UFUNCTION(BlueprintPure, Category = "Placement")
+	bool IsPlacementValid() const { return bPlacementValid; }
+
+	// Puts the preview at a ground point instead of the cursor, e.g. for benchmarks or gamepad placement.
+	void SetPlacementLocation(const FVector& Location);
+
+	// --- Input recording ---
+	// Records the Move, Zoom, Rotate and PanDrag input with frame times and cursor positions into a ring of MaxRecords
+	// 16-byte entries, allocated here once. Older input is overwritten when the ring is full.
+	void StartInputRecording(int32 MaxRecords = 262144);
+	void StopInputRecording() { InputRecorder.Stop(); }
+	bool IsRecordingInput() const { return InputRecorder.IsRecording(); }
+	// Writes the recorded input from the oldest state snapshot still in the ring.
+	bool SaveInputRecording(const FString& Filename) const { return InputRecorder.Save(Filename); }
+
+	// Restores the recording's starting state, then feeds one recorded frame per frame back through the Handle*Input
+	// functions with the recorded frame times, ignoring live input. With bMaxSpeed the engine runs on a fixed time step
+	// at the recorded frame times, as fast as it can, instead of in real time.
+	bool StartInputReplay(const FString& Filename, bool bMaxSpeed = true);
+	void StopInputReplay();
+	bool IsReplayingInput() const { return InputPlayer.IsOpen(); }
+
 protected:
+	virtual void PostInitializeComponents() override;
 	virtual void OnPossess(APawn* InPawn) override;
+	virtual void OnUnPossess() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaTime) override;
+	virtual void PlayerTick(float DeltaTime) override;
 	virtual void SetupInputComponent() override;
+	virtual void RegisterActorTickFunctions(bool bRegister) override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
 	
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	TObjectPtr<UStrategyCursorQueryComponent> CursorQuery;
+
 	// --- Input Actions & Context ---
+	// Soft references: loading the controller class doesn't load them; see GetStartupAssets.
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input")
-	TObjectPtr<UInputMappingContext> DefaultMappingContext;
+	TSoftObjectPtr<UInputMappingContext> DefaultMappingContext;
 
 	// (Other UInputAction properties remain the same)
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input|Movement")
-	TObjectPtr<UInputAction> MoveAction;
+	TSoftObjectPtr<UInputAction> MoveAction;
+
+	// Hold to drag the ground with the cursor (e.g. middle mouse button).
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input|Movement")
+	TSoftObjectPtr<UInputAction> PanDragAction;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input|Camera")
-	TObjectPtr<UInputAction> ZoomAction;
+	TSoftObjectPtr<UInputAction> ZoomAction;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input|Camera")
-	TObjectPtr<UInputAction> RotateActionTrigger;
+	TSoftObjectPtr<UInputAction> RotateActionTrigger;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input|Camera")
-	TObjectPtr<UInputAction> RotateActionValue;
+	TSoftObjectPtr<UInputAction> RotateActionValue;
+
+	// Press starts a marquee at the cursor, release selects the units inside it. Hold Shift to add to the selection.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input|Selection")
+	TSoftObjectPtr<UInputAction> SelectAction;
+
+	// Orders the selection to the ground point under the cursor.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input|Selection")
+	TSoftObjectPtr<UInputAction> MoveOrderAction;
+
+	// Turns the building being placed a quarter turn.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input|Placement")
+	TSoftObjectPtr<UInputAction> RotatePlacementAction;
 
 	// --- ADD THESE DEBUGGING VARIABLES ---
 	FVector DebugBeforeZoomLocation;
@@ -62,42 +285,297 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Zoom")
 	float ZoomStepAmount = 200.0f;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Zoom")
-	float ZoomInterpSpeed = 5.0f;
+	// Camera smoothing runs at this fixed rate (Hz), independent of the frame rate; rendering interpolates between steps.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Smoothing", meta = (ClampMin = "10.0", ClampMax = "1000.0"))
+	float CameraSubstepRate = 120.0f;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Rotation")
-	float RotationInterpSpeed = 5.0f;
+	// Upper bound on smoothing steps per frame; after a longer hitch the camera lags behind instead of catching up.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Smoothing", meta = (ClampMin = "1"))
+	int32 MaxCameraSubstepsPerFrame = 32;
+
+	// Angular frequencies (rad/s) of the critically damped springs for each camera channel. Higher is snappier.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Smoothing", meta = (ClampMin = "0.1"))
+	float ZoomSpringFrequency = 10.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Smoothing", meta = (ClampMin = "0.1"))
+	float PitchSpringFrequency = 10.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Smoothing", meta = (ClampMin = "0.1"))
+	float YawSpringFrequency = 12.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Smoothing", meta = (ClampMin = "0.1"))
+	float PanSpringFrequency = 12.0f;
+
+	// Arm length (cm) and pitch/yaw (degrees) distance from their targets below which the camera counts as settled.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Settle", meta = (ClampMin = "0.0"))
+	float ZoomSettleTolerance = 0.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Settle", meta = (ClampMin = "0.0"))
+	float PitchSettleTolerance = 0.05f;
+
+	// Pan distance (cm) from the target and pan speed (cm/s) below which movement counts as settled.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Settle", meta = (ClampMin = "0.0"))
+	float MovementSettleSpeed = 1.0f;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Rotation")
 	float CameraRotationSpeed = 0.5f;
 
+	// Multiplier on the movement component's MaxSpeed for key and edge-scroll panning.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Movement")
-	float CameraMoveSpeed = 1.0f; // Note: This will now be a multiplier for AddMovementInput
+	float CameraMoveSpeed = 1.0f;
+
+	// Pan speed multiplier at MinZoomLength and MaxZoomLength, so panning covers about the same screen distance at any zoom.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Movement", meta = (ClampMin = "0.0"))
+	float PanSpeedScaleAtMinZoom = 0.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Movement", meta = (ClampMin = "0.0"))
+	float PanSpeedScaleAtMaxZoom = 2.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Movement")
+	bool bEnableEdgeScroll = true;
+
+	// Width (pixels) of the band along the viewport border where the cursor pans; speed ramps up towards the border.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Movement", meta = (ClampMin = "0.0", EditCondition = "bEnableEdgeScroll"))
+	float EdgeScrollMargin = 20.0f;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Zoom")
-	TObjectPtr<UCurveFloat> CameraPitchByZoomCurve;
+	TSoftObjectPtr<UCurveFloat> CameraPitchByZoomCurve;
+
+	// Number of samples CameraPitchByZoomCurve is baked into over [MinZoomLength, MaxZoomLength].
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Zoom", meta = (ClampMin = "2", ClampMax = "256"))
+	int32 PitchCurveTableResolution = 64;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Zoom", meta = (ClampMin = "0.0", ClampMax = "1.0"))
 	float ZoomRecenterStrength = 0.5f;
 
+	// How far (in pixels) the cursor may move before the next wheel notch starts a new zoom gesture with a fresh ground trace.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Zoom", meta = (ClampMin = "0.0"))
+	float ZoomAnchorCursorTolerance = 2.0f;
+
+	// Keep the pawn on the ground (UStrategyTerrainHeightSubsystem heights) and anchor zoom on the cached heightfield.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Terrain")
+	bool bFollowTerrain = true;
+
+	// Ground heights are prefetched around the pan target out to this multiple of the arm length.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Terrain", meta = (ClampMin = "0.0", EditCondition = "bFollowTerrain"))
+	float TerrainPrefetchArmLengthScale = 2.0f;
+
+	// Rendering cost bands by arm length, sorted by MinArmLength. Zooming out moves to cheaper tiers.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Zoom Tiers")
+	TArray<FStrategyZoomTier> ZoomTiers;
+
+	// How far (cm) past a tier boundary the arm length must go before the tier switches.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Zoom Tiers", meta = (ClampMin = "0.0"))
+	float ZoomTierHysteresis = 150.0f;
+
+	// Half size (pixels) of the square selected by a click, and the drag distance below which a marquee counts as a click.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Selection", meta = (ClampMin = "0.0"))
+	float MarqueeClickRadius = 8.0f;
+
+	// Distance (cm) between the destination slots of units sharing a move order.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Units", meta = (ClampMin = "0.0"))
+	float MoveOrderSpacing = 150.0f;
+
+	// Slot layout of move orders, facing the camera's yaw.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Units")
+	EStrategyFormationShape MoveOrderFormation = EStrategyFormationShape::Box;
+
+	// Mesh for the instanced unit representation, used by StrategySpawnUnits.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Units")
+	TObjectPtr<UStaticMesh> UnitMesh;
+
+	// Saved camera positions by slot; may be authored on the Blueprint controller.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Bookmarks")
+	TArray<FStrategyCameraBookmark> CameraBookmarks;
+
+	// Longest a cut jump waits for the destination to stream in before cutting anyway.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera|Bookmarks", meta = (ClampMin = "0.0"))
+	float JumpPrefetchTimeout = 3.0f;
+
+	// Frames between the state snapshots an input recording can be replayed from. Longer intervals cut more off the start of a wrapped recording.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug", meta = (ClampMin = "1"))
+	int32 InputRecordingSnapshotInterval = 300;
 
 private:
+	friend struct FStrategyCameraTickFunction;
+	friend class UStrategyBenchmarkCommandlet;
+
 	// A cached pointer to the pawn we are controlling.
 	UPROPERTY()
 	TObjectPtr<AStrategyCameraPawn> PossessedCameraPawn;
+
+	UPROPERTY()
+	TObjectPtr<UStrategyTerrainHeightSubsystem> TerrainHeights;
 	
 
 	float TargetZoomLength;
 	bool bIsRotatingCamera;
 	FVector2D LastMousePositionForRotation;
 
+	// --- Zoom-to-cursor ---
+	// Cached for the whole zoom gesture so wheel notches after the first one don't trace.
+	FStrategyZoomAnchor ZoomAnchor;
+	FVector2D ZoomAnchorMousePosition;
+
+	// CameraPitchByZoomCurve baked over the zoom range; rebuilt on possess and when the inputs change in the editor.
+	FStrategyCurveTable PitchCurveTable;
+
+	// Owns the console variable overrides for ZoomTiers; restored in EndPlay.
+	FStrategyZoomTierSelector ZoomTierSelector;
+
+	// --- Camera smoothing ---
+	// Arm length, pitch, yaw and pan, stepped at CameraSubstepRate. TargetPanLocation is where panning is heading.
+	FStrategyCameraIntegrator CameraIntegrator;
+	FVector TargetPanLocation = FVector::ZeroVector;
+
+	// --- Pan input ---
+	// Key input summed over this frame's move events; sampled together with edge scroll and drag once per frame in Tick.
+	FVector2D PendingPanKeyInput = FVector2D::ZeroVector;
+	// This frame's pan: screen-axis intent (X right, Y forward, length <= 1) and drag distance in pixels.
+	FVector2D FramePanIntent = FVector2D::ZeroVector;
+	FVector2D FramePanDragPixels = FVector2D::ZeroVector;
+	int32 FrameViewportWidth = 0;
+	FVector2D LastPanDragMousePosition = FVector2D::ZeroVector;
+	bool bIsPanDragging = false;
+	uint64 NumPawnMoves = 0;
+	// Pawn root whose TransformUpdated counts NumPawnMoves.
+	TWeakObjectPtr<USceneComponent> ObservedPawnRoot;
+	FDelegateHandle PawnTransformUpdatedHandle;
+
+	// --- Camera settle state machine ---
+	FStrategyCameraTickFunction CameraTickFunction;
+	EStrategyCameraSettleState CameraSettleState = EStrategyCameraSettleState::Settled;
+	uint64 NumCameraUpdateTicks = 0;
+
+	// --- Input recording and replay ---
+	FStrategyInputRecorder InputRecorder;
+	FStrategyInputPlayer InputPlayer;
+	// Recorded time of the frame being replayed, used by the camera instead of the engine's; negative when not replaying.
+	float ReplayDeltaTime = -1.f;
+	bool bReplayAtMaxSpeed = false;
+	bool bSavedUseFixedTimeStep = false;
+	double SavedFixedDeltaTime = 0.0;
+
+	// --- Camera jumps ---
+	FStrategyCameraBookmark PendingJumpBookmark;
+	// Keeps the last jump's assets loaded while the camera is there.
+	TSharedPtr<FStreamableHandle> CameraJumpAssets;
+	uint64 CameraJumpStartCycles = 0;
+	uint64 CameraJumpStartFrame = 0;
+	bool bCameraJumpPending = false;
+	bool bCameraJumpCut = false;
+	bool bCameraJumpPrefetched = false;
+	FStrategyCameraJumpMetrics LastCameraJumpMetrics;
+
+	// --- Startup ---
+	// Holds the startup assets loaded for the controller's lifetime.
+	TSharedPtr<FStreamableHandle> StartupAssets;
+	double StartupStartSeconds = 0.0;
+	FStrategyStartupMetrics StartupMetrics;
+
+	// --- Building placement ---
+	UPROPERTY()
+	TSubclassOf<AActor> PlacementClass;
+
+	FIntPoint PlacementSize = FIntPoint(1, 1);
+	int32 PlacementQuarterTurns = 0;
+	// Rotated footprint, and the cell and grid revision it was last validated at.
+	FStrategyPlacementFootprint PlacementFootprint;
+	FIntPoint PlacementCell = FIntPoint(MAX_int32, MAX_int32);
+	uint32 PlacementRevision = MAX_uint32;
+	FVector PlacementGroundPoint = FVector::ZeroVector;
+	bool bPlacementValid = false;
+
+	// --- Selection ---
+	TArray<FStrategyUnitHandle> SelectedUnits;
+	TArray<FStrategyUnitHandle> MarqueeScratch;
+	TSet<FStrategyUnitHandle> MarqueeSelectedSet;
+	FVector2D MarqueeStartPosition = FVector2D::ZeroVector;
+	bool bIsMarqueeSelecting = false;
+
 	// --- Input Handling Functions (declarations are the same) ---
 	void HandleMoveInput(const FInputActionValue& Value);
+	void HandlePanDragStarted(const FInputActionValue& Value);
+	void HandlePanDragCompleted(const FInputActionValue& Value);
 	void HandleZoomInput(const FInputActionValue& Value);
 	void HandleRotateCameraTrigger(const FInputActionValue& Value);
 	void HandleRotateCameraValue(const FInputActionValue& Value);
+	void HandleSelectStarted(const FInputActionValue& Value);
+	void HandleSelectCompleted(const FInputActionValue& Value);
+	void HandleMoveOrder(const FInputActionValue& Value);
+	void HandleRotatePlacement(const FInputActionValue& Value);
+	void HandlePawnTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
 
 	void InitializeCameraSettings();
-	void UpdateCameraZoomAndPitch(float DeltaTime);
+	// Moves the NumPawnMoves counter to Root (null to stop counting).
+	void ObservePawnRoot(USceneComponent* Root);
+	// Binds whichever input actions are loaded, replacing earlier bindings.
+	void BindInputActions();
+	// Advances the startup phases; once the pawn is possessed and the startup assets are in, sets up input and the pitch curve.
+	void UpdateStartup();
+	void AddDefaultMappingContext();
+	void NoteInputProcessed();
+	void BakePitchCurveTable();
+	void UpdateStreamingTarget();
+	// Boom pitch (negative = looking down) for an arm length, read from the baked curve table.
+	float GetBoomPitchForArmLength(float ArmLength) const { return PitchCurveTable.Evaluate(ArmLength) * -1.f; }
+	bool BeginZoomAnchor();
+	FRotator GetBoomWorldRotation(float BoomPitch) const;
+	void TickCamera(float DeltaTime);
+	bool IsCameraSettled() const;
+	void SettleCamera();
+	// Re-seeds the camera springs from the pawn and boom as they are now, at rest.
+	void ResetCameraIntegrator();
+	FStrategyCameraSpringTargets MakeCameraSpringTargets() const;
+	FStrategyCameraSpringSettings MakeCameraSpringSettings() const;
+	void UpdateCameraSprings(float DeltaTime);
+	// Puts the pan target on the cached ground height and prefetches the heights around it.
+	void FollowTerrain();
+	// Reads viewport size and mouse position once and folds keys, edge scroll and drag into this frame's pan.
+	void SampleCameraPanInput();
+	float GetPanSpeedScale(double ArmLength) const;
 	void UpdateCameraMovement(float DeltaTime);
+	// Opens this frame in the recording (with a snapshot when one is due) and appends the event, unless it is a Frame.
+	void RecordInput(EStrategyInputRecordType Type, float A = 0.f, float B = 0.f, uint8 Flags = 0);
+	FStrategyInputSnapshot MakeInputSnapshot() const;
+	void ApplyInputSnapshot(const FStrategyInputSnapshot& Snapshot);
+	void ReplayInputFrame();
+	// Adds or removes DefaultMappingContext, so live devices don't interfere with a replay.
+	void SetLiveInputEnabled(bool bEnabled);
+	// Springs towards the pending bookmark (or cuts to it), then tracks the jump until the view is stable.
+	void MoveToCameraBookmark(const FStrategyCameraBookmark& Bookmark, bool bCut);
+	void UpdateCameraJump();
+	// Follows the cursor with the placement preview; re-validates only when its cell or the grid changed.
+	void UpdatePlacementPreview();
+	// Ground point under the cursor from the height cache, or on the pawn's ground plane where nothing is cached.
+	bool GetCursorGroundPoint(FVector& OutPoint) const;
+
+	// Spawns simulated units on a disc around the pawn and selects them. No-op in Shipping.
+	UFUNCTION(Exec)
+	void StrategySpawnUnits(int32 Count = 1000, float Radius = 5000.f);
+
+	// Starts a single-player lockstep session over a loopback transport (units on a disc around the pawn, selected),
+	// so move orders go through the lockstep path; or ends it. No-op in Shipping.
+	UFUNCTION(Exec)
+	void StrategyStartLockstep(int32 Count = 1000, float Radius = 5000.f, float TurnMs = 100.f);
+
+	UFUNCTION(Exec)
+	void StrategyEndLockstep();
+
+	// Input recording from the console. Relative file names go to Saved/InputRecordings. No-op in Shipping.
+	UFUNCTION(Exec)
+	void StrategyRecordInput(int32 MaxRecords = 262144);
+
+	UFUNCTION(Exec)
+	void StrategySaveInput(const FString& Filename = TEXT("Session.stinput"));
+
+	UFUNCTION(Exec)
+	void StrategyReplayInput(const FString& Filename = TEXT("Session.stinput"), bool bMaxSpeed = true);
+
+	// Camera bookmarks from the console. No-op in Shipping.
+	UFUNCTION(Exec)
+	void StrategySetBookmark(int32 Slot);
+
+	UFUNCTION(Exec)
+	void StrategyJumpBookmark(int32 Slot, bool bCutWhenReady = false);
 };
\ No newline at end of file
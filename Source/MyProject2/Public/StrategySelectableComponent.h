@@ -0,0 +1,32 @@
+// StrategySelectableComponent.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "StrategyUnitRegistrySubsystem.h"
+#include "StrategySelectableComponent.generated.h"
+
+/**
+ * Makes the owning actor a selectable unit: registers it with UStrategyUnitRegistrySubsystem for its lifetime and
+ * forwards root component moves to the registry. Does not tick.
+ */
+UCLASS(ClassGroup = (Strategy), meta = (BlueprintSpawnableComponent))
+class MYPROJECT2_API UStrategySelectableComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UStrategySelectableComponent();
+
+	FStrategyUnitHandle GetUnitHandle() const { return UnitHandle; }
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	void OnRootTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	FStrategyUnitHandle UnitHandle;
+	FDelegateHandle TransformUpdatedHandle;
+};
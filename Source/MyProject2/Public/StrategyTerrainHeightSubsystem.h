@@ -0,0 +1,112 @@
+// StrategyTerrainHeightSubsystem.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "StrategyTerrainHeightSubsystem.generated.h"
+
+class ULevel;
+
+struct FStrategyTerrainHeightSettings
+{
+	// Tile size (cm) and samples per side, edges included, so a lookup never needs a neighbouring tile.
+	double TileSize = 3200.0;
+	int32 SamplesPerTileSide = 33;
+
+	// Downward traces start at TraceTopZ and stop at TraceBottomZ. Samples without a hit use NoGroundHeight.
+	double TraceTopZ = 100000.0;
+	double TraceBottomZ = -100000.0;
+	float NoGroundHeight = 0.f;
+	ECollisionChannel TraceChannel = ECC_WorldStatic;
+
+	// Tiles whose traces are issued per frame, and the number of tiles kept (least recently used are dropped).
+	int32 MaxTilesPerFrame = 4;
+	int32 MaxCachedTiles = 256;
+
+	double GetSampleSpacing() const { return TileSize / (SamplesPerTileSide - 1); }
+};
+
+/**
+ * Tiled heightfield of the ground (landscape and static geometry), sampled lazily around the camera.
+ *
+ * A tile is sampled with one batch of asynchronous downward traces, run by the engine's async trace task off the
+ * game thread; results land a frame later. Until a tile is ready, lookups in it fail and callers keep their
+ * previous answer. Stale tiles (after Invalidate, or a level streaming in or out) keep serving the old heights
+ * until the new ones arrive. Lookups are a map find and a bilinear blend of four samples, with no physics query.
+ */
+UCLASS()
+class MYPROJECT2_API UStrategyTerrainHeightSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Bilinear ground height at Location. Queues the tile and returns false if it has no heights yet.
+	bool GetHeight(const FVector2D& Location, float& OutHeight);
+
+	// First point where the ray meets the heightfield, marching at the sample spacing. False if the ray leaves the
+	// sampled area (or MaxDistance) before hitting, so the caller can fall back to a physics query.
+	bool Raycast(const FVector& Origin, const FVector& Direction, double MaxDistance, FVector& OutHit);
+
+	// Queues every tile overlapping the disc for sampling, nearest first.
+	void RequestArea(const FVector2D& Center, double Radius);
+
+	// Marks the tiles overlapping Bounds for re-sampling; they keep their current heights until then.
+	void Invalidate(const FBox2D& Bounds);
+	void InvalidateAll();
+
+	// Issues traces for queued tiles now instead of waiting for Tick; the results still arrive with the async traces.
+	void FlushRequests();
+
+	// Replaces the settings and drops every tile.
+	void Configure(const FStrategyTerrainHeightSettings& InSettings);
+	const FStrategyTerrainHeightSettings& GetSettings() const { return Settings; }
+
+	int32 GetNumReadyTiles() const { return NumReadyTiles; }
+	// Tiles queued or with traces in flight.
+	int32 GetNumPendingTiles() const { return NumPendingTiles; }
+
+private:
+	struct FTile
+	{
+		// SamplesPerTileSide^2 heights, row-major (Y rows).
+		TArray<float> Heights;
+		// Heights from the traces in flight, swapped in when the last one returns.
+		TArray<float> PendingHeights;
+		float MaxHeight = 0.f;
+		int32 NumPendingSamples = 0;
+		// Serial of the latest sampling request (from NextRequestSerial); results of any other request are ignored.
+		uint32 RequestSerial = 0;
+		uint64 LastUsedFrame = 0;
+		bool bReady = false;
+		bool bQueued = false;
+		bool bStale = false;
+	};
+
+	FIntPoint GetTileKey(const FVector2D& Location) const;
+	FTile& FindOrAddTile(const FIntPoint& Key);
+	void QueueTile(const FIntPoint& Key, FTile& Tile);
+	void IssueTileTraces(const FIntPoint& Key, FTile& Tile);
+	void OnSampleTraced(const FTraceHandle& Handle, FTraceDatum& Data, FIntPoint TileKey, uint32 RequestSerial);
+	void EvictTiles();
+	void OnLevelChanged(ULevel* Level, UWorld* World);
+
+	FStrategyTerrainHeightSettings Settings;
+	TMap<FIntPoint, FTile> Tiles;
+	TArray<FIntPoint> RequestQueue;
+	int32 NumReadyTiles = 0;
+	int32 NumPendingTiles = 0;
+	// Highest sampled height, where Raycast starts marching.
+	float MaxSampledHeight = -UE_MAX_FLT;
+	// Subsystem-wide and never reset, so traces still in flight for an evicted (or reconfigured) tile can't match the
+	// request of a tile recreated under the same key.
+	uint32 NextRequestSerial = 0;
+
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+};
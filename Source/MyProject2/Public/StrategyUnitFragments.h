@@ -0,0 +1,61 @@
+// StrategyUnitFragments.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "StrategyUnitRegistrySubsystem.h"
+#include "StrategyFogOfWarSubsystem.h"
+#include "StrategyUnitFragments.generated.h"
+
+// Mass fragments for simulated units. Kept trivially copyable: chunks are memcpy'd when entities change archetype.
+
+USTRUCT()
+struct MYPROJECT2_API FStrategyUnitTransformFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FVector Location = FVector::ZeroVector;
+	float Yaw = 0.f;
+};
+
+USTRUCT()
+struct MYPROJECT2_API FStrategyUnitVelocityFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FVector Velocity = FVector::ZeroVector;
+};
+
+USTRUCT()
+struct MYPROJECT2_API FStrategyUnitMoveTargetFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FVector Target = FVector::ZeroVector;
+	float MaxSpeed = 600.f;
+	// Distance (cm) to Target at which the unit stops.
+	float AcceptanceRadius = 25.f;
+	// Shared flow field towards the order's destination (UStrategyFlowFieldSubsystem id), or INDEX_NONE to steer straight.
+	// Keeps the field from being evicted until the unit arrives; only set through UStrategyUnitSimulationSubsystem.
+	int32 FlowFieldId = INDEX_NONE;
+	// Set by the movement processor; the sync processor removes FStrategyUnitMovingTag when it sees it.
+	bool bArrived = false;
+};
+
+// Links an entity to its registry entry (selection), its instance in the ISM representation and its fog-of-war vision.
+USTRUCT()
+struct MYPROJECT2_API FStrategyUnitInstanceFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FStrategyUnitHandle UnitHandle;
+	int32 InstanceIndex = INDEX_NONE;
+	FStrategyVisionHandle VisionHandle;
+};
+
+// Present while the unit has a move order; idle units are skipped by every per-frame processor.
+USTRUCT()
+struct MYPROJECT2_API FStrategyUnitMovingTag : public FMassTag
+{
+	GENERATED_BODY()
+};
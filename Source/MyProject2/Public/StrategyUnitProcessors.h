@@ -0,0 +1,61 @@
+// StrategyUnitProcessors.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "MassEntityQuery.h"
+#include "StrategyFlowFieldSubsystem.h"
+#include "StrategyUnitProcessors.generated.h"
+
+class UStrategyUnitSimulationSubsystem;
+
+/**
+ * Moves units with a move order towards their target, following the order's flow field while one is ready and
+ * steering straight to the unit's own slot for the last stretch. Runs over chunks in parallel
+ * (Strategy.Units.ParallelMovement) and only writes to the entity's own fragments, so chunks are independent.
+ * Not registered with the Mass processing phases; UStrategyUnitSimulationSubsystem runs it explicitly.
+ */
+UCLASS()
+class MYPROJECT2_API UStrategyUnitMovementProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UStrategyUnitMovementProcessor();
+
+	// Ready flow fields by id, gathered on the game thread before the processor runs; read-only while it runs.
+	void SetFlowFields(const TMap<int32, FStrategyFlowFieldRef>* InFlowFields) { FlowFields = InFlowFields; }
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery EntityQuery;
+	const TMap<int32, FStrategyFlowFieldRef>* FlowFields = nullptr;
+};
+
+/**
+ * Game-thread pass after movement over the moving units only: pushes positions to the unit registry and the
+ * instance transforms to the representation, and clears the moving tag of units that arrived.
+ */
+UCLASS()
+class MYPROJECT2_API UStrategyUnitSyncProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UStrategyUnitSyncProcessor();
+
+	void SetSimulation(UStrategyUnitSimulationSubsystem* InSimulation) { Simulation = InSimulation; }
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery EntityQuery;
+
+	UPROPERTY()
+	TObjectPtr<UStrategyUnitSimulationSubsystem> Simulation;
+};
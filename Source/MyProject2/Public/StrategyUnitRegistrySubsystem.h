@@ -0,0 +1,123 @@
+// StrategyUnitRegistrySubsystem.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyUnitRegistrySubsystem.generated.h"
+
+struct FMinimalViewInfo;
+
+// Stable reference to a registered unit. Stale handles (unit unregistered, slot reused) are detected by the serial.
+struct FStrategyUnitHandle
+{
+	int32 Id = INDEX_NONE;
+	uint32 Serial = 0;
+
+	bool IsSet() const { return Id != INDEX_NONE; }
+	bool operator==(const FStrategyUnitHandle& Other) const { return Id == Other.Id && Serial == Other.Serial; }
+	friend uint32 GetTypeHash(const FStrategyUnitHandle& Handle) { return HashCombine(::GetTypeHash(Handle.Id), ::GetTypeHash(Handle.Serial)); }
+};
+
+// A screen rectangle and the perspective view it is drawn in, prepared once per selection query.
+struct FStrategyScreenQuery
+{
+	// Positions are made relative to the view origin before projection so the batch can run in float.
+	FVector ViewOrigin = FVector::ZeroVector;
+	FMatrix TranslatedViewProjection = FMatrix::Identity;
+
+	// Rectangle in normalized device coordinates (X right, Y up).
+	FVector2f NdcMin = FVector2f::ZeroVector;
+	FVector2f NdcMax = FVector2f::ZeroVector;
+
+	// Camera-space rays through the rectangle corners (bottom-left, bottom-right, top-right, top-left), for culling.
+	FVector CornerRays[4];
+
+	// Builds the query from a camera view and two opposite corners of the rectangle in viewport pixels.
+	static FStrategyScreenQuery Make(const FMinimalViewInfo& View, const FIntPoint& ViewportSize, const FVector2D& ScreenStart, const FVector2D& ScreenEnd);
+};
+
+/**
+ * Selectable units of a world, kept in a uniform 2D grid over X/Y with positions stored as structure-of-arrays.
+ *
+ * Units are densely packed: removal swaps the last unit into the hole, and every unit knows its cell and its slot in
+ * that cell, so register, move and unregister are O(1). Screen-rectangle selection first culls cells against the
+ * rectangle's frustum and then projects the surviving candidates four at a time with SIMD.
+ */
+UCLASS()
+class MYPROJECT2_API UStrategyUnitRegistrySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Cell edge length (cm) of the grid.
+	static constexpr double CellSize = 2000.0;
+
+	// Actor may be null for units that have no actor of their own (e.g. instanced units).
+	FStrategyUnitHandle RegisterUnit(AActor* Actor, const FVector& Location);
+	void UnregisterUnit(FStrategyUnitHandle Handle);
+	void UnregisterAllUnits();
+
+	// Updates a unit's position; only touches the grid when the unit crosses into another cell.
+	void UpdateUnitLocation(FStrategyUnitHandle Handle, const FVector& Location);
+
+	bool IsValidUnit(FStrategyUnitHandle Handle) const;
+	FVector GetUnitLocation(FStrategyUnitHandle Handle) const;
+	AActor* GetUnitActor(FStrategyUnitHandle Handle) const;
+	int32 GetNumUnits() const { return DenseIds.Num(); }
+
+	// Positions of all units in dense order, for whole-population passes (e.g. the minimap). Invalidated by register/unregister.
+	TConstArrayView<double> GetUnitPositionsX() const { return PositionX; }
+	TConstArrayView<double> GetUnitPositionsY() const { return PositionY; }
+
+	// Appends every unit whose position projects inside the query rectangle (in front of the camera). Returns the number added.
+	int32 SelectInScreenRect(const FStrategyScreenQuery& Query, TArray<FStrategyUnitHandle>& OutUnits);
+
+	// Number of units that survived the cell cull in the last SelectInScreenRect, for benchmarks and stats.
+	int32 GetLastNumCandidates() const { return LastNumCandidates; }
+
+private:
+	struct FCell
+	{
+		// Dense indices of the units in this cell.
+		TArray<int32> Units;
+		// Z range of everything ever added to the cell; only grows until the cell empties.
+		double MinZ = UE_DOUBLE_BIG_NUMBER;
+		double MaxZ = -UE_DOUBLE_BIG_NUMBER;
+	};
+
+	static FIntPoint GetCellCoord(double X, double Y);
+
+	int32 FindDenseIndex(FStrategyUnitHandle Handle) const;
+	void AddToCell(int32 DenseIndex);
+	void RemoveFromCell(int32 DenseIndex);
+
+	// Cells whose box intersects the query frustum.
+	void GatherCandidateCells(const FStrategyScreenQuery& Query, TArray<const FCell*>& OutCells) const;
+
+	// --- Dense unit data (SoA), indexed by dense index ---
+	TArray<double> PositionX;
+	TArray<double> PositionY;
+	TArray<double> PositionZ;
+	TArray<FIntPoint> UnitCells;
+	TArray<int32> UnitSlotsInCell;
+	TArray<TWeakObjectPtr<AActor>> UnitActors;
+	TArray<int32> DenseIds;
+
+	// --- Handle table, indexed by id ---
+	TArray<int32> DenseIndexById;
+	TArray<uint32> SerialById;
+	TArray<int32> FreeIds;
+
+	TMap<FIntPoint, FCell> Cells;
+	// Z range of all units ever registered; bounds the frustum slab used to find candidate cells.
+	double UnitsMinZ = UE_DOUBLE_BIG_NUMBER;
+	double UnitsMaxZ = -UE_DOUBLE_BIG_NUMBER;
+
+	// Scratch buffers reused by SelectInScreenRect so a query doesn't allocate once warmed up.
+	TArray<const FCell*> ScratchCells;
+	TArray<int32> ScratchCandidates;
+	TArray<float> ScratchX;
+	TArray<float> ScratchY;
+	TArray<float> ScratchZ;
+	int32 LastNumCandidates = 0;
+};
@@ -0,0 +1,116 @@
+// StrategyUnitSimulationSubsystem.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MassEntityTypes.h"
+#include "StrategyUnitRegistrySubsystem.h"
+#include "StrategyFlowFieldSubsystem.h"
+#include "StrategyFogOfWarSubsystem.h"
+#include "StrategyFormation.h"
+#include "StrategyUnitSimulationSubsystem.generated.h"
+
+class UStaticMesh;
+class UInstancedStaticMeshComponent;
+class UStrategyUnitMovementProcessor;
+class UStrategyUnitSyncProcessor;
+struct FMassEntityManager;
+struct FStrategyUnitMoveTargetFragment;
+
+/**
+ * Mass-based unit layer: units are entities (transform, velocity, move target) instead of actors, rendered through one
+ * instanced static mesh, registered with UStrategyUnitRegistrySubsystem so marquee selection finds them, and given a
+ * vision source in UStrategyFogOfWarSubsystem.
+ *
+ * Ticks once per frame and runs its processors directly, movement (parallel over chunks) then sync (game thread).
+ * Only units with a move order are touched each frame.
+ */
+UCLASS()
+class MYPROJECT2_API UStrategyUnitSimulationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Mesh used for the instanced representation. Units spawned before a mesh is set are not rendered.
+	void SetRepresentationMesh(UStaticMesh* Mesh);
+
+	// Creates one idle unit per location. Appends the units' registry handles to OutUnits if given.
+	void SpawnUnits(TConstArrayView<FVector> Locations, TArray<FStrategyUnitHandle>* OutUnits = nullptr);
+	// Destroys the given units; unknown handles are ignored. Their instances are hidden, not removed, so the other
+	// units' instance indices stay valid.
+	void DestroyUnits(TConstArrayView<FStrategyUnitHandle> Units);
+	void DestroyAllUnits();
+
+	// Orders the units to Destination, spread on a square grid with Spacing (cm) between slots. Unknown handles are ignored.
+	// All units of the order follow one shared flow field towards Destination. Returns the number of units ordered.
+	int32 MoveUnits(TConstArrayView<FStrategyUnitHandle> Units, const FVector& Destination, float Spacing);
+	// As MoveUnits, but into a Shape formation facing Yaw (degrees), each unit to the slot FStrategyFormationSolver
+	// gives it, so paths don't cross.
+	int32 MoveUnitsInFormation(TConstArrayView<FStrategyUnitHandle> Units, const FVector& Destination, EStrategyFormationShape Shape, float Yaw, float Spacing);
+	const FStrategyFormationSolver& GetFormationSolver() const { return FormationSolver; }
+
+	// Runs one simulation step; called by Tick, and directly by benchmarks.
+	void RunSimulation(float DeltaTime);
+
+	int32 GetNumUnits() const { return Entities.Num(); }
+
+	// Vision radius (cm) of units spawned from now on; 0 spawns them without vision.
+	void SetUnitVisionRadius(float Radius) { UnitVisionRadius = FMath::Max(Radius, 0.f); }
+	double GetLastMovementMs() const { return LastMovementMs; }
+	double GetLastSyncMs() const { return LastSyncMs; }
+
+private:
+	friend class UStrategyUnitSyncProcessor;
+
+	FMassEntityManager& GetEntityManager() const;
+	void FlushRepresentation();
+	// Points Target at a flow field, moving its user count from the previous field so that one isn't evicted under it.
+	void SetFlowField(FStrategyUnitMoveTargetFragment& Target, int32 FlowFieldId);
+
+	UPROPERTY()
+	TObjectPtr<UStrategyUnitMovementProcessor> MovementProcessor;
+
+	UPROPERTY()
+	TObjectPtr<UStrategyUnitSyncProcessor> SyncProcessor;
+
+	UPROPERTY()
+	TObjectPtr<UInstancedStaticMeshComponent> Representation;
+
+	UPROPERTY()
+	TObjectPtr<UStrategyUnitRegistrySubsystem> Registry;
+
+	UPROPERTY()
+	TObjectPtr<UStrategyFlowFieldSubsystem> FlowFields;
+
+	UPROPERTY()
+	TObjectPtr<UStrategyFogOfWarSubsystem> FogOfWar;
+
+	float UnitVisionRadius = 1200.f;
+
+	// Flow fields ready this frame, handed to the movement processor.
+	TMap<int32, FStrategyFlowFieldRef> ReadyFlowFields;
+
+	FMassArchetypeHandle UnitArchetype;
+	TMap<FStrategyUnitHandle, FMassEntityHandle> Entities;
+
+	// Instance transforms mirrored from the entities; the sync processor writes the moved ones and widens the dirty range.
+	TArray<FTransform> InstanceTransforms;
+	TArray<FTransform> ScratchTransforms;
+	int32 DirtyInstanceMin = MAX_int32;
+	int32 DirtyInstanceMax = INDEX_NONE;
+
+	double LastMovementMs = 0.0;
+	double LastSyncMs = 0.0;
+
+	// --- Formation orders, scratch kept between orders ---
+	FStrategyFormationSolver FormationSolver;
+	TArray<FMassEntityHandle> FormationEntities;
+	TArray<FVector> FormationUnitLocations;
+	TArray<FVector> FormationSlots;
+	TArray<int32> FormationAssignment;
+};
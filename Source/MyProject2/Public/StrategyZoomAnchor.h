@@ -0,0 +1,50 @@
+// StrategyZoomAnchor.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Closed-form zoom-to-cursor solver.
+ *
+ * The anchor is captured once per zoom gesture from the ground point under the cursor. It stores the
+ * cursor ray in camera space (constant while the cursor stays on the same pixel) and the focus point.
+ * For any later boom state (pitch, yaw, arm length) and pawn height it returns where the focus point must
+ * sit relative to the pawn so that it stays under the cursor, without tracing.
+ */
+struct MYPROJECT2_API FStrategyZoomAnchor
+{
+public:
+	// Captures the anchor. BoomRotation is the world rotation of the spring arm, ArmLength its target length.
+	// Returns false (and stays inactive) if the focus point cannot be reached by a downward cursor ray.
+	bool Begin(const FVector& PawnLocation, const FRotator& BoomRotation, float ArmLength, const FVector& InFocusPoint);
+
+	void Reset();
+
+	bool IsActive() const { return bActive; }
+
+	// The ground point captured at the start of the gesture.
+	const FVector& GetFocusPoint() const { return FocusPoint; }
+
+	// Offset from a pawn at PawnHeight (world Z) to the anchored focus point for the given boom state.
+	// Returns false if the cursor ray would not hit the focus plane for this state (e.g. pitched above the horizon).
+	bool GetPawnToFocus(const FRotator& BoomRotation, float ArmLength, double PawnHeight, FVector& OutPawnToFocus) const;
+
+	// Horizontal pawn translation that keeps the focus point under the cursor when the boom goes from one state to
+	// another. The pawn heights come from ground following; the translation is independent of where the pawn is on
+	// the plane, so it composes with panning.
+	bool ComputePawnOffset(const FRotator& FromBoomRotation, float FromArmLength, double FromPawnHeight, const FRotator& ToBoomRotation, float ToArmLength, double ToPawnHeight, FVector& OutPawnOffset) const;
+
+	// Camera location relative to the pawn for a spring arm with no socket/target offset.
+	static FVector GetCameraOffset(const FRotator& BoomRotation, float ArmLength)
+	{
+		return -BoomRotation.Vector() * ArmLength;
+	}
+
+private:
+	FVector FocusPoint = FVector::ZeroVector;
+
+	// Direction from the camera to the focus point, in camera space.
+	FVector LocalCursorDirection = FVector::ForwardVector;
+
+	bool bActive = false;
+};
@@ -0,0 +1,83 @@
+// StrategyZoomTiers.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "StrategyZoomTiers.generated.h"
+
+// Rendering cost settings for a band of camera arm lengths. A tier applies from MinArmLength up to the next tier's MinArmLength.
+USTRUCT(BlueprintType)
+struct MYPROJECT2_API FStrategyZoomTier
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Zoom Tier", meta = (ClampMin = "0.0"))
+	float MinArmLength = 0.f;
+
+	// r.ViewDistanceScale: scales cull distances (and with them HLOD/instance visibility ranges).
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Zoom Tier", meta = (ClampMin = "0.0"))
+	float ViewDistanceScale = 1.f;
+
+	// r.StaticMeshLODDistanceScale: higher values switch static meshes (and HLOD meshes) to coarser LODs sooner.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Zoom Tier", meta = (ClampMin = "0.0"))
+	float StaticMeshLODDistanceScale = 1.f;
+
+	// r.SkeletalMeshLODBias
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Zoom Tier", meta = (ClampMin = "0"))
+	int32 SkeletalMeshLODBias = 0;
+
+	// sg.ShadowQuality upper bound; the user's setting is never raised.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Zoom Tier", meta = (ClampMin = "0", ClampMax = "4"))
+	int32 MaxShadowQuality = 4;
+
+	// sg.GlobalIlluminationQuality upper bound (Lumen); the user's setting is never raised.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Zoom Tier", meta = (ClampMin = "0", ClampMax = "4"))
+	int32 MaxGlobalIlluminationQuality = 4;
+};
+
+/**
+ * Maps the interpolated arm length to a zoom tier with hysteresis, and pushes the tier's settings to the renderer's
+ * console variables only when the tier actually changes.
+ *
+ * Nothing is set above the priority the user's settings already have: the r.* variables are set at the priority they
+ * were last set with, the shadow/GI caps through Scalability::SetQualityLevels. A value someone else changed since the
+ * last ApplyTier (the scalability menu, UGameUserSettings::ApplySettings, the console) becomes the new original, and
+ * Restore() leaves it alone.
+ */
+class MYPROJECT2_API FStrategyZoomTierSelector
+{
+public:
+	// Tiers must be sorted by MinArmLength. Returns true if the selected tier changed.
+	bool Update(TConstArrayView<FStrategyZoomTier> Tiers, float ArmLength, float Hysteresis);
+
+	// Index into the tiers passed to Update, or INDEX_NONE before the first update.
+	int32 GetCurrentTier() const { return CurrentTier; }
+
+	void ApplyTier(const FStrategyZoomTier& Tier);
+
+	// Puts back the original values, with their original priority, where they still hold what ApplyTier set.
+	void Restore();
+
+private:
+	struct FSavedConsoleVariable
+	{
+		IConsoleVariable* Variable = nullptr;
+		FString Value;
+		EConsoleVariableFlags Priority = ECVF_SetByConstructor;
+		// What ApplyTier last set; anything else means the value was changed from outside.
+		FString AppliedValue;
+	};
+
+	// Sets a console variable at the priority it already has, saving its original value and priority first.
+	void SetSaved(const TCHAR* Name, const FString& Value);
+
+	TArray<FSavedConsoleVariable> SavedVariables;
+
+	// User's shadow/GI scalability levels, and the capped levels ApplyTier last set. INDEX_NONE until first applied.
+	int32 UserShadowQuality = INDEX_NONE;
+	int32 UserGlobalIlluminationQuality = INDEX_NONE;
+	int32 AppliedShadowQuality = INDEX_NONE;
+	int32 AppliedGlobalIlluminationQuality = INDEX_NONE;
+
+	int32 CurrentTier = INDEX_NONE;
+};